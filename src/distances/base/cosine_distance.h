@@ -9,4 +9,26 @@
 
 namespace base {
 	float cosine_distance_ref (const float* x, const float* y, size_t d);
+
+	/// Cosine distance given the inverse norms 1 / ||x|| and 1 / ||y||,
+	/// see fvec_inv_norms_ref.  Only the inner product is computed.
+	float cosine_distance_inv_norms_ref (const float* x, const float* y,
+	                                     size_t d, float inv_norm_x,
+	                                     float inv_norm_y);
+
+	/// Cosine distance of unit vectors, 1 - x.y.
+	float cosine_distance_normalized_ref (const float* x, const float* y,
+	                                      size_t d);
+
+	/// Cosine distances between x and ny vectors y, y_stride floats
+	/// apart, with inverse norms y_inv_norms.  The norm of x is computed
+	/// once.  If y_inv_norms is NULL the norms of y are computed.
+	void cosine_distance_ny_ref (float* dis, const float* x, const float* y,
+	                             const float* y_inv_norms, size_t d,
+	                             size_t y_stride, size_t ny);
+
+	/// inv_norms[i] = 1 / ||x_i|| of nx vectors x_i, x_stride floats
+	/// apart.
+	void fvec_inv_norms_ref (float* inv_norms, const float* x, size_t d,
+	                         size_t x_stride, size_t nx);
 }
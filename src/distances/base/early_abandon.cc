@@ -0,0 +1,65 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "early_abandon.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace base {
+
+float
+fvec_L2sqr_early_ref (const float* x, const float* y, size_t d,
+                      float threshold)
+{
+    float res = 0;
+
+    for (size_t start = 0; start < d; start += EARLY_ABANDON_BLOCK) {
+        size_t end = std::min (d, start + EARLY_ABANDON_BLOCK);
+
+        for (size_t i = start; i < end; i++) {
+            const float tmp = x[i] - y[i];
+            res += tmp * tmp;
+        }
+
+        /* The partial sum only grows, the vector can not enter the top-k.  */
+        if (res >= threshold)
+            return res;
+    }
+    return res;
+}
+
+float
+fvec_L1_early_ref (const float* x, const float* y, size_t d,
+                   float threshold)
+{
+    float res = 0;
+
+    for (size_t start = 0; start < d; start += EARLY_ABANDON_BLOCK) {
+        size_t end = std::min (d, start + EARLY_ABANDON_BLOCK);
+
+        for (size_t i = start; i < end; i++) {
+            const float tmp = x[i] - y[i];
+            res += std::fabs(tmp);
+        }
+
+        if (res >= threshold)
+            return res;
+    }
+    return res;
+}
+
+}  // namespace base
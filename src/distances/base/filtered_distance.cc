@@ -0,0 +1,68 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "filtered_distance.h"
+
+namespace base {
+
+void
+fvec_L2sqr_ny_transposed_bitmap_ref (float* dis, const float* x,
+                                     const float* y, const float* y_sqlen,
+                                     size_t d, size_t d_offset, size_t ny,
+                                     const uint64_t* bitmap)
+{
+    float x_sqlen = 0;
+    for (size_t j = 0; j < d; j++) {
+        x_sqlen += x[j] * x[j];
+    }
+
+    for (size_t i = 0; i < ny; i++) {
+        if (!((bitmap[i / ID_SELECTOR_WORD_BITS]
+               >> (i % ID_SELECTOR_WORD_BITS)) & 1))
+            continue;
+
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+
+        dis[i] = x_sqlen + y_sqlen[i] - 2 * dp;
+    }
+}
+
+void
+fvec_L2sqr_ny_transposed_ids_ref (float* dis, const float* x, const float* y,
+                                  const float* y_sqlen, size_t d,
+                                  size_t d_offset, const int64_t* ids,
+                                  size_t nids)
+{
+    float x_sqlen = 0;
+    for (size_t j = 0; j < d; j++) {
+        x_sqlen += x[j] * x[j];
+    }
+
+    for (size_t k = 0; k < nids; k++) {
+        size_t i = (size_t) ids[k];
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+
+        dis[k] = x_sqlen + y_sqlen[i] - 2 * dp;
+    }
+}
+
+}  // namespace base
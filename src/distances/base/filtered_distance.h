@@ -0,0 +1,46 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FILTERED_DISTANCE_BASE_H
+#define FILTERED_DISTANCE_BASE_H
+
+#include <cstdint>
+#include <cstdio>
+#include "filter.h"
+
+namespace base {
+
+/// squared L2 distances between x and the transposed y vectors selected by
+/// bitmap, as fvec_L2sqr_ny_transposed_ref.  dis[i] is written for the y
+/// vectors i with bit i % 64 of bitmap[i / 64] set, the other entries of
+/// dis may be written too and are not meaningful.
+void
+fvec_L2sqr_ny_transposed_bitmap_ref (float* dis, const float* x,
+                                     const float* y, const float* y_sqlen,
+                                     size_t d, size_t d_offset, size_t ny,
+                                     const uint64_t* bitmap);
+
+/// squared L2 distances between x and the nids transposed y vectors with
+/// the sorted ids, dis[k] is the distance of y vector ids[k].
+void
+fvec_L2sqr_ny_transposed_ids_ref (float* dis, const float* x, const float* y,
+                                  const float* y_sqlen, size_t d,
+                                  size_t d_offset, const int64_t* ids,
+                                  size_t nids);
+
+}  // namespace base
+
+#endif /* FILTERED_DISTANCE_BASE_H */
@@ -40,5 +40,21 @@ fvec_Linf_ref(const float* x, const float* y, size_t d) {
        return res;
 }
 
-}  // namespace base 
+int
+fvec_madd_and_argmin_ref(size_t n, const float* a, float bf, const float* b,
+                         float* c) {
+       float vmin = 1e20;
+       int imin = -1;
+
+       for (size_t i = 0; i < n; i++) {
+           c[i] = a[i] + bf * b[i];
+           if (c[i] < vmin) {
+               vmin = c[i];
+               imin = i;
+           }
+       }
+       return imin;
+}
+
+}  // namespace base
 
@@ -0,0 +1,109 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "maxsim.h"
+#include "innerproduct.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#define MAXSIM_QUERY_BLOCK 32   /* Query tokens whose maxima are kept.  */
+#define MAXSIM_DOC_BLOCK   64   /* Document tokens reused from the cache.  */
+
+namespace base {
+
+float
+maxsim_ref (const float* q, size_t nq, const float* doc,
+            size_t nd, size_t d, size_t stride)
+{
+    /* A block of MAXSIM_DOC_BLOCK document tokens is compared with a block
+       of MAXSIM_QUERY_BLOCK query tokens before moving on, so both stay in
+       the cache.  The inner products of a query token with 4 document
+       tokens are computed by fvec_inner_product_batch_4_ref.  */
+    float qmax[MAXSIM_QUERY_BLOCK];
+    float res = 0, m, dis0, dis1, dis2, dis3;
+    size_t i0, i1, j0, j1, i, j;
+
+    for (i0 = 0; i0 < nq; i0 += MAXSIM_QUERY_BLOCK) {
+        i1 = std::min (i0 + MAXSIM_QUERY_BLOCK, nq);
+        for (i = i0; i < i1; i++)
+            qmax[i - i0] = -HUGE_VALF;
+
+        for (j0 = 0; j0 < nd; j0 += MAXSIM_DOC_BLOCK) {
+            j1 = std::min (j0 + MAXSIM_DOC_BLOCK, nd);
+
+            for (i = i0; i < i1; i++) {
+                const float* x = q + i * stride;
+
+                m = qmax[i - i0];
+                for (j = j0; j + 4 <= j1; j += 4) {
+                    const float* y = doc + j * stride;
+
+                    fvec_inner_product_batch_4_ref (x, y, y + stride,
+                        y + 2 * stride, y + 3 * stride, d, dis0, dis1, dis2,
+                        dis3);
+                    m = std::max (m, std::max (std::max (dis0, dis1),
+                                               std::max (dis2, dis3)));
+                }
+                for (; j < j1; j++) {
+                    dis0 = fvec_inner_product_ref (x, doc + j * stride,
+                                                   d);
+                    m = std::max (m, dis0);
+                }
+                qmax[i - i0] = m;
+            }
+        }
+
+        for (i = i0; i < i1; i++)
+            res += qmax[i - i0];
+    }
+    return res;
+}
+
+int64_t
+ivec_maxsim_ref (const int8_t* q, size_t nq, const int8_t* doc,
+                 size_t nd, size_t d, size_t stride)
+{
+    /* Blocked as maxsim_ref, one ivec_inner_product_ref call per
+       pair of tokens.  */
+    int32_t qmax[MAXSIM_QUERY_BLOCK], dis;
+    int64_t res = 0;
+    size_t i0, i1, j0, j1, i, j;
+
+    for (i0 = 0; i0 < nq; i0 += MAXSIM_QUERY_BLOCK) {
+        i1 = std::min (i0 + MAXSIM_QUERY_BLOCK, nq);
+        for (i = i0; i < i1; i++)
+            qmax[i - i0] = INT32_MIN;
+
+        for (j0 = 0; j0 < nd; j0 += MAXSIM_DOC_BLOCK) {
+            j1 = std::min (j0 + MAXSIM_DOC_BLOCK, nd);
+
+            for (i = i0; i < i1; i++)
+                for (j = j0; j < j1; j++) {
+                    dis = ivec_inner_product_ref (q + i * stride,
+                                                  doc + j * stride, d);
+                    qmax[i - i0] = std::max (qmax[i - i0], dis);
+                }
+        }
+
+        for (i = i0; i < i1; i++)
+            res += qmax[i - i0];
+    }
+    return res;
+}
+
+}  // namespace base
@@ -0,0 +1,40 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAXSIM_BASE_H
+#define MAXSIM_BASE_H
+
+#include <cstdint>
+#include <cstdio>
+
+namespace base {
+
+/// Late interaction score of a query of nq token vectors q and a document
+/// of nd >= 1 token vectors doc, all of d floats and stride floats apart:
+/// the sum over the query tokens of the largest inner product with a
+/// document token.
+float
+maxsim_ref (const float* q, size_t nq, const float* doc,
+            size_t nd, size_t d, size_t stride);
+
+/// Late interaction score of int8 token vectors, see maxsim_ref.
+int64_t
+ivec_maxsim_ref (const int8_t* q, size_t nq, const int8_t* doc,
+                 size_t nd, size_t d, size_t stride);
+
+}  // namespace base
+
+#endif /* MAXSIM_BASE_H */
@@ -0,0 +1,71 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "panel_distance.h"
+
+#include <cmath>
+
+namespace base {
+
+void
+fvec_L2sqr_ny_panel_ref (float* dis, const float* x, const float* panels,
+                         size_t d, size_t ny, size_t width)
+{
+    for (size_t i = 0; i < ny; i++) {
+        const float* yi = panels + (i / width) * d * width + i % width;
+        float res = 0;
+
+        for (size_t j = 0; j < d; j++) {
+            const float tmp = x[j] - yi[j * width];
+            res += tmp * tmp;
+        }
+        dis[i] = res;
+    }
+}
+
+void
+fvec_inner_product_ny_panel_ref (float* dis, const float* x,
+                                 const float* panels, size_t d, size_t ny,
+                                 size_t width)
+{
+    for (size_t i = 0; i < ny; i++) {
+        const float* yi = panels + (i / width) * d * width + i % width;
+        float res = 0;
+
+        for (size_t j = 0; j < d; j++) {
+            res += x[j] * yi[j * width];
+        }
+        dis[i] = res;
+    }
+}
+
+void
+fvec_L1_ny_panel_ref (float* dis, const float* x, const float* panels,
+                      size_t d, size_t ny, size_t width)
+{
+    for (size_t i = 0; i < ny; i++) {
+        const float* yi = panels + (i / width) * d * width + i % width;
+        float res = 0;
+
+        for (size_t j = 0; j < d; j++) {
+            const float tmp = x[j] - yi[j * width];
+            res += std::fabs(tmp);
+        }
+        dis[i] = res;
+    }
+}
+
+}  // namespace base
@@ -0,0 +1,75 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "range_search.h"
+#include "hamming_distance.h"
+
+namespace base {
+
+void
+fvec_L2sqr_ny_transposed_range_ref (const float* x, const float* y,
+                                    const float* y_sqlen, size_t d,
+                                    size_t d_offset, size_t ny, float radius,
+                                    struct range_result_t* res)
+{
+    float x_sqlen = 0;
+    for (size_t j = 0; j < d; j++) {
+        x_sqlen += x[j] * x[j];
+    }
+
+    for (size_t i = 0; i < ny; i++) {
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+
+        float dis = x_sqlen + y_sqlen[i] - 2 * dp;
+        if (dis < radius)
+            range_result_push (res, dis, (int64_t) i);
+    }
+}
+
+void
+fvec_inner_product_ny_transposed_range_ref (const float* x, const float* y,
+                                            size_t d, size_t d_offset,
+                                            size_t ny, float radius,
+                                            struct range_result_t* res)
+{
+    for (size_t i = 0; i < ny; i++) {
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+
+        if (dp > radius)
+            range_result_push (res, dp, (int64_t) i);
+    }
+}
+
+void
+hamming_distance_ny_range_ref (const uint8_t* x, const uint8_t* y,
+                               size_t size, size_t y_stride, size_t ny,
+                               size_t radius, struct range_result_t* res)
+{
+    for (size_t i = 0; i < ny; i++) {
+        size_t dis = hamming_distance_ref (x, y + i * y_stride, size);
+
+        if (dis < radius)
+            range_result_push (res, (float) dis, (int64_t) i);
+    }
+}
+
+}  // namespace base
@@ -0,0 +1,154 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sparse_distance.h"
+
+namespace base {
+
+float
+svec_inner_product_ref (const int32_t* xi, const float* xv, size_t nx,
+                        const int32_t* yi, const float* yv, size_t ny)
+{
+    /* Merge the sorted indices, only the common ones contribute.  */
+    size_t i = 0, j = 0;
+    float res = 0;
+
+    while (i < nx && j < ny) {
+        if (xi[i] == yi[j]) {
+            res += xv[i] * yv[j];
+            i++;
+            j++;
+        } else if (xi[i] < yi[j]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return res;
+}
+
+float
+svec_L2sqr_ref (const int32_t* xi, const float* xv, size_t nx,
+                const int32_t* yi, const float* yv, size_t ny)
+{
+    /* Merge the sorted indices, an index in only one vector contributes
+       its value squared.  */
+    size_t i = 0, j = 0;
+    float res = 0;
+
+    while (i < nx && j < ny) {
+        if (xi[i] == yi[j]) {
+            const float tmp = xv[i] - yv[j];
+            res += tmp * tmp;
+            i++;
+            j++;
+        } else if (xi[i] < yi[j]) {
+            res += xv[i] * xv[i];
+            i++;
+        } else {
+            res += yv[j] * yv[j];
+            j++;
+        }
+    }
+    for (; i < nx; i++)
+        res += xv[i] * xv[i];
+    for (; j < ny; j++)
+        res += yv[j] * yv[j];
+    return res;
+}
+
+float
+svec_dense_inner_product_ref (const int32_t* xi, const float* xv, size_t nx,
+                              const float* y)
+{
+    float res = 0;
+
+    for (size_t i = 0; i < nx; i++)
+        res += xv[i] * y[xi[i]];
+    return res;
+}
+
+float
+svec_dense_L2sqr_ref (const int32_t* xi, const float* xv, size_t nx,
+                      const float* y, float y_sqlen)
+{
+    /* ||x - y||^2 = ||y||^2 + sum over the indices of x of
+       (x_i - y_i)^2 - y_i^2.  */
+    float res = 0;
+
+    for (size_t i = 0; i < nx; i++) {
+        const float tmp = xv[i] - y[xi[i]];
+        res += tmp * tmp - y[xi[i]] * y[xi[i]];
+    }
+    return y_sqlen + res;
+}
+
+void
+svec_inner_product_ny_ref (float* dis, const int32_t* xi, const float* xv,
+                           size_t nx, const int64_t* y_offsets,
+                           const int32_t* y_ids, const float* y_vals,
+                           size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_inner_product_ref (xi, xv, nx, y_ids + start,
+                                         y_vals + start,
+                                         y_offsets[i + 1] - start);
+    }
+}
+
+void
+svec_L2sqr_ny_ref (float* dis, const int32_t* xi, const float* xv,
+                   size_t nx, const int64_t* y_offsets, const int32_t* y_ids,
+                   const float* y_vals, size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_L2sqr_ref (xi, xv, nx, y_ids + start, y_vals + start,
+                                 y_offsets[i + 1] - start);
+    }
+}
+
+void
+svec_dense_inner_product_ny_ref (float* dis, const float* x,
+                                 const int64_t* y_offsets,
+                                 const int32_t* y_ids, const float* y_vals,
+                                 size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_dense_inner_product_ref (y_ids + start, y_vals + start,
+                                               y_offsets[i + 1] - start, x);
+    }
+}
+
+void
+svec_dense_L2sqr_ny_ref (float* dis, const float* x, float x_sqlen,
+                         const int64_t* y_offsets, const int32_t* y_ids,
+                         const float* y_vals, size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_dense_L2sqr_ref (y_ids + start, y_vals + start,
+                                       y_offsets[i + 1] - start, x, x_sqlen);
+    }
+}
+
+}  // namespace base
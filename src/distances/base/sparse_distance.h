@@ -0,0 +1,81 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPARSE_DISTANCE_BASE_H
+#define SPARSE_DISTANCE_BASE_H
+
+/* Sparse vectors are stored as nnz (index, value) pairs, the indices sorted
+   in increasing order without duplicates, as pgvector's sparsevec.  A set
+   of ny sparse vectors is stored in CSR form: vector i has the pairs
+   y_offsets[i] to y_offsets[i + 1] - 1 of y_ids and y_vals.  */
+
+#include <cstdint>
+#include <cstdio>
+
+namespace base {
+
+/// inner product of two sparse vectors
+float
+svec_inner_product_ref (const int32_t* xi, const float* xv, size_t nx,
+                        const int32_t* yi, const float* yv, size_t ny);
+
+/// squared L2 distance between two sparse vectors
+float
+svec_L2sqr_ref (const int32_t* xi, const float* xv, size_t nx,
+                const int32_t* yi, const float* yv, size_t ny);
+
+/// inner product of a sparse vector x and a dense vector y
+float
+svec_dense_inner_product_ref (const int32_t* xi, const float* xv, size_t nx,
+                              const float* y);
+
+/// squared L2 distance between a sparse vector x and a dense vector y with
+/// squared norm y_sqlen
+float
+svec_dense_L2sqr_ref (const int32_t* xi, const float* xv, size_t nx,
+                      const float* y, float y_sqlen);
+
+/// inner products of the sparse vector x and ny sparse vectors in CSR form
+void
+svec_inner_product_ny_ref (float* dis, const int32_t* xi, const float* xv,
+                           size_t nx, const int64_t* y_offsets,
+                           const int32_t* y_ids, const float* y_vals,
+                           size_t ny);
+
+/// squared L2 distances between the sparse vector x and ny sparse vectors
+/// in CSR form
+void
+svec_L2sqr_ny_ref (float* dis, const int32_t* xi, const float* xv,
+                   size_t nx, const int64_t* y_offsets, const int32_t* y_ids,
+                   const float* y_vals, size_t ny);
+
+/// inner products of the dense vector x and ny sparse vectors in CSR form
+void
+svec_dense_inner_product_ny_ref (float* dis, const float* x,
+                                 const int64_t* y_offsets,
+                                 const int32_t* y_ids, const float* y_vals,
+                                 size_t ny);
+
+/// squared L2 distances between the dense vector x with squared norm
+/// x_sqlen and ny sparse vectors in CSR form
+void
+svec_dense_L2sqr_ny_ref (float* dis, const float* x, float x_sqlen,
+                         const int64_t* y_offsets, const int32_t* y_ids,
+                         const float* y_vals, size_t ny);
+
+}  // namespace base
+
+#endif /* SPARSE_DISTANCE_BASE_H */
@@ -0,0 +1,82 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include "fixed_dim.h"
+#include "fixed_dim_kernels.h"
+#include "../intrinsic/euclidean_l2_distance.h"
+#include "../intrinsic/innerproduct.h"
+#include "../intrinsic/manhattan_l1_distance.h"
+
+namespace powerpc {
+
+/* Instances of the FIXED_DIMS, one case per dimension.  */
+#define FIXED_DIM_CASE_L2SQR(D) \
+    case D: return fvec_L2sqr_fixed<D>;
+#define FIXED_DIM_CASE_INNER_PRODUCT(D) \
+    case D: return fvec_inner_product_fixed<D>;
+#define FIXED_DIM_CASE_L1(D) \
+    case D: return fvec_L1_fixed<D>;
+
+fixed_dim_fn_t
+fvec_L2sqr_fixed_dim (size_t d) {
+    switch (d) {
+    FIXED_DIMS (FIXED_DIM_CASE_L2SQR)
+    }
+    return NULL;
+}
+
+fixed_dim_fn_t
+fvec_inner_product_fixed_dim (size_t d) {
+    switch (d) {
+    FIXED_DIMS (FIXED_DIM_CASE_INNER_PRODUCT)
+    }
+    return NULL;
+}
+
+fixed_dim_fn_t
+fvec_L1_fixed_dim (size_t d) {
+    switch (d) {
+    FIXED_DIMS (FIXED_DIM_CASE_L1)
+    }
+    return NULL;
+}
+
+float
+fvec_L2sqr_ref_fixed (const float* x, const float* y, size_t d) {
+    fixed_dim_fn_t fn = fvec_L2sqr_fixed_dim (d);
+
+    return fn ? fn (x, y, d) : fvec_L2sqr_ref_ippc (x, y, d);
+}
+
+float
+fvec_inner_product_ref_fixed (const float* x, const float* y, size_t d) {
+    fixed_dim_fn_t fn = fvec_inner_product_fixed_dim (d);
+
+    return fn ? fn (x, y, d) : fvec_inner_product_ref_ippc (x, y, d);
+}
+
+float
+fvec_L1_ref_fixed (const float* x, const float* y, size_t d) {
+    fixed_dim_fn_t fn = fvec_L1_fixed_dim (d);
+
+    return fn ? fn (x, y, d) : fvec_L1_ref_ippc (x, y, d);
+}
+
+}  // namespace powerpc
+
+#endif
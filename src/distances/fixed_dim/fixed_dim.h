@@ -0,0 +1,52 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIXED_DIM_POWERPC_H
+#define FIXED_DIM_POWERPC_H
+
+#include <cstddef>
+
+/* The dimensions with a fixed dimension instance of the L2, inner product
+   and L1 functions, see fixed_dim_kernels.h.  Each must be a multiple of
+   FIXED_DIM_BLOCK.  */
+#define FIXED_DIMS(X) X(96) X(128) X(384) X(768) X(1024) X(1536)
+
+namespace powerpc {
+
+/* Same signature as the generic functions, d is ignored by the fixed
+   dimension instances.  */
+typedef float (*fixed_dim_fn_t) (const float* x, const float* y, size_t d);
+
+/// The fixed dimension instance for dimension d, NULL if there is none.
+/// Look the instance up once outside of a loop over a database.
+fixed_dim_fn_t fvec_L2sqr_fixed_dim (size_t d);
+fixed_dim_fn_t fvec_inner_product_fixed_dim (size_t d);
+fixed_dim_fn_t fvec_L1_fixed_dim (size_t d);
+
+/// Call the fixed dimension instance for d if there is one, else the
+/// generic intrinsic version.
+float
+fvec_L2sqr_ref_fixed (const float* x, const float* y, size_t d);
+
+float
+fvec_inner_product_ref_fixed (const float* x, const float* y, size_t d);
+
+float
+fvec_L1_ref_fixed (const float* x, const float* y, size_t d);
+
+}  // namespace powerpc
+
+#endif /* FIXED_DIM_POWERPC_H */
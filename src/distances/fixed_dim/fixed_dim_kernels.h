@@ -0,0 +1,144 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIXED_DIM_KERNELS_POWERPC_H
+#define FIXED_DIM_KERNELS_POWERPC_H
+
+/* Fixed dimension versions of the L2, inner product and L1 functions.  The
+   generic functions take the dimension at run time, so they pay for the
+   loop control and check for a scalar tail on every call.  The dimension D
+   of these is a template argument and a multiple of FIXED_DIM_BLOCK, so the
+   loop has a compile time trip count, is fully unrolled and has no tail.
+   Each block of FIXED_DIM_BLOCK floats goes to four independent vector
+   accumulators.
+
+   The templates need altivec.h, include fixed_dim.h for the instances of
+   the dimensions in FIXED_DIMS.  */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+#include <cstddef>
+
+#define FIXED_DIM_BLOCK 16   /* Floats, four VSX registers.  */
+
+namespace powerpc {
+
+template <size_t D>
+float
+fvec_L2sqr_fixed (const float* x, const float* y, size_t d) {
+    static_assert (D % FIXED_DIM_BLOCK == 0,
+                   "D must be a multiple of FIXED_DIM_BLOCK");
+    vector float vx0, vx1, vx2, vx3, vy0, vy1, vy2, vy3;
+    vector float vres0 = {0, 0, 0, 0}, vres1 = {0, 0, 0, 0};
+    vector float vres2 = {0, 0, 0, 0}, vres3 = {0, 0, 0, 0};
+
+    (void) d;
+
+#pragma GCC unroll 128
+    for (size_t i = 0; i < D; i = i + FIXED_DIM_BLOCK) {
+        vx0 = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vx1 = vec_xl ((long)((i + 4)*sizeof(float)), (float *) x);
+        vx2 = vec_xl ((long)((i + 8)*sizeof(float)), (float *) x);
+        vx3 = vec_xl ((long)((i + 12)*sizeof(float)), (float *) x);
+        vy0 = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vy1 = vec_xl ((long)((i + 4)*sizeof(float)), (float *) y);
+        vy2 = vec_xl ((long)((i + 8)*sizeof(float)), (float *) y);
+        vy3 = vec_xl ((long)((i + 12)*sizeof(float)), (float *) y);
+
+        vx0 = vec_sub (vx0, vy0);
+        vx1 = vec_sub (vx1, vy1);
+        vx2 = vec_sub (vx2, vy2);
+        vx3 = vec_sub (vx3, vy3);
+        vres0 = vec_madd (vx0, vx0, vres0);
+        vres1 = vec_madd (vx1, vx1, vres1);
+        vres2 = vec_madd (vx2, vx2, vres2);
+        vres3 = vec_madd (vx3, vx3, vres3);
+    }
+
+    vres0 = vec_add (vec_add (vres0, vres1), vec_add (vres2, vres3));
+    return vres0[0] + vres0[1] + vres0[2] + vres0[3];
+}
+
+template <size_t D>
+float
+fvec_inner_product_fixed (const float* x, const float* y, size_t d) {
+    static_assert (D % FIXED_DIM_BLOCK == 0,
+                   "D must be a multiple of FIXED_DIM_BLOCK");
+    vector float vx0, vx1, vx2, vx3, vy0, vy1, vy2, vy3;
+    vector float vres0 = {0, 0, 0, 0}, vres1 = {0, 0, 0, 0};
+    vector float vres2 = {0, 0, 0, 0}, vres3 = {0, 0, 0, 0};
+
+    (void) d;
+
+#pragma GCC unroll 128
+    for (size_t i = 0; i < D; i = i + FIXED_DIM_BLOCK) {
+        vx0 = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vx1 = vec_xl ((long)((i + 4)*sizeof(float)), (float *) x);
+        vx2 = vec_xl ((long)((i + 8)*sizeof(float)), (float *) x);
+        vx3 = vec_xl ((long)((i + 12)*sizeof(float)), (float *) x);
+        vy0 = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vy1 = vec_xl ((long)((i + 4)*sizeof(float)), (float *) y);
+        vy2 = vec_xl ((long)((i + 8)*sizeof(float)), (float *) y);
+        vy3 = vec_xl ((long)((i + 12)*sizeof(float)), (float *) y);
+
+        vres0 = vec_madd (vx0, vy0, vres0);
+        vres1 = vec_madd (vx1, vy1, vres1);
+        vres2 = vec_madd (vx2, vy2, vres2);
+        vres3 = vec_madd (vx3, vy3, vres3);
+    }
+
+    vres0 = vec_add (vec_add (vres0, vres1), vec_add (vres2, vres3));
+    return vres0[0] + vres0[1] + vres0[2] + vres0[3];
+}
+
+template <size_t D>
+float
+fvec_L1_fixed (const float* x, const float* y, size_t d) {
+    static_assert (D % FIXED_DIM_BLOCK == 0,
+                   "D must be a multiple of FIXED_DIM_BLOCK");
+    vector float vx0, vx1, vx2, vx3, vy0, vy1, vy2, vy3;
+    vector float vres0 = {0, 0, 0, 0}, vres1 = {0, 0, 0, 0};
+    vector float vres2 = {0, 0, 0, 0}, vres3 = {0, 0, 0, 0};
+
+    (void) d;
+
+#pragma GCC unroll 128
+    for (size_t i = 0; i < D; i = i + FIXED_DIM_BLOCK) {
+        vx0 = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vx1 = vec_xl ((long)((i + 4)*sizeof(float)), (float *) x);
+        vx2 = vec_xl ((long)((i + 8)*sizeof(float)), (float *) x);
+        vx3 = vec_xl ((long)((i + 12)*sizeof(float)), (float *) x);
+        vy0 = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vy1 = vec_xl ((long)((i + 4)*sizeof(float)), (float *) y);
+        vy2 = vec_xl ((long)((i + 8)*sizeof(float)), (float *) y);
+        vy3 = vec_xl ((long)((i + 12)*sizeof(float)), (float *) y);
+
+        vres0 = vec_add (vec_abs (vec_sub (vx0, vy0)), vres0);
+        vres1 = vec_add (vec_abs (vec_sub (vx1, vy1)), vres1);
+        vres2 = vec_add (vec_abs (vec_sub (vx2, vy2)), vres2);
+        vres3 = vec_add (vec_abs (vec_sub (vx3, vy3)), vres3);
+    }
+
+    vres0 = vec_add (vec_add (vres0, vres1), vec_add (vres2, vres3));
+    return vres0[0] + vres0[1] + vres0[2] + vres0[3];
+}
+
+}  // namespace powerpc
+
+#endif
+
+#endif /* FIXED_DIM_KERNELS_POWERPC_H */
@@ -0,0 +1,127 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+
+#include "early_abandon.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define FLOAT_VEC_SIZE 4
+
+namespace powerpc {
+
+float
+fvec_L2sqr_early_ref_ippc (const float* x, const float* y, size_t d,
+                           float threshold)
+{
+    /* PowerPC, accumulate as fvec_L2sqr_ref_ippc and sum the lanes of the
+       accumulator every EARLY_ABANDON_BLOCK dimensions to compare it with
+       the threshold.  The distance of a vector that is not abandoned is the
+       same as with fvec_L2sqr_ref_ippc.  Original code:
+
+       for (size_t start = 0; start < d; start += EARLY_ABANDON_BLOCK) {
+           size_t end = std::min (d, start + EARLY_ABANDON_BLOCK);
+
+           for (size_t i = start; i < end; i++) {
+               const float tmp = x[i] - y[i];
+               res += tmp * tmp;
+           }
+
+           if (res >= threshold)
+               return res;
+       }
+       return res;
+    */
+    size_t i, base, start, end;
+    float res = 0, partial;
+
+    vector float vx, vy;
+    vector float vtmp = {0, 0, 0, 0};
+    vector float vres = {0, 0, 0, 0};
+
+    base = (d / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (start = 0; start < base; start = end) {
+        end = std::min (base, start + EARLY_ABANDON_BLOCK);
+
+        for (i = start; i < end; i = i + FLOAT_VEC_SIZE) {
+            /* Load up the data vectors */
+            vx = vec_xl ((long)(i*sizeof(float)), (float *)x);
+            vy = vec_xl ((long)(i*sizeof(float)), (float *)y);
+
+            vtmp = vec_sub(vx, vy);
+            vres = vec_madd(vtmp, vtmp, vres);
+        }
+
+        partial = vres[0] + vres[1] + vres[2] + vres[3];
+        if (partial >= threshold)
+            return partial;
+    }
+
+    /* Handle any remaining data elements */
+    for (i = base; i < d; i++) {
+        const float tmp = x[i] - y[i];
+        res += tmp * tmp;
+    }
+
+    return res + vres[0] + vres[1] + vres[2] + vres[3];
+}
+
+float
+fvec_L1_early_ref_ippc (const float* x, const float* y, size_t d,
+                        float threshold)
+{
+    /* PowerPC, accumulate as fvec_L1_ref_ippc with the threshold checks of
+       fvec_L2sqr_early_ref_ippc.  */
+    size_t i, base, start, end;
+    float res = 0, partial;
+
+    vector float vx, vy;
+    vector float vres = {0, 0, 0, 0};
+
+    base = (d / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (start = 0; start < base; start = end) {
+        end = std::min (base, start + EARLY_ABANDON_BLOCK);
+
+        for (i = start; i < end; i = i + FLOAT_VEC_SIZE) {
+            vx = vec_xl ((long)(i*sizeof(float)), (float *)x);
+            vy = vec_xl ((long)(i*sizeof(float)), (float *)y);
+
+            vres = vec_add(vres, vec_abs(vec_sub(vx, vy)));
+        }
+
+        partial = vres[0] + vres[1] + vres[2] + vres[3];
+        if (partial >= threshold)
+            return partial;
+    }
+
+    /* Handle any remaining data elements */
+    for (i = base; i < d; i++) {
+        const float tmp = x[i] - y[i];
+        res += std::fabs(tmp);
+    }
+
+    return res + vres[0] + vres[1] + vres[2] + vres[3];
+}
+
+}  // namespace powerpc
+
+#endif
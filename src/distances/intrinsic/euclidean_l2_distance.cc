@@ -161,7 +161,7 @@ fvec_L2sqr_ny_transposed_ref_ippc (float* __restrict dis,
 
     /* Handle any remaining x data elements, in scalar mode. */
     for (size_t j = base; j < d; j++) {
-        x_sqlen += x[j + base] * x[j + base];
+        x_sqlen += x[j] * x[j];
     }
 
     for (size_t i = 0; i < ny; i++ ) {
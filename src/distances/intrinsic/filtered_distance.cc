@@ -0,0 +1,219 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+
+#include "filtered_distance.h"
+
+#define FLOAT_VEC_SIZE 4
+
+/* y vectors evaluated together by fvec_L2sqr_8_transposed_ippc, 8 bits of
+   the bitmap.  */
+#define FILTER_BLOCK_SIZE 8
+
+/* Set bits of a bitmap word from which the blocks of the word with a
+   selected vector are evaluated in full, 2 per block on average.  Below it
+   the selected vectors are gathered one at a time.  */
+#define FILTER_DENSE_BITS 16
+
+namespace powerpc {
+
+static inline float
+fvec_sqlen_ippc (const float* x, size_t d)
+{
+    size_t i, base;
+    float res;
+    vector float vx;
+    vector float vsq = {0, 0, 0, 0};
+
+    base = (d / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (i = 0; i < base; i = i + FLOAT_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vsq = vec_madd (vx, vx, vsq);
+    }
+
+    res = vsq[0] + vsq[1] + vsq[2] + vsq[3];
+
+    /* Handle any remaining x data elements, in scalar mode. */
+    for (i = base; i < d; i++) {
+        res += x[i] * x[i];
+    }
+    return res;
+}
+
+/* Distance of the single transposed y vector i, its elements are d_offset
+   floats apart so they are loaded one at a time.  */
+static inline float
+fvec_L2sqr_1_transposed_ippc (const float* x, const float* y,
+                              const float* y_sqlen, size_t d,
+                              size_t d_offset, float x_sqlen, size_t i)
+{
+    float dp = 0;
+    for (size_t j = 0; j < d; j++) {
+        dp += x[j] * y[i + j * d_offset];
+    }
+
+    return x_sqlen + y_sqlen[i] - 2 * dp;
+}
+
+/* Distances of the 8 transposed y vectors i to i + 7 stored to dis[0] to
+   dis[7].  Two accumulators hide the latency of the multiply-add.  */
+static inline void
+fvec_L2sqr_8_transposed_ippc (float* dis, const float* x, const float* y,
+                              const float* y_sqlen, size_t d,
+                              size_t d_offset, float x_sqlen, size_t i)
+{
+    vector float vx, vy0, vy1;
+    vector float vd0 = {0, 0, 0, 0};
+    vector float vd1 = {0, 0, 0, 0};
+    vector float vx_sqlen = vec_splats (x_sqlen);
+    vector float vtwo = vec_splats (2.0f);
+
+    for (size_t j = 0; j < d; j++) {
+        const float* yj = y + i + j * d_offset;
+
+        vx = vec_splats (x[j]);
+        vy0 = vec_xl (0, (float*) yj);
+        vy1 = vec_xl ((long)(FLOAT_VEC_SIZE*sizeof(float)), (float*) yj);
+
+        vd0 = vec_madd (vx, vy0, vd0);
+        vd1 = vec_madd (vx, vy1, vd1);
+    }
+
+    /* x_sqlen + y_sqlen - 2 * dp  */
+    vd0 = vec_nmsub (vtwo, vd0,
+                     vec_add (vx_sqlen,
+                              vec_xl ((long)(i*sizeof(float)),
+                                      (float*) y_sqlen)));
+    vd1 = vec_nmsub (vtwo, vd1,
+                     vec_add (vx_sqlen,
+                              vec_xl ((long)((i + FLOAT_VEC_SIZE)
+                                             *sizeof(float)),
+                                      (float*) y_sqlen)));
+
+    vec_xst (vd0, 0, dis);
+    vec_xst (vd1, (long)(FLOAT_VEC_SIZE*sizeof(float)), dis);
+}
+
+void
+fvec_L2sqr_ny_transposed_bitmap_ref_ippc (float* dis, const float* x,
+                                          const float* y,
+                                          const float* y_sqlen, size_t d,
+                                          size_t d_offset, size_t ny,
+                                          const uint64_t* bitmap)
+{
+    /* PowerPC, skip the bitmap words without a selected vector.  If a word
+       selects at least FILTER_DENSE_BITS vectors, compute its blocks of 8
+       vectors with a selected one with the vector registers, else gather
+       the selected vectors one at a time.  Original code:
+
+       for (size_t i = 0; i < ny; i++) {
+           if (!((bitmap[i / 64] >> (i % 64)) & 1))
+               continue;
+
+           float dp = 0;
+           for (size_t j = 0; j < d; j++) {
+               dp += x[j] * y[i + j * d_offset];
+           }
+
+           dis[i] = x_sqlen + y_sqlen[i] - 2 * dp;
+       }
+    */
+    size_t num_words = id_selector_num_words (ny);
+    float x_sqlen = fvec_sqlen_ippc (x, d);
+
+    for (size_t w = 0; w < num_words; w++) {
+        uint64_t word = bitmap[w];
+        size_t i0 = w * ID_SELECTOR_WORD_BITS;
+
+        if (word == 0)
+            continue;
+
+        if (__builtin_popcountll (word) >= FILTER_DENSE_BITS) {
+            for (size_t b = 0; b < ID_SELECTOR_WORD_BITS;
+                 b = b + FILTER_BLOCK_SIZE) {
+                uint64_t block = (uint64_t) 0xff << b;
+
+                if (i0 + b + FILTER_BLOCK_SIZE > ny)
+                    break;
+                if (!(word & block))
+                    continue;
+
+                fvec_L2sqr_8_transposed_ippc (dis + i0 + b, x, y, y_sqlen,
+                                              d, d_offset, x_sqlen, i0 + b);
+                word &= ~block;
+            }
+        }
+
+        /* The selected vectors of a sparse word, or after the last full
+           block of the database, in scalar mode.  */
+        while (word) {
+            size_t i = i0 + __builtin_ctzll (word);
+
+            dis[i] = fvec_L2sqr_1_transposed_ippc (x, y, y_sqlen, d,
+                                                   d_offset, x_sqlen, i);
+            word &= word - 1;
+        }
+    }
+}
+
+void
+fvec_L2sqr_ny_transposed_ids_ref_ippc (float* dis, const float* x,
+                                       const float* y, const float* y_sqlen,
+                                       size_t d, size_t d_offset,
+                                       const int64_t* ids, size_t nids)
+{
+    /* PowerPC, the ids are sorted and distinct, so 8 ids k to k + 7 that
+       span 8 consecutive vectors are a full block that is computed with the
+       vector registers.  The other vectors are gathered one at a time.
+       Original code:
+
+       for (size_t k = 0; k < nids; k++) {
+           size_t i = (size_t) ids[k];
+           float dp = 0;
+           for (size_t j = 0; j < d; j++) {
+               dp += x[j] * y[i + j * d_offset];
+           }
+
+           dis[k] = x_sqlen + y_sqlen[i] - 2 * dp;
+       }
+    */
+    float x_sqlen = fvec_sqlen_ippc (x, d);
+    size_t k = 0;
+
+    while (k < nids) {
+        if (k + FILTER_BLOCK_SIZE <= nids
+            && ids[k + FILTER_BLOCK_SIZE - 1] - ids[k]
+               == FILTER_BLOCK_SIZE - 1) {
+            fvec_L2sqr_8_transposed_ippc (dis + k, x, y, y_sqlen, d,
+                                          d_offset, x_sqlen,
+                                          (size_t) ids[k]);
+            k += FILTER_BLOCK_SIZE;
+        } else {
+            dis[k] = fvec_L2sqr_1_transposed_ippc (x, y, y_sqlen, d,
+                                                   d_offset, x_sqlen,
+                                                   (size_t) ids[k]);
+            k++;
+        }
+    }
+}
+
+}  // namespace powerpc
+
+#endif
@@ -174,11 +174,12 @@ fvec_madd_and_argmin_ref_ippc (size_t n, const float* a, float bf,
         vb = vec_xl ((long)(i*sizeof(float)), (float *) b);
 
 	vc = vec_madd(vbf, vb, va);
+        vec_xst (vc, (long)(i*sizeof(float)), c);
 
         /* Checke each vector element */
         for (int j = 0; j < FLOAT_VEC_SIZE; j++) {
             if (vc[j] < vmin) {
-                vmin = c[i + j];
+                vmin = vc[j];
                 imin = i + j;
              }
         }
@@ -186,6 +187,7 @@ fvec_madd_and_argmin_ref_ippc (size_t n, const float* a, float bf,
 
     /* Handle any remaining data elements */
     for (size_t i = base; i < n; i++) {
+        c[i] = a[i] + bf * b[i];
         if (c[i] < vmin) {
             vmin = c[i];
             imin = i;
@@ -0,0 +1,144 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+
+#include "panel_distance.h"
+
+#define FLOAT_VEC_SIZE 4
+
+/* Distances computed by fvec_panel_ippc.  */
+#define PANEL_L2 0
+#define PANEL_IP 1
+#define PANEL_L1 2
+
+namespace powerpc {
+
+/* Distances between x and the nv * 4 vectors of one panel, stored to
+   out[0] to out[nv * 4 - 1].  x[j] is splat once and feeds the nv vector
+   loads of dimension j, one accumulator per 4 vectors.  metric and nv are
+   constants where the function is inlined, so the accumulators stay in
+   registers.  */
+static inline void
+fvec_panel_ippc (int metric, float* out, const float* x, const float* panel,
+                 size_t d, size_t nv)
+{
+    vector float vx, vy, vtmp;
+    vector float vacc[PANEL_MAX_WIDTH / FLOAT_VEC_SIZE];
+    size_t j, v;
+
+    for (v = 0; v < nv; v++)
+        vacc[v] = vec_splats (0.0f);
+
+    for (j = 0; j < d; j++) {
+        const float* pj = panel + j * nv * FLOAT_VEC_SIZE;
+
+        vx = vec_splats (x[j]);
+        for (v = 0; v < nv; v++) {
+            vy = vec_xl ((long)(v*FLOAT_VEC_SIZE*sizeof(float)), (float*) pj);
+
+            if (metric == PANEL_L2) {
+                vtmp = vec_sub (vx, vy);
+                vacc[v] = vec_madd (vtmp, vtmp, vacc[v]);
+            } else if (metric == PANEL_IP) {
+                vacc[v] = vec_madd (vx, vy, vacc[v]);
+            } else {
+                vacc[v] = vec_add (vacc[v], vec_abs (vec_sub (vx, vy)));
+            }
+        }
+    }
+
+    for (v = 0; v < nv; v++)
+        vec_xst (vacc[v], (long)(v*FLOAT_VEC_SIZE*sizeof(float)), out);
+}
+
+static inline void
+fvec_ny_panel_ippc (int metric, float* dis, const float* x,
+                    const float* panels, size_t d, size_t ny, size_t width)
+{
+    size_t p, full = ny / width;
+    float tail[PANEL_MAX_WIDTH];
+
+    for (p = 0; p < full; p++) {
+        float* out = dis + p * width;
+        const float* panel = panels + p * d * width;
+
+        switch (width) {
+        case 4:
+            fvec_panel_ippc (metric, out, x, panel, d, 1);
+            break;
+        case 8:
+            fvec_panel_ippc (metric, out, x, panel, d, 2);
+            break;
+        default:
+            fvec_panel_ippc (metric, out, x, panel, d, 4);
+            break;
+        }
+    }
+
+    /* The last panel is zero padded, compute all of it and keep the
+       distances of the ny % width vectors.  */
+    if (full * width < ny) {
+        fvec_panel_ippc (metric, tail, x, panels + full * d * width, d,
+                         width / FLOAT_VEC_SIZE);
+        for (p = full * width; p < ny; p++)
+            dis[p] = tail[p - full * width];
+    }
+}
+
+void
+fvec_L2sqr_ny_panel_ref_ippc (float* dis, const float* x, const float* panels,
+                              size_t d, size_t ny, size_t width)
+{
+    /* PowerPC, compute the distances of a panel of width vectors at a time,
+       each vector load holds dimension j of 4 of them.  Original code:
+
+       for (size_t i = 0; i < ny; i++) {
+           const float* yi = panels + (i / width) * d * width + i % width;
+           float res = 0;
+
+           for (size_t j = 0; j < d; j++) {
+               const float tmp = x[j] - yi[j * width];
+               res += tmp * tmp;
+           }
+           dis[i] = res;
+       }
+    */
+    fvec_ny_panel_ippc (PANEL_L2, dis, x, panels, d, ny, width);
+}
+
+void
+fvec_inner_product_ny_panel_ref_ippc (float* dis, const float* x,
+                                      const float* panels, size_t d, size_t ny,
+                                      size_t width)
+{
+    /* PowerPC, as fvec_L2sqr_ny_panel_ref_ippc.  */
+    fvec_ny_panel_ippc (PANEL_IP, dis, x, panels, d, ny, width);
+}
+
+void
+fvec_L1_ny_panel_ref_ippc (float* dis, const float* x, const float* panels,
+                           size_t d, size_t ny, size_t width)
+{
+    /* PowerPC, as fvec_L2sqr_ny_panel_ref_ippc.  */
+    fvec_ny_panel_ippc (PANEL_L1, dis, x, panels, d, ny, width);
+}
+
+}  // namespace powerpc
+
+#endif
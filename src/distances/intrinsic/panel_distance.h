@@ -0,0 +1,48 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANEL_DISTANCE_INTRINSIC_POWERPC_H
+#define PANEL_DISTANCE_INTRINSIC_POWERPC_H
+
+#include <cstdint>
+#include <cstdio>
+#include "panel.h"
+
+namespace powerpc {
+
+/// squared L2 distances between x and the first ny vectors of a
+/// panel_store_t with panels of width vectors, panels is its data.  dis[i]
+/// is the distance of vector i.
+void
+fvec_L2sqr_ny_panel_ref_ippc (float* dis, const float* x, const float* panels,
+                              size_t d, size_t ny, size_t width);
+
+/// inner products between x and the first ny vectors of panels, see
+/// fvec_L2sqr_ny_panel_ref_ippc.
+void
+fvec_inner_product_ny_panel_ref_ippc (float* dis, const float* x,
+                                      const float* panels, size_t d, size_t ny,
+                                      size_t width);
+
+/// L1 distances between x and the first ny vectors of panels, see
+/// fvec_L2sqr_ny_panel_ref_ippc.
+void
+fvec_L1_ny_panel_ref_ippc (float* dis, const float* x, const float* panels,
+                           size_t d, size_t ny, size_t width);
+
+}  // namespace powerpc
+
+#endif /* PANEL_DISTANCE_INTRINSIC_POWERPC_H */
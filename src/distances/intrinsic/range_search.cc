@@ -0,0 +1,245 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+
+#include "range_search.h"
+#include "hamming_distance.h"
+
+#define FLOAT_VEC_SIZE 4
+
+namespace powerpc {
+
+/* Append the lanes of vdis selected by vmask to res with the ids id0 to
+   id0 + 3.  Every lane is stored and the count only advances for the
+   selected ones, so the matches are compacted without a branch per lane.  */
+static inline void
+range_append_ippc (struct range_result_t* res, vector float vdis,
+                   vector unsigned int vmask, size_t id0)
+{
+    size_t n;
+
+    range_result_reserve (res, FLOAT_VEC_SIZE);
+    n = res->n;
+    for (size_t lane = 0; lane < FLOAT_VEC_SIZE; lane++) {
+        res->dis[n] = vdis[lane];
+        res->ids[n] = (int64_t) (id0 + lane);
+        n += vmask[lane] & 1;
+    }
+    res->n = n;
+}
+
+/* Inner products of x with the 8 transposed y vectors i to i + 7, the 4
+   lanes of a vector hold 4 consecutive y vectors as the transposed layout
+   stores them.  Two accumulators hide the latency of the multiply-add.  */
+static inline void
+fvec_dp_8_transposed_ippc (const float* x, const float* y, size_t d,
+                           size_t d_offset, size_t i, vector float* vdp0,
+                           vector float* vdp1)
+{
+    vector float vx, vy0, vy1;
+    vector float vd0 = {0, 0, 0, 0};
+    vector float vd1 = {0, 0, 0, 0};
+
+    for (size_t j = 0; j < d; j++) {
+        const float* yj = y + i + j * d_offset;
+
+        vx = vec_splats (x[j]);
+        vy0 = vec_xl (0, (float*) yj);
+        vy1 = vec_xl ((long)(FLOAT_VEC_SIZE*sizeof(float)), (float*) yj);
+
+        vd0 = vec_madd (vx, vy0, vd0);
+        vd1 = vec_madd (vx, vy1, vd1);
+    }
+    *vdp0 = vd0;
+    *vdp1 = vd1;
+}
+
+void
+fvec_L2sqr_ny_transposed_range_ref_ippc (const float* x, const float* y,
+                                         const float* y_sqlen, size_t d,
+                                         size_t d_offset, size_t ny,
+                                         float radius,
+                                         struct range_result_t* res)
+{
+    /* PowerPC, compute the distances of 8 y vectors at a time and compare
+       them with the radius in the vector registers.  Only the distances
+       below the radius are stored, the full distance array is never
+       written.  Original code:
+
+       for (size_t i = 0; i < ny; i++) {
+           float dp = 0;
+           for (size_t j = 0; j < d; j++) {
+               dp += x[j] * y[i + j * d_offset];
+           }
+
+           float dis = x_sqlen + y_sqlen[i] - 2 * dp;
+           if (dis < radius)
+               range_result_push (res, dis, (int64_t) i);
+       }
+    */
+    size_t i, base;
+    float x_sqlen = 0;
+    vector float vx, vdp0, vdp1, vdis0, vdis1, vx_sqlen;
+    vector float vsq = {0, 0, 0, 0};
+    vector float vradius = vec_splats (radius);
+    vector float vtwo = vec_splats (2.0f);
+
+    base = (d / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (i = 0; i < base; i = i + FLOAT_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vsq = vec_madd (vx, vx, vsq);
+    }
+
+    x_sqlen = vsq[0] + vsq[1] + vsq[2] + vsq[3];
+
+    /* Handle any remaining x data elements, in scalar mode. */
+    for (i = base; i < d; i++) {
+        x_sqlen += x[i] * x[i];
+    }
+    vx_sqlen = vec_splats (x_sqlen);
+
+    base = (ny / (2 * FLOAT_VEC_SIZE)) * (2 * FLOAT_VEC_SIZE);
+
+    for (i = 0; i < base; i = i + 2 * FLOAT_VEC_SIZE) {
+        fvec_dp_8_transposed_ippc (x, y, d, d_offset, i, &vdp0, &vdp1);
+
+        /* x_sqlen + y_sqlen - 2 * dp  */
+        vdis0 = vec_nmsub (vtwo, vdp0,
+                           vec_add (vx_sqlen,
+                                    vec_xl ((long)(i*sizeof(float)),
+                                            (float*) y_sqlen)));
+        vdis1 = vec_nmsub (vtwo, vdp1,
+                           vec_add (vx_sqlen,
+                                    vec_xl ((long)((i + FLOAT_VEC_SIZE)
+                                                   *sizeof(float)),
+                                            (float*) y_sqlen)));
+
+        /* Most blocks have no match.  */
+        if (vec_any_lt (vdis0, vradius))
+            range_append_ippc (res, vdis0,
+                               (vector unsigned int) vec_cmplt (vdis0,
+                                                                vradius),
+                               i);
+        if (vec_any_lt (vdis1, vradius))
+            range_append_ippc (res, vdis1,
+                               (vector unsigned int) vec_cmplt (vdis1,
+                                                                vradius),
+                               i + FLOAT_VEC_SIZE);
+    }
+
+    /* Handle any remaining y vectors, in scalar mode. */
+    for (i = base; i < ny; i++) {
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+
+        float dis = x_sqlen + y_sqlen[i] - 2 * dp;
+        if (dis < radius)
+            range_result_push (res, dis, (int64_t) i);
+    }
+}
+
+void
+fvec_inner_product_ny_transposed_range_ref_ippc (const float* x,
+                                                 const float* y, size_t d,
+                                                 size_t d_offset, size_t ny,
+                                                 float radius,
+                                                 struct range_result_t* res)
+{
+    /* PowerPC, as fvec_L2sqr_ny_transposed_range_ref_ippc with the inner
+       products compared with the radius.  */
+    size_t i, base;
+    vector float vdp0, vdp1;
+    vector float vradius = vec_splats (radius);
+
+    base = (ny / (2 * FLOAT_VEC_SIZE)) * (2 * FLOAT_VEC_SIZE);
+
+    for (i = 0; i < base; i = i + 2 * FLOAT_VEC_SIZE) {
+        fvec_dp_8_transposed_ippc (x, y, d, d_offset, i, &vdp0, &vdp1);
+
+        if (vec_any_gt (vdp0, vradius))
+            range_append_ippc (res, vdp0,
+                               (vector unsigned int) vec_cmpgt (vdp0,
+                                                                vradius),
+                               i);
+        if (vec_any_gt (vdp1, vradius))
+            range_append_ippc (res, vdp1,
+                               (vector unsigned int) vec_cmpgt (vdp1,
+                                                                vradius),
+                               i + FLOAT_VEC_SIZE);
+    }
+
+    /* Handle any remaining y vectors, in scalar mode. */
+    for (i = base; i < ny; i++) {
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+
+        if (dp > radius)
+            range_result_push (res, dp, (int64_t) i);
+    }
+}
+
+void
+hamming_distance_ny_range_ref_ippc (const uint8_t* x, const uint8_t* y,
+                                    size_t size, size_t y_stride, size_t ny,
+                                    size_t radius, struct range_result_t* res)
+{
+    /* PowerPC, the distances of 4 codes at a time with
+       hamming_distance_ref_ippc are compared with the radius in a vector
+       register as fvec_L2sqr_ny_transposed_range_ref_ippc.  */
+    size_t i, base;
+    vector unsigned int vdis;
+    vector unsigned int vradius = vec_splats ((unsigned int) radius);
+
+    base = (ny / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (i = 0; i < base; i = i + FLOAT_VEC_SIZE) {
+        const uint8_t* yi = y + i * y_stride;
+
+        vdis = (vector unsigned int) {
+            (unsigned int) hamming_distance_ref_ippc (x, yi, size),
+            (unsigned int) hamming_distance_ref_ippc (x, yi + y_stride, size),
+            (unsigned int) hamming_distance_ref_ippc (x, yi + 2 * y_stride,
+                                                      size),
+            (unsigned int) hamming_distance_ref_ippc (x, yi + 3 * y_stride,
+                                                      size)};
+
+        if (vec_any_lt (vdis, vradius))
+            range_append_ippc (res, vec_ctf (vdis, 0),
+                               (vector unsigned int) vec_cmplt (vdis,
+                                                                vradius),
+                               i);
+    }
+
+    /* Handle any remaining codes, in scalar mode. */
+    for (i = base; i < ny; i++) {
+        size_t dis = hamming_distance_ref_ippc (x, y + i * y_stride, size);
+
+        if (dis < radius)
+            range_result_push (res, (float) dis, (int64_t) i);
+    }
+}
+
+}  // namespace powerpc
+
+#endif
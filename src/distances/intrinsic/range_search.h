@@ -0,0 +1,55 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RANGE_SEARCH_INTRINSIC_POWERPC_H
+#define RANGE_SEARCH_INTRINSIC_POWERPC_H
+
+#include <cstdint>
+#include <cstdio>
+#include "range.h"
+
+namespace powerpc {
+
+/// squared L2 distances between x and ny transposed y vectors as
+/// fvec_L2sqr_ny_transposed_ref_ippc.  Only the ids and distances of the y
+/// vectors with a distance below radius are appended to res.
+void
+fvec_L2sqr_ny_transposed_range_ref_ippc (const float* x, const float* y,
+                                         const float* y_sqlen, size_t d,
+                                         size_t d_offset, size_t ny,
+                                         float radius,
+                                         struct range_result_t* res);
+
+/// inner products between x and ny transposed y vectors, element j of y
+/// vector i is y[i + j * d_offset].  Only the ids and inner products of the
+/// y vectors with an inner product above radius are appended to res.
+void
+fvec_inner_product_ny_transposed_range_ref_ippc (const float* x, const float* y,
+                                                 size_t d, size_t d_offset,
+                                                 size_t ny, float radius,
+                                                 struct range_result_t* res);
+
+/// Hamming distances between the code x of size bytes and ny codes y,
+/// y_stride bytes apart.  Only the ids and distances of the codes with a
+/// distance below radius are appended to res.
+void
+hamming_distance_ny_range_ref_ippc (const uint8_t* x, const uint8_t* y,
+                                    size_t size, size_t y_stride, size_t ny,
+                                    size_t radius, struct range_result_t* res);
+
+}  // namespace powerpc
+
+#endif /* RANGE_SEARCH_INTRINSIC_POWERPC_H */
@@ -0,0 +1,328 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+
+#include "sparse_distance.h"
+
+#include <utility>
+
+#define FLOAT_VEC_SIZE 4
+#define INT32_VEC_SIZE 4
+
+/* Nonzeros of the longer vector per nonzero of the shorter one from which
+   the sparse-sparse kernels gallop instead of merging.  */
+#define SVEC_GALLOP_RATIO 8
+
+namespace powerpc {
+
+/* Return the first position p >= k of the sorted indices idx[0 .. n - 1]
+   with idx[p] >= key, or n.  Gallop in steps of 4, 8, 16, ... to get past
+   long runs of smaller indices, binary search the last step down to one
+   block of 4 indices and count the indices of the block below the key with
+   one vector compare.  A lookup costs time logarithmic in the number of
+   indices skipped.  */
+static inline size_t
+svec_skip_ippc (const int32_t* idx, size_t k, size_t n, int32_t key)
+{
+    size_t step = INT32_VEC_SIZE;
+    size_t hi, mid;
+    vector int vidx;
+    vector unsigned int vlt;
+
+    while (k + step <= n && idx[k + step - 1] < key) {
+        k += step;
+        step *= 2;
+    }
+
+    /* The position is in [k, hi], idx[hi] >= key unless hi is n.  */
+    hi = k + step - 1 < n ? k + step - 1 : n;
+    while (hi - k >= INT32_VEC_SIZE) {
+        mid = k + (hi - k) / 2;
+        if (idx[mid] < key)
+            k = mid + 1;
+        else
+            hi = mid;
+    }
+
+    /* The indices of the block below the key come first, as they are
+       sorted.  hi < k + 4, so if the block fits the position is in it.  */
+    if (k + INT32_VEC_SIZE <= n) {
+        vidx = vec_xl ((long)(k*sizeof(int32_t)), (int*) idx);
+        vlt = (vector unsigned int) vec_cmplt (vidx, vec_splats ((int) key));
+        return k + (vlt[0] & 1) + (vlt[1] & 1) + (vlt[2] & 1) + (vlt[3] & 1);
+    }
+
+    while (k < n && idx[k] < key)
+        k++;
+    return k;
+}
+
+/* Sum of the squares of v[start .. end - 1].  */
+static inline float
+svec_sqsum_ippc (const float* v, size_t start, size_t end)
+{
+    vector float vx;
+    vector float vres = {0, 0, 0, 0};
+    float res;
+    size_t i = start;
+
+    for (; i + FLOAT_VEC_SIZE <= end; i += FLOAT_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float*) v);
+        vres = vec_madd (vx, vx, vres);
+    }
+    res = vres[0] + vres[1] + vres[2] + vres[3];
+
+    for (; i < end; i++)
+        res += v[i] * v[i];
+    return res;
+}
+
+float
+svec_inner_product_ref_ippc (const int32_t* xi, const float* xv, size_t nx,
+                             const int32_t* yi, const float* yv, size_t ny)
+{
+    /* PowerPC, merge the sorted indices as the base version without
+       branches, or if one vector has SVEC_GALLOP_RATIO times the nonzeros
+       of the other look up the indices of the shorter one in the longer one
+       with svec_skip_ippc.  The merge itself is scalar code, one index pair
+       per step with selects instead of branches; only the block compare of
+       svec_skip_ippc and the sums of squares use vector instructions.  For
+       vectors of similar length the gain over the base version comes from
+       the branches avoided, not from VSX.  Original code:
+
+       while (i < nx && j < ny) {
+           if (xi[i] == yi[j]) {
+               res += xv[i] * yv[j];
+               i++;
+               j++;
+           } else if (xi[i] < yi[j]) {
+               i++;
+           } else {
+               j++;
+           }
+       }
+    */
+    size_t i = 0, j = 0;
+    int32_t a, b;
+    float res = 0;
+
+    if (nx > ny) {
+        std::swap (xi, yi);
+        std::swap (xv, yv);
+        std::swap (nx, ny);
+    }
+
+    if (ny >= SVEC_GALLOP_RATIO * nx) {
+        for (i = 0; i < nx; i++) {
+            j = svec_skip_ippc (yi, j, ny, xi[i]);
+            if (j == ny)
+                break;
+            if (yi[j] == xi[i])
+                res += xv[i] * yv[j++];
+        }
+        return res;
+    }
+
+    while (i < nx && j < ny) {
+        a = xi[i];
+        b = yi[j];
+        /* Select rather than multiply by the compare, so a value of an
+           index in only one vector, even inf or NaN, adds an exact 0.  */
+        res += a == b ? xv[i] * yv[j] : 0.0f;
+        i += a <= b;
+        j += b <= a;
+    }
+    return res;
+}
+
+float
+svec_L2sqr_ref_ippc (const int32_t* xi, const float* xv, size_t nx,
+                     const int32_t* yi, const float* yv, size_t ny)
+{
+    /* PowerPC, merge as svec_inner_product_ref_ippc, the values of an index
+       in only one of the vectors are added squared.  In the galloping case
+       start from the squared norm of the longer vector and replace y_j^2 by
+       (x_i - y_j)^2 for the common indices as svec_dense_L2sqr_ref_ippc.  */
+    size_t i = 0, j = 0;
+    int32_t a, b;
+    float res = 0, tmp;
+
+    if (nx > ny) {
+        std::swap (xi, yi);
+        std::swap (xv, yv);
+        std::swap (nx, ny);
+    }
+
+    if (ny >= SVEC_GALLOP_RATIO * nx) {
+        for (i = 0; i < nx; i++) {
+            j = svec_skip_ippc (yi, j, ny, xi[i]);
+            if (j < ny && yi[j] == xi[i]) {
+                tmp = xv[i] - yv[j];
+                res += tmp * tmp - yv[j] * yv[j];
+                j++;
+            } else {
+                res += xv[i] * xv[i];
+            }
+        }
+        return svec_sqsum_ippc (yv, 0, ny) + res;
+    }
+
+    while (i < nx && j < ny) {
+        a = xi[i];
+        b = yi[j];
+        tmp = (a <= b ? xv[i] : 0.0f) - (b <= a ? yv[j] : 0.0f);
+        res += tmp * tmp;
+        i += a <= b;
+        j += b <= a;
+    }
+    res += svec_sqsum_ippc (xv, i, nx);
+    res += svec_sqsum_ippc (yv, j, ny);
+    return res;
+}
+
+float
+svec_dense_inner_product_ref_ippc (const int32_t* xi, const float* xv,
+                                   size_t nx, const float* y)
+{
+    /* PowerPC, gather the values of y at 4 indices of x into a vector.
+       Original code:
+
+       for (i = 0; i < nx; i++)
+           res += xv[i] * y[xi[i]];
+    */
+    size_t i, base;
+    float res;
+    vector float vx, vy;
+    vector float vres = {0, 0, 0, 0};
+
+    base = (nx / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (i = 0; i < base; i = i + FLOAT_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float*) xv);
+        vy = (vector float) {y[xi[i]], y[xi[i + 1]], y[xi[i + 2]],
+                             y[xi[i + 3]]};
+
+        vres = vec_madd (vx, vy, vres);
+    }
+    res = vres[0] + vres[1] + vres[2] + vres[3];
+
+    /* Handle any remaining data elements */
+    for (i = base; i < nx; i++)
+        res += xv[i] * y[xi[i]];
+    return res;
+}
+
+float
+svec_dense_L2sqr_ref_ippc (const int32_t* xi, const float* xv, size_t nx,
+                           const float* y, float y_sqlen)
+{
+    /* PowerPC, gather the values of y as svec_dense_inner_product_ref_ippc.
+       The squares of the differences and of the gathered values of y are
+       summed separately.  */
+    size_t i, base;
+    float res;
+    vector float vx, vy, vtmp;
+    vector float vres = {0, 0, 0, 0};
+    vector float vsq = {0, 0, 0, 0};
+
+    base = (nx / FLOAT_VEC_SIZE) * FLOAT_VEC_SIZE;
+
+    for (i = 0; i < base; i = i + FLOAT_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float*) xv);
+        vy = (vector float) {y[xi[i]], y[xi[i + 1]], y[xi[i + 2]],
+                             y[xi[i + 3]]};
+
+        vtmp = vec_sub (vx, vy);
+        vres = vec_madd (vtmp, vtmp, vres);
+        vsq = vec_madd (vy, vy, vsq);
+    }
+    res = (vres[0] + vres[1] + vres[2] + vres[3])
+          - (vsq[0] + vsq[1] + vsq[2] + vsq[3]);
+
+    /* Handle any remaining data elements */
+    for (i = base; i < nx; i++) {
+        const float tmp = xv[i] - y[xi[i]];
+        res += tmp * tmp - y[xi[i]] * y[xi[i]];
+    }
+    return y_sqlen + res;
+}
+
+void
+svec_inner_product_ny_ref_ippc (float* dis, const int32_t* xi,
+                                const float* xv, size_t nx,
+                                const int64_t* y_offsets,
+                                const int32_t* y_ids, const float* y_vals,
+                                size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_inner_product_ref_ippc (xi, xv, nx, y_ids + start,
+                                              y_vals + start,
+                                              y_offsets[i + 1] - start);
+    }
+}
+
+void
+svec_L2sqr_ny_ref_ippc (float* dis, const int32_t* xi, const float* xv,
+                        size_t nx, const int64_t* y_offsets,
+                        const int32_t* y_ids, const float* y_vals, size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_L2sqr_ref_ippc (xi, xv, nx, y_ids + start,
+                                      y_vals + start,
+                                      y_offsets[i + 1] - start);
+    }
+}
+
+void
+svec_dense_inner_product_ny_ref_ippc (float* dis, const float* x,
+                                      const int64_t* y_offsets,
+                                      const int32_t* y_ids,
+                                      const float* y_vals, size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_dense_inner_product_ref_ippc (y_ids + start,
+                                                    y_vals + start,
+                                                    y_offsets[i + 1] - start,
+                                                    x);
+    }
+}
+
+void
+svec_dense_L2sqr_ny_ref_ippc (float* dis, const float* x, float x_sqlen,
+                              const int64_t* y_offsets, const int32_t* y_ids,
+                              const float* y_vals, size_t ny)
+{
+    for (size_t i = 0; i < ny; i++) {
+        int64_t start = y_offsets[i];
+
+        dis[i] = svec_dense_L2sqr_ref_ippc (y_ids + start, y_vals + start,
+                                            y_offsets[i + 1] - start, x,
+                                            x_sqlen);
+    }
+}
+
+}  // namespace powerpc
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__powerpc__)
+
+#include "multi_acc.h"
+#include "multi_acc_kernels.h"
+
+namespace powerpc {
+
+/* Instances of the MULTI_ACC_COUNTS, one case per count.  */
+#define MULTI_ACC_CASE_L2SQR(N) \
+    case N: return fvec_L2sqr_macc<N>;
+#define MULTI_ACC_CASE_NORM_L2SQR(N) \
+    case N: return fvec_norm_L2sqr_macc<N>;
+#define MULTI_ACC_CASE_INNER_PRODUCT(N) \
+    case N: return fvec_inner_product_macc<N>;
+#define MULTI_ACC_CASE_L1(N) \
+    case N: return fvec_L1_macc<N>;
+#define MULTI_ACC_CASE_COSINE(N) \
+    case N: return cosine_distance_macc<N>;
+#define MULTI_ACC_CASE_JACCARD(N) \
+    case N: return jaccard_distance_macc<N>;
+
+multi_acc_pair_fn_t
+fvec_L2sqr_multi_acc (unsigned int nacc) {
+    switch (nacc) {
+    MULTI_ACC_COUNTS (MULTI_ACC_CASE_L2SQR)
+    }
+    return NULL;
+}
+
+multi_acc_norm_fn_t
+fvec_norm_L2sqr_multi_acc (unsigned int nacc) {
+    switch (nacc) {
+    MULTI_ACC_COUNTS (MULTI_ACC_CASE_NORM_L2SQR)
+    }
+    return NULL;
+}
+
+multi_acc_pair_fn_t
+fvec_inner_product_multi_acc (unsigned int nacc) {
+    switch (nacc) {
+    MULTI_ACC_COUNTS (MULTI_ACC_CASE_INNER_PRODUCT)
+    }
+    return NULL;
+}
+
+multi_acc_pair_fn_t
+fvec_L1_multi_acc (unsigned int nacc) {
+    switch (nacc) {
+    MULTI_ACC_COUNTS (MULTI_ACC_CASE_L1)
+    }
+    return NULL;
+}
+
+multi_acc_pair_fn_t
+cosine_distance_multi_acc (unsigned int nacc) {
+    switch (nacc) {
+    MULTI_ACC_COUNTS (MULTI_ACC_CASE_COSINE)
+    }
+    return NULL;
+}
+
+multi_acc_pair_fn_t
+jaccard_distance_multi_acc (unsigned int nacc) {
+    switch (nacc) {
+    MULTI_ACC_COUNTS (MULTI_ACC_CASE_JACCARD)
+    }
+    return NULL;
+}
+
+}  // namespace powerpc
+
+#endif
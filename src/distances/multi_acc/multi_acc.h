@@ -0,0 +1,45 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MULTI_ACC_POWERPC_H
+#define MULTI_ACC_POWERPC_H
+
+#include <cstddef>
+
+/* The accumulator counts with an instance of the float functions, see
+   multi_acc_kernels.h.  The intrinsic versions are the single accumulator
+   variant.  */
+#define MULTI_ACC_COUNTS(X) X(2) X(4) X(8)
+
+namespace powerpc {
+
+typedef float (*multi_acc_pair_fn_t) (const float* x, const float* y,
+                                      size_t d);
+typedef float (*multi_acc_norm_fn_t) (const float* x, size_t d);
+
+/// The variant of the function with nacc accumulators, NULL if there is
+/// none.  Pick the variant per function once, the best count depends on
+/// the FMA latency and the number of sums per element.
+multi_acc_pair_fn_t fvec_L2sqr_multi_acc (unsigned int nacc);
+multi_acc_norm_fn_t fvec_norm_L2sqr_multi_acc (unsigned int nacc);
+multi_acc_pair_fn_t fvec_inner_product_multi_acc (unsigned int nacc);
+multi_acc_pair_fn_t fvec_L1_multi_acc (unsigned int nacc);
+multi_acc_pair_fn_t cosine_distance_multi_acc (unsigned int nacc);
+multi_acc_pair_fn_t jaccard_distance_multi_acc (unsigned int nacc);
+
+}  // namespace powerpc
+
+#endif /* MULTI_ACC_POWERPC_H */
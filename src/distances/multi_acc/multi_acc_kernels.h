@@ -0,0 +1,339 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MULTI_ACC_KERNELS_POWERPC_H
+#define MULTI_ACC_KERNELS_POWERPC_H
+
+/* Multiple accumulator versions of the float functions.  The intrinsic
+   versions add every vector to a single accumulator, so each vec_madd waits
+   for the result of the previous one and the loop runs at the latency of
+   one FMA per vector.  These keep NACC independent accumulators and unroll
+   the loop NACC times, one vector per accumulator, so NACC FMAs are in
+   flight and both VSX pipes can be busy.  The accumulators are added
+   pairwise at the end.  The remaining whole vectors go to the first
+   accumulator and the last d % 4 elements are done in scalar mode as in
+   the intrinsic versions.
+
+   The sums are done in a different order than the intrinsic versions, the
+   results may differ in the last bits.
+
+   The templates need altivec.h, include multi_acc.h for the instances of
+   the accumulator counts in MULTI_ACC_COUNTS.  */
+
+#if defined(__powerpc__)
+
+#include <altivec.h>   /* Required for the Power GCC built-ins  */
+#include <cstddef>
+#include <cmath>
+
+#define MULTI_ACC_VEC_SIZE 4   /* Floats per VSX register.  */
+
+namespace powerpc {
+
+/* Add the NACC accumulators in v pairwise into v[0].  */
+template <int NACC, class V>
+inline void
+multi_acc_reduce (V* v) {
+    static_assert (NACC > 0 && (NACC & (NACC - 1)) == 0,
+                   "NACC must be a power of 2");
+#pragma GCC unroll 8
+    for (int n = NACC / 2; n > 0; n = n / 2)
+#pragma GCC unroll 8
+        for (int k = 0; k < n; k++)
+            v[k] = vec_add (v[k], v[k + n]);
+}
+
+template <int NACC>
+float
+fvec_L2sqr_macc (const float* x, const float* y, size_t d) {
+    const size_t step = NACC * MULTI_ACC_VEC_SIZE;
+    const vector float vzero = {0, 0, 0, 0};
+    vector float vx, vy, vtmp;
+    vector float vres[NACC];
+    size_t i, base;
+    float res = 0;
+
+#pragma GCC unroll 8
+    for (int k = 0; k < NACC; k++)
+        vres[k] = vzero;
+
+    base = (d / step) * step;
+    for (i = 0; i < base; i = i + step) {
+#pragma GCC unroll 8
+        for (int k = 0; k < NACC; k++) {
+            vx = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) x);
+            vy = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) y);
+            vtmp = vec_sub (vx, vy);
+            vres[k] = vec_madd (vtmp, vtmp, vres[k]);
+        }
+    }
+
+    /* Remaining whole vectors.  */
+    for (; i + MULTI_ACC_VEC_SIZE <= d; i = i + MULTI_ACC_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vy = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vtmp = vec_sub (vx, vy);
+        vres[0] = vec_madd (vtmp, vtmp, vres[0]);
+    }
+
+    /* Handle any remaining data elements */
+    for (; i < d; i++) {
+        const float tmp = x[i] - y[i];
+        res += tmp * tmp;
+    }
+
+    multi_acc_reduce<NACC> (vres);
+    return res + vres[0][0] + vres[0][1] + vres[0][2] + vres[0][3];
+}
+
+/* Squares in double as fvec_norm_L2sqr_ref_ippc, NACC accumulators each
+   for the even and the odd elements.  */
+template <int NACC>
+float
+fvec_norm_L2sqr_macc (const float* x, size_t d) {
+    const size_t step = NACC * MULTI_ACC_VEC_SIZE;
+    const vector double vzero = {0, 0};
+    vector float vx;
+    vector double vxd;
+    vector double vrese[NACC], vreso[NACC];
+    size_t i, base;
+    double res = 0;
+
+#pragma GCC unroll 8
+    for (int k = 0; k < NACC; k++) {
+        vrese[k] = vzero;
+        vreso[k] = vzero;
+    }
+
+    base = (d / step) * step;
+    for (i = 0; i < base; i = i + step) {
+#pragma GCC unroll 8
+        for (int k = 0; k < NACC; k++) {
+            vx = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) x);
+            vxd = vec_doublee (vx);
+            vrese[k] = vec_madd (vxd, vxd, vrese[k]);
+            vxd = vec_doubleo (vx);
+            vreso[k] = vec_madd (vxd, vxd, vreso[k]);
+        }
+    }
+
+    /* Remaining whole vectors.  */
+    for (; i + MULTI_ACC_VEC_SIZE <= d; i = i + MULTI_ACC_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vxd = vec_doublee (vx);
+        vrese[0] = vec_madd (vxd, vxd, vrese[0]);
+        vxd = vec_doubleo (vx);
+        vreso[0] = vec_madd (vxd, vxd, vreso[0]);
+    }
+
+    /* Handle any remaining data elements */
+    for (; i < d; i++)
+        res += x[i] * x[i];
+
+    multi_acc_reduce<NACC> (vrese);
+    multi_acc_reduce<NACC> (vreso);
+    return res + vreso[0][0] + vreso[0][1] + vrese[0][0] + vrese[0][1];
+}
+
+template <int NACC>
+float
+fvec_inner_product_macc (const float* x, const float* y, size_t d) {
+    const size_t step = NACC * MULTI_ACC_VEC_SIZE;
+    const vector float vzero = {0, 0, 0, 0};
+    vector float vx, vy;
+    vector float vres[NACC];
+    size_t i, base;
+    float res = 0;
+
+#pragma GCC unroll 8
+    for (int k = 0; k < NACC; k++)
+        vres[k] = vzero;
+
+    base = (d / step) * step;
+    for (i = 0; i < base; i = i + step) {
+#pragma GCC unroll 8
+        for (int k = 0; k < NACC; k++) {
+            vx = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) x);
+            vy = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) y);
+            vres[k] = vec_madd (vx, vy, vres[k]);
+        }
+    }
+
+    /* Remaining whole vectors.  */
+    for (; i + MULTI_ACC_VEC_SIZE <= d; i = i + MULTI_ACC_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vy = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vres[0] = vec_madd (vx, vy, vres[0]);
+    }
+
+    /* Handle any remaining data elements */
+    for (; i < d; i++)
+        res += x[i] * y[i];
+
+    multi_acc_reduce<NACC> (vres);
+    return res + vres[0][0] + vres[0][1] + vres[0][2] + vres[0][3];
+}
+
+template <int NACC>
+float
+fvec_L1_macc (const float* x, const float* y, size_t d) {
+    const size_t step = NACC * MULTI_ACC_VEC_SIZE;
+    const vector float vzero = {0, 0, 0, 0};
+    vector float vx, vy;
+    vector float vres[NACC];
+    size_t i, base;
+    float res = 0;
+
+#pragma GCC unroll 8
+    for (int k = 0; k < NACC; k++)
+        vres[k] = vzero;
+
+    base = (d / step) * step;
+    for (i = 0; i < base; i = i + step) {
+#pragma GCC unroll 8
+        for (int k = 0; k < NACC; k++) {
+            vx = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) x);
+            vy = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) y);
+            vres[k] = vec_add (vec_abs (vec_sub (vx, vy)), vres[k]);
+        }
+    }
+
+    /* Remaining whole vectors.  */
+    for (; i + MULTI_ACC_VEC_SIZE <= d; i = i + MULTI_ACC_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vy = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vres[0] = vec_add (vec_abs (vec_sub (vx, vy)), vres[0]);
+    }
+
+    /* Handle any remaining data elements */
+    for (; i < d; i++)
+        res += std::fabs (x[i] - y[i]);
+
+    multi_acc_reduce<NACC> (vres);
+    return res + vres[0][0] + vres[0][1] + vres[0][2] + vres[0][3];
+}
+
+/* Three sums per element, 3 * NACC accumulators.  */
+template <int NACC>
+float
+cosine_distance_macc (const float* x, const float* y, size_t d) {
+    const size_t step = NACC * MULTI_ACC_VEC_SIZE;
+    const vector float vzero = {0, 0, 0, 0};
+    vector float vx, vy;
+    vector float vdot[NACC], vmag_x[NACC], vmag_y[NACC];
+    float dot, mag_x, mag_y;
+    size_t i, base;
+
+#pragma GCC unroll 8
+    for (int k = 0; k < NACC; k++) {
+        vdot[k] = vzero;
+        vmag_x[k] = vzero;
+        vmag_y[k] = vzero;
+    }
+
+    base = (d / step) * step;
+    for (i = 0; i < base; i = i + step) {
+#pragma GCC unroll 8
+        for (int k = 0; k < NACC; k++) {
+            vx = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) x);
+            vy = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) y);
+            vdot[k] = vec_madd (vx, vy, vdot[k]);
+            vmag_x[k] = vec_madd (vx, vx, vmag_x[k]);
+            vmag_y[k] = vec_madd (vy, vy, vmag_y[k]);
+        }
+    }
+
+    /* Remaining whole vectors.  */
+    for (; i + MULTI_ACC_VEC_SIZE <= d; i = i + MULTI_ACC_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vy = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vdot[0] = vec_madd (vx, vy, vdot[0]);
+        vmag_x[0] = vec_madd (vx, vx, vmag_x[0]);
+        vmag_y[0] = vec_madd (vy, vy, vmag_y[0]);
+    }
+
+    multi_acc_reduce<NACC> (vdot);
+    multi_acc_reduce<NACC> (vmag_x);
+    multi_acc_reduce<NACC> (vmag_y);
+    dot = vdot[0][0] + vdot[0][1] + vdot[0][2] + vdot[0][3];
+    mag_x = vmag_x[0][0] + vmag_x[0][1] + vmag_x[0][2] + vmag_x[0][3];
+    mag_y = vmag_y[0][0] + vmag_y[0][1] + vmag_y[0][2] + vmag_y[0][3];
+
+    /* Handle any remaining data elements */
+    for (; i < d; i++) {
+        dot += x[i] * y[i];
+        mag_x += x[i] * x[i];
+        mag_y += y[i] * y[i];
+    }
+
+    return 1.0f - (dot / (sqrt (mag_x * mag_y)));
+}
+
+/* Two sums per element, 2 * NACC accumulators.  */
+template <int NACC>
+float
+jaccard_distance_macc (const float* x, const float* y, size_t d) {
+    const size_t step = NACC * MULTI_ACC_VEC_SIZE;
+    const vector float vzero = {0, 0, 0, 0};
+    vector float vx, vy;
+    vector float vnum[NACC], vden[NACC];
+    float num, den;
+    size_t i, base;
+
+#pragma GCC unroll 8
+    for (int k = 0; k < NACC; k++) {
+        vnum[k] = vzero;
+        vden[k] = vzero;
+    }
+
+    base = (d / step) * step;
+    for (i = 0; i < base; i = i + step) {
+#pragma GCC unroll 8
+        for (int k = 0; k < NACC; k++) {
+            vx = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) x);
+            vy = vec_xl ((long)((i + k*4)*sizeof(float)), (float *) y);
+            vnum[k] = vec_add (vnum[k], vec_min (vx, vy));
+            vden[k] = vec_add (vden[k], vec_max (vx, vy));
+        }
+    }
+
+    /* Remaining whole vectors.  */
+    for (; i + MULTI_ACC_VEC_SIZE <= d; i = i + MULTI_ACC_VEC_SIZE) {
+        vx = vec_xl ((long)(i*sizeof(float)), (float *) x);
+        vy = vec_xl ((long)(i*sizeof(float)), (float *) y);
+        vnum[0] = vec_add (vnum[0], vec_min (vx, vy));
+        vden[0] = vec_add (vden[0], vec_max (vx, vy));
+    }
+
+    multi_acc_reduce<NACC> (vnum);
+    multi_acc_reduce<NACC> (vden);
+    num = vnum[0][0] + vnum[0][1] + vnum[0][2] + vnum[0][3];
+    den = vden[0][0] + vden[0][1] + vden[0][2] + vden[0][3];
+
+    /* Handle any remaining data elements */
+    for (; i < d; i++) {
+        num += std::fmin (x[i], y[i]);
+        den += std::fmax (x[i], y[i]);
+    }
+
+    return 1.0f - (num / den);
+}
+
+}  // namespace powerpc
+
+#endif
+
+#endif /* MULTI_ACC_KERNELS_POWERPC_H */
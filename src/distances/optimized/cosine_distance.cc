@@ -18,6 +18,8 @@
 
 #include <iostream>
 #include "cosine_distance.h"
+#include "innerproduct.h"
+#include "euclidean_l2_distance.h"
 
 #include <cmath>
 
@@ -63,6 +65,51 @@ cosine_distance_ref_ppc (const float* x, const float* y, size_t d)
     return res;
 }
 
+float
+cosine_distance_inv_norms_ref_ppc (const float* x, const float* y, size_t d,
+                                   float inv_norm_x, float inv_norm_y)
+{
+    /* The norms are known, the distance reduces to the inner product.  */
+    return 1.0f - fvec_inner_product_ref_ppc (x, y, d) * inv_norm_x
+                  * inv_norm_y;
+}
+
+float
+cosine_distance_normalized_ref_ppc (const float* x, const float* y, size_t d)
+{
+    return 1.0f - fvec_inner_product_ref_ppc (x, y, d);
+}
+
+void
+cosine_distance_ny_ref_ppc (float* dis, const float* x, const float* y,
+                            const float* y_inv_norms, size_t d,
+                            size_t y_stride, size_t ny)
+{
+    float inv_norm_x = 1.0f / sqrt (fvec_norm_L2sqr_ref_ppc (x, d));
+
+    for (size_t i = 0; i < ny; i++)
+    {
+        const float* yi = y + i * y_stride;
+        float inv_norm_y = y_inv_norms ? y_inv_norms[i]
+                           : 1.0f / sqrt (fvec_norm_L2sqr_ref_ppc (yi, d));
+
+        dis[i] = 1.0f - fvec_inner_product_ref_ppc (x, yi, d) * inv_norm_x
+                        * inv_norm_y;
+    }
+}
+
+void
+fvec_inv_norms_ref_ppc (float* inv_norms, const float* x, size_t d,
+                        size_t x_stride, size_t nx)
+{
+    for (size_t i = 0; i < nx; i++)
+    {
+        const float* xi = x + i * x_stride;
+
+        inv_norms[i] = 1.0f / sqrt (fvec_norm_L2sqr_ref_ppc (xi, d));
+    }
+}
+
 } // namespace powerpc
 
 #endif
@@ -0,0 +1,41 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EARLY_ABANDON_POWERPC_H
+#define EARLY_ABANDON_POWERPC_H
+
+#include <cstdint>
+#include <cstdio>
+
+#define EARLY_ABANDON_BLOCK 64  /* Dimensions between threshold checks.  */
+
+namespace powerpc {
+
+/// squared L2 distance between x and y as fvec_L2sqr_ref_ppc, checking the
+/// partial sum against threshold after every 64 dimensions.  Returns the
+/// distance if it is below threshold, else a partial sum >= threshold.
+float
+fvec_L2sqr_early_ref_ppc (const float* x, const float* y, size_t d,
+                          float threshold);
+
+/// L1 distance between x and y, see fvec_L2sqr_early_ref_ppc.
+float
+fvec_L1_early_ref_ppc (const float* x, const float* y, size_t d,
+                       float threshold);
+
+}  // namespace powerpc
+
+#endif /* EARLY_ABANDON_POWERPC_H */
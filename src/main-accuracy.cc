@@ -0,0 +1,485 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Accuracy test.  The result check of print_result only compares the
+   optimized versions with the base version, which has rounding errors of
+   its own.  With --accuracy <n> each function and code version is called
+   on n pairs of random vectors per array size and the results are compared
+   with an oracle computed in long double with compensated (Kahan)
+   summation.  The maximum and mean relative error and a histogram of the
+   error in units in the last place (ULP) of the float result are reported,
+   giving the exact accuracy cost of reassociating the sums, for example
+   with more accumulators or fused multiply-adds.
+
+   A correctly rounded result is within 0.5 ULP of the oracle.  The integer
+   functions are exact, their error is in units of 1.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include "main-accuracy.h"
+#include "main-kernels.h"
+#include "main-output.h"
+
+/* Upper bounds of the ULP histogram buckets but the last.  */
+static const double accuracy_ulp_bound[ACCURACY_ULP_BUCKETS - 1]
+    = {0.5, 1, 2, 4, 8, 16, 64, 256, 1024};
+
+/* Results of all of the array sizes, printed at the end of the run.  */
+static std::vector<struct accuracy_result_t> accuracy_results;
+
+/* The inputs of one trial, see struct kernel_inputs_t.  */
+struct accuracy_data_t {
+    float *x;
+    float *y[4];
+    float *yt;
+    float *y_sqlen;
+    int8_t *xi, *yi;
+    uint8_t *c1, *c2;
+};
+
+/* Compensated sum, the error of each addition is carried in c.  */
+struct kahan_sum_t {
+    long double sum = 0;
+    long double c = 0;
+};
+
+static void
+kahan_add (struct kahan_sum_t *k, long double value)
+{
+    long double y = value - k->c;
+    long double t = k->sum + y;
+
+    k->c = (t - k->sum) - y;
+    k->sum = t;
+}
+
+/* Oracles of the distance functions, y is read with a stride of
+   y_stride elements.  */
+static long double
+oracle_dot (const float *x, const float *y, size_t d, size_t y_stride)
+{
+    struct kahan_sum_t k;
+
+    for (size_t i = 0; i < d; i++)
+        kahan_add (&k, (long double) x[i] * y[i * y_stride]);
+    return k.sum;
+}
+
+static long double
+oracle_L2sqr (const float *x, const float *y, size_t d)
+{
+    struct kahan_sum_t k;
+
+    for (size_t i = 0; i < d; i++)
+    {
+        long double diff = (long double) x[i] - y[i];
+
+        kahan_add (&k, diff * diff);
+    }
+    return k.sum;
+}
+
+static long double
+oracle_L1 (const float *x, const float *y, size_t d)
+{
+    struct kahan_sum_t k;
+
+    for (size_t i = 0; i < d; i++)
+        kahan_add (&k, fabsl ((long double) x[i] - y[i]));
+    return k.sum;
+}
+
+static long double
+oracle_cosine (const float *x, const float *y, size_t d)
+{
+    long double dot = oracle_dot (x, y, d, 1);
+    long double x_sqlen = oracle_dot (x, x, d, 1);
+    long double y_sqlen = oracle_dot (y, y, d, 1);
+
+    return 1.0L - dot / sqrtl (x_sqlen * y_sqlen);
+}
+
+static long double
+oracle_jaccard (const float *x, const float *y, size_t d)
+{
+    struct kahan_sum_t num, den;
+
+    for (size_t i = 0; i < d; i++)
+    {
+        kahan_add (&num, fmin (x[i], y[i]));
+        kahan_add (&den, fmax (x[i], y[i]));
+    }
+    return 1.0L - num.sum / den.sum;
+}
+
+/* Exact results of fun_id on in, returns the number of results.  */
+static unsigned int
+accuracy_oracle (unsigned int fun_id, const struct kernel_inputs_t *in,
+                 size_t d, long double *exact)
+{
+    using namespace std;
+    long long int sum = 0;
+    unsigned int i;
+
+    switch (fun_id)
+    {
+    case FVEC_L2SQR_REF:
+        exact[0] = oracle_L2sqr (in->x, in->y[0], d);
+        return 1;
+
+    case FVEC_NORM_L2SQR_REF:
+        exact[0] = oracle_dot (in->x, in->x, d, 1);
+        return 1;
+
+    case FVEC_L2SQR_NY_TRANSPOSED_REF:
+    {
+        /* The squared lengths of y are inputs of the function.  */
+        long double x_sqlen = oracle_dot (in->x, in->x, d, 1);
+
+        for (i = 0; i < NY_DISTANCE; i++)
+            exact[i] = x_sqlen + in->y_sqlen[i]
+                - 2 * oracle_dot (in->x, in->yt + i, d, NY_DISTANCE);
+        return NY_DISTANCE;
+    }
+
+    case FVEC_L2SQR_BATCH_4_REF:
+        for (i = 0; i < 4; i++)
+            exact[i] = oracle_L2sqr (in->x, in->y[i], d);
+        return 4;
+
+    case IVEC_L2SQR_REF:
+        for (size_t j = 0; j < d; j++)
+            sum += (in->xi[j] - in->yi[j]) * (in->xi[j] - in->yi[j]);
+        exact[0] = sum;
+        return 1;
+
+    case FVEC_INNER_PRODUCT_REF:
+        exact[0] = oracle_dot (in->x, in->y[0], d, 1);
+        return 1;
+
+    case FVEC_INNER_PRODUCT_BATCH_4_REF:
+        for (i = 0; i < 4; i++)
+            exact[i] = oracle_dot (in->x, in->y[i], d, 1);
+        return 4;
+
+    case IVEC_INNER_PRODUCT_REF:
+        for (size_t j = 0; j < d; j++)
+            sum += in->xi[j] * in->yi[j];
+        exact[0] = sum;
+        return 1;
+
+    case FVEC_L1_REF:
+        exact[0] = oracle_L1 (in->x, in->y[0], d);
+        return 1;
+
+    case COSINE_DISTANCE_REF:
+        exact[0] = oracle_cosine (in->x, in->y[0], d);
+        return 1;
+
+    case HAMMING_DISTANCE_REF:
+        for (size_t j = 0; j < d; j++)
+            for (uint8_t bits = in->c1[j] ^ in->c2[j]; bits; bits >>= 1)
+                sum += bits & 1;
+        exact[0] = sum;
+        return 1;
+
+    case JACCARD_DISTANCE_REF:
+        exact[0] = oracle_jaccard (in->x, in->y[0], d);
+        return 1;
+
+    default:
+        cout << "ERROR, accuracy_oracle: no oracle for func_id " << fun_id
+             << ", exiting.\n";
+        exit(-1);
+    }
+}
+
+/* Error of result in units in the last place of the float nearest to
+   exact, or in units of 1 for the integer functions.  */
+static double
+ulp_error (long double result, long double exact, bool is_float)
+{
+    long double err = fabsl (result - exact);
+    float rounded = fabsf ((float) exact);
+
+    if (!is_float)
+        return (double) err;
+
+    return (double) (err / (nextafterf (rounded, INFINITY) - rounded));
+}
+
+static void
+add_result (struct accuracy_result_t *acc, long double result,
+            long double exact, bool is_float)
+{
+    long double err = fabsl (result - exact);
+    double rel_err = (double) (exact != 0 ? err / fabsl (exact) : err);
+    double ulp = ulp_error (result, exact, is_float);
+    unsigned int b;
+
+    /* NaN results count as the largest error.  */
+    if (std::isnan (rel_err) || std::isnan (ulp))
+        rel_err = ulp = INFINITY;
+
+    for (b = 0; b < ACCURACY_ULP_BUCKETS - 1; b++)
+        if (ulp <= accuracy_ulp_bound[b])
+            break;
+    acc->ulp_histogram[b]++;
+
+    if (rel_err > acc->max_rel_err)
+        acc->max_rel_err = rel_err;
+    if (ulp > acc->max_ulp)
+        acc->max_ulp = ulp;
+
+    /* The means are sums until the end of run_accuracy_tests.  */
+    acc->mean_rel_err += rel_err;
+    acc->mean_ulp += ulp;
+    acc->num_results++;
+}
+
+/* Random floats in [0, 1) as in the working set databases, random int8_t
+   and uint8_t values.  */
+static void
+fill_accuracy_data (struct accuracy_data_t *data, size_t d,
+                    std::mt19937 &gen)
+{
+    std::uniform_real_distribution<float> dist (0.0f, 1.0f);
+    std::uniform_int_distribution<int> byte (0, 255);
+    size_t i, j;
+
+    for (i = 0; i < d; i++)
+    {
+        data->x[i] = dist (gen);
+        for (j = 0; j < 4; j++)
+            data->y[j][i] = dist (gen);
+        data->xi[i] = (int8_t) (byte (gen) - 128);
+        data->yi[i] = (int8_t) (byte (gen) - 128);
+        data->c1[i] = (uint8_t) byte (gen);
+        data->c2[i] = (uint8_t) byte (gen);
+    }
+
+    for (i = 0; i < d * NY_DISTANCE; i++)
+        data->yt[i] = dist (gen);
+
+    for (j = 0; j < NY_DISTANCE; j++)
+        data->y_sqlen[j] = (float) oracle_dot (data->yt + j, data->yt + j, d,
+                                               NY_DISTANCE);
+}
+
+/* Check the selected functions and code versions on accuracy_trials
+   random inputs of dimension d.  */
+void
+run_accuracy_tests (struct results_data_t* result, unsigned int array_index,
+                    size_t d, struct flags_t cmd_flags)
+{
+    using namespace std;
+    struct accuracy_result_t acc[FUNC_ID_MAX][NUM_CODE_VERSIONS];
+    struct accuracy_data_t data;
+    struct arena_t arena;
+    struct kernel_inputs_t in;
+    long double exact[NY_DISTANCE];
+    double out[NY_DISTANCE];
+    unsigned int i, code_ver, n, k;
+    mt19937 gen (ACCURACY_SEED + d);
+    int trial;
+
+    cout << "  Accuracy test, " << cmd_flags.accuracy_trials << " trials"
+         << endl;
+
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    data.x = (float *) arena_alloc_vectors (&arena, 1, d, sizeof (float));
+    for (k = 0; k < 4; k++)
+        data.y[k] = (float *) arena_alloc_vectors (&arena, 1, d,
+                                                   sizeof (float));
+    data.yt = (float *) arena_alloc_vectors (&arena, NY_DISTANCE, d,
+                                             sizeof (float));
+    data.y_sqlen = (float *) arena_alloc (&arena,
+                                          NY_DISTANCE * sizeof (float));
+    data.xi = (int8_t *) arena_alloc_vectors (&arena, 1, d, sizeof (int8_t));
+    data.yi = (int8_t *) arena_alloc_vectors (&arena, 1, d, sizeof (int8_t));
+    data.c1 = (uint8_t *) arena_alloc_vectors (&arena, 1, d,
+                                               sizeof (uint8_t));
+    data.c2 = (uint8_t *) arena_alloc_vectors (&arena, 1, d,
+                                               sizeof (uint8_t));
+
+    in.x = data.x;
+    for (k = 0; k < 4; k++)
+        in.y[k] = data.y[k];
+    in.yt = data.yt;
+    in.y_sqlen = data.y_sqlen;
+    in.xi = data.xi;
+    in.yi = data.yi;
+    in.c1 = data.c1;
+    in.c2 = data.c2;
+
+    for (trial = 0; trial < cmd_flags.accuracy_trials; trial++)
+    {
+        fill_accuracy_data (&data, d, gen);
+
+        for (i = 0; i < FUNC_ID_MAX; i++)
+        {
+            const struct kernel_info_t *info;
+            bool is_float;
+
+            if (!cmd_flags.run_func_flag[i])
+                continue;
+
+            info = get_kernel_info (i);
+            is_float = info->sig != SIG_IVEC_PAIR
+                && info->sig != SIG_BVEC_PAIR;
+            accuracy_oracle (i, &in, d, exact);
+
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            {
+                if (!cmd_flags.run_code_version[code_ver])
+                    continue;
+
+                n = call_kernel (info, code_ver, &in, d, out);
+                for (k = 0; k < n; k++)
+                    add_result (&acc[i][code_ver], out[k], exact[k],
+                                is_float);
+            }
+        }
+    }
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            struct accuracy_result_t *res = &acc[i][code_ver];
+
+            if (res->num_results == 0)
+                continue;
+
+            res->fun_id = i;
+            res->array_index = array_index;
+            res->code_ver = code_ver;
+            res->mean_rel_err /= res->num_results;
+            res->mean_ulp /= res->num_results;
+            accuracy_results.push_back (*res);
+        }
+
+    arena_release (&arena);
+}
+
+/* Label of histogram bucket b.  */
+static void
+print_bucket_label (std::ostream &out, unsigned int b)
+{
+    if (b < ACCURACY_ULP_BUCKETS - 1)
+        out << "<=" << accuracy_ulp_bound[b];
+    else
+        out << ">" << accuracy_ulp_bound[ACCURACY_ULP_BUCKETS - 2];
+}
+
+/* One row per function, code version and array size with the errors and
+   the ULP histogram.  */
+void
+print_accuracy_tests (std::ofstream &out_file, struct results_data_t* result,
+                      struct flags_t cmd_flags)
+{
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+    unsigned int b;
+
+    out_file << "Accuracy against a long double oracle with compensated"
+             << " summation, " << cmd_flags.accuracy_trials
+             << " trials of random vectors per array size.\n"
+             << "Errors of the integer functions are in units of 1.\n";
+    out_file << "Function name\tarray size\tresults\tmax rel err\t"
+             << "mean rel err\tmax ULP\tmean ULP\tULP histogram\n"
+             << "\t\t\t\t\t\t\t" << std::defaultfloat
+             << std::setprecision (6);
+    for (b = 0; b < ACCURACY_ULP_BUCKETS; b++)
+    {
+        print_bucket_label (out_file, b);
+        out_file << "\t";
+    }
+    out_file << "\n";
+
+    for (size_t n = 0; n < accuracy_results.size (); n++)
+    {
+        const struct accuracy_result_t *res = &accuracy_results[n];
+
+        out_file << "  " << result[res->fun_id].function_name
+                 << suffix[res->code_ver] << "\t"
+                 << cmd_flags.array_sizes[res->array_index] << "\t"
+                 << res->num_results << "\t" << std::scientific
+                 << std::setprecision (2) << res->max_rel_err << "\t"
+                 << res->mean_rel_err << "\t" << std::fixed
+                 << res->max_ulp << "\t" << res->mean_ulp
+                 << std::defaultfloat << std::setprecision (6);
+        for (b = 0; b < ACCURACY_ULP_BUCKETS; b++)
+            out_file << "\t" << res->ulp_histogram[b];
+        out_file << "\n";
+    }
+    out_file << "\n";
+}
+
+/* Non-finite errors, from NaN results, are written as null.  */
+static void
+write_json_error (std::ofstream &out_file, double err)
+{
+    if (std::isfinite (err))
+        out_file << err;
+    else
+        out_file << "null";
+}
+
+/* The accuracy results are added to the JSON file as records with the
+   number of trials set.  They are not used by --compare.  */
+void
+write_json_accuracy_results (std::ofstream &out_file,
+                             struct results_data_t* result,
+                             struct flags_t cmd_flags, bool *first)
+{
+    unsigned int b;
+
+    for (size_t n = 0; n < accuracy_results.size (); n++)
+    {
+        const struct accuracy_result_t *res = &accuracy_results[n];
+
+        if (!*first)
+            out_file << ",\n";
+        *first = false;
+
+        out_file << "    {\"mode\": \"accuracy\", \"kernel\": ";
+        write_json_string (out_file, result[res->fun_id].function_name);
+        out_file << ", \"version\": \"" << code_version_name (res->code_ver)
+                 << "\", \"dim\": " << cmd_flags.array_sizes[res->array_index]
+                 << ", \"dtype\": \"" << func_dtype_name (res->fun_id)
+                 << "\", \"accuracy_trials\": " << cmd_flags.accuracy_trials
+                 << ", \"num_results\": " << res->num_results
+                 << std::defaultfloat << std::setprecision (6)
+                 << ", \"max_rel_err\": ";
+        write_json_error (out_file, res->max_rel_err);
+        out_file << ", \"mean_rel_err\": ";
+        write_json_error (out_file, res->mean_rel_err);
+        out_file << ", \"max_ulp\": ";
+        write_json_error (out_file, res->max_ulp);
+        out_file << ", \"mean_ulp\": ";
+        write_json_error (out_file, res->mean_ulp);
+        out_file << ", \"ulp_bounds\": [";
+        for (b = 0; b < ACCURACY_ULP_BUCKETS - 1; b++)
+            out_file << (b ? ", " : "") << accuracy_ulp_bound[b];
+        out_file << "], \"ulp_histogram\": [";
+        for (b = 0; b < ACCURACY_ULP_BUCKETS; b++)
+            out_file << (b ? ", " : "") << res->ulp_histogram[b];
+        out_file << "]}";
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_ACCURACY_H
+#define MAIN_ACCURACY_H
+
+#include <fstream>
+#include "main-helpers.h"
+
+/* Seed of the random vectors of the accuracy test, the same inputs are
+   used on every run.  */
+#define ACCURACY_SEED        2718
+
+/* Buckets of the ULP error histogram.  Bucket i counts the results with an
+   error of at most accuracy_ulp_bound[i] units in the last place, the last
+   bucket counts the rest.  */
+#define ACCURACY_ULP_BUCKETS 10
+
+/* Accuracy of one function, code version and array size over all of the
+   trials.  Functions returning several distances per call, the batch_4 and
+   ny_transposed functions, contribute each distance as a result.  */
+struct accuracy_result_t {
+    unsigned int fun_id = 0;
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned long int num_results = 0;
+    double max_rel_err = 0;
+    double mean_rel_err = 0;
+    double max_ulp = 0;
+    double mean_ulp = 0;
+    unsigned long int ulp_histogram[ACCURACY_ULP_BUCKETS] = {0};
+};
+
+void run_accuracy_tests (struct results_data_t* result,
+                         unsigned int array_index, size_t d,
+                         struct flags_t cmd_flags);
+
+void print_accuracy_tests (std::ofstream &out_file,
+                           struct results_data_t* result,
+                           struct flags_t cmd_flags);
+void write_json_accuracy_results (std::ofstream &out_file,
+                                  struct results_data_t* result,
+                                  struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_ACCURACY_H */
@@ -0,0 +1,368 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Cosine distance modes.  cosine_distance_ref computes both norms and the
+   inner product on every call, although a database vector's norm does not
+   change between queries.  With --cosine_modes the cosine distances of the
+   query to a database of COSINE_DB_SIZE vectors are computed per code
+   version with the full function, with inverse norms computed once when the
+   database is set up, with the ny function and with vectors normalized to
+   unit length.  The time per database vector is reported and the distances
+   are checked against the base version of the full function.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include "main-cosine.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+
+static std::vector<struct cosine_result_t> cosine_results;
+
+typedef float (*cosine_inv_norms_fn_t) (const float* x, const float* y,
+                                        size_t d, float inv_norm_x,
+                                        float inv_norm_y);
+typedef void (*cosine_ny_fn_t) (float* dis, const float* x, const float* y,
+                                const float* y_inv_norms, size_t d,
+                                size_t y_stride, size_t ny);
+typedef void (*inv_norms_fn_t) (float* inv_norms, const float* x, size_t d,
+                                size_t x_stride, size_t nx);
+
+/* The cosine functions of one code version.  */
+struct cosine_kernels_t {
+    fvec_pair_fn_t full;
+    cosine_inv_norms_fn_t inv_norms;
+    cosine_ny_fn_t ny;
+    fvec_pair_fn_t normalized;
+    inv_norms_fn_t vec_inv_norms;
+};
+
+static const struct cosine_kernels_t cosine_kernels[NUM_CODE_VERSIONS] = {
+    {base::cosine_distance_ref, base::cosine_distance_inv_norms_ref,
+     base::cosine_distance_ny_ref, base::cosine_distance_normalized_ref,
+     base::fvec_inv_norms_ref},
+    {powerpc::cosine_distance_ref_ppc,
+     powerpc::cosine_distance_inv_norms_ref_ppc,
+     powerpc::cosine_distance_ny_ref_ppc,
+     powerpc::cosine_distance_normalized_ref_ppc,
+     powerpc::fvec_inv_norms_ref_ppc},
+    {powerpc::cosine_distance_ref_ippc,
+     powerpc::cosine_distance_inv_norms_ref_ippc,
+     powerpc::cosine_distance_ny_ref_ippc,
+     powerpc::cosine_distance_normalized_ref_ippc,
+     powerpc::fvec_inv_norms_ref_ippc},
+};
+
+static const char*
+cosine_mode_name (unsigned int mode)
+{
+    switch (mode)
+    {
+    case COSINE_MODE_FULL:
+        return "full";
+    case COSINE_MODE_INV_NORMS:
+        return "inv_norms";
+    case COSINE_MODE_NY:
+        return "ny";
+    case COSINE_MODE_NORMALIZED:
+        return "normalized";
+    }
+    return "unknown";
+}
+
+/* The database and its inverse norms, and unit length copies of the query
+   and the database for the normalized mode.  */
+struct cosine_db_t {
+    const float *x;
+    const float *y;
+    const float *xn;
+    const float *yn;
+    const float *y_inv_norms;
+    size_t d;
+    size_t stride;
+};
+
+/* One pass of the query over the database, the distances go to dis.  */
+static void
+run_cosine_pass (const struct cosine_kernels_t *k, unsigned int mode,
+                 const struct cosine_db_t *db, float *dis)
+{
+    size_t j;
+    float inv_norm_x;
+
+    switch (mode)
+    {
+    case COSINE_MODE_FULL:
+        for (j = 0; j < COSINE_DB_SIZE; j++)
+            dis[j] = k->full (db->x, db->y + j * db->stride, db->d);
+        break;
+
+    case COSINE_MODE_INV_NORMS:
+        /* The query norm is computed once per query.  */
+        k->vec_inv_norms (&inv_norm_x, db->x, db->d, db->stride, 1);
+        for (j = 0; j < COSINE_DB_SIZE; j++)
+            dis[j] = k->inv_norms (db->x, db->y + j * db->stride, db->d,
+                                   inv_norm_x, db->y_inv_norms[j]);
+        break;
+
+    case COSINE_MODE_NY:
+        k->ny (dis, db->x, db->y, db->y_inv_norms, db->d, db->stride,
+               COSINE_DB_SIZE);
+        break;
+
+    case COSINE_MODE_NORMALIZED:
+        for (j = 0; j < COSINE_DB_SIZE; j++)
+            dis[j] = k->normalized (db->xn, db->yn + j * db->stride, db->d);
+        break;
+    }
+}
+
+/* Scale the n vectors of x, stride floats apart, to unit length.  */
+static void
+normalize_vectors (float *x, size_t d, size_t stride, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        float *xi = x + i * stride;
+        double norm = 0;
+
+        for (size_t j = 0; j < d; j++)
+            norm += (double) xi[j] * xi[j];
+        norm = sqrt (norm);
+        for (size_t j = 0; j < d; j++)
+            xi[j] = norm > 0 ? xi[j] / norm : 0;
+    }
+}
+
+void
+run_cosine_tests (struct results_data_t* result, unsigned int array_index,
+                  struct flags_t cmd_flags, const struct test_data_t *data)
+{
+    using namespace std;
+    size_t first = cosine_results.size ();
+    size_t d = data->size;
+    struct arena_t arena;
+    struct cosine_db_t db;
+    float *y, *xn, *yn, *y_inv_norms, *dis, *ref;
+    unsigned long long int t0, t1;
+    unsigned int code_ver, mode, num_runs, run;
+    size_t k, j;
+    int rep;
+
+    if (!cmd_flags.run_func_flag[COSINE_DISTANCE_REF])
+        return;
+
+    /* Passes over the database with about the calls of the cosine test.  */
+    num_runs = result[COSINE_DISTANCE_REF].num_runs[array_index]
+               / COSINE_DB_SIZE;
+    if (num_runs == 0)
+        num_runs = 1;
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        for (mode = 0; mode < COSINE_MODE_MAX; mode++)
+        {
+            struct cosine_result_t res;
+
+            res.array_index = array_index;
+            res.code_ver = code_ver;
+            res.mode = mode;
+            res.num_runs = num_runs;
+            cosine_results.push_back (res);
+        }
+    }
+
+    if (first == cosine_results.size ())
+        return;
+
+    cout << "  Cosine distance modes" << endl;
+
+    /* Random database in [0, 1), the inverse norms are computed once when
+       the database is set up and are not timed.  */
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    y = (float *) arena_alloc_vectors (&arena, COSINE_DB_SIZE, d,
+                                       sizeof (float));
+    xn = (float *) arena_alloc_vectors (&arena, 1, d, sizeof (float));
+    yn = (float *) arena_alloc_vectors (&arena, COSINE_DB_SIZE, d,
+                                        sizeof (float));
+    y_inv_norms = (float *) arena_alloc (&arena,
+                                         COSINE_DB_SIZE * sizeof (float));
+    dis = (float *) arena_alloc (&arena, COSINE_DB_SIZE * sizeof (float));
+    ref = (float *) arena_alloc (&arena, COSINE_DB_SIZE * sizeof (float));
+
+    db.d = d;
+    db.stride = arena_padded_dim (d, sizeof (float));
+
+    mt19937 gen (COSINE_SEED + d);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+
+    for (j = 0; j < COSINE_DB_SIZE; j++)
+        for (k = 0; k < d; k++)
+            y[j * db.stride + k] = value (gen);
+
+    for (k = 0; k < d; k++)
+        xn[k] = data->x[k];
+    for (k = 0; k < COSINE_DB_SIZE * db.stride; k++)
+        yn[k] = y[k];
+    normalize_vectors (xn, d, db.stride, 1);
+    normalize_vectors (yn, d, db.stride, COSINE_DB_SIZE);
+
+    base::fvec_inv_norms_ref (y_inv_norms, y, d, db.stride, COSINE_DB_SIZE);
+
+    db.x = data->x;
+    db.y = y;
+    db.xn = xn;
+    db.yn = yn;
+    db.y_inv_norms = y_inv_norms;
+
+    /* Interleave the versions and modes across the repetitions as in
+       main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < cosine_results.size (); k++)
+        {
+            struct cosine_result_t *res = &cosine_results[k];
+            const struct cosine_kernels_t *kern
+                = &cosine_kernels[res->code_ver];
+
+            t0 = get_time ();
+            for (run = 0; run < res->num_runs; run++)
+                run_cosine_pass (kern, res->mode, &db, dis);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                res->samples.push_back (t1 - t0);
+        }
+
+    /* Check against the base version of the full function.  The distances
+       are in [0, 2], the difference is absolute.  */
+    run_cosine_pass (&cosine_kernels[CODE_VER_ORIG], COSINE_MODE_FULL, &db,
+                     ref);
+
+    for (k = first; k < cosine_results.size (); k++)
+    {
+        struct cosine_result_t *res = &cosine_results[k];
+
+        compute_time_stats (res->samples, &res->stats);
+
+        run_cosine_pass (&cosine_kernels[res->code_ver], res->mode, &db, dis);
+        for (j = 0; j < COSINE_DB_SIZE; j++)
+        {
+            double err = fabs ((double) dis[j] - ref[j]);
+
+            if (!(err <= res->max_err))
+                res->max_err = err;
+        }
+        res->mismatch = !(res->max_err < ERR_THRESHOLD);
+
+        if (res->mismatch)
+            cout << "WARNING, cosine distance "
+                 << code_version_name (res->code_ver) << " version, "
+                 << cosine_mode_name (res->mode) << " mode, array size " << d
+                 << ", differs from the base version by " << res->max_err
+                 << ".\n";
+    }
+
+    arena_release (&arena);
+}
+
+/* Median ns per database vector.  */
+static double
+cosine_ns_per_vector (const struct cosine_result_t *res)
+{
+    return res->stats.median / ((double) res->num_runs * COSINE_DB_SIZE);
+}
+
+/* One row per array size and code version with the ns per database vector
+   of each mode, then the speedup of each mode over the full function.  */
+void
+print_cosine_tests (std::ofstream &out_file, struct results_data_t* result,
+                    struct flags_t cmd_flags)
+{
+    unsigned int mode;
+    size_t n;
+
+    out_file << "Cosine distance modes, median execution time per database"
+             << " vector in ns for a\ndatabase of " << COSINE_DB_SIZE
+             << " vectors and the speedup over the full function.  Results"
+             << "\nthat differ from the base version are marked with !.\n";
+    out_file << "Function name\tarray size\tversion";
+    for (mode = 0; mode < COSINE_MODE_MAX; mode++)
+        out_file << "\t" << cosine_mode_name (mode);
+    out_file << "\tspeedup";
+    for (mode = COSINE_MODE_FULL + 1; mode < COSINE_MODE_MAX; mode++)
+        out_file << "\t" << cosine_mode_name (mode);
+    out_file << "\n";
+
+    /* The modes of an array size and version are consecutive.  */
+    for (n = 0; n + COSINE_MODE_MAX <= cosine_results.size ();
+         n += COSINE_MODE_MAX)
+    {
+        const struct cosine_result_t *row = &cosine_results[n];
+
+        out_file << "  " << result[COSINE_DISTANCE_REF].function_name << "\t"
+                 << cmd_flags.array_sizes[row->array_index] << "\t"
+                 << code_version_name (row->code_ver) << std::fixed
+                 << std::setprecision (2);
+        for (mode = 0; mode < COSINE_MODE_MAX; mode++)
+            out_file << "\t" << cosine_ns_per_vector (&row[mode])
+                     << (row[mode].mismatch ? "!" : "");
+
+        out_file << "\t" << std::setprecision (3);
+        for (mode = COSINE_MODE_FULL + 1; mode < COSINE_MODE_MAX; mode++)
+            out_file << "\t" << row[COSINE_MODE_FULL].stats.median
+                                / row[mode].stats.median;
+        out_file << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_cosine_results (std::ofstream &out_file,
+                           struct results_data_t* result,
+                           struct flags_t cmd_flags, bool *first)
+{
+    for (size_t n = 0; n < cosine_results.size (); n++)
+    {
+        const struct cosine_result_t *res = &cosine_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"cosine_mode\": \"" << cosine_mode_name (res->mode)
+             << "\", \"dim\": " << cmd_flags.array_sizes[res->array_index]
+             << ", \"dtype\": \"float32\", \"db_size\": " << COSINE_DB_SIZE
+             << ", \"num_runs\": " << res->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ns_per_vector\": " << cosine_ns_per_vector (res);
+
+        rec.mode = "cosine";
+        rec.kernel = result[COSINE_DISTANCE_REF].function_name;
+        rec.version = code_version_name (res->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        rec.err_key = "max_abs_err";
+        rec.max_err = res->max_err;
+        rec.checked = true;
+        rec.mismatch = res->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_COSINE_H
+#define MAIN_COSINE_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+#define COSINE_DB_SIZE  64      /* Database vectors per query.  */
+#define COSINE_SEED     314
+
+/* Ways of computing the cosine distances of a query to a database.  */
+enum cosine_mode_id {
+    COSINE_MODE_FULL = 0,       /* cosine_distance_ref per vector.  */
+    COSINE_MODE_INV_NORMS,      /* Precomputed inverse norms per vector.  */
+    COSINE_MODE_NY,             /* cosine_distance_ny_ref over the database.  */
+    COSINE_MODE_NORMALIZED,     /* Unit vectors, 1 - inner product.  */
+    COSINE_MODE_MAX,
+};
+
+/* Time of one array size, code version and mode.  */
+struct cosine_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int mode = 0;
+    unsigned int num_runs = 0;      /* Passes over the database.  */
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base full cosine.  */
+    bool mismatch = false;
+};
+
+void run_cosine_tests (struct results_data_t* result, unsigned int array_index,
+                       struct flags_t cmd_flags,
+                       const struct test_data_t *data);
+
+void print_cosine_tests (std::ofstream &out_file,
+                         struct results_data_t* result,
+                         struct flags_t cmd_flags);
+void write_json_cosine_results (std::ofstream &out_file,
+                                struct results_data_t* result,
+                                struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_COSINE_H */
@@ -0,0 +1,614 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Dataset loaders.  By default the test data is generated by the load_data_*
+   functions in main-helpers.cc.  With --dataset the vectors are read from a
+   SIFT/GIST style fvecs, bvecs or ivecs file or from a NumPy .npy file
+   instead.  The files are memory mapped so large corpora are only paged in
+   as the rows are used.  */
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "main-dataset.h"
+
+#define NPY_MAGIC     "\x93NUMPY"
+#define NPY_MAGIC_LEN 6
+
+/* The fvecs family and .npy files are little endian.  */
+static inline uint32_t
+le32_to_host (uint32_t v)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap32 (v);
+#else
+    return v;
+#endif
+}
+
+static inline uint64_t
+le64_to_host (uint64_t v)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap64 (v);
+#else
+    return v;
+#endif
+}
+
+static inline bool
+host_is_little_endian (void)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return false;
+#else
+    return true;
+#endif
+}
+
+static uint32_t
+read_le32 (const char *p)
+{
+    uint32_t v;
+
+    memcpy (&v, p, sizeof (v));
+    return le32_to_host (v);
+}
+
+static void
+dataset_error (const struct dataset_t *ds, const char *msg)
+{
+    std::cout << "ERROR, dataset " << ds->file_name << ": " << msg
+              << ", exiting.\n";
+    exit (-1);
+}
+
+static int
+dataset_format_from_name (const char *file_name)
+{
+    const char *ext = strrchr (file_name, '.');
+
+    if (ext == NULL)
+        return -1;
+    if (strcmp (ext, ".fvecs") == 0)
+        return DATASET_FVECS;
+    if (strcmp (ext, ".bvecs") == 0)
+        return DATASET_BVECS;
+    if (strcmp (ext, ".ivecs") == 0)
+        return DATASET_IVECS;
+    if (strcmp (ext, ".npy") == 0)
+        return DATASET_NPY;
+    return -1;
+}
+
+static void
+open_vecs (struct dataset_t *ds)
+{
+    size_t row_bytes;
+    uint32_t dim;
+
+    switch (ds->format)
+    {
+    case DATASET_FVECS:
+        ds->dtype = DATASET_FLOAT32;
+        ds->elem_size = sizeof (float);
+        break;
+    case DATASET_BVECS:
+        ds->dtype = DATASET_UINT8;
+        ds->elem_size = sizeof (uint8_t);
+        break;
+    default:
+        ds->dtype = DATASET_INT32;
+        ds->elem_size = sizeof (int32_t);
+        break;
+    }
+
+    if (ds->map_size < sizeof (uint32_t))
+        dataset_error (ds, "file is too short");
+
+    /* Every row repeats the dimension.  Check the first and last rows
+       rather than reading the whole file.  */
+    dim = read_le32 (ds->map);
+    if (dim == 0 || dim > (1U << 24))
+        dataset_error (ds, "invalid vector dimension");
+
+    row_bytes = sizeof (uint32_t) + dim * ds->elem_size;
+    if (ds->map_size % row_bytes != 0)
+        dataset_error (ds, "file size is not a multiple of the row size");
+
+    ds->d = dim;
+    ds->n = ds->map_size / row_bytes;
+    ds->stride = row_bytes;
+    ds->data_offset = sizeof (uint32_t);
+
+    if (read_le32 (ds->map + (ds->n - 1) * row_bytes) != dim)
+        dataset_error (ds, "rows do not all have the same dimension");
+}
+
+/* Find 'key': in the .npy header dictionary and return a pointer to the
+   value.  */
+static const char*
+npy_header_value (const struct dataset_t *ds, const std::string &header,
+                  const char *key)
+{
+    std::string pattern = std::string ("'") + key + "'";
+    size_t pos = header.find (pattern);
+
+    if (pos == std::string::npos)
+        dataset_error (ds, ".npy header is missing a key");
+
+    pos = header.find (':', pos + pattern.size ());
+    if (pos == std::string::npos)
+        dataset_error (ds, "malformed .npy header");
+
+    pos++;
+    while (pos < header.size () && header[pos] == ' ')
+        pos++;
+
+    return header.c_str () + pos;
+}
+
+static void
+open_npy (struct dataset_t *ds)
+{
+    size_t header_len = 0, header_start = 0;
+    unsigned long int shape[2];
+    int num_dims = 0;
+    const char *p;
+    char *end;
+
+    if (ds->map_size < NPY_MAGIC_LEN + 4
+        || memcmp (ds->map, NPY_MAGIC, NPY_MAGIC_LEN) != 0)
+        dataset_error (ds, "not a .npy file");
+
+    /* Version 1 has a 2 byte header length, versions 2 and 3 a 4 byte
+       length.  */
+    if (ds->map[6] == 1)
+    {
+        header_len = (uint8_t) ds->map[8] | ((uint8_t) ds->map[9] << 8);
+        header_start = 10;
+    }
+    else if (ds->map[6] == 2 || ds->map[6] == 3)
+    {
+        if (ds->map_size < 12)
+            dataset_error (ds, "file is too short");
+        header_len = read_le32 (ds->map + 8);
+        header_start = 12;
+    }
+    else
+        dataset_error (ds, "unsupported .npy version");
+
+    if (header_start + header_len > ds->map_size)
+        dataset_error (ds, "file is too short");
+
+    std::string header (ds->map + header_start, header_len);
+
+    /* Element type, only little endian or single byte types.  */
+    p = npy_header_value (ds, header, "descr");
+    if (strncmp (p, "'<f4'", 5) == 0)
+        ds->dtype = DATASET_FLOAT32;
+    else if (strncmp (p, "'|u1'", 5) == 0)
+        ds->dtype = DATASET_UINT8;
+    else if (strncmp (p, "'|i1'", 5) == 0)
+        ds->dtype = DATASET_INT8;
+    else if (strncmp (p, "'<i4'", 5) == 0)
+        ds->dtype = DATASET_INT32;
+    else if (strncmp (p, "'<i8'", 5) == 0)
+        ds->dtype = DATASET_INT64;
+    else
+        dataset_error (ds, "unsupported .npy dtype, expected <f4, |u1, |i1,"
+                       " <i4 or <i8");
+
+    p = npy_header_value (ds, header, "fortran_order");
+    if (strncmp (p, "False", 5) != 0)
+        dataset_error (ds, "Fortran order .npy arrays are not supported");
+
+    /* Shape, (n, d) or (d,) for a single vector.  */
+    p = npy_header_value (ds, header, "shape");
+    if (*p != '(')
+        dataset_error (ds, "malformed .npy shape");
+    p++;
+
+    while (num_dims < 2)
+    {
+        while (*p == ' ')
+            p++;
+        if (*p == ')')
+            break;
+        shape[num_dims++] = strtoul (p, &end, 10);
+        if (end == p)
+            dataset_error (ds, "malformed .npy shape");
+        p = end;
+        while (*p == ' ')
+            p++;
+        if (*p == ',')
+            p++;
+    }
+
+    while (*p == ' ')
+        p++;
+    if (num_dims == 0 || *p != ')')
+        dataset_error (ds, "expected a 1-D or 2-D .npy array");
+
+    if (num_dims == 1)
+    {
+        ds->n = 1;
+        ds->d = shape[0];
+    }
+    else
+    {
+        ds->n = shape[0];
+        ds->d = shape[1];
+    }
+
+    switch (ds->dtype)
+    {
+    case DATASET_UINT8:
+    case DATASET_INT8:
+        ds->elem_size = 1;
+        break;
+    case DATASET_INT64:
+        ds->elem_size = 8;
+        break;
+    default:
+        ds->elem_size = 4;
+        break;
+    }
+
+    ds->stride = ds->d * ds->elem_size;
+    ds->data_offset = header_start + header_len;
+
+    if (ds->n == 0 || ds->d == 0)
+        dataset_error (ds, "empty .npy array");
+
+    if (ds->data_offset + ds->n * ds->stride > ds->map_size)
+        dataset_error (ds, "file is shorter than the .npy shape");
+}
+
+void
+dataset_open (const char *file_name, struct dataset_t *ds)
+{
+    using namespace std;
+    struct stat st;
+    void *map;
+    int fd;
+
+    ds->file_name = file_name;
+    ds->format = dataset_format_from_name (file_name);
+
+    if (ds->format < 0)
+    {
+        cout << "ERROR, unknown dataset format " << file_name
+             << ", expected a .fvecs, .bvecs, .ivecs or .npy file.\n";
+        exit (-1);
+    }
+
+    fd = open (file_name, O_RDONLY);
+    if (fd < 0 || fstat (fd, &st) != 0)
+    {
+        cout << "ERROR, could not open dataset " << file_name
+             << ", exiting.\n";
+        exit (-1);
+    }
+
+    if (st.st_size == 0)
+        dataset_error (ds, "file is empty");
+
+    /* Map the whole file read only, the pages are read in as the rows are
+       used.  The mapping stays valid after the file is closed.  */
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+
+    if (map == MAP_FAILED)
+        dataset_error (ds, "mmap failed");
+
+    ds->map = (const char *) map;
+    ds->map_size = st.st_size;
+
+    if (ds->format == DATASET_NPY)
+        open_npy (ds);
+    else
+        open_vecs (ds);
+}
+
+void
+dataset_close (struct dataset_t *ds)
+{
+    if (ds->map)
+        munmap ((void *) ds->map, ds->map_size);
+    ds->map = NULL;
+    ds->map_size = 0;
+    ds->n = 0;
+}
+
+const char*
+dataset_dtype_name (int dtype)
+{
+    switch (dtype)
+    {
+    case DATASET_FLOAT32:
+        return "float32";
+    case DATASET_UINT8:
+        return "uint8";
+    case DATASET_INT8:
+        return "int8";
+    case DATASET_INT32:
+        return "int32";
+    case DATASET_INT64:
+        return "int64";
+    default:
+        return "unknown";
+    }
+}
+
+const void*
+dataset_row (const struct dataset_t *ds, size_t i)
+{
+    return ds->map + ds->data_offset + i * ds->stride;
+}
+
+/* Convert row i to d floats.  */
+void
+dataset_row_float (const struct dataset_t *ds, size_t i, float *out)
+{
+    const char *row = (const char *) dataset_row (ds, i);
+    size_t j;
+
+    switch (ds->dtype)
+    {
+    case DATASET_FLOAT32:
+        for (j = 0; j < ds->d; j++)
+        {
+            uint32_t v = read_le32 (row + j * sizeof (float));
+            memcpy (&out[j], &v, sizeof (float));
+        }
+        break;
+
+    case DATASET_UINT8:
+        for (j = 0; j < ds->d; j++)
+            out[j] = (float) (uint8_t) row[j];
+        break;
+
+    case DATASET_INT8:
+        for (j = 0; j < ds->d; j++)
+            out[j] = (float) (int8_t) row[j];
+        break;
+
+    case DATASET_INT32:
+        for (j = 0; j < ds->d; j++)
+            out[j] = (float) (int32_t) read_le32 (row + j * sizeof (int32_t));
+        break;
+
+    case DATASET_INT64:
+        for (j = 0; j < ds->d; j++)
+        {
+            uint64_t v;
+            memcpy (&v, row + j * sizeof (int64_t), sizeof (v));
+            out[j] = (float) (int64_t) le64_to_host (v);
+        }
+        break;
+    }
+}
+
+/* Convert row i to d int64 values, used for the ground truth ids.  */
+void
+dataset_row_int64 (const struct dataset_t *ds, size_t i, int64_t *out)
+{
+    const char *row = (const char *) dataset_row (ds, i);
+    size_t j;
+
+    switch (ds->dtype)
+    {
+    case DATASET_INT32:
+        for (j = 0; j < ds->d; j++)
+            out[j] = (int32_t) read_le32 (row + j * sizeof (int32_t));
+        break;
+
+    case DATASET_INT64:
+        for (j = 0; j < ds->d; j++)
+        {
+            uint64_t v;
+            memcpy (&v, row + j * sizeof (int64_t), sizeof (v));
+            out[j] = (int64_t) le64_to_host (v);
+        }
+        break;
+
+    case DATASET_UINT8:
+        for (j = 0; j < ds->d; j++)
+            out[j] = (uint8_t) row[j];
+        break;
+
+    case DATASET_INT8:
+        for (j = 0; j < ds->d; j++)
+            out[j] = (int8_t) row[j];
+        break;
+
+    default:
+        dataset_error (ds, "expected integer ids");
+    }
+}
+
+/* Return up to max_rows rows of the dataset as a float matrix.  A float32
+   .npy file whose rows are suitably aligned is used in place, otherwise the
+   rows are converted into padded rows allocated from the matrix arena.  */
+void
+dataset_float_matrix (const struct dataset_t *ds, size_t max_rows,
+                      struct float_matrix_t *m)
+{
+    size_t i, n;
+    float *buf;
+
+    n = ds->n < max_rows ? ds->n : max_rows;
+    m->n = n;
+    m->d = ds->d;
+    arena_init (&m->arena, ARENA_CHUNK_SIZE, 0);
+
+    if (ds->format == DATASET_NPY && ds->dtype == DATASET_FLOAT32
+        && host_is_little_endian ()
+        && ((uintptr_t) dataset_row (ds, 0)) % DATASET_ROW_ALIGN == 0
+        && ds->stride % DATASET_ROW_ALIGN == 0)
+    {
+        m->data = (const float *) dataset_row (ds, 0);
+        m->stride = ds->d;
+        return;
+    }
+
+    buf = (float *) arena_alloc_vectors (&m->arena, n, ds->d, sizeof (float));
+    m->stride = arena_padded_dim (ds->d, sizeof (float));
+
+    for (i = 0; i < n; i++)
+        dataset_row_float (ds, i, buf + i * m->stride);
+
+    m->data = buf;
+}
+
+void
+release_float_matrix (struct float_matrix_t *m)
+{
+    arena_release (&m->arena);
+    m->data = NULL;
+    m->n = 0;
+}
+
+/* The dataset_load_* functions fill the test arrays of the load_data_*
+   functions with consecutive dataset rows, starting with row first and
+   wrapping around at the end of the dataset.  Only the first d elements of
+   each row are used.  */
+
+static void
+load_rows_float (const struct dataset_t *ds, size_t first, size_t d,
+                 float **rows, int num_rows)
+{
+    float *tmp = (float *) malloc (ds->d * sizeof (float));
+
+    if (!tmp)
+    {
+        std::cout << "ERROR, failed to allocate a dataset row.\n";
+        exit (-1);
+    }
+
+    for (int r = 0; r < num_rows; r++)
+    {
+        dataset_row_float (ds, (first + r) % ds->n, tmp);
+        memcpy (rows[r], tmp, d * sizeof (float));
+    }
+
+    free (tmp);
+}
+
+void
+dataset_load_float (const struct dataset_t *ds, size_t first, size_t d,
+                    float *x, float *y0, float *y1, float *y2, float *y3)
+{
+    float *rows[5] = {x, y0, y1, y2, y3};
+
+    load_rows_float (ds, first, d, rows, 5);
+}
+
+/* The integer functions work on int8_t data.  Byte datasets are used as is,
+   shifted by 128 for uint8, other datasets are scaled so the largest
+   magnitude maps to 127.  */
+void
+dataset_load_int8 (const struct dataset_t *ds, size_t first, size_t d,
+                   int8_t *x, int8_t *y)
+{
+    float *xf = (float *) malloc (d * sizeof (float));
+    float *yf = (float *) malloc (d * sizeof (float));
+    float *rows[2] = {xf, yf};
+    float max_abs = 0, scale = 1, offset = 0;
+    size_t j;
+
+    if (!xf || !yf)
+    {
+        std::cout << "ERROR, failed to allocate the int8 dataset rows.\n";
+        exit (-1);
+    }
+
+    load_rows_float (ds, first, d, rows, 2);
+
+    if (ds->dtype == DATASET_UINT8)
+        offset = -128;
+    else if (ds->dtype != DATASET_INT8)
+    {
+        for (j = 0; j < d; j++)
+            max_abs = fmaxf (max_abs, fmaxf (fabsf (xf[j]), fabsf (yf[j])));
+        if (max_abs > 0)
+            scale = 127 / max_abs;
+    }
+
+    for (j = 0; j < d; j++)
+    {
+        x[j] = (int8_t) lrintf (xf[j] * scale + offset);
+        y[j] = (int8_t) lrintf (yf[j] * scale + offset);
+    }
+
+    free (xf);
+    free (yf);
+}
+
+/* Convert the first d elements of row i to uint8_t for the Hamming and
+   Jaccard functions.  Byte datasets are used as is, shifted by 128 for int8,
+   other datasets are scaled from the [min, max] of the row to [0, 255].  */
+void
+dataset_row_uint8 (const struct dataset_t *ds, size_t i, size_t d,
+                   uint8_t *out)
+{
+    float *row = (float *) malloc (ds->d * sizeof (float));
+    float min_v, max_v, scale = 1, offset = 0;
+    size_t j;
+
+    if (!row)
+    {
+        std::cout << "ERROR, failed to allocate a dataset row.\n";
+        exit (-1);
+    }
+
+    dataset_row_float (ds, i, row);
+
+    if (ds->dtype == DATASET_INT8)
+        offset = 128;
+    else if (ds->dtype != DATASET_UINT8)
+    {
+        min_v = max_v = row[0];
+        for (j = 0; j < d; j++)
+        {
+            min_v = fminf (min_v, row[j]);
+            max_v = fmaxf (max_v, row[j]);
+        }
+        if (max_v > min_v)
+            scale = 255 / (max_v - min_v);
+        offset = -min_v * scale;
+    }
+
+    for (j = 0; j < d; j++)
+        out[j] = (uint8_t) lrintf (row[j] * scale + offset);
+
+    free (row);
+}
+
+void
+dataset_load_char (const struct dataset_t *ds, size_t first, size_t d,
+                   uint8_t *c1, uint8_t *c2)
+{
+    dataset_row_uint8 (ds, first % ds->n, d, c1);
+    dataset_row_uint8 (ds, (first + 1) % ds->n, d, c2);
+}
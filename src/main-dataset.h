@@ -0,0 +1,96 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_DATASET_H
+#define MAIN_DATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include "arena.h"
+
+/* File formats of the datasets.  The fvecs, bvecs and ivecs formats of the
+   SIFT and GIST corpora store each vector as a little endian int32
+   dimension followed by the elements.  A NumPy .npy file holds a 2-D C
+   order array after a text header.  */
+enum dataset_format_id {
+    DATASET_FVECS = 0,
+    DATASET_BVECS,
+    DATASET_IVECS,
+    DATASET_NPY,
+};
+
+/* Type of the dataset elements.  */
+enum dataset_dtype_id {
+    DATASET_FLOAT32 = 0,
+    DATASET_UINT8,
+    DATASET_INT8,
+    DATASET_INT32,
+    DATASET_INT64,
+};
+
+/* A dataset file mapped into memory.  Row i starts data_offset + i * stride
+   bytes from the start of the mapping.  */
+struct dataset_t {
+    const char *file_name = NULL;
+    int format = DATASET_FVECS;
+    int dtype = DATASET_FLOAT32;
+    size_t elem_size = 0;
+    size_t n = 0;                   /* Number of vectors.  */
+    size_t d = 0;                   /* Dimension.  */
+    size_t stride = 0;              /* Bytes between consecutive rows.  */
+    size_t data_offset = 0;         /* Bytes to the first element of row 0.  */
+    const char *map = NULL;
+    size_t map_size = 0;
+};
+
+/* The rows of a dataset as a float matrix.  The rows start on a
+   DATASET_ROW_ALIGN byte boundary since the optimized versions of the
+   functions load the vectors with vector float pointers.  The stride is a
+   multiple of DATASET_ROW_ALIGN bytes and the padding is zero, so the
+   functions can be called with the stride as the dimension.  */
+#define DATASET_ROW_ALIGN ARENA_VEC_BYTES
+
+struct float_matrix_t {
+    const float *data = NULL;
+    size_t n = 0;
+    size_t d = 0;
+    size_t stride = 0;              /* Floats between consecutive rows.  */
+    struct arena_t arena;           /* Rows converted from the dataset.  */
+};
+
+void dataset_open (const char *file_name, struct dataset_t *ds);
+void dataset_close (struct dataset_t *ds);
+const char* dataset_dtype_name (int dtype);
+
+const void* dataset_row (const struct dataset_t *ds, size_t i);
+void dataset_row_float (const struct dataset_t *ds, size_t i, float *out);
+void dataset_row_int64 (const struct dataset_t *ds, size_t i, int64_t *out);
+void dataset_row_uint8 (const struct dataset_t *ds, size_t i, size_t d,
+                        uint8_t *out);
+
+void dataset_float_matrix (const struct dataset_t *ds, size_t max_rows,
+                           struct float_matrix_t *m);
+void release_float_matrix (struct float_matrix_t *m);
+
+void dataset_load_float (const struct dataset_t *ds, size_t first, size_t d,
+                         float *x, float *y0, float *y1, float *y2,
+                         float *y3);
+void dataset_load_int8 (const struct dataset_t *ds, size_t first, size_t d,
+                        int8_t *x, int8_t *y);
+void dataset_load_char (const struct dataset_t *ds, size_t first, size_t d,
+                        uint8_t *c1, uint8_t *c2);
+
+#endif /* MAIN_DATASET_H */
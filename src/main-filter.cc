@@ -0,0 +1,442 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Filtered search.  With --filter_sweep the FILTER_K nearest neighbors of a
+   query are searched among the vectors of a database selected by a filter,
+   for selectivities from 0.1% to 100% of the database.  The database is
+   stored transposed as for fvec_L2sqr_ny_transposed_ref.  The filtered
+   kernels of each code version, with the selection as a bitmap and as a
+   list of ids, are timed against computing all of the distances and
+   testing the bitmap afterwards, to find the selectivity below which
+   filtering in the kernel pays off.  The neighbors are checked against the
+   base version of the post filter.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-filter.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "filter.h"
+#include "knn.h"
+#include "distances/base/filtered_distance.h"
+#include "distances/intrinsic/filtered_distance.h"
+
+/* Percent of the database selected by the filter.  */
+static const double filter_selectivity[] = {0.1, 0.3, 1, 3, 10, 30, 100};
+
+#define FILTER_NUM_LEVELS \
+    (sizeof (filter_selectivity) / sizeof (filter_selectivity[0]))
+
+static std::vector<struct filter_test_result_t> filter_results;
+
+typedef void (*bitmap_fn_t) (float* dis, const float* x, const float* y,
+                             const float* y_sqlen, size_t d, size_t d_offset,
+                             size_t ny, const uint64_t* bitmap);
+typedef void (*ids_fn_t) (float* dis, const float* x, const float* y,
+                          const float* y_sqlen, size_t d, size_t d_offset,
+                          const int64_t* ids, size_t nids);
+
+/* The filter functions of one code version, there is no optimized
+   version.  */
+struct filter_kernels_t {
+    fvec_ny_transposed_fn_t l2_ny;
+    bitmap_fn_t bitmap;
+    ids_fn_t ids;
+};
+
+static const struct filter_kernels_t filter_kernels[NUM_CODE_VERSIONS] = {
+    {base::fvec_L2sqr_ny_transposed_ref,
+     base::fvec_L2sqr_ny_transposed_bitmap_ref,
+     base::fvec_L2sqr_ny_transposed_ids_ref},
+    {NULL, NULL, NULL},
+    {powerpc::fvec_L2sqr_ny_transposed_ref_ippc,
+     powerpc::fvec_L2sqr_ny_transposed_bitmap_ref_ippc,
+     powerpc::fvec_L2sqr_ny_transposed_ids_ref_ippc},
+};
+
+static const char*
+filter_kernel_name (unsigned int kernel)
+{
+    switch (kernel)
+    {
+    case FILTER_POST:
+        return "post";
+    case FILTER_BITMAP:
+        return "bitmap";
+    case FILTER_IDS:
+        return "ids";
+    }
+    return "unknown";
+}
+
+static const char*
+filter_function_name (unsigned int kernel)
+{
+    switch (kernel)
+    {
+    case FILTER_POST:
+        return "fvec_L2sqr_ny_transposed_ref";
+    case FILTER_BITMAP:
+        return "fvec_L2sqr_ny_transposed_bitmap_ref";
+    case FILTER_IDS:
+        return "fvec_L2sqr_ny_transposed_ids_ref";
+    }
+    return "unknown";
+}
+
+/* The query and the database, element j of vector i is y[i + j * ny].  */
+struct filter_db_t {
+    const float *x;
+    const float *y;
+    const float *y_sqlen;
+    float *dis;
+    size_t d;
+    size_t ny;
+};
+
+/* One query against the vectors of the database selected by sel, the
+   nearest ones go to res.  */
+static void
+run_filter_pass (const struct filter_kernels_t *k, unsigned int kernel,
+                 const struct filter_db_t *db,
+                 const struct id_selector_t *sel, struct topk_t *res)
+{
+    size_t i;
+
+    topk_reset (res);
+
+    switch (kernel)
+    {
+    case FILTER_POST:
+        k->l2_ny (db->dis, db->x, db->y, db->y_sqlen, db->d, db->ny, db->ny);
+        for (i = 0; i < db->ny; i++)
+            if (id_selector_is_member (sel, (int64_t) i)
+                && db->dis[i] < topk_threshold (res))
+                topk_push (res, db->dis[i], (int64_t) i);
+        break;
+
+    case FILTER_BITMAP:
+        k->bitmap (db->dis, db->x, db->y, db->y_sqlen, db->d, db->ny,
+                   db->ny, sel->bitmap);
+        for (i = 0; i < sel->nids; i++)
+            if (db->dis[sel->ids[i]] < topk_threshold (res))
+                topk_push (res, db->dis[sel->ids[i]], sel->ids[i]);
+        break;
+
+    case FILTER_IDS:
+        k->ids (db->dis, db->x, db->y, db->y_sqlen, db->d, db->ny, sel->ids,
+                sel->nids);
+        for (i = 0; i < sel->nids; i++)
+            if (db->dis[i] < topk_threshold (res))
+                topk_push (res, db->dis[i], sel->ids[i]);
+        break;
+    }
+}
+
+/* Largest relative difference of the sorted neighbors of res and ref,
+   infinite if they do not have the same ids.  */
+static double
+topk_diff (const struct topk_t *res, const struct topk_t *ref)
+{
+    double max_err = 0;
+
+    if (res->n != ref->n)
+        return HUGE_VAL;
+
+    for (size_t i = 0; i < res->n; i++)
+    {
+        if (res->ids[i] != ref->ids[i])
+            return HUGE_VAL;
+        check_rel_error (&max_err, res->dis[i], ref->dis[i]);
+    }
+    return max_err;
+}
+
+/* Arguments of run_filter_pass while calibrating.  */
+struct filter_calibrate_arg_t {
+    const struct filter_test_result_t *r;
+    const struct filter_db_t *db;
+    const struct id_selector_t *sel;
+    struct topk_t *res;
+};
+
+static void
+filter_calibrate_run (void *arg, unsigned int num_runs)
+{
+    struct filter_calibrate_arg_t *a = (struct filter_calibrate_arg_t *) arg;
+
+    for (unsigned int run = 0; run < num_runs; run++)
+        run_filter_pass (&filter_kernels[a->r->code_ver], a->r->kernel, a->db,
+                         &a->sel[a->r->level], a->res);
+}
+
+void
+run_filter_tests (unsigned int array_index, struct flags_t cmd_flags)
+{
+    using namespace std;
+    size_t first = filter_results.size ();
+    size_t d = cmd_flags.array_sizes[array_index];
+    size_t ny;
+    struct arena_t arena;
+    struct filter_db_t db;
+    struct id_selector_t sel[FILTER_NUM_LEVELS];
+    struct topk_t res, ref;
+    float *x, *y, *y_sqlen;
+    vector<int64_t> perm;
+    unsigned long long int t0, t1;
+    unsigned int code_ver, level, kernel, run;
+    size_t k, i, j;
+    int rep;
+
+    if (!cmd_flags.run_func_flag[FVEC_L2SQR_NY_TRANSPOSED_REF])
+        return;
+
+    /* Keep the database within FILTER_DB_ELEMENTS floats for the large
+       array sizes.  */
+    ny = min ((size_t) FILTER_DB_SIZE,
+              max ((size_t) FILTER_MIN_DB_SIZE, FILTER_DB_ELEMENTS / d));
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver]
+            || filter_kernels[code_ver].bitmap == NULL)
+            continue;
+
+        for (level = 0; level < FILTER_NUM_LEVELS; level++)
+            for (kernel = 0; kernel < FILTER_KERNEL_MAX; kernel++)
+            {
+                struct filter_test_result_t r;
+
+                r.array_index = array_index;
+                r.code_ver = code_ver;
+                r.level = level;
+                r.kernel = kernel;
+                r.db_size = ny;
+                filter_results.push_back (r);
+            }
+    }
+
+    if (first == filter_results.size ())
+        return;
+
+    cout << "  Filtered search" << endl;
+
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    x = (float *) arena_alloc (&arena, d * sizeof (float));
+    y = (float *) arena_alloc (&arena, d * ny * sizeof (float));
+    y_sqlen = (float *) arena_alloc (&arena, ny * sizeof (float));
+    db.dis = (float *) arena_alloc (&arena, ny * sizeof (float));
+
+    mt19937 gen (FILTER_SEED + d);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+
+    for (j = 0; j < d; j++)
+        x[j] = value (gen);
+    for (i = 0; i < ny; i++)
+    {
+        y_sqlen[i] = 0;
+        for (j = 0; j < d; j++)
+        {
+            y[i + j * ny] = value (gen);
+            y_sqlen[i] += y[i + j * ny] * y[i + j * ny];
+        }
+    }
+
+    db.x = x;
+    db.y = y;
+    db.y_sqlen = y_sqlen;
+    db.d = d;
+    db.ny = ny;
+
+    /* The selection of each level is the first vectors of a random
+       permutation of the database, at least one vector.  */
+    perm.resize (ny);
+    for (i = 0; i < ny; i++)
+        perm[i] = (int64_t) i;
+    shuffle (perm.begin (), perm.end (), gen);
+
+    for (level = 0; level < FILTER_NUM_LEVELS; level++)
+    {
+        size_t n = (size_t) (ny * filter_selectivity[level] / 100 + 0.5);
+
+        id_selector_init (&sel[level], ny);
+        for (i = 0; i < max (n, (size_t) 1); i++)
+            id_selector_add (&sel[level], perm[i]);
+        id_selector_finish (&sel[level]);
+    }
+
+    topk_init (&res, FILTER_K);
+    topk_init (&ref, FILTER_K);
+
+    /* Calibrate the number of queries per sample of each version,
+       selectivity and kernel.  */
+    for (k = first; k < filter_results.size (); k++)
+    {
+        struct filter_test_result_t *r = &filter_results[k];
+        struct filter_calibrate_arg_t arg = { r, &db, sel, &res };
+
+        if (cmd_flags.calibrate)
+            r->num_runs = calibrate_runs (filter_calibrate_run, &arg,
+                                          calibrate_target_ns (cmd_flags));
+        else
+            r->num_runs = cmd_flags.num_runs;
+    }
+
+    /* Interleave the versions, selectivities and kernels across the
+       repetitions as in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < filter_results.size (); k++)
+        {
+            struct filter_test_result_t *r = &filter_results[k];
+            const struct filter_kernels_t *kern = &filter_kernels[r->code_ver];
+
+            t0 = get_time ();
+            for (run = 0; run < r->num_runs; run++)
+                run_filter_pass (kern, r->kernel, &db, &sel[r->level], &res);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                r->samples.push_back (t1 - t0);
+        }
+
+    /* Check the neighbors against the base version of the post filter.  */
+    for (k = first; k < filter_results.size (); k++)
+    {
+        struct filter_test_result_t *r = &filter_results[k];
+
+        compute_time_stats (r->samples, &r->stats);
+        r->selected = sel[r->level].nids;
+
+        run_filter_pass (&filter_kernels[CODE_VER_ORIG], FILTER_POST, &db,
+                         &sel[r->level], &ref);
+        run_filter_pass (&filter_kernels[r->code_ver], r->kernel, &db,
+                         &sel[r->level], &res);
+        topk_sort (&ref);
+        topk_sort (&res);
+        r->max_err = topk_diff (&res, &ref);
+        r->mismatch = !(r->max_err < ERR_THRESHOLD);
+
+        if (r->mismatch)
+            cout << "WARNING, filtered search "
+                 << filter_kernel_name (r->kernel) << " kernel "
+                 << code_version_name (r->code_ver)
+                 << " version, array size " << d << ", selectivity "
+                 << filter_selectivity[r->level]
+                 << "%, differs from the base version by " << r->max_err
+                 << ".\n";
+    }
+
+    for (level = 0; level < FILTER_NUM_LEVELS; level++)
+        id_selector_release (&sel[level]);
+    topk_release (&res);
+    topk_release (&ref);
+    arena_release (&arena);
+}
+
+/* Median ns per database vector, selected or not.  */
+static double
+filter_ns_per_vector (const struct filter_test_result_t *r)
+{
+    return r->stats.median / ((double) r->num_runs * r->db_size);
+}
+
+/* One row per array size, code version and selectivity with the ns per
+   database vector of each kernel and the speedup of the filtered kernels
+   over the post filter.  */
+void
+print_filter_tests (std::ofstream &out_file, struct flags_t cmd_flags)
+{
+    unsigned int kernel;
+    size_t n;
+
+    out_file << "Filtered search, median execution time per database vector"
+             << " in ns of a " << FILTER_K << "-NN search\nof the vectors"
+             << " selected by a filter, and the speedup of filtering in the"
+             << " kernel\nwith a bitmap and a list of ids over computing all"
+             << " of the distances and\ntesting the bitmap afterwards."
+             << "  Results that differ from the base version\nare marked"
+             << " with !.\n";
+    out_file << "Array size\tversion\tdb size\tselect %";
+    for (kernel = 0; kernel < FILTER_KERNEL_MAX; kernel++)
+        out_file << "\t" << filter_kernel_name (kernel);
+    out_file << "\tbitmap speedup\tids speedup\n";
+
+    /* The kernels of an array size, version and selectivity are
+       consecutive.  */
+    for (n = 0; n + FILTER_KERNEL_MAX <= filter_results.size ();
+         n += FILTER_KERNEL_MAX)
+    {
+        const struct filter_test_result_t *row = &filter_results[n];
+
+        out_file << "  " << cmd_flags.array_sizes[row->array_index] << "\t"
+                 << code_version_name (row->code_ver) << "\t"
+                 << row->db_size << "\t"
+                 << std::defaultfloat << filter_selectivity[row->level]
+                 << std::fixed
+                 << std::setprecision (2);
+        for (kernel = 0; kernel < FILTER_KERNEL_MAX; kernel++)
+            out_file << "\t" << filter_ns_per_vector (&row[kernel])
+                     << (row[kernel].mismatch ? "!" : "");
+
+        out_file << "\t" << std::setprecision (3)
+                 << filter_ns_per_vector (&row[FILTER_POST])
+                    / filter_ns_per_vector (&row[FILTER_BITMAP])
+                 << "\t"
+                 << filter_ns_per_vector (&row[FILTER_POST])
+                    / filter_ns_per_vector (&row[FILTER_IDS])
+                 << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_filter_results (std::ofstream &out_file, struct flags_t cmd_flags,
+                           bool *first)
+{
+    for (size_t n = 0; n < filter_results.size (); n++)
+    {
+        const struct filter_test_result_t *r = &filter_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"filter_kernel\": \"" << filter_kernel_name (r->kernel)
+             << "\", \"filter_selectivity\": " << filter_selectivity[r->level]
+             << ", \"dim\": " << cmd_flags.array_sizes[r->array_index]
+             << ", \"dtype\": \"float32\", \"db_size\": " << r->db_size
+             << ", \"selected\": " << r->selected
+             << ", \"k\": " << FILTER_K
+             << ", \"num_runs\": " << r->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ns_per_vector\": " << filter_ns_per_vector (r);
+
+        rec.mode = "filter_sweep";
+        rec.kernel = filter_function_name (r->kernel);
+        rec.version = code_version_name (r->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &r->stats;
+        rec.samples = &r->samples;
+        rec.err_key = "max_err";
+        rec.max_err = r->max_err;
+        rec.checked = true;
+        rec.mismatch = r->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
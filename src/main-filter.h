@@ -0,0 +1,59 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_FILTER_H
+#define MAIN_FILTER_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+#define FILTER_DB_SIZE      16384       /* Most database vectors.  */
+#define FILTER_DB_ELEMENTS  (1 << 22)   /* Most database floats.  */
+#define FILTER_MIN_DB_SIZE  1024
+#define FILTER_K            10          /* Nearest neighbors per query.  */
+#define FILTER_SEED         601
+
+/* Kernels timed per array size, code version and selectivity.  */
+enum filter_kernel_id {
+    FILTER_POST = 0,            /* All distances, then test the bitmap.  */
+    FILTER_BITMAP,              /* fvec_L2sqr_ny_transposed_bitmap.  */
+    FILTER_IDS,                 /* fvec_L2sqr_ny_transposed_ids.  */
+    FILTER_KERNEL_MAX,
+};
+
+/* Time of one array size, code version, selectivity and kernel.  */
+struct filter_test_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int level = 0;         /* Index in the selectivity sweep.  */
+    unsigned int kernel = 0;
+    unsigned int num_runs = 0;      /* Queries per timed sample.  */
+    size_t db_size = 0;
+    size_t selected = 0;            /* Vectors passing the filter.  */
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base post filter.  */
+    bool mismatch = false;
+};
+
+void run_filter_tests (unsigned int array_index, struct flags_t cmd_flags);
+
+void print_filter_tests (std::ofstream &out_file, struct flags_t cmd_flags);
+void write_json_filter_results (std::ofstream &out_file,
+                                struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_FILTER_H */
@@ -0,0 +1,269 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Fixed dimension benchmark.  With --fixed_dim, the functions that have a
+   fixed dimension instance for the array size, see
+   distances/fixed_dim/fixed_dim.h, are timed against the generic code
+   versions.  All of the versions are called through a function pointer, as
+   a caller using the dispatcher would, so the difference is the cost of
+   the loop control and the tail of the generic versions.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include "main-fixed-dim.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "distances/fixed_dim/fixed_dim.h"
+
+static std::vector<struct fixed_dim_result_t> fixed_dim_results;
+
+/* The fixed dimension instance of function fun_id for dimension d, NULL if
+   there is none.  */
+static fvec_pair_fn_t
+fixed_dim_kernel (unsigned int fun_id, size_t d)
+{
+    switch (fun_id)
+    {
+    case FVEC_L2SQR_REF:
+        return powerpc::fvec_L2sqr_fixed_dim (d);
+    case FVEC_INNER_PRODUCT_REF:
+        return powerpc::fvec_inner_product_fixed_dim (d);
+    case FVEC_L1_REF:
+        return powerpc::fvec_L1_fixed_dim (d);
+    }
+    return NULL;
+}
+
+static fvec_pair_fn_t
+fixed_dim_version_fn (const struct fixed_dim_result_t *res, size_t d)
+{
+    if (res->version == FIXED_DIM_VER)
+        return fixed_dim_kernel (res->fun_id, d);
+
+    return get_kernel_info (res->fun_id)->fvec_pair[res->version];
+}
+
+static float
+run_fixed_dim_kernel (fvec_pair_fn_t fn, const float *x, const float *y,
+                      size_t d, unsigned int num_runs)
+{
+    float result = 0;
+
+    for (unsigned int i = 0; i < num_runs; i++)
+        result += fn (x, y, d);
+    return result;
+}
+
+static const char*
+fixed_dim_version_name (unsigned int version)
+{
+    return version == FIXED_DIM_VER ? "fixed_dim" : code_version_name (version);
+}
+
+/* Time the generic versions and the fixed dimension instance of each
+   selected function with one for the array size.  The number of runs is
+   the one used for the generic tests.  */
+void
+run_fixed_dim_tests (struct results_data_t* result, unsigned int array_index,
+                     struct flags_t cmd_flags, const struct test_data_t *data)
+{
+    using namespace std;
+    size_t first = fixed_dim_results.size ();
+    size_t d = data->size;
+    unsigned long long int t0, t1;
+    unsigned int i, version;
+    size_t k;
+    int rep;
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+    {
+        if (!cmd_flags.run_func_flag[i] || !fixed_dim_kernel (i, d))
+            continue;
+
+        for (version = 0; version <= FIXED_DIM_VER; version++)
+        {
+            struct fixed_dim_result_t res;
+
+            if (version < NUM_CODE_VERSIONS
+                && !cmd_flags.run_code_version[version])
+                continue;
+
+            res.fun_id = i;
+            res.array_index = array_index;
+            res.version = version;
+            res.num_runs = result[i].num_runs[array_index];
+            fixed_dim_results.push_back (res);
+        }
+    }
+
+    if (first == fixed_dim_results.size ())
+        return;
+
+    cout << "  Fixed dimension kernels" << endl;
+
+    /* Interleave the versions across the repetitions as in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < fixed_dim_results.size (); k++)
+        {
+            struct fixed_dim_result_t *res = &fixed_dim_results[k];
+            fvec_pair_fn_t fn = fixed_dim_version_fn (res, d);
+
+            t0 = get_time ();
+            run_fixed_dim_kernel (fn, data->x, data->y0, d, res->num_runs);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                res->samples.push_back (t1 - t0);
+        }
+
+    /* The base version is the first of each function.  */
+    for (k = first; k < fixed_dim_results.size (); k++)
+    {
+        struct fixed_dim_result_t *res = &fixed_dim_results[k];
+        const struct fixed_dim_result_t *ref = &fixed_dim_results[k];
+        double diff;
+
+        while (ref->version != CODE_VER_ORIG)
+            ref--;
+
+        compute_time_stats (res->samples, &res->stats);
+        res->result = fixed_dim_version_fn (res, d) (data->x, data->y0, d);
+
+        /* Relative difference as in print_results_check_flt.  */
+        diff = fabs ((double) res->result - ref->result);
+        if (ref->result != 0)
+            diff /= fabs (ref->result);
+        res->mismatch = !(diff < ERR_THRESHOLD);
+
+        if (res->mismatch)
+            cout << "WARNING, " << result[res->fun_id].function_name << " "
+                 << fixed_dim_version_name (res->version)
+                 << " version, array size " << d
+                 << ", differs from the base version.\n";
+    }
+}
+
+/* ns per call of res, 0 if not run.  */
+static double
+fixed_dim_ns_per_call (const struct fixed_dim_result_t *res)
+{
+    return res->num_runs ? res->stats.median / res->num_runs : 0;
+}
+
+/* One row per function and array size with the median ns per call of each
+   version, then the speedup of the fixed dimension instance over each
+   generic version.  Versions that were not run are marked with -.  */
+void
+print_fixed_dim_tests (std::ofstream &out_file, struct results_data_t* result,
+                       struct flags_t cmd_flags)
+{
+    const struct fixed_dim_result_t *row[FIXED_DIM_VER + 1];
+    unsigned int version;
+    size_t n, m;
+
+    out_file << "Fixed dimension kernels, median execution time per call in"
+             << " ns and the speedup of the\nfixed dimension instance over"
+             << " the generic versions.  Results that differ from\nthe base"
+             << " version are marked with !.\n";
+    out_file << "Function name\tarray size\t";
+    for (version = 0; version <= FIXED_DIM_VER; version++)
+        out_file << fixed_dim_version_name (version) << "\t";
+    out_file << "speedup over";
+    for (version = 0; version < FIXED_DIM_VER; version++)
+        out_file << "\t" << fixed_dim_version_name (version);
+    out_file << "\n";
+
+    for (n = 0; n < fixed_dim_results.size (); n = m)
+    {
+        const struct fixed_dim_result_t *fixed;
+
+        for (version = 0; version <= FIXED_DIM_VER; version++)
+            row[version] = NULL;
+
+        for (m = n; m < fixed_dim_results.size ()
+                 && fixed_dim_results[m].fun_id == fixed_dim_results[n].fun_id
+                 && fixed_dim_results[m].array_index
+                    == fixed_dim_results[n].array_index; m++)
+            row[fixed_dim_results[m].version] = &fixed_dim_results[m];
+
+        fixed = row[FIXED_DIM_VER];
+        out_file << "  " << result[fixed->fun_id].function_name << "\t"
+                 << cmd_flags.array_sizes[fixed->array_index] << std::fixed
+                 << std::setprecision (2);
+
+        for (version = 0; version <= FIXED_DIM_VER; version++)
+        {
+            out_file << "\t";
+            if (row[version])
+                out_file << fixed_dim_ns_per_call (row[version])
+                         << (row[version]->mismatch ? "!" : "");
+            else
+                out_file << "-";
+        }
+
+        out_file << "\t" << std::setprecision (3);
+        for (version = 0; version < FIXED_DIM_VER; version++)
+        {
+            double fixed_ns = fixed_dim_ns_per_call (fixed);
+
+            out_file << "\t";
+            if (row[version] && fixed_ns > 0)
+                out_file << fixed_dim_ns_per_call (row[version]) / fixed_ns;
+            else
+                out_file << "-";
+        }
+        out_file << std::defaultfloat << "\n";
+    }
+    out_file << "\n";
+}
+
+/* The fixed dimension instances are added to the JSON file as records with
+   the version fixed_dim.  The generic versions are already there.  */
+void
+write_json_fixed_dim_results (std::ofstream &out_file,
+                              struct results_data_t* result,
+                              struct flags_t cmd_flags, bool *first)
+{
+    for (size_t n = 0; n < fixed_dim_results.size (); n++)
+    {
+        const struct fixed_dim_result_t *res = &fixed_dim_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        if (res->version != FIXED_DIM_VER)
+            continue;
+
+        keys << ", \"dim\": " << cmd_flags.array_sizes[res->array_index]
+             << ", \"dtype\": \"" << func_dtype_name (res->fun_id)
+             << "\", \"threads\": 1, \"working_set\": \"none\""
+             << ", \"num_runs\": " << res->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ns_per_call\": " << fixed_dim_ns_per_call (res);
+
+        rec.mode = "fixed_dim";
+        rec.kernel = result[res->fun_id].function_name;
+        rec.version = fixed_dim_version_name (res->version);
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        rec.checked = true;
+        rec.mismatch = res->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_FIXED_DIM_H
+#define MAIN_FIXED_DIM_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+/* Version index of the fixed dimension instance in fixed_dim_result_t, the
+   generic versions are the code versions.  */
+#define FIXED_DIM_VER  NUM_CODE_VERSIONS
+
+/* Time of one function, version and array size called through a function
+   pointer.  */
+struct fixed_dim_result_t {
+    unsigned int fun_id = 0;
+    unsigned int array_index = 0;
+    unsigned int version = 0;       /* Code version or FIXED_DIM_VER.  */
+    unsigned int num_runs = 0;
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    float result = 0;
+    bool mismatch = false;          /* Differs from the base version.  */
+};
+
+void run_fixed_dim_tests (struct results_data_t* result,
+                          unsigned int array_index, struct flags_t cmd_flags,
+                          const struct test_data_t *data);
+
+void print_fixed_dim_tests (std::ofstream &out_file,
+                            struct results_data_t* result,
+                            struct flags_t cmd_flags);
+void write_json_fixed_dim_results (std::ofstream &out_file,
+                                   struct results_data_t* result,
+                                   struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_FIXED_DIM_H */
@@ -0,0 +1,593 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Differential fuzzer.  Each fuzz input picks a function, a dimension, the
+   offsets of the input arrays, a distribution of the float values, the
+   special values (NaN, infinity, denormals) mixed in and a seed for the
+   values.  Every code version of the function in the kernel table is
+   called on the inputs and must agree with the base version: exactly for
+   the integer functions, within a bound on the rounding error of the sums
+   for the float functions, and NaN and infinite results must match.  The
+   input arrays are allocated at their exact size, so reads past the end of
+   the vectors are caught by the address sanitizer of the libFuzzer build
+   and usually give a mismatch otherwise.  fvec_madd_and_argmin_ref, which
+   is not in the kernel table, is checked on each input as well.
+
+   --fuzz <n> runs n random inputs from FUZZ_SEED.  make fuzz builds
+   bin/fuzz with clang's libFuzzer, whose LLVMFuzzerTestOneInput aborts on
+   the first mismatch so libFuzzer saves the input.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <cfloat>
+#include <random>
+#include <vector>
+#include "main-fuzz.h"
+#include "main-kernels.h"
+#include "main-output.h"
+#include "distances/base/manhattan_l1_distance.h"
+#include "distances/intrinsic/manhattan_l1_distance.h"
+
+/* Calls, skipped comparisons and mismatches of each function and code
+   version.  */
+struct fuzz_stats_t {
+    unsigned long int calls = 0;
+    unsigned long int skipped = 0;
+    unsigned long int mismatches = 0;
+};
+
+static struct fuzz_stats_t fuzz_stats[FUNC_ID_MAX][NUM_CODE_VERSIONS];
+
+/* fvec_madd_and_argmin_ref returns an index and writes an array, so it is
+   not in the kernel table and has its own counts.  */
+static struct fuzz_stats_t argmin_stats[NUM_CODE_VERSIONS];
+
+/* One decoded fuzz input.  */
+struct fuzz_case_t {
+    unsigned int fun_id;
+    size_t d;
+    unsigned int flt_offset;        /* Floats.  */
+    unsigned int byte_offset;       /* Bytes, int8_t and uint8_t inputs.  */
+    unsigned int dist;              /* enum fuzz_dist_id  */
+    unsigned int special;           /* FUZZ_SPECIAL_* bits.  */
+    unsigned int special_rate;      /* One in 2^special_rate values.  */
+    uint32_t seed;
+};
+
+/* The fuzz input layout, byte:
+     0     function, modulo the number of selected functions
+     1-2   dimension, the high bit of byte 2 selects a small dimension
+     3     float offset in bits 0-1, byte offset in bits 2-5
+     4     value distribution, modulo FUZZ_DIST_MAX
+     5     special values in bits 0-2, their rate in bits 3-5
+     6-9   seed of the values
+   Returns false if no function is selected.  */
+static bool
+decode_fuzz_input (const uint8_t *data, size_t size,
+                   const struct flags_t *cmd_flags, struct fuzz_case_t *fc)
+{
+    uint8_t in[FUZZ_INPUT_SIZE] = {0};
+    unsigned int i, num_funcs = 0, pick;
+
+    for (i = 0; i < FUZZ_INPUT_SIZE && i < size; i++)
+        in[i] = data[i];
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+        if (cmd_flags->run_func_flag[i])
+            num_funcs++;
+    if (num_funcs == 0)
+        return false;
+
+    pick = in[0] % num_funcs;
+    for (i = 0; i < FUNC_ID_MAX; i++)
+        if (cmd_flags->run_func_flag[i] && pick-- == 0)
+            break;
+    fc->fun_id = i;
+
+    if (in[2] & 0x80)
+        fc->d = in[1] % (FUZZ_SMALL_DIM + 1);
+    else
+        fc->d = ((in[2] << 8) | in[1]) % (FUZZ_MAX_DIM + 1);
+
+    fc->flt_offset = in[3] & 0x3;
+    fc->byte_offset = (in[3] >> 2) & 0xf;
+    fc->dist = in[4] % FUZZ_DIST_MAX;
+    fc->special = in[5] & 0x7;
+    fc->special_rate = 1 + ((in[5] >> 3) & 0x7);
+    fc->seed = in[6] | (in[7] << 8) | (in[8] << 16)
+        | ((uint32_t) in[9] << 24);
+    return true;
+}
+
+static const char*
+fuzz_dist_name (unsigned int dist)
+{
+    switch (dist)
+    {
+    case FUZZ_DIST_UNIT: return "unit";
+    case FUZZ_DIST_SIGNED: return "signed";
+    case FUZZ_DIST_LARGE: return "large";
+    case FUZZ_DIST_TINY: return "tiny";
+    case FUZZ_DIST_EXPONENT: return "exponent";
+    case FUZZ_DIST_INTEGER: return "integer";
+    }
+    return "unknown";
+}
+
+static float
+fuzz_value (const struct fuzz_case_t *fc, std::mt19937 &gen)
+{
+    std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+    float sign = (gen () & 1) ? -1.0f : 1.0f;
+
+    if (fc->special && gen () % (1U << fc->special_rate) == 0)
+    {
+        /* Pick one of the selected special values.  */
+        unsigned int kind;
+
+        do
+            kind = 1U << (gen () % 3);
+        while (!(fc->special & kind));
+
+        if (kind == FUZZ_SPECIAL_NAN)
+            return NAN;
+        if (kind == FUZZ_SPECIAL_INF)
+            return sign * INFINITY;
+        return sign * unit (gen) * FLT_MIN;
+    }
+
+    switch (fc->dist)
+    {
+    case FUZZ_DIST_SIGNED:
+        return 2 * unit (gen) - 1;
+    case FUZZ_DIST_LARGE:
+        return (2 * unit (gen) - 1) * 1e15f;
+    case FUZZ_DIST_TINY:
+        return (2 * unit (gen) - 1) * 1e-20f;
+    case FUZZ_DIST_EXPONENT:
+        return sign * ldexpf (1 + unit (gen), (int) (gen () % 41) - 20);
+    case FUZZ_DIST_INTEGER:
+        return (float) ((int) (gen () % 17) - 8);
+    }
+    return unit (gen);
+}
+
+/* Bounds on the sums of the functions, computed in double.  */
+static double
+sum_abs_prod (const float *x, const float *y, size_t d, size_t y_stride)
+{
+    double sum = 0;
+
+    for (size_t i = 0; i < d; i++)
+        sum += fabs ((double) x[i] * y[i * y_stride]);
+    return sum;
+}
+
+static double
+sum_sq_diff (const float *x, const float *y, size_t d)
+{
+    double sum = 0;
+
+    for (size_t i = 0; i < d; i++)
+        sum += ((double) x[i] - y[i]) * ((double) x[i] - y[i]);
+    return sum;
+}
+
+static double
+sum_abs_diff (const float *x, const float *y, size_t d)
+{
+    double sum = 0;
+
+    for (size_t i = 0; i < d; i++)
+        sum += fabs ((double) x[i] - y[i]);
+    return sum;
+}
+
+/* Largest difference allowed between two versions of result k of fun_id.
+   The error of a float sum of n terms is bounded by about n * FLT_EPSILON
+   / 2 times the sum of the absolute values of the terms, so two versions
+   summing in different orders differ by at most twice that.  Denormal
+   products add up to FLT_TRUE_MIN each.  Returns false if the result is
+   not defined well enough in float to compare, for example if an
+   intermediate value overflows in one version and not in another.  An
+   infinite tolerance only compares NaN and infinite results.  */
+static bool
+fuzz_tolerance (unsigned int fun_id, unsigned int k,
+                const struct kernel_inputs_t *in, size_t d, bool has_nan,
+                double *tol)
+{
+    double mag, nx, ny, num = 0, den = 0, abs_num = 0, abs_den = 0;
+    double n = FUZZ_TOLERANCE * (d + FUZZ_EXTRA_OPS);
+
+    switch (fun_id)
+    {
+    case IVEC_L2SQR_REF:
+    case IVEC_INNER_PRODUCT_REF:
+    case HAMMING_DISTANCE_REF:
+        *tol = 0;
+        return true;
+
+    case FVEC_L2SQR_REF:
+    case FVEC_L2SQR_BATCH_4_REF:
+        mag = sum_sq_diff (in->x, in->y[k], d);
+        break;
+
+    case FVEC_NORM_L2SQR_REF:
+        mag = sum_abs_prod (in->x, in->x, d, 1);
+        break;
+
+    case FVEC_L2SQR_NY_TRANSPOSED_REF:
+        mag = sum_abs_prod (in->x, in->x, d, 1) + fabs (in->y_sqlen[k])
+            + 2 * sum_abs_prod (in->x, in->yt + k, d, NY_DISTANCE);
+        break;
+
+    case FVEC_INNER_PRODUCT_REF:
+    case FVEC_INNER_PRODUCT_BATCH_4_REF:
+        mag = sum_abs_prod (in->x, in->y[k], d, 1);
+        break;
+
+    case FVEC_L1_REF:
+        mag = sum_abs_diff (in->x, in->y[0], d);
+        break;
+
+    case COSINE_DISTANCE_REF:
+        /* The product of the squared lengths is a float intermediate.  */
+        nx = sum_abs_prod (in->x, in->x, d, 1);
+        ny = sum_abs_prod (in->y[0], in->y[0], d, 1);
+        if (nx * ny == 0 || !std::isfinite (nx * ny))
+        {
+            *tol = INFINITY;
+            return true;
+        }
+        if (nx * ny < FLT_MIN || nx * ny > FLT_MAX)
+            return false;
+        mag = 1 + sum_abs_prod (in->x, in->y[0], d, 1) / sqrt (nx * ny);
+        break;
+
+    case JACCARD_DISTANCE_REF:
+        /* fmin and fmax drop NaNs, the vector min and max need not.  */
+        if (has_nan)
+            return false;
+        for (size_t i = 0; i < d; i++)
+        {
+            double lo = fmin (in->x[i], in->y[0][i]);
+            double hi = fmax (in->x[i], in->y[0][i]);
+
+            num += lo;
+            den += hi;
+            abs_num += fabs (lo);
+            abs_den += fabs (hi);
+        }
+        if (den == 0)
+        {
+            *tol = INFINITY;
+            return true;
+        }
+        mag = (abs_num + abs_den * fabs (num / den)) / fabs (den);
+        break;
+
+    default:
+        return false;
+    }
+
+    /* Infinite and NaN inputs.  */
+    if (!std::isfinite (mag))
+    {
+        *tol = INFINITY;
+        return true;
+    }
+    if (mag > FLT_MAX / 2)
+        return false;
+
+    *tol = n * (FLT_EPSILON * mag + FLT_TRUE_MIN);
+    return true;
+}
+
+static bool
+results_agree (double base, double run, double tol)
+{
+    if (std::isnan (base) || std::isnan (run))
+        return std::isnan (base) && std::isnan (run);
+    if (std::isinf (base) || std::isinf (run))
+        return base == run;
+    return std::isinf (tol) || fabs (base - run) <= tol;
+}
+
+static void
+print_fuzz_mismatch (struct results_data_t* result,
+                     const struct fuzz_case_t *fc, unsigned int code_ver,
+                     unsigned int k, double base, double run, double tol,
+                     const uint8_t *data, size_t size)
+{
+    using namespace std;
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+
+    cout << "WARNING, fuzz mismatch, " << result[fc->fun_id].function_name
+         << suffix[code_ver] << " result " << k << " is "
+         << setprecision (9) << run << ", the base version gives " << base
+         << ", tolerance " << tol << setprecision (6) << ".\n"
+         << "  d " << fc->d << ", float offset " << fc->flt_offset
+         << ", byte offset " << fc->byte_offset << ", "
+         << fuzz_dist_name (fc->dist) << " values, specials "
+         << fc->special << " one in " << (1U << fc->special_rate)
+         << ", seed " << fc->seed << ", input";
+    for (size_t i = 0; i < size && i < FUZZ_INPUT_SIZE; i++)
+        cout << " " << hex << setw (2) << setfill ('0') << (int) data[i];
+    cout << dec << setfill (' ') << endl;
+}
+
+/* Check fvec_madd_and_argmin_ref on the dimension, float offset and seed
+   of a fuzz input.  The values are small integers, so c is exact whether
+   or not the multiply-add is fused and the minimum is usually repeated.
+   A copy of the first minimum is also put in the last element, in the
+   scalar tail when d is not a multiple of 4.  The index of the first
+   minimum and all of c must match the base version.  Returns the number
+   of mismatches.  */
+static int
+fuzz_madd_and_argmin (const struct fuzz_case_t *fc,
+                      const struct flags_t *cmd_flags, int *reports)
+{
+    using namespace std;
+    size_t d = fc->d, i, bad_i;
+    vector<float> a (fc->flt_offset + d), b (fc->flt_offset + d);
+    vector<float> c_base (d), c (d);
+    float *pa = a.data () + fc->flt_offset, *pb = b.data () + fc->flt_offset;
+    mt19937 gen (fc->seed);
+    uniform_int_distribution<int> value (-8, 8);
+    float bf = (float) value (gen);
+    int i_base, i_min;
+
+    if (!cmd_flags->run_code_version[CODE_INTRINSIC_PPC])
+        return 0;
+
+    for (i = 0; i < d; i++)
+    {
+        pa[i] = (float) value (gen);
+        pb[i] = (float) value (gen);
+    }
+
+    if (d > 1)
+    {
+        i_base = base::fvec_madd_and_argmin_ref (d, pa, bf, pb,
+                                                 c_base.data ());
+        pa[d - 1] = pa[i_base];
+        pb[d - 1] = pb[i_base];
+    }
+
+    i_base = base::fvec_madd_and_argmin_ref (d, pa, bf, pb, c_base.data ());
+    i_min = powerpc::fvec_madd_and_argmin_ref_ippc (d, pa, bf, pb,
+                                                    c.data ());
+    argmin_stats[CODE_INTRINSIC_PPC].calls++;
+
+    for (bad_i = 0; bad_i < d && c[bad_i] == c_base[bad_i]; bad_i++)
+        ;
+    if (i_min == i_base && bad_i == d)
+        return 0;
+
+    argmin_stats[CODE_INTRINSIC_PPC].mismatches++;
+    if (*reports > 0)
+    {
+        cout << "WARNING, fuzz mismatch, fvec_madd_and_argmin_ref"
+             << PPC_INTRINSIC_SUFFIX << ", d " << d << ", float offset "
+             << fc->flt_offset << ", seed " << fc->seed << ": index "
+             << i_min << ", base index " << i_base;
+        if (bad_i < d)
+            cout << ", c[" << bad_i << "] " << c[bad_i] << ", base "
+                 << c_base[bad_i];
+        cout << endl;
+        (*reports)--;
+    }
+    return 1;
+}
+
+/* Run one fuzz input, returns the number of mismatches.  reports is the
+   number of mismatches still to be printed.  */
+static int
+fuzz_one_input (const uint8_t *data, size_t size,
+                struct results_data_t* result,
+                const struct flags_t *cmd_flags, int *reports)
+{
+    using namespace std;
+    struct fuzz_case_t fc;
+    struct kernel_inputs_t in;
+    const struct kernel_info_t *info;
+    double base_out[NY_DISTANCE], out[NY_DISTANCE], tol;
+    unsigned int code_ver, k, n_base, n;
+    int mismatches = 0;
+    bool has_nan = false;
+    size_t i, d;
+
+    if (!decode_fuzz_input (data, size, cmd_flags, &fc))
+        return 0;
+
+    d = fc.d;
+    info = get_kernel_info (fc.fun_id);
+
+    /* Exactly sized arrays, read past the end at the address sanitizer's
+       peril.  */
+    vector<float> x (fc.flt_offset + d), y[4], yt (fc.flt_offset
+                                                   + d * NY_DISTANCE);
+    vector<float> y_sqlen (NY_DISTANCE);
+    vector<int8_t> xi (fc.byte_offset + d), yi (fc.byte_offset + d);
+    vector<uint8_t> c1 (fc.byte_offset + d), c2 (fc.byte_offset + d);
+    mt19937 gen (fc.seed);
+
+    for (k = 0; k < 4; k++)
+        y[k].resize (fc.flt_offset + d);
+
+    for (i = fc.flt_offset; i < x.size (); i++)
+    {
+        x[i] = fuzz_value (&fc, gen);
+        for (k = 0; k < 4; k++)
+            y[k][i] = fuzz_value (&fc, gen);
+    }
+    for (i = fc.flt_offset; i < yt.size (); i++)
+        yt[i] = fuzz_value (&fc, gen);
+    for (i = fc.byte_offset; i < xi.size (); i++)
+    {
+        xi[i] = (int8_t) gen ();
+        yi[i] = (int8_t) gen ();
+        c1[i] = (uint8_t) gen ();
+        c2[i] = (uint8_t) gen ();
+    }
+
+    in.x = x.data () + fc.flt_offset;
+    for (k = 0; k < 4; k++)
+        in.y[k] = y[k].data () + fc.flt_offset;
+    in.yt = yt.data () + fc.flt_offset;
+    in.y_sqlen = y_sqlen.data ();
+    in.xi = xi.data () + fc.byte_offset;
+    in.yi = yi.data () + fc.byte_offset;
+    in.c1 = c1.data () + fc.byte_offset;
+    in.c2 = c2.data () + fc.byte_offset;
+
+    /* The squared lengths of the transposed vectors are inputs, computed
+       in double as a caller might.  */
+    for (k = 0; k < NY_DISTANCE; k++)
+        y_sqlen[k] = (float) sum_abs_prod (in.yt + k, in.yt + k, d,
+                                           NY_DISTANCE);
+
+    for (i = 0; i < d && !has_nan; i++)
+    {
+        has_nan = std::isnan (in.x[i]);
+        for (k = 0; k < 4; k++)
+            has_nan |= std::isnan (in.y[k][i]);
+    }
+
+    n_base = call_kernel (info, CODE_VER_ORIG, &in, d, base_out);
+    fuzz_stats[fc.fun_id][CODE_VER_ORIG].calls++;
+
+    for (code_ver = CODE_VER_ORIG + 1; code_ver < NUM_CODE_VERSIONS;
+         code_ver++)
+    {
+        struct fuzz_stats_t *stats = &fuzz_stats[fc.fun_id][code_ver];
+
+        if (!cmd_flags->run_code_version[code_ver])
+            continue;
+
+        n = call_kernel (info, code_ver, &in, d, out);
+        if (n == 0)
+            continue;
+        stats->calls++;
+
+        for (k = 0; k < n && k < n_base; k++)
+        {
+            if (!fuzz_tolerance (fc.fun_id, k, &in, d, has_nan, &tol))
+            {
+                stats->skipped++;
+                continue;
+            }
+
+            if (results_agree (base_out[k], out[k], tol))
+                continue;
+
+            stats->mismatches++;
+            mismatches++;
+            if (*reports > 0)
+            {
+                print_fuzz_mismatch (result, &fc, code_ver, k, base_out[k],
+                                     out[k], tol, data, size);
+                (*reports)--;
+            }
+        }
+    }
+    return mismatches + fuzz_madd_and_argmin (&fc, cmd_flags, reports);
+}
+
+/* Standalone fuzzer, cmd_flags.fuzz_iterations random inputs.  Returns
+   FUZZ_MISMATCH_EXIT_CODE if any version disagrees with the base
+   version.  */
+int
+run_fuzz_tests (std::ofstream &out_file, struct results_data_t* result,
+                struct flags_t cmd_flags)
+{
+    using namespace std;
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+    mt19937 gen (FUZZ_SEED);
+    uint8_t data[FUZZ_INPUT_SIZE];
+    int reports = FUZZ_MAX_REPORTS;
+    long int mismatches = 0;
+    unsigned int i, code_ver;
+    int iter;
+
+    cout << "Fuzzing " << cmd_flags.fuzz_iterations << " inputs" << endl;
+
+    for (iter = 0; iter < cmd_flags.fuzz_iterations; iter++)
+    {
+        for (i = 0; i < FUZZ_INPUT_SIZE; i++)
+            data[i] = (uint8_t) gen ();
+        mismatches += fuzz_one_input (data, FUZZ_INPUT_SIZE, result,
+                                      &cmd_flags, &reports);
+    }
+
+    out_file << "Fuzzed " << cmd_flags.fuzz_iterations << " inputs, "
+             << mismatches << " results differ from the base version.\n"
+             << "Function name\tcalls\tskipped\tmismatches\n";
+    for (i = 0; i < FUNC_ID_MAX; i++)
+        for (code_ver = CODE_VER_ORIG + 1; code_ver < NUM_CODE_VERSIONS;
+             code_ver++)
+        {
+            struct fuzz_stats_t *stats = &fuzz_stats[i][code_ver];
+
+            if (stats->calls == 0)
+                continue;
+
+            out_file << "  " << result[i].function_name << suffix[code_ver]
+                     << "\t" << stats->calls << "\t" << stats->skipped
+                     << "\t" << stats->mismatches << "\n";
+        }
+    if (argmin_stats[CODE_INTRINSIC_PPC].calls)
+        out_file << "  fvec_madd_and_argmin_ref" << PPC_INTRINSIC_SUFFIX
+                 << "\t" << argmin_stats[CODE_INTRINSIC_PPC].calls << "\t0\t"
+                 << argmin_stats[CODE_INTRINSIC_PPC].mismatches << "\n";
+    out_file << "\n";
+
+    cout << mismatches << " results differ from the base version." << endl;
+    return mismatches ? FUZZ_MISMATCH_EXIT_CODE : 0;
+}
+
+/* libFuzzer entry point.  All functions and code versions are fuzzed.  */
+extern "C" int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size)
+{
+    static struct results_data_t *result = NULL;
+    static struct flags_t cmd_flags;
+    int reports = 1;
+    unsigned int i;
+
+    if (result == NULL)
+    {
+        char group_id_name[GROUP_ID_MAX][GROUP_ID_NAME_MAX];
+
+        result = new results_data_t[FUNC_ID_MAX];
+        initialize_group_func_names (group_id_name, result);
+        initialize_kernel_table ();
+
+        for (i = 0; i < FUNC_ID_MAX; i++)
+            cmd_flags.run_func_flag[i] = true;
+        for (i = 0; i < NUM_CODE_VERSIONS; i++)
+            cmd_flags.run_code_version[i] = true;
+    }
+
+    if (fuzz_one_input (data, size, result, &cmd_flags, &reports))
+        abort ();
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_FUZZ_H
+#define MAIN_FUZZ_H
+
+#include <fstream>
+#include <cstdint>
+#include "main-helpers.h"
+
+/* Exit code of the program if --fuzz finds a mismatch.  */
+#define FUZZ_MISMATCH_EXIT_CODE 3
+
+/* Seed of the standalone fuzzer, the same inputs are tried on every
+   run.  */
+#define FUZZ_SEED          1618
+
+/* Bytes of a fuzz input, see decode_fuzz_input.  Longer inputs are
+   truncated, shorter ones padded with zeros.  */
+#define FUZZ_INPUT_SIZE    10
+
+/* Largest dimension, and the largest of the small dimensions chosen by the
+   high bit of the dimension bytes.  */
+#define FUZZ_MAX_DIM       2048
+#define FUZZ_SMALL_DIM     64
+
+/* Two versions agree if their results differ by at most FUZZ_TOLERANCE
+   times the error bound of a sum of d + FUZZ_EXTRA_OPS terms, see
+   fuzz_tolerance.  */
+#define FUZZ_TOLERANCE     2.0
+#define FUZZ_EXTRA_OPS     8
+
+/* Mismatches printed by the standalone fuzzer, the rest are counted.  */
+#define FUZZ_MAX_REPORTS   10
+
+/* Value distributions of the float inputs.  */
+enum fuzz_dist_id {
+    FUZZ_DIST_UNIT = 0,       /* [0, 1)  */
+    FUZZ_DIST_SIGNED,         /* [-1, 1)  */
+    FUZZ_DIST_LARGE,          /* [-1e15, 1e15)  */
+    FUZZ_DIST_TINY,           /* [-1e-20, 1e-20), denormal products.  */
+    FUZZ_DIST_EXPONENT,       /* Random sign and exponent in [-20, 20].  */
+    FUZZ_DIST_INTEGER,        /* Integers in [-8, 8], exact sums.  */
+    FUZZ_DIST_MAX,
+};
+
+/* Special values mixed into the float inputs.  */
+#define FUZZ_SPECIAL_NAN       0x1
+#define FUZZ_SPECIAL_INF       0x2
+#define FUZZ_SPECIAL_DENORMAL  0x4
+
+int run_fuzz_tests (std::ofstream &out_file, struct results_data_t* result,
+                    struct flags_t cmd_flags);
+
+/* Entry point of the libFuzzer build, see the fuzz target of the
+   Makefile.  Aborts on a mismatch.  */
+extern "C" int LLVMFuzzerTestOneInput (const uint8_t *data, size_t size);
+
+#endif /* MAIN_FUZZ_H */
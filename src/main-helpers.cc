@@ -17,7 +17,14 @@
 #include <iomanip>
 #include <iostream>
 #include "main-helpers.h"
+#include "main-working-set.h"
+#include "main-output.h"
+#include "main-numa.h"
+#include "main-offsets.h"
+#include "main-multi-acc.h"
 #include <cstring>
+#include <climits>
+#include <cmath>
 #include <string>
 
 #define MAX_DATE 25 // for test_results and test_time file names suffix
@@ -45,6 +52,47 @@
 #define COSINE_DISTANCE_REF_OPT                             1016
 #define HAMMING_DISTANCE_REF_OPT                            1017
 #define JACCARD_DISTANCE_REF_OPT                            1018
+#define WORKING_SET_OPT                                     1019
+#define RANDOM_ACCESS_OPT                                   1020
+#define REPS_OPT                                            1021
+#define WARMUP_OPT                                          1022
+#define CPU_OPT                                             1023
+#define NO_PIN_OPT                                          1024
+#define JSON_OPT                                            1025
+#define CSV_OPT                                             1026
+#define COMPARE_OPT                                         1027
+#define THRESHOLD_OPT                                       1028
+#define PERF_COUNTERS_OPT                                   1029
+#define PERF_RAW_EVENT_OPT                                  1030
+#define TARGET_TIME_OPT                                     1031
+#define DATASET_OPT                                         1032
+#define QUERIES_OPT                                         1033
+#define GROUNDTRUTH_OPT                                     1034
+#define K_OPT                                               1035
+#define NUM_QUERIES_OPT                                     1036
+#define THREADS_OPT                                         1037
+#define PLACEMENT_OPT                                       1038
+#define THREAD_CPUS_OPT                                     1039
+#define SHARED_DB_OPT                                       1040
+#define NUMA_OPT                                            1041
+#define NUMA_REPLICAS_OPT                                   1042
+#define NUMA_MATRIX_OPT                                     1043
+#define THREAD_NODE_OPT                                     1044
+#define PAGE_SIZE_OPT                                       1045
+#define OFFSET_SWEEP_OPT                                    1046
+#define ACCURACY_OPT                                        1047
+#define FUZZ_OPT                                            1048
+#define FIXED_DIM_OPT                                       1049
+#define MULTI_ACC_OPT                                       1050
+#define COSINE_MODES_OPT                                    1051
+#define SPARSE_OPT                                          1052
+#define MAXSIM_OPT                                          1053
+#define RANGE_SEARCH_OPT                                    1054
+#define FILTER_SWEEP_OPT                                    1055
+#define EARLY_ABANDON_OPT                                   1056
+#define PANEL_OPT                                           1057
+#define PARALLEL_OPT                                        1058
+#define PAIRWISE_OPT                                        1059
 
 
 // undocumented option for developers use
@@ -98,6 +146,61 @@ const struct option longopts[] =
     {"run_intrinsic_code", no_argument, &long_opt,
                                 RUN_INTRINSIC_CODE},
 
+    /* Run the functions over a database sized to a cache level.  */
+    {"working_set", required_argument, &long_opt, WORKING_SET_OPT},
+    {"random_access", no_argument, &long_opt, RANDOM_ACCESS_OPT},
+
+    /* Repetitions of each timed test and CPU pinning.  */
+    {"reps", required_argument, &long_opt, REPS_OPT},
+    {"warmup", required_argument, &long_opt, WARMUP_OPT},
+    {"target_time", required_argument, &long_opt, TARGET_TIME_OPT},
+    {"cpu", required_argument, &long_opt, CPU_OPT},
+    {"no_pin", no_argument, &long_opt, NO_PIN_OPT},
+
+    /* Machine readable output and comparison against a baseline.  */
+    {"json", required_argument, &long_opt, JSON_OPT},
+    {"csv", required_argument, &long_opt, CSV_OPT},
+    {"compare", required_argument, &long_opt, COMPARE_OPT},
+    {"threshold", required_argument, &long_opt, THRESHOLD_OPT},
+
+    /* Hardware performance counters.  */
+    {"perf_counters", no_argument, &long_opt, PERF_COUNTERS_OPT},
+    {"perf_raw_event", required_argument, &long_opt, PERF_RAW_EVENT_OPT},
+
+    /* Test data and k-NN recall from a dataset file.  */
+    {"dataset", required_argument, &long_opt, DATASET_OPT},
+    {"queries", required_argument, &long_opt, QUERIES_OPT},
+    {"groundtruth", required_argument, &long_opt, GROUNDTRUTH_OPT},
+    {"k", required_argument, &long_opt, K_OPT},
+    {"num_queries", required_argument, &long_opt, NUM_QUERIES_OPT},
+
+    /* Thread scaling test.  */
+    {"threads", required_argument, &long_opt, THREADS_OPT},
+    {"placement", required_argument, &long_opt, PLACEMENT_OPT},
+    {"thread_cpus", required_argument, &long_opt, THREAD_CPUS_OPT},
+    {"shared_db", no_argument, &long_opt, SHARED_DB_OPT},
+
+    /* NUMA placement.  */
+    {"numa", required_argument, &long_opt, NUMA_OPT},
+    {"numa_replicas", no_argument, &long_opt, NUMA_REPLICAS_OPT},
+    {"numa_matrix", no_argument, &long_opt, NUMA_MATRIX_OPT},
+    {"thread_node", required_argument, &long_opt, THREAD_NODE_OPT},
+    {"page_size", required_argument, &long_opt, PAGE_SIZE_OPT},
+    {"offset_sweep", required_argument, &long_opt, OFFSET_SWEEP_OPT},
+    {"accuracy", required_argument, &long_opt, ACCURACY_OPT},
+    {"fuzz", required_argument, &long_opt, FUZZ_OPT},
+    {"fixed_dim", no_argument, &long_opt, FIXED_DIM_OPT},
+    {"multi_acc", required_argument, &long_opt, MULTI_ACC_OPT},
+    {"cosine_modes", no_argument, &long_opt, COSINE_MODES_OPT},
+    {"sparse", no_argument, &long_opt, SPARSE_OPT},
+    {"maxsim", no_argument, &long_opt, MAXSIM_OPT},
+    {"range_search", no_argument, &long_opt, RANGE_SEARCH_OPT},
+    {"filter_sweep", no_argument, &long_opt, FILTER_SWEEP_OPT},
+    {"early_abandon", no_argument, &long_opt, EARLY_ABANDON_OPT},
+    {"panel", no_argument, &long_opt, PANEL_OPT},
+    {"parallel", required_argument, &long_opt, PARALLEL_OPT},
+    {"pairwise", no_argument, &long_opt, PAIRWISE_OPT},
+
     
     /* undocumented developers option */
     {"VERBOSE", no_argument, &long_opt, VERBOSE_OPT},
@@ -131,11 +234,70 @@ print_help (void)
     cout << " -h                      Print help and exit.\n";
     cout << " --help                  Print help and exit.\n";
     cout << " -R <num>                Set the number of times to run each\n";
-    cout << "                         function test.\n";
-    cout << "                         Default = " << NUM_RUNS << endl;
+    cout << "                         function in a timed loop.  By default\n";
+    cout << "                         the number is calibrated for each\n";
+    cout << "                         function and array size.\n";
+    cout << " --target_time <ms>      Calibrate the number of runs so the\n";
+    cout << "                         timed repetitions of each test take\n";
+    cout << "                         ms milliseconds.  Ignored with -R.\n";
+    cout << "                         Default = " << TARGET_TIME_MS << endl;
+    cout << " --reps <num>            Number of timed repetitions of each\n";
+    cout << "                         test.  The median is reported with\n";
+    cout << "                         min, mean, p99 and stddev.\n";
+    cout << "                         Default = " << NUM_REPS << endl;
+    cout << " --warmup <num>          Number of untimed repetitions before\n";
+    cout << "                         the timed repetitions.\n";
+    cout << "                         Default = " << NUM_WARMUP << endl;
+    cout << " --cpu <num>             Pin the tests to CPU num.  By default\n";
+    cout << "                         the tests are pinned to the CPU the\n";
+    cout << "                         program starts on.\n";
+    cout << " --no_pin                Do not pin the tests to a CPU.\n";
+    cout << " --json <file>           Write the results as JSON to file.\n";
+    cout << "                         Default is results/test_time_<date>.json\n";
+    cout << " --csv <file>            Write the results as CSV to file.\n";
+    cout << "                         Default is results/test_time_<date>.csv\n";
+    cout << " --compare <file>        Compare the times against a JSON file\n";
+    cout << "                         from an earlier run.  Exit with code "
+         << REGRESSION_EXIT_CODE << "\n";
+    cout << "                         if a test is slower by more than the\n";
+    cout << "                         threshold with 95% confidence.\n";
+    cout << " --threshold <percent>   Regression threshold for --compare.\n";
+    cout << "                         Default = " << COMPARE_THRESHOLD << endl;
+    cout << " --perf_counters         Read the cycles, instructions, cache\n";
+    cout << "                         and branch misses around each test with\n";
+    cout << "                         perf_event_open, Linux only.  Reports\n";
+    cout << "                         IPC, cycles/element and bytes/cycle.\n";
+    cout << " --perf_raw_event <code> Also count the processor specific raw\n";
+    cout << "                         event code, e.g. a vector instruction\n";
+    cout << "                         event.  Implies --perf_counters.\n";
+    cout << " --dataset <file>        Use the vectors of a .fvecs, .bvecs,\n";
+    cout << "                         .ivecs or .npy file as the test data\n";
+    cout << "                         instead of generated data.  The array\n";
+    cout << "                         size is the dataset dimension.\n";
+    cout << " --queries <file>        Query vectors for the k-NN recall\n";
+    cout << "                         test, run if given with --dataset.\n";
+    cout << " --groundtruth <file>    Ids of the nearest dataset vectors of\n";
+    cout << "                         each query, e.g. an .ivecs file.  If\n";
+    cout << "                         not given, the optimized versions are\n";
+    cout << "                         checked against the base version.\n";
+    cout << " --k <num>               Number of nearest neighbors of the\n";
+    cout << "                         recall test.  Default = " << RECALL_K
+         << endl;
+    cout << " --num_queries <num>     Maximum number of queries of the\n";
+    cout << "                         recall test.  Default = "
+         << NUM_RECALL_QUERIES << endl;
+    cout << " --early_abandon         Also time the recall test search with\n";
+    cout << "                         the L2 and L1 distances stopping once\n";
+    cout << "                         they reach the k-th best distance.\n";
     cout << " -s <num>, --size <num>  Array size to test.  Use multiple";
     cout << " times\n";
     cout << "                         to test multiple array sizes.\n";
+    cout << " -s <first>:<last>[:<step>]\n";
+    cout << "                         Test the sizes from first to last,\n";
+    cout << "                         adding step, default 1.\n";
+    cout << " -s <first>:<last>:x<factor>\n";
+    cout << "                         Test the sizes from first to last,\n";
+    cout << "                         multiplying by factor.\n";
     cout << "\n";
     cout << " -E                      Test all euclidean distance functions.";
     cout << "\n";
@@ -165,6 +327,101 @@ print_help (void)
     cout << " --run_intrinsic_code      Run the optimized intrinsic code versions\n";
     cout << " By default, the base and the optimized code versions are run.\n";
     cout << "\n";
+    cout << " --working_set <set>       Run the functions over a database of\n";
+    cout << "                           vectors instead of a single pair of\n";
+    cout << "                           arrays.  <set> is L1, L2 or L3 for a\n";
+    cout << "                           database of half the cache size, DRAM\n";
+    cout << "                           for " << DRAM_LLC_MULTIPLE
+         << " times the last level cache\n";
+    cout << "                           or <n>xLLC for n times the last level\n";
+    cout << "                           cache.  Reports ns/vector and GB/s.\n";
+    cout << " --random_access           Visit the database vectors in a random\n";
+    cout << "                           order, default is in order.\n";
+    cout << " --page_size <p>           Pages of the working set databases,\n";
+    cout << "                           default, base (no transparent huge\n";
+    cout << "                           pages), thp (transparent huge pages)\n";
+    cout << "                           or hugetlb (reserved huge pages).\n";
+    cout << " --offset_sweep <step>     Repeat the tests with the inputs 0 to\n";
+    cout << "                           15 bytes past a cache line, step is\n";
+    cout << "                           bytes or floats.  Reports the time at\n";
+    cout << "                           each offset and checks the results.\n";
+    cout << " --accuracy <n>            Check the results of n random vector\n";
+    cout << "                           pairs per array size against a long\n";
+    cout << "                           double oracle.  Reports the relative\n";
+    cout << "                           error and a histogram of the error in\n";
+    cout << "                           units in the last place.\n";
+    cout << " --fuzz <n>                Instead of timing the functions, check\n";
+    cout << "                           that the code versions agree with the\n";
+    cout << "                           base version on n random inputs of\n";
+    cout << "                           random size, alignment and values.\n";
+    cout << " --fixed_dim               Time the fixed dimension instances of\n";
+    cout << "                           the L2, inner product and L1 functions\n";
+    cout << "                           against the generic versions for the\n";
+    cout << "                           array sizes that have one.\n";
+    cout << " --multi_acc <n1,n2,...>   Time the float functions with n1, n2,\n";
+    cout << "                           ... accumulators, 1 (the intrinsic\n";
+    cout << "                           version), 2, 4 or 8.  Reports the\n";
+    cout << "                           elements/ns and, with --perf_counters,\n";
+    cout << "                           elements/cycle of each variant.\n";
+    cout << " --cosine_modes            Time the cosine distance of a query to\n";
+    cout << "                           a database with the full function,\n";
+    cout << "                           precomputed inverse norms, the ny\n";
+    cout << "                           function and unit length vectors.\n";
+    cout << " --sparse                  Time the sparse vector inner product\n";
+    cout << "                           and L2 kernels scanning a database of\n";
+    cout << "                           sparse vectors with sparse and dense\n";
+    cout << "                           queries, for several nnz profiles.\n";
+    cout << " --maxsim                  Time the MaxSim late interaction score\n";
+    cout << "                           of a query of 32 token vectors against\n";
+    cout << "                           documents of 100 to 300 tokens, with\n";
+    cout << "                           inner product calls, the blocked\n";
+    cout << "                           kernel and int8 tokens.\n";
+    cout << " --range_search            Time the L2, inner product and Hamming\n";
+    cout << "                           range search kernels returning the ids\n";
+    cout << "                           within a radius, and the L2 distance\n";
+    cout << "                           array followed by a scan.\n";
+    cout << " --filter_sweep            Time a k-NN search of the vectors\n";
+    cout << "                           selected by a bitmap or list of ids\n";
+    cout << "                           filter against filtering after the\n";
+    cout << "                           distances, for 0.1% to 100% selected.\n";
+    cout << " --panel                   Time the L2, inner product and L1\n";
+    cout << "                           distances to a database stored in\n";
+    cout << "                           panels of 4, 8 and 16 vectors against\n";
+    cout << "                           the row-major batch_4 functions.\n";
+    cout << " --parallel <n1,n2,...>    Time a k-NN search, a distance matrix\n";
+    cout << "                           and a k-means step split into chunks\n";
+    cout << "                           over a work stealing pool of n1, n2,\n";
+    cout << "                           ... threads, with the efficiency.\n";
+    cout << " --pairwise                Time the all-pairs distances of a set\n";
+    cout << "                           of vectors for each metric with loops\n";
+    cout << "                           over the pair function and with cdist\n";
+    cout << "                           and pdist in float and half precision\n";
+    cout << "                           on the largest --parallel count.\n";
+    cout << " --threads <n1,n2,...>     Run each function concurrently on n1,\n";
+    cout << "                           n2, ... threads over the working set,\n";
+    cout << "                           L1 if no working set is given.\n";
+    cout << "                           Reports vectors/s, per thread\n";
+    cout << "                           efficiency and GB/s.\n";
+    cout << " --placement <p>           CPU placement of the threads, compact\n";
+    cout << "                           fills the SMT threads of a core first,\n";
+    cout << "                           spread places one thread per core\n";
+    cout << "                           first.  Default = compact.\n";
+    cout << " --thread_cpus <c1,c2,...> Bind thread i to CPU ci instead.\n";
+    cout << " --shared_db               All threads read one database, by\n";
+    cout << "                           default each thread has its own.\n";
+    cout << " --numa <policy>           Place the working set databases on\n";
+    cout << "                           the node of the thread (local), on\n";
+    cout << "                           the next node (remote), interleaved\n";
+    cout << "                           (interleave) or on node <n>.  Default\n";
+    cout << "                           = first_touch.\n";
+    cout << " --numa_replicas           With --shared_db, one database per\n";
+    cout << "                           node, read by the threads of the node.\n";
+    cout << " --thread_node <n>         Bind the threads to the CPUs of\n";
+    cout << "                           node n.\n";
+    cout << " --numa_matrix             Measure the GB/s of the threads of\n";
+    cout << "                           each node reading the memory of each\n";
+    cout << "                           node.\n";
+    cout << "\n";
     cout << "\n";
     cout << " By default, all tests are run for array an size of 16.\n";
     cout << "\n";
@@ -210,6 +467,61 @@ print_cmd_opts (struct flags_t cmd_flags,
         cmd_flags.run_code_version[CODE_OPTIMIZED_PPC] << endl;
     cout << "Run intrinsic functions: " <<
         cmd_flags.run_code_version[CODE_INTRINSIC_PPC] << endl;
+    cout << "Working set: " << working_set_name (cmd_flags) << ", "
+         << (cmd_flags.working_set != WORKING_SET_NONE ?
+             get_working_set_bytes (cmd_flags) : 0) << " bytes, "
+         << (cmd_flags.random_access ? "random" : "cyclic") << " access\n";
+    if (cmd_flags.calibrate)
+        cout << "Runs: calibrated to " << cmd_flags.target_time_ms
+             << " ms per test\n";
+    else
+        cout << "Runs: " << cmd_flags.num_runs << endl;
+    cout << "Repetitions: " << cmd_flags.num_reps << ", warmup: "
+         << cmd_flags.num_warmup << ", CPU: " << cmd_flags.cpu << endl;
+    cout << "Thread counts:";
+    for (i = 0; i < cmd_flags.thread_counts.size (); i++)
+        cout << " " << cmd_flags.thread_counts[i];
+    cout << (cmd_flags.shared_db ? ", shared" : ", per thread")
+         << " database\n";
+    cout << "NUMA placement: " << numa_policy_name (cmd_flags)
+         << (cmd_flags.numa_replicas ? ", replicas" : "")
+         << (cmd_flags.numa_matrix ? ", matrix" : "") << endl;
+    cout << "Page size: " << page_size_name (cmd_flags) << endl;
+    cout << "Offset sweep: "
+         << (cmd_flags.offset_sweep == OFFSET_SWEEP_BYTES ? "bytes"
+             : cmd_flags.offset_sweep == OFFSET_SWEEP_FLOATS ? "floats"
+             : "off") << endl;
+    cout << "Accuracy trials: " << cmd_flags.accuracy_trials << endl;
+    cout << "Fuzz iterations: " << cmd_flags.fuzz_iterations << endl;
+    cout << "Fixed dimension kernels: "
+         << (cmd_flags.fixed_dim ? "yes" : "no") << endl;
+    cout << "Multiple accumulator counts: ";
+    if (cmd_flags.multi_acc_counts.empty ())
+        cout << "none";
+    for (size_t n = 0; n < cmd_flags.multi_acc_counts.size (); n++)
+        cout << (n ? "," : "") << cmd_flags.multi_acc_counts[n];
+    cout << endl;
+    cout << "Cosine distance modes: "
+         << (cmd_flags.cosine_modes ? "yes" : "no") << endl;
+    cout << "Sparse vector kernels: "
+         << (cmd_flags.sparse ? "yes" : "no") << endl;
+    cout << "MaxSim: " << (cmd_flags.maxsim ? "yes" : "no") << endl;
+    cout << "Range search: " << (cmd_flags.range_search ? "yes" : "no")
+         << endl;
+    cout << "Filter sweep: " << (cmd_flags.filter_sweep ? "yes" : "no")
+         << endl;
+    cout << "Early abandon: " << (cmd_flags.early_abandon ? "yes" : "no")
+         << endl;
+    cout << "Panel layout: " << (cmd_flags.panel ? "yes" : "no") << endl;
+    cout << "Parallel engine threads:";
+    for (i = 0; i < cmd_flags.parallel_counts.size (); i++)
+        cout << " " << cmd_flags.parallel_counts[i];
+    cout << endl;
+    cout << "Pairwise distances: " << (cmd_flags.pairwise ? "yes" : "no")
+         << endl;
+    cout << "Dataset: "
+         << (cmd_flags.dataset_file ? cmd_flags.dataset_file : "generated")
+         << endl;
     cout << endl;
 }
 
@@ -256,19 +568,49 @@ check_short_opt_arg (int optind, char **argv)
 void
 get_size_arg (char *optarg, struct flags_t *cmd_flags)
 {
+    /* The argument is a single size or a range first:last[:step].  The
+       step is added to the size, or the size is multiplied by N if the
+       step is xN.  The default step is 1.  For example 4:4096:x2 is the
+       powers of two from 4 to 4096 and 1:130:1 is every size from 1 to
+       130.  */
     using namespace std;
-    int val;
+    long int first, last, step = 1, val;
+    bool multiply = false;
+    char *str = optarg;
+    char *end;
+
+    first = strtol (str, &end, 10);
+    last = first;
+
+    if (end != str && *end == ':')
+    {
+        str = end + 1;
+        last = strtol (str, &end, 10);
+
+        if (end != str && *end == ':')
+        {
+            str = end + 1;
+            if (*str == 'x' || *str == 'X')
+            {
+                multiply = true;
+                str++;
+            }
+            step = strtol (str, &end, 10);
+        }
+    }
 
-    if (cmd_flags->num_array_sizes == MAX_ARRAY_SIZES)
+    if (end == str || *end != '\0' || first < 1 || last < first
+        || (multiply && step < 2) || (!multiply && step < 1))
     {
-        cout << "ERROR: exceeded max number of array sizes, " <<
-            MAX_ARRAY_SIZES << endl;
+        cout << "ERROR, invalid array size " << optarg << ", expected <size>"
+             << " or <first>:<last>[:<step> | :x<factor>].\n";
         exit(-1);
     }
-    val = atoi(optarg);
 
-    cmd_flags->array_sizes[cmd_flags->num_array_sizes] = val;
-    cmd_flags->num_array_sizes = cmd_flags->num_array_sizes + 1;
+    for (val = first; val <= last; val = multiply ? val * step : val + step)
+        cmd_flags->array_sizes.push_back ((int) val);
+
+    cmd_flags->num_array_sizes = cmd_flags->array_sizes.size ();
 }
 
 /*
@@ -285,6 +627,36 @@ get_size_arg (char *optarg, struct flags_t *cmd_flags)
  * (Internally, this means we must be sure to reset "place" to EMSG before
  * returning -1.)
  */
+/* Parse a comma separated list of integers of at least min_value.  Returns
+   non zero if the list is not valid.  */
+int
+parse_int_list (const char *arg, std::vector<int> &list, int min_value)
+{
+    const char *p = arg;
+    char *end;
+    long value;
+
+    list.clear ();
+    while (*p)
+    {
+        value = strtol (p, &end, 10);
+        if (end == p || value < min_value || value > INT_MAX)
+            return 1;
+
+        list.push_back ((int) value);
+        p = end;
+        if (*p == ',')
+        {
+            p++;
+            if (*p == '\0')
+                return 1;
+        }
+        else if (*p != '\0')
+            return 1;
+    }
+    return list.empty ();
+}
+
 int
 getopt_long(int argc, char *const argv[],
             const char *optstring,
@@ -558,6 +930,275 @@ read_cmd_opts (int argc, char **argv, struct flags_t *cmd_flags)
                 cmd_flags->run_code_version[CODE_INTRINSIC_PPC] = true;
                 break;
 
+            case WORKING_SET_OPT:
+                if (parse_working_set_arg (optarg, cmd_flags))
+                {
+                    cout << "ERROR, unknown working set " << optarg << endl;
+                    print_help();
+                    exit(-1);
+                }
+                break;
+
+            case RANDOM_ACCESS_OPT:
+                cmd_flags->random_access = true;
+                break;
+
+            case REPS_OPT:
+                cmd_flags->num_reps = atoi(optarg);
+                if (cmd_flags->num_reps < 1)
+                {
+                    cout << "ERROR, --reps must be at least 1.\n";
+                    exit(-1);
+                }
+                break;
+
+            case WARMUP_OPT:
+                cmd_flags->num_warmup = atoi(optarg);
+                if (cmd_flags->num_warmup < 0)
+                {
+                    cout << "ERROR, --warmup can not be negative.\n";
+                    exit(-1);
+                }
+                break;
+
+            case TARGET_TIME_OPT:
+                cmd_flags->target_time_ms = atof(optarg);
+                if (cmd_flags->target_time_ms <= 0)
+                {
+                    cout << "ERROR, --target_time must be positive.\n";
+                    exit(-1);
+                }
+                break;
+
+            case CPU_OPT:
+                cmd_flags->cpu = atoi(optarg);
+                cmd_flags->pin_cpu = true;
+                break;
+
+            case NO_PIN_OPT:
+                cmd_flags->pin_cpu = false;
+                break;
+
+            case JSON_OPT:
+                cmd_flags->json_file = optarg;
+                break;
+
+            case CSV_OPT:
+                cmd_flags->csv_file = optarg;
+                break;
+
+            case COMPARE_OPT:
+                cmd_flags->compare_file = optarg;
+                break;
+
+            case PERF_COUNTERS_OPT:
+                cmd_flags->perf_counters = true;
+                break;
+
+            case PERF_RAW_EVENT_OPT:
+                cmd_flags->perf_counters = true;
+                cmd_flags->perf_raw_event = strtoll(optarg, NULL, 0);
+                break;
+
+            case THRESHOLD_OPT:
+                cmd_flags->compare_threshold = atof(optarg);
+                if (cmd_flags->compare_threshold < 0)
+                {
+                    cout << "ERROR, --threshold can not be negative.\n";
+                    exit(-1);
+                }
+                break;
+
+            case DATASET_OPT:
+                cmd_flags->dataset_file = optarg;
+                break;
+
+            case QUERIES_OPT:
+                cmd_flags->queries_file = optarg;
+                break;
+
+            case GROUNDTRUTH_OPT:
+                cmd_flags->groundtruth_file = optarg;
+                break;
+
+            case K_OPT:
+                cmd_flags->recall_k = atoi(optarg);
+                if (cmd_flags->recall_k < 1)
+                {
+                    cout << "ERROR, --k must be at least 1.\n";
+                    exit(-1);
+                }
+                break;
+
+            case NUM_QUERIES_OPT:
+                cmd_flags->num_queries = atoi(optarg);
+                if (cmd_flags->num_queries < 1)
+                {
+                    cout << "ERROR, --num_queries must be at least 1.\n";
+                    exit(-1);
+                }
+                break;
+
+            case THREADS_OPT:
+                if (parse_int_list (optarg, cmd_flags->thread_counts, 1))
+                {
+                    cout << "ERROR, invalid thread counts " << optarg
+                         << ", expected a list such as 1,2,4,8.\n";
+                    exit(-1);
+                }
+                break;
+
+            case PLACEMENT_OPT:
+                if (strcmp (optarg, "compact") == 0)
+                    cmd_flags->placement = PLACEMENT_COMPACT;
+                else if (strcmp (optarg, "spread") == 0)
+                    cmd_flags->placement = PLACEMENT_SPREAD;
+                else
+                {
+                    cout << "ERROR, unknown placement " << optarg
+                         << ", expected compact or spread.\n";
+                    exit(-1);
+                }
+                break;
+
+            case THREAD_CPUS_OPT:
+                if (parse_int_list (optarg, cmd_flags->thread_cpus, 0))
+                {
+                    cout << "ERROR, invalid CPU list " << optarg << endl;
+                    exit(-1);
+                }
+                break;
+
+            case SHARED_DB_OPT:
+                cmd_flags->shared_db = true;
+                break;
+
+            case NUMA_OPT:
+                if (parse_numa_arg (optarg, cmd_flags))
+                {
+                    cout << "ERROR, unknown NUMA placement " << optarg
+                         << ", expected first_touch, local, remote,"
+                         << " interleave or a node number.\n";
+                    exit(-1);
+                }
+                break;
+
+            case NUMA_REPLICAS_OPT:
+                cmd_flags->numa_replicas = true;
+                break;
+
+            case NUMA_MATRIX_OPT:
+                cmd_flags->numa_matrix = true;
+                break;
+
+            case THREAD_NODE_OPT:
+            {
+                std::vector<int> cpus;
+                char *end;
+                long node = strtol (optarg, &end, 10);
+
+                if (end == optarg || *end != '\0' || node < 0
+                    || node >= NUMA_MAX_NODES
+                    || numa_node_cpus ((int) node, cpus))
+                {
+                    cout << "ERROR, --thread_node " << optarg
+                         << " is not a node with CPUs.\n";
+                    exit(-1);
+                }
+                cmd_flags->thread_node = (int) node;
+                break;
+            }
+
+            case OFFSET_SWEEP_OPT:
+                if (parse_offset_sweep_arg (optarg, cmd_flags))
+                {
+                    cout << "ERROR, unknown offset sweep step " << optarg
+                         << ", expected bytes or floats.\n";
+                    exit(-1);
+                }
+                break;
+
+            case ACCURACY_OPT:
+                cmd_flags->accuracy_trials = atoi(optarg);
+                if (cmd_flags->accuracy_trials < 1)
+                {
+                    cout << "ERROR, --accuracy must be at least 1.\n";
+                    exit(-1);
+                }
+                break;
+
+            case FUZZ_OPT:
+                cmd_flags->fuzz_iterations = atoi(optarg);
+                if (cmd_flags->fuzz_iterations < 1)
+                {
+                    cout << "ERROR, --fuzz must be at least 1.\n";
+                    exit(-1);
+                }
+                break;
+
+            case FIXED_DIM_OPT:
+                cmd_flags->fixed_dim = true;
+                break;
+
+            case COSINE_MODES_OPT:
+                cmd_flags->cosine_modes = true;
+                break;
+
+            case SPARSE_OPT:
+                cmd_flags->sparse = true;
+                break;
+
+            case MAXSIM_OPT:
+                cmd_flags->maxsim = true;
+                break;
+
+            case RANGE_SEARCH_OPT:
+                cmd_flags->range_search = true;
+                break;
+
+            case FILTER_SWEEP_OPT:
+                cmd_flags->filter_sweep = true;
+                break;
+
+            case EARLY_ABANDON_OPT:
+                cmd_flags->early_abandon = true;
+                break;
+
+            case PANEL_OPT:
+                cmd_flags->panel = true;
+                break;
+
+            case PARALLEL_OPT:
+                if (parse_int_list (optarg, cmd_flags->parallel_counts, 1))
+                {
+                    cout << "ERROR, invalid parallel thread counts " << optarg
+                         << ", expected a list such as 1,2,4,8.\n";
+                    exit(-1);
+                }
+                break;
+
+            case PAIRWISE_OPT:
+                cmd_flags->pairwise = true;
+                break;
+
+            case MULTI_ACC_OPT:
+                if (parse_multi_acc_arg (optarg, cmd_flags))
+                {
+                    cout << "ERROR, invalid accumulator counts " << optarg
+                         << ", expected a list of 1, 2, 4 or 8.\n";
+                    exit(-1);
+                }
+                break;
+
+            case PAGE_SIZE_OPT:
+                if (parse_page_size_arg (optarg, cmd_flags))
+                {
+                    cout << "ERROR, unknown page size " << optarg
+                         << ", expected default, base, thp or hugetlb.\n";
+                    exit(-1);
+                }
+                break;
+
             case VERBOSE_OPT:
                 cmd_flags->verbose_output = true;
                 break;
@@ -589,6 +1230,12 @@ read_cmd_opts (int argc, char **argv, struct flags_t *cmd_flags)
         case 'R':     /* Set number of runs. */
             check_short_opt_arg(optind, argv);
             cmd_flags->num_runs = atoi(optarg);
+            cmd_flags->calibrate = false;
+            if (cmd_flags->num_runs < 1)
+            {
+                cout << "ERROR, -R must be at least 1.\n";
+                exit(-1);
+            }
             break;
 
         case 'E':     /* Run all Euclidean tests. */
@@ -642,7 +1289,7 @@ read_cmd_opts (int argc, char **argv, struct flags_t *cmd_flags)
     {
         /* Minimum run is for vector length of 16.  */
         cmd_flags->num_array_sizes = 1;
-        cmd_flags->array_sizes[0] = 16;
+        cmd_flags->array_sizes.push_back (16);
     }
 
     /* By default enable all tests in the group unless the user specifically
@@ -862,8 +1509,9 @@ print_time_code_ver (std::ofstream &out_file, int fun_index_max,
             out_file << "  " << result[i].function_name << suffix << "\t";
 
             for (j = 0; j< array_index_max; j++)
-                out_file << result[i].execution_time[j][code_ver]
-                         << "\t";
+                out_file << std::fixed << std::setprecision (2)
+                         << (double) result[i].execution_time[j][code_ver]
+                            / result[i].num_runs[j] << "\t";
 
             out_file << "\n";
         }
@@ -931,7 +1579,7 @@ print_time (std::ofstream &out_file, int fun_index_max, int array_index_max,
     using namespace std;
 
     /* Print the base execution times.  */
-    out_file << "Original code execution time in ns.\n";
+    out_file << "Original code median execution time per call in ns.\n";
     out_file << "Function name \t array size\n\t";
     strcpy (suffix, PPC_BASE_SUFFIX);
 
@@ -947,7 +1595,7 @@ print_time (std::ofstream &out_file, int fun_index_max, int array_index_max,
     /* Print the optimized results.  */
     if (cmd_flags.run_code_version[CODE_OPTIMIZED_PPC])
     {
-        out_file << "Optimized PowerPC code execution time in ns.\n";
+        out_file << "Optimized PowerPC code median execution time per call in ns.\n";
         out_file << "Function name \t array size\n\t";
         strcpy (suffix, PPC_OPT_SUFFIX);
 
@@ -967,7 +1615,7 @@ print_time (std::ofstream &out_file, int fun_index_max, int array_index_max,
     /* Print the intrinsic results.  */
     if (cmd_flags.run_code_version[CODE_INTRINSIC_PPC])
     {
-        out_file << "Intrinsic PowerPC code execution time in ns.\n";
+        out_file << "Intrinsic PowerPC code median execution time per call in ns.\n";
         out_file << "Function name \t array size\n\t";
         strcpy (suffix, PPC_INTRINSIC_SUFFIX);
 
@@ -994,10 +1642,11 @@ print_results_check_int (int result_base, int result_run,
     float diff;
     int rtn = 0;
 
+    /* Relative difference, the integer results should match exactly.  */
     if (result_base != 0)
-         diff = abs (result_base - result_run) / result_base;
+        diff = (float) abs (result_base - result_run) / abs (result_base);
     else
-        diff = result_run;
+        diff = abs (result_run);
 
     if (diff < ERR_THRESHOLD)
         out_file << "True\t";
@@ -1016,10 +1665,12 @@ print_results_check_flt (float result_base, float result_run,
     float diff;
     int rtn = 0;
 
+    /* Relative difference.  Unqualified abs can resolve to the int
+       version, and a negative result_base would pass any result.  */
     if (result_base != 0.0)
-         diff = abs (result_base - result_run) / result_base;
+        diff = fabs (result_base - result_run) / fabs (result_base);
     else
-        diff = result_run;
+        diff = fabs (result_run);
 
     if (diff < ERR_THRESHOLD)
         out_file << "True\t";
@@ -1148,24 +1799,19 @@ print_result (std::ofstream &out_file, int fun_id_max, int array_index_max,
     }
 }
 
+/* The data arrays are allocated from the arena, so each array starts on a
+   cache line and is zero padded to a multiple of the vector size.  They are
+   released with the arena.  */
 void
-load_data_char (size_t d, uint8_t **c1, uint8_t **c2)
+load_data_char (struct arena_t *arena, size_t d, uint8_t **c1, uint8_t **c2)
 {
     using namespace std;
     uint8_t *c1p;
     uint8_t *c2p;
 
-    *c1 = (uint8_t *)malloc(d * sizeof(uint8_t));
-    *c2 = (uint8_t *)malloc(d * sizeof(uint8_t));
+    *c1 = (uint8_t *) arena_alloc_vectors (arena, 1, d, sizeof (uint8_t));
+    *c2 = (uint8_t *) arena_alloc_vectors (arena, 1, d, sizeof (uint8_t));
 
-    if (!(*c1) || !(*c2)) {
-        cout << "ERROR, failed to allocat the unit8_t data arrays.\n";
-        /* Failed to malloc all of the arrays, release memory, return error.
-         */
-        free (*c1);
-        free (*c2);
-        exit (-1);
-    }
     c1p = *c1;
     c2p = *c2;
 
@@ -1176,17 +1822,9 @@ load_data_char (size_t d, uint8_t **c1, uint8_t **c2)
     return;
 }
 
-void
-release_data_char (uint8_t **c1, uint8_t **c2)
-{
-    free (*c1);
-    free (*c2);
-    return;
-}
-
 int
-load_data_float (size_t d, float **x, float **y0, float **y1, float **y2,
-                 float **y3)
+load_data_float (struct arena_t *arena, size_t d, float **x, float **y0,
+                 float **y1, float **y2, float **y3)
 {
     using namespace std;
     int i;
@@ -1196,23 +1834,11 @@ load_data_float (size_t d, float **x, float **y0, float **y1, float **y2,
     float *y2p;
     float *y3p;
 
-    *x = (float *) malloc(d * sizeof(float));
-    *y0 = (float *) malloc(d * sizeof(float));
-    *y1 = (float *) malloc(d * sizeof(float));
-    *y2 = (float *) malloc(d * sizeof(float));
-    *y3 = (float *) malloc(d * sizeof(float));
-
-    if (!(*x) || !(*y0) || !(*y1) || !(*y2) || !(*y3)) {
-        cout << "ERROR, failed to allocat the euclidean_l2_distance float data arrays.\n";
-        /* Failed to malloc all of the arrays, release memory, return error.
-         */
-        free (*x);
-        free (*y0);
-        free (*y1);
-        free (*y2);
-        free (*y3);
-        exit (-1);
-    }
+    *x = (float *) arena_alloc_vectors (arena, 1, d, sizeof (float));
+    *y0 = (float *) arena_alloc_vectors (arena, 1, d, sizeof (float));
+    *y1 = (float *) arena_alloc_vectors (arena, 1, d, sizeof (float));
+    *y2 = (float *) arena_alloc_vectors (arena, 1, d, sizeof (float));
+    *y3 = (float *) arena_alloc_vectors (arena, 1, d, sizeof (float));
 
     xp = *x;
     y0p = *y0;
@@ -1242,37 +1868,15 @@ load_data_float (size_t d, float **x, float **y0, float **y1, float **y2,
 }
 
 void
-release_data_float (float **x, float **y0, float **y1,
-                    float **y2, float **y3,  float *dis)
-{
-    free (*x);
-    free (*y0);
-    free (*y1);
-    free (*y2);
-    free (*y3);
-    free (dis);
-    return;
-}
-
-void
-load_data_int8 (size_t d, int8_t **x, int8_t **y)
+load_data_int8 (struct arena_t *arena, size_t d, int8_t **x, int8_t **y)
 {
     using namespace std;
     int i;
     int8_t *xp;
     int8_t *yp;
 
-    *x = (int8_t *) malloc(d * sizeof(int8_t));
-    *y = (int8_t *) malloc(d * sizeof(int8_t));
-
-    if (!*x || !*y) {
-        cout << "ERROR, failed to allocat the euclidean_l2_distance integer  data arrays.\n";
-        /* Failed to malloc all of the arrays, release memory, return error.
-         */
-        free (*x);
-        free (*y);
-        exit (-1);
-    }
+    *x = (int8_t *) arena_alloc_vectors (arena, 1, d, sizeof (int8_t));
+    *y = (int8_t *) arena_alloc_vectors (arena, 1, d, sizeof (int8_t));
 
     xp = *x;
     yp = *y;
@@ -1282,10 +1886,3 @@ load_data_int8 (size_t d, int8_t **x, int8_t **y)
         yp[i] = 2*i;
     }
 }
-
-void
-release_data_int8 (int8_t **x, int8_t **y)
-{
-    free (*x);
-    free (*y);
-}
@@ -14,13 +14,18 @@
  * limitations under the License.
  */
 
+#ifndef MAIN_HELPERS_H
+#define MAIN_HELPERS_H
+
 #include <cstring>
 #include <string>
 #include <ctime>
 #include <ios>
 #include <iostream>
 #include <fstream>
+#include <vector>
 #include "main-tests.h"
+#include "arena.h"
 #include <unistd.h>
 
 #define VERSION    "0.6"
@@ -64,25 +69,90 @@ struct option
 
 std::string getDateAsFileSuffix(void);
 int read_cmd_opts (int argc, char ** argv, struct flags_t *cmd_flags);
+int parse_int_list (const char *arg, std::vector<int> &list, int min_value);
 
-int load_data_float (size_t d, float **x, float **y0, float **y1, float **y2,
-                     float **y3);
-void release_data_float (float **x, float **y0, float **y1, float **y2,
-                         float **y3, float *dis);
-void load_data_int8 (size_t d, int8_t **x, int8_t **y);
-void release_data_int8 (int8_t **x, int8_t **y);
-void load_data_char (size_t d, uint8_t **c1, uint8_t **c2);
-void release_data_char (uint8_t **c1, uint8_t **c2);
+int load_data_float (struct arena_t *arena, size_t d, float **x, float **y0,
+                     float **y1, float **y2, float **y3);
+void load_data_int8 (struct arena_t *arena, size_t d, int8_t **x,
+                     int8_t **y);
+void load_data_char (struct arena_t *arena, size_t d, uint8_t **c1,
+                     uint8_t **c2);
 
 /* Call each function NUM_RUNS to get a reasonably large execution time for
    the function.  Goal is to have the number of runs large enough relative
    to the various system activity to get a reasonably consistent execution
-   time.   */
-#define NUM_RUNS 10000000     /* Default.  */
+   time.  By default the number of runs is calibrated for each function and
+   array size so the timed repetitions of a test take TARGET_TIME_MS, NUM_RUNS
+   is only used if calibration is turned off.   */
+#define NUM_RUNS 1000000      /* Default.  */
+#define TARGET_TIME_MS 200    /* Default.  */
+
+/* Each timed loop of NUM_RUNS calls is repeated NUM_REPS times after
+   NUM_WARMUP untimed repetitions.  The median of the repetitions is
+   reported as the execution time, see main-stats.cc.  */
+#define NUM_REPS   10         /* Default.  */
+#define NUM_WARMUP 1          /* Default.  */
+
+/* Working set to run the functions over, see main-working-set.cc.  The
+   default WORKING_SET_NONE runs the functions on a single pair of arrays.  */
+enum working_set_id {
+    WORKING_SET_NONE = 0,
+    WORKING_SET_L1,
+    WORKING_SET_L2,
+    WORKING_SET_L3,
+    WORKING_SET_DRAM,
+};
+
+/* Default DRAM working set size as a multiple of the last level cache.  */
+#define DRAM_LLC_MULTIPLE 8
+
+/* Default regression threshold for --compare, in percent.  A test is only
+   flagged if the whole confidence interval of the slowdown is above the
+   threshold, see main-output.cc.  */
+#define COMPARE_THRESHOLD 5.0
+
+/* CPU placement of the threads of the thread scaling test, see
+   main-threads.cc.  Compact fills the SMT threads of a core before moving
+   to the next core, spread places one thread per core first.  */
+enum placement_id {
+    PLACEMENT_COMPACT = 0,
+    PLACEMENT_SPREAD,
+};
+
+/* Pages backing the working set databases, see arena.h.  */
+enum page_size_id {
+    PAGE_SIZE_DEFAULT = 0,
+    PAGE_SIZE_BASE,
+    PAGE_SIZE_THP,
+    PAGE_SIZE_HUGETLB,
+};
+
+/* Offset sweep step, see main-offsets.cc.  */
+enum offset_sweep_id {
+    OFFSET_SWEEP_NONE = 0,
+    OFFSET_SWEEP_BYTES,
+    OFFSET_SWEEP_FLOATS,
+};
+
+/* NUMA placement of the working set databases, see main-numa.cc.  */
+enum numa_policy_id {
+    NUMA_FIRST_TOUCH = 0,
+    NUMA_LOCAL,
+    NUMA_REMOTE,
+    NUMA_INTERLEAVE,
+    NUMA_NODE,
+};
+
+/* Number of nearest neighbors and maximum number of queries of the k-NN
+   recall test run with --queries, see main-recall.cc.  */
+#define RECALL_K            10    /* Default.  */
+#define NUM_RECALL_QUERIES  100   /* Default.  */
 
 struct flags_t {
-    int array_sizes[MAX_ARRAY_SIZES];
+    std::vector<int> array_sizes;
     int num_runs = NUM_RUNS;
+    bool calibrate = true;          /* False if -R is given.  */
+    double target_time_ms = TARGET_TIME_MS;
     int num_array_sizes = 0;
     bool run_func_flag[FUNC_ID_MAX];
     bool run_un_optimized = false;
@@ -90,6 +160,49 @@ struct flags_t {
     bool verbose_output = false;
     bool run_subset = false;
     bool run_code_version[NUM_CODE_VERSIONS];
+    int working_set = WORKING_SET_NONE;
+    int llc_multiple = DRAM_LLC_MULTIPLE;
+    bool random_access = false;
+    int num_reps = NUM_REPS;
+    int num_warmup = NUM_WARMUP;
+    bool pin_cpu = true;
+    int cpu = -1;                   /* -1, pin to the CPU we start on.  */
+    int num_threads = 1;
+    std::vector<int> thread_counts;      /* Empty, no thread scaling test.  */
+    std::vector<int> thread_cpus;        /* Empty, CPUs set by placement.  */
+    int placement = PLACEMENT_COMPACT;
+    bool shared_db = false;
+    int thread_node = -1;                /* -1, threads on all nodes.  */
+    int numa_policy = NUMA_FIRST_TOUCH;
+    int numa_node = 0;                   /* Node of NUMA_NODE.  */
+    bool numa_replicas = false;
+    bool numa_matrix = false;
+    int page_size = PAGE_SIZE_DEFAULT;
+    int offset_sweep = OFFSET_SWEEP_NONE;
+    int accuracy_trials = 0;        /* 0, no accuracy test.  */
+    int fuzz_iterations = 0;        /* 0, time the functions.  */
+    bool fixed_dim = false;
+    std::vector<int> multi_acc_counts;   /* Empty, no accumulator test.  */
+    bool cosine_modes = false;
+    bool sparse = false;
+    bool maxsim = false;
+    bool range_search = false;
+    bool filter_sweep = false;
+    bool early_abandon = false;         /* In the recall test.  */
+    bool panel = false;
+    std::vector<int> parallel_counts;    /* Empty, no parallel engines.  */
+    bool pairwise = false;
+    const char *json_file = NULL;   /* NULL, use the default file name.  */
+    const char *csv_file = NULL;
+    const char *compare_file = NULL;
+    double compare_threshold = COMPARE_THRESHOLD;
+    bool perf_counters = false;
+    long long int perf_raw_event = -1;   /* -1, no raw event.  */
+    const char *dataset_file = NULL;     /* NULL, generated test data.  */
+    const char *queries_file = NULL;
+    const char *groundtruth_file = NULL;
+    int recall_k = RECALL_K;
+    int num_queries = NUM_RECALL_QUERIES;
 };
 
 /* The indexes to access the group names in group_id_name */
@@ -111,6 +224,9 @@ void print_cmd_opts (struct flags_t cmd_flags,
 
 void initialize_group_func_names (char group_id_name[][GROUP_ID_NAME_MAX],
                                   struct results_data_t *result);
+void print_group_name (std::ofstream &out_file, int *group_id, int index,
+                       struct results_data_t* result,
+                       char group_id_name[][GROUP_ID_NAME_MAX]);
 void print_time (std::ofstream &out_file, int fun_index, int array_index,
                  struct results_data_t* result,
                  struct flags_t cmd_flags,
@@ -124,3 +240,5 @@ void setup_function_info(struct results_data_t *result, int fun_id,
                          int test_group,
                          const char* name, bool optimized,
                          bool output_excluded);
+
+#endif /* MAIN_HELPERS_H */
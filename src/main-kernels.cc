@@ -0,0 +1,238 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include "main-kernels.h"
+#include "main-supported.h"
+
+/* declared in main-tests.cc  */
+void check_fun_id (unsigned int fun_id);
+
+/* Static storage, the function pointers not set below are NULL.  */
+static struct kernel_info_t kernel_table[FUNC_ID_MAX];
+
+static void
+setup_fvec_pair (unsigned int fun_id, fvec_pair_fn_t base_fn,
+                 fvec_pair_fn_t optimized_fn, fvec_pair_fn_t intrinsic_fn)
+{
+    check_fun_id (fun_id);
+    kernel_table[fun_id].sig = SIG_FVEC_PAIR;
+    kernel_table[fun_id].elem_size = sizeof (float);
+    kernel_table[fun_id].fvec_pair[CODE_VER_ORIG] = base_fn;
+    kernel_table[fun_id].fvec_pair[CODE_OPTIMIZED_PPC] = optimized_fn;
+    kernel_table[fun_id].fvec_pair[CODE_INTRINSIC_PPC] = intrinsic_fn;
+}
+
+static void
+setup_fvec_norm (unsigned int fun_id, fvec_norm_fn_t base_fn,
+                 fvec_norm_fn_t optimized_fn, fvec_norm_fn_t intrinsic_fn)
+{
+    check_fun_id (fun_id);
+    kernel_table[fun_id].sig = SIG_FVEC_NORM;
+    kernel_table[fun_id].elem_size = sizeof (float);
+    kernel_table[fun_id].fvec_norm[CODE_VER_ORIG] = base_fn;
+    kernel_table[fun_id].fvec_norm[CODE_OPTIMIZED_PPC] = optimized_fn;
+    kernel_table[fun_id].fvec_norm[CODE_INTRINSIC_PPC] = intrinsic_fn;
+}
+
+static void
+setup_fvec_batch_4 (unsigned int fun_id, fvec_batch_4_fn_t base_fn,
+                    fvec_batch_4_fn_t optimized_fn,
+                    fvec_batch_4_fn_t intrinsic_fn)
+{
+    check_fun_id (fun_id);
+    kernel_table[fun_id].sig = SIG_FVEC_BATCH_4;
+    kernel_table[fun_id].elem_size = sizeof (float);
+    kernel_table[fun_id].fvec_batch_4[CODE_VER_ORIG] = base_fn;
+    kernel_table[fun_id].fvec_batch_4[CODE_OPTIMIZED_PPC] = optimized_fn;
+    kernel_table[fun_id].fvec_batch_4[CODE_INTRINSIC_PPC] = intrinsic_fn;
+}
+
+static void
+setup_fvec_ny_transposed (unsigned int fun_id,
+                          fvec_ny_transposed_fn_t base_fn,
+                          fvec_ny_transposed_fn_t optimized_fn,
+                          fvec_ny_transposed_fn_t intrinsic_fn)
+{
+    check_fun_id (fun_id);
+    kernel_table[fun_id].sig = SIG_FVEC_NY_TRANSPOSED;
+    kernel_table[fun_id].elem_size = sizeof (float);
+    kernel_table[fun_id].fvec_ny_transposed[CODE_VER_ORIG] = base_fn;
+    kernel_table[fun_id].fvec_ny_transposed[CODE_OPTIMIZED_PPC] = optimized_fn;
+    kernel_table[fun_id].fvec_ny_transposed[CODE_INTRINSIC_PPC] = intrinsic_fn;
+}
+
+static void
+setup_ivec_pair (unsigned int fun_id, ivec_pair_fn_t base_fn,
+                 ivec_pair_fn_t optimized_fn, ivec_pair_fn_t intrinsic_fn)
+{
+    check_fun_id (fun_id);
+    kernel_table[fun_id].sig = SIG_IVEC_PAIR;
+    kernel_table[fun_id].elem_size = sizeof (int8_t);
+    kernel_table[fun_id].ivec_pair[CODE_VER_ORIG] = base_fn;
+    kernel_table[fun_id].ivec_pair[CODE_OPTIMIZED_PPC] = optimized_fn;
+    kernel_table[fun_id].ivec_pair[CODE_INTRINSIC_PPC] = intrinsic_fn;
+}
+
+static void
+setup_bvec_pair (unsigned int fun_id, bvec_pair_fn_t base_fn,
+                 bvec_pair_fn_t optimized_fn, bvec_pair_fn_t intrinsic_fn)
+{
+    check_fun_id (fun_id);
+    kernel_table[fun_id].sig = SIG_BVEC_PAIR;
+    kernel_table[fun_id].elem_size = sizeof (uint8_t);
+    kernel_table[fun_id].bvec_pair[CODE_VER_ORIG] = base_fn;
+    kernel_table[fun_id].bvec_pair[CODE_OPTIMIZED_PPC] = optimized_fn;
+    kernel_table[fun_id].bvec_pair[CODE_INTRINSIC_PPC] = intrinsic_fn;
+}
+
+void
+initialize_kernel_table (void)
+{
+    /*  Euclidean functions.  */
+    setup_fvec_pair (FVEC_L2SQR_REF, base::fvec_L2sqr_ref,
+                     powerpc::fvec_L2sqr_ref_ppc,
+                     powerpc::fvec_L2sqr_ref_ippc);
+
+    setup_fvec_norm (FVEC_NORM_L2SQR_REF, base::fvec_norm_L2sqr_ref,
+                     powerpc::fvec_norm_L2sqr_ref_ppc,
+                     powerpc::fvec_norm_L2sqr_ref_ippc);
+
+    setup_fvec_ny_transposed (FVEC_L2SQR_NY_TRANSPOSED_REF,
+                              base::fvec_L2sqr_ny_transposed_ref,
+                              powerpc::fvec_L2sqr_ny_transposed_ref_ppc,
+                              powerpc::fvec_L2sqr_ny_transposed_ref_ippc);
+
+    setup_fvec_batch_4 (FVEC_L2SQR_BATCH_4_REF, base::fvec_L2sqr_batch_4_ref,
+                        powerpc::fvec_L2sqr_batch_4_ref_ppc,
+                        powerpc::fvec_L2sqr_batch_4_ref_ippc);
+
+    setup_ivec_pair (IVEC_L2SQR_REF, base::ivec_L2sqr_ref,
+                     powerpc::ivec_L2sqr_ref_ppc,
+                     powerpc::ivec_L2sqr_ref_ippc);
+
+    /*  Inner product functions.  */
+    setup_fvec_pair (FVEC_INNER_PRODUCT_REF, base::fvec_inner_product_ref,
+                     powerpc::fvec_inner_product_ref_ppc,
+                     powerpc::fvec_inner_product_ref_ippc);
+
+    setup_fvec_batch_4 (FVEC_INNER_PRODUCT_BATCH_4_REF,
+                        base::fvec_inner_product_batch_4_ref,
+                        powerpc::fvec_inner_product_batch_4_ref_ppc,
+                        powerpc::fvec_inner_product_batch_4_ref_ippc);
+
+    setup_ivec_pair (IVEC_INNER_PRODUCT_REF, base::ivec_inner_product_ref,
+                     powerpc::ivec_inner_product_ref_ppc,
+                     powerpc::ivec_inner_product_ref_ippc);
+
+    /* Manhattan, cosine and Jaccard functions.  */
+    setup_fvec_pair (FVEC_L1_REF, base::fvec_L1_ref,
+                     powerpc::fvec_L1_ref_ppc, powerpc::fvec_L1_ref_ippc);
+
+    setup_fvec_pair (COSINE_DISTANCE_REF, base::cosine_distance_ref,
+                     powerpc::cosine_distance_ref_ppc,
+                     powerpc::cosine_distance_ref_ippc);
+
+    setup_fvec_pair (JACCARD_DISTANCE_REF, base::jaccard_distance_ref,
+                     powerpc::jaccard_distance_ref_ppc,
+                     powerpc::jaccard_distance_ippc);
+
+    /* Hamming function.  The vector versions need vec_popcnt, fall back to
+       the base version if it is not supported.  */
+#if VEC_POPCNT_SUPPORTED
+    setup_bvec_pair (HAMMING_DISTANCE_REF, base::hamming_distance_ref,
+                     powerpc::hamming_distance_ref_ppc,
+                     powerpc::hamming_distance_ref_ippc);
+#else
+    setup_bvec_pair (HAMMING_DISTANCE_REF, base::hamming_distance_ref,
+                     base::hamming_distance_ref,
+                     base::hamming_distance_ref);
+#endif
+}
+
+const struct kernel_info_t*
+get_kernel_info (unsigned int fun_id)
+{
+    using namespace std;
+
+    check_fun_id (fun_id);
+
+    if (kernel_table[fun_id].sig == -1)
+    {
+        cout << "ERROR, get_kernel_info: no kernel table entry for func_id "
+             << fun_id << ", exiting.\n";
+        exit(-1);
+    }
+    return &kernel_table[fun_id];
+}
+
+/* Call the code_ver version of the function of info on in and store its
+   results, NY_DISTANCE at most, in out.  Returns the number of results, 0
+   if there is no such version.  */
+unsigned int
+call_kernel (const struct kernel_info_t *info, unsigned int code_ver,
+             const struct kernel_inputs_t *in, size_t d, double *out)
+{
+    float dis[NY_DISTANCE];
+    unsigned int i;
+
+    switch (info->sig)
+    {
+    case SIG_FVEC_PAIR:
+        if (!info->fvec_pair[code_ver])
+            return 0;
+        out[0] = info->fvec_pair[code_ver] (in->x, in->y[0], d);
+        return 1;
+
+    case SIG_FVEC_NORM:
+        if (!info->fvec_norm[code_ver])
+            return 0;
+        out[0] = info->fvec_norm[code_ver] (in->x, d);
+        return 1;
+
+    case SIG_FVEC_BATCH_4:
+        if (!info->fvec_batch_4[code_ver])
+            return 0;
+        info->fvec_batch_4[code_ver] (in->x, in->y[0], in->y[1], in->y[2],
+                                      in->y[3], d, dis[0], dis[1], dis[2],
+                                      dis[3]);
+        for (i = 0; i < 4; i++)
+            out[i] = dis[i];
+        return 4;
+
+    case SIG_FVEC_NY_TRANSPOSED:
+        if (!info->fvec_ny_transposed[code_ver])
+            return 0;
+        info->fvec_ny_transposed[code_ver] (dis, in->x, in->yt, in->y_sqlen,
+                                            d, NY_DISTANCE, NY_DISTANCE);
+        for (i = 0; i < NY_DISTANCE; i++)
+            out[i] = dis[i];
+        return NY_DISTANCE;
+
+    case SIG_IVEC_PAIR:
+        if (!info->ivec_pair[code_ver])
+            return 0;
+        out[0] = info->ivec_pair[code_ver] (in->xi, in->yi, d);
+        return 1;
+
+    case SIG_BVEC_PAIR:
+        if (!info->bvec_pair[code_ver])
+            return 0;
+        out[0] = info->bvec_pair[code_ver] (in->c1, in->c2, d);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_KERNELS_H
+#define MAIN_KERNELS_H
+
+#include "main-tests.h"
+
+/* The test_* functions in main-tests.cc call each distance function by
+   name.  The harness modes that run the functions over a database of vectors
+   instead look the functions up in the kernel table.  The table has an entry
+   for each func_id with a pointer to the base, optimized and intrinsic
+   version of the function.  Only the pointer array matching the argument
+   signature of the function is set.  */
+
+enum kernel_sig_id {
+    SIG_FVEC_PAIR = 0,        /* float fn (x, y, d)  */
+    SIG_FVEC_NORM,            /* float fn (x, d)  */
+    SIG_FVEC_BATCH_4,         /* void fn (x, y0, y1, y2, y3, d, dis0..dis3)  */
+    SIG_FVEC_NY_TRANSPOSED,   /* void fn (dis, x, y, y_sqlen, d, d_offset,
+                                          ny)  */
+    SIG_IVEC_PAIR,            /* int32_t fn (x, y, d), int8_t data  */
+    SIG_BVEC_PAIR,            /* size_t fn (x, y, size), uint8_t data  */
+    SIG_ID_MAX,
+};
+
+typedef float (*fvec_pair_fn_t) (const float* x, const float* y, size_t d);
+typedef float (*fvec_norm_fn_t) (const float* x, size_t d);
+typedef void (*fvec_batch_4_fn_t) (const float* x, const float* y0,
+                                   const float* y1, const float* y2,
+                                   const float* y3, const size_t d,
+                                   float& dis0, float& dis1, float& dis2,
+                                   float& dis3);
+typedef void (*fvec_ny_transposed_fn_t) (float* dis, const float* x,
+                                         const float* y, const float* y_sqlen,
+                                         size_t d, size_t d_offset,
+                                         size_t ny);
+typedef int32_t (*ivec_pair_fn_t) (const int8_t* x, const int8_t* y,
+                                   size_t d);
+typedef size_t (*bvec_pair_fn_t) (const uint8_t* x, const uint8_t* y,
+                                  size_t size);
+
+struct kernel_info_t {
+    int sig = -1;                  /* enum kernel_sig_id  */
+    size_t elem_size = 0;          /* Size of one vector element in bytes.  */
+    fvec_pair_fn_t fvec_pair[NUM_CODE_VERSIONS];
+    fvec_norm_fn_t fvec_norm[NUM_CODE_VERSIONS];
+    fvec_batch_4_fn_t fvec_batch_4[NUM_CODE_VERSIONS];
+    fvec_ny_transposed_fn_t fvec_ny_transposed[NUM_CODE_VERSIONS];
+    ivec_pair_fn_t ivec_pair[NUM_CODE_VERSIONS];
+    bvec_pair_fn_t bvec_pair[NUM_CODE_VERSIONS];
+};
+
+/* The inputs of one call through the kernel table.  y holds the vectors of
+   the pair and batch_4 functions.  yt holds NY_DISTANCE vectors transposed
+   for the ny_transposed function, which is called with d_offset and ny set
+   to NY_DISTANCE, and y_sqlen their squared lengths.  */
+struct kernel_inputs_t {
+    const float *x;
+    const float *y[4];
+    const float *yt;
+    const float *y_sqlen;
+    const int8_t *xi, *yi;
+    const uint8_t *c1, *c2;
+};
+
+void initialize_kernel_table (void);
+const struct kernel_info_t* get_kernel_info (unsigned int fun_id);
+
+unsigned int call_kernel (const struct kernel_info_t *info,
+                          unsigned int code_ver,
+                          const struct kernel_inputs_t *in, size_t d,
+                          double *out);
+
+#endif /* MAIN_KERNELS_H */
@@ -0,0 +1,374 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* MaxSim late interaction scoring.  With --maxsim a query of
+   MAXSIM_QUERY_TOKENS token vectors of the array size is scored against
+   MAXSIM_NUM_DOCS documents of MAXSIM_MIN_DOC_TOKENS to
+   MAXSIM_MAX_DOC_TOKENS token vectors per code version, with one
+   fvec_inner_product_ref call per pair of tokens, with the blocked
+   maxsim_ref and with int8 tokens.  The documents per second are reported
+   and the scores are checked against the base version.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-maxsim.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "distances/base/maxsim.h"
+#include "distances/optimized/maxsim.h"
+#include "distances/intrinsic/maxsim.h"
+
+static std::vector<struct maxsim_result_t> maxsim_results;
+
+typedef float (*maxsim_fn_t) (const float* q, size_t nq, const float* doc,
+                              size_t nd, size_t d, size_t stride);
+typedef int64_t (*ivec_maxsim_fn_t) (const int8_t* q, size_t nq,
+                                     const int8_t* doc, size_t nd, size_t d,
+                                     size_t stride);
+
+/* The MaxSim functions of one code version.  */
+struct maxsim_kernels_t {
+    fvec_pair_fn_t ip;
+    maxsim_fn_t maxsim;
+    ivec_maxsim_fn_t ivec_maxsim;
+};
+
+static const struct maxsim_kernels_t maxsim_kernels[NUM_CODE_VERSIONS] = {
+    {base::fvec_inner_product_ref, base::maxsim_ref, base::ivec_maxsim_ref},
+    {powerpc::fvec_inner_product_ref_ppc, powerpc::maxsim_ref_ppc,
+     powerpc::ivec_maxsim_ref_ppc},
+    {powerpc::fvec_inner_product_ref_ippc, powerpc::maxsim_ref_ippc,
+     powerpc::ivec_maxsim_ref_ippc},
+};
+
+static const char*
+maxsim_mode_name (unsigned int mode)
+{
+    switch (mode)
+    {
+    case MAXSIM_MODE_IP_CALLS:
+        return "ip_calls";
+    case MAXSIM_MODE_BLOCKED:
+        return "blocked";
+    case MAXSIM_MODE_INT8:
+        return "int8";
+    }
+    return "unknown";
+}
+
+static const char*
+maxsim_function_name (unsigned int mode)
+{
+    switch (mode)
+    {
+    case MAXSIM_MODE_IP_CALLS:
+        return "fvec_inner_product_ref";
+    case MAXSIM_MODE_BLOCKED:
+        return "maxsim_ref";
+    case MAXSIM_MODE_INT8:
+        return "ivec_maxsim_ref";
+    }
+    return "unknown";
+}
+
+/* The query and the documents, document i is the tokens doc_start[i] to
+   doc_start[i + 1] - 1 of doc.  The tokens are stride values apart, the
+   int8 copies stride8 values apart hold independent random values.  */
+struct maxsim_db_t {
+    const float *q;
+    const float *doc;
+    const int8_t *q8;
+    const int8_t *doc8;
+    size_t doc_start[MAXSIM_NUM_DOCS + 1];
+    size_t d;
+    size_t stride;
+    size_t stride8;
+};
+
+/* MaxSim with one inner product call per pair of tokens.  */
+static float
+maxsim_ip_calls (fvec_pair_fn_t ip, const float* q, size_t nq,
+                 const float* doc, size_t nd, size_t d, size_t stride)
+{
+    float res = 0, m;
+    size_t i, j;
+
+    for (i = 0; i < nq; i++)
+    {
+        m = -HUGE_VALF;
+        for (j = 0; j < nd; j++)
+            m = std::max (m, ip (q + i * stride, doc + j * stride, d));
+        res += m;
+    }
+    return res;
+}
+
+/* Score the documents, the score of document i goes to scores[i].  */
+static void
+run_maxsim_pass (const struct maxsim_kernels_t *k, unsigned int mode,
+                 const struct maxsim_db_t *db, double *scores)
+{
+    size_t i, start, nd;
+
+    for (i = 0; i < MAXSIM_NUM_DOCS; i++)
+    {
+        start = db->doc_start[i];
+        nd = db->doc_start[i + 1] - start;
+
+        switch (mode)
+        {
+        case MAXSIM_MODE_IP_CALLS:
+            scores[i] = maxsim_ip_calls (k->ip, db->q, MAXSIM_QUERY_TOKENS,
+                                         db->doc + start * db->stride, nd,
+                                         db->d, db->stride);
+            break;
+
+        case MAXSIM_MODE_BLOCKED:
+            scores[i] = k->maxsim (db->q, MAXSIM_QUERY_TOKENS,
+                                   db->doc + start * db->stride, nd, db->d,
+                                   db->stride);
+            break;
+
+        case MAXSIM_MODE_INT8:
+            scores[i] = k->ivec_maxsim (db->q8, MAXSIM_QUERY_TOKENS,
+                                        db->doc8 + start * db->stride8, nd,
+                                        db->d, db->stride8);
+            break;
+        }
+    }
+}
+
+void
+run_maxsim_tests (unsigned int array_index, struct flags_t cmd_flags)
+{
+    using namespace std;
+    size_t first = maxsim_results.size ();
+    size_t d = cmd_flags.array_sizes[array_index];
+    struct arena_t arena;
+    struct maxsim_db_t db;
+    float *q, *doc;
+    int8_t *q8, *doc8;
+    double scores[MAXSIM_NUM_DOCS], ref[MAXSIM_NUM_DOCS];
+    double ref8[MAXSIM_NUM_DOCS];
+    unsigned long long int t0, t1;
+    unsigned int code_ver, mode;
+    size_t k, j, num_tokens;
+    int rep;
+
+    if (!cmd_flags.run_func_flag[FVEC_INNER_PRODUCT_REF])
+        return;
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        for (mode = 0; mode < MAXSIM_MODE_MAX; mode++)
+        {
+            struct maxsim_result_t res;
+
+            res.array_index = array_index;
+            res.code_ver = code_ver;
+            res.mode = mode;
+            maxsim_results.push_back (res);
+        }
+    }
+
+    if (first == maxsim_results.size ())
+        return;
+
+    cout << "  MaxSim late interaction" << endl;
+
+    mt19937 gen (MAXSIM_SEED + d);
+    uniform_int_distribution<size_t> doc_tokens (MAXSIM_MIN_DOC_TOKENS,
+                                                 MAXSIM_MAX_DOC_TOKENS);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+    uniform_int_distribution<int> value8 (-128, 127);
+
+    db.doc_start[0] = 0;
+    for (j = 0; j < MAXSIM_NUM_DOCS; j++)
+        db.doc_start[j + 1] = db.doc_start[j] + doc_tokens (gen);
+    num_tokens = db.doc_start[MAXSIM_NUM_DOCS];
+
+    /* The tokens of all of the documents are padded vectors of one
+       allocation.  */
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    q = (float *) arena_alloc_vectors (&arena, MAXSIM_QUERY_TOKENS, d,
+                                       sizeof (float));
+    doc = (float *) arena_alloc_vectors (&arena, num_tokens, d,
+                                         sizeof (float));
+    q8 = (int8_t *) arena_alloc_vectors (&arena, MAXSIM_QUERY_TOKENS, d, 1);
+    doc8 = (int8_t *) arena_alloc_vectors (&arena, num_tokens, d, 1);
+    db.stride = arena_padded_dim (d, sizeof (float));
+    db.stride8 = arena_padded_dim (d, 1);
+
+    for (k = 0; k < MAXSIM_QUERY_TOKENS; k++)
+        for (j = 0; j < d; j++)
+        {
+            q[k * db.stride + j] = value (gen);
+            q8[k * db.stride8 + j] = value8 (gen);
+        }
+    for (k = 0; k < num_tokens; k++)
+        for (j = 0; j < d; j++)
+        {
+            doc[k * db.stride + j] = value (gen);
+            doc8[k * db.stride8 + j] = value8 (gen);
+        }
+
+    db.q = q;
+    db.doc = doc;
+    db.q8 = q8;
+    db.doc8 = doc8;
+    db.d = d;
+
+    /* Interleave the versions and modes across the repetitions as in
+       main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < maxsim_results.size (); k++)
+        {
+            struct maxsim_result_t *res = &maxsim_results[k];
+
+            t0 = get_time ();
+            run_maxsim_pass (&maxsim_kernels[res->code_ver], res->mode, &db,
+                             scores);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                res->samples.push_back (t1 - t0);
+        }
+
+    /* Check the float modes against the base version with one inner
+       product call per token pair and the int8 mode against the base int8
+       version.  The difference is relative to the score.  */
+    run_maxsim_pass (&maxsim_kernels[CODE_VER_ORIG], MAXSIM_MODE_IP_CALLS,
+                     &db, ref);
+    run_maxsim_pass (&maxsim_kernels[CODE_VER_ORIG], MAXSIM_MODE_INT8, &db,
+                     ref8);
+
+    for (k = first; k < maxsim_results.size (); k++)
+    {
+        struct maxsim_result_t *res = &maxsim_results[k];
+        const double *expected = res->mode == MAXSIM_MODE_INT8 ? ref8 : ref;
+
+        compute_time_stats (res->samples, &res->stats);
+
+        run_maxsim_pass (&maxsim_kernels[res->code_ver], res->mode, &db,
+                         scores);
+        for (j = 0; j < MAXSIM_NUM_DOCS; j++)
+            check_rel_error (&res->max_err, scores[j], expected[j]);
+        res->mismatch = !(res->max_err < ERR_THRESHOLD);
+
+        if (res->mismatch)
+            cout << "WARNING, MaxSim " << code_version_name (res->code_ver)
+                 << " version, " << maxsim_mode_name (res->mode)
+                 << " mode, array size " << d
+                 << ", differs from the base version by " << res->max_err
+                 << ".\n";
+    }
+
+    arena_release (&arena);
+}
+
+/* Documents per second from the median time of a pass.  */
+static double
+maxsim_docs_per_s (const struct maxsim_result_t *res)
+{
+    return MAXSIM_NUM_DOCS * 1e9 / res->stats.median;
+}
+
+/* One row per array size and code version with the documents per second
+   of each mode, then the speedup of each mode over the inner product
+   calls.  */
+void
+print_maxsim_tests (std::ofstream &out_file, struct flags_t cmd_flags)
+{
+    unsigned int mode;
+    size_t n;
+
+    out_file << "MaxSim late interaction, documents per second for a query"
+             << " of " << MAXSIM_QUERY_TOKENS << " token\nvectors against "
+             << MAXSIM_NUM_DOCS << " documents of " << MAXSIM_MIN_DOC_TOKENS
+             << " to " << MAXSIM_MAX_DOC_TOKENS << " token vectors and the"
+             << " speedup\nover one inner product call per pair of tokens."
+             << "  Results that differ from\nthe base version are marked"
+             << " with !.\n";
+    out_file << "Function name\tarray size\tversion";
+    for (mode = 0; mode < MAXSIM_MODE_MAX; mode++)
+        out_file << "\t" << maxsim_mode_name (mode);
+    out_file << "\tspeedup";
+    for (mode = MAXSIM_MODE_IP_CALLS + 1; mode < MAXSIM_MODE_MAX; mode++)
+        out_file << "\t" << maxsim_mode_name (mode);
+    out_file << "\n";
+
+    /* The modes of an array size and version are consecutive.  */
+    for (n = 0; n + MAXSIM_MODE_MAX <= maxsim_results.size ();
+         n += MAXSIM_MODE_MAX)
+    {
+        const struct maxsim_result_t *row = &maxsim_results[n];
+
+        out_file << "  maxsim_ref\t" << cmd_flags.array_sizes[row->array_index]
+                 << "\t" << code_version_name (row->code_ver) << std::fixed
+                 << std::setprecision (0);
+        for (mode = 0; mode < MAXSIM_MODE_MAX; mode++)
+            out_file << "\t" << maxsim_docs_per_s (&row[mode])
+                     << (row[mode].mismatch ? "!" : "");
+
+        out_file << "\t" << std::setprecision (3);
+        for (mode = MAXSIM_MODE_IP_CALLS + 1; mode < MAXSIM_MODE_MAX; mode++)
+            out_file << "\t" << row[MAXSIM_MODE_IP_CALLS].stats.median
+                                / row[mode].stats.median;
+        out_file << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_maxsim_results (std::ofstream &out_file, struct flags_t cmd_flags,
+                           bool *first)
+{
+    for (size_t n = 0; n < maxsim_results.size (); n++)
+    {
+        const struct maxsim_result_t *res = &maxsim_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"maxsim_mode\": \"" << maxsim_mode_name (res->mode)
+             << "\", \"dim\": " << cmd_flags.array_sizes[res->array_index]
+             << ", \"dtype\": \""
+             << (res->mode == MAXSIM_MODE_INT8 ? "int8" : "float32")
+             << "\", \"query_tokens\": " << MAXSIM_QUERY_TOKENS
+             << ", \"num_docs\": " << MAXSIM_NUM_DOCS
+             << std::fixed << std::setprecision (1)
+             << ", \"docs_per_s\": " << maxsim_docs_per_s (res);
+
+        rec.mode = "maxsim";
+        rec.kernel = maxsim_function_name (res->mode);
+        rec.version = code_version_name (res->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        rec.err_key = "max_err";
+        rec.max_err = res->max_err;
+        rec.checked = true;
+        rec.mismatch = res->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_MAXSIM_H
+#define MAIN_MAXSIM_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+#define MAXSIM_QUERY_TOKENS     32
+#define MAXSIM_MIN_DOC_TOKENS   100
+#define MAXSIM_MAX_DOC_TOKENS   300
+#define MAXSIM_NUM_DOCS         16      /* Documents per timed pass.  */
+#define MAXSIM_SEED             1618
+
+/* Ways of scoring the documents.  */
+enum maxsim_mode_id {
+    MAXSIM_MODE_IP_CALLS = 0,   /* fvec_inner_product_ref per token pair.  */
+    MAXSIM_MODE_BLOCKED,        /* maxsim_ref.  */
+    MAXSIM_MODE_INT8,           /* ivec_maxsim_ref of int8 tokens.  */
+    MAXSIM_MODE_MAX,
+};
+
+/* Time of one array size, code version and mode.  */
+struct maxsim_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int mode = 0;
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base version.  */
+    bool mismatch = false;
+};
+
+void run_maxsim_tests (unsigned int array_index, struct flags_t cmd_flags);
+
+void print_maxsim_tests (std::ofstream &out_file, struct flags_t cmd_flags);
+void write_json_maxsim_results (std::ofstream &out_file,
+                                struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_MAXSIM_H */
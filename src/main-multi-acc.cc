@@ -0,0 +1,388 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Multiple accumulator benchmark.  With --multi_acc <n1,n2,...>, the float
+   functions with multiple accumulator variants, see
+   distances/multi_acc/multi_acc.h, are timed with n1, n2, ... accumulators.
+   One accumulator is the intrinsic version.  The throughput is reported in
+   elements per ns and, with --perf_counters, elements per cycle, from the
+   fastest repetition, along with the peak of each variant over the array
+   sizes.  Array sizes that fit in the L1 show the throughput limit of the
+   loop itself.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include "main-multi-acc.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-perf.h"
+#include "main-output.h"
+#include "distances/multi_acc/multi_acc.h"
+
+static std::vector<struct multi_acc_result_t> multi_acc_results;
+
+/* The variant of function fun_id with nacc accumulators.  Sets the pair or
+   the norm function pointer, returns false if there is no variant.  */
+static bool
+multi_acc_kernel (unsigned int fun_id, unsigned int nacc,
+                  fvec_pair_fn_t *pair_fn, fvec_norm_fn_t *norm_fn)
+{
+    const struct kernel_info_t *kinfo = get_kernel_info (fun_id);
+
+    *pair_fn = NULL;
+    *norm_fn = NULL;
+
+    switch (fun_id)
+    {
+    case FVEC_L2SQR_REF:
+        *pair_fn = powerpc::fvec_L2sqr_multi_acc (nacc);
+        break;
+    case FVEC_NORM_L2SQR_REF:
+        *norm_fn = powerpc::fvec_norm_L2sqr_multi_acc (nacc);
+        break;
+    case FVEC_INNER_PRODUCT_REF:
+        *pair_fn = powerpc::fvec_inner_product_multi_acc (nacc);
+        break;
+    case FVEC_L1_REF:
+        *pair_fn = powerpc::fvec_L1_multi_acc (nacc);
+        break;
+    case COSINE_DISTANCE_REF:
+        *pair_fn = powerpc::cosine_distance_multi_acc (nacc);
+        break;
+    case JACCARD_DISTANCE_REF:
+        *pair_fn = powerpc::jaccard_distance_multi_acc (nacc);
+        break;
+    default:
+        return false;
+    }
+
+    /* One accumulator, the intrinsic version.  */
+    if (nacc == 1)
+    {
+        if (kinfo->sig == SIG_FVEC_NORM)
+            *norm_fn = kinfo->fvec_norm[CODE_INTRINSIC_PPC];
+        else
+            *pair_fn = kinfo->fvec_pair[CODE_INTRINSIC_PPC];
+    }
+
+    return *pair_fn != NULL || *norm_fn != NULL;
+}
+
+int
+parse_multi_acc_arg (const char *arg, struct flags_t *cmd_flags)
+{
+    /* A list of accumulator counts, each 1 or a count in MULTI_ACC_COUNTS.
+       Returns 1 if the list is malformed or a count has no variant.  The
+       options are read before the kernel table is set up, all of the
+       functions have the same counts.  */
+    if (parse_int_list (arg, cmd_flags->multi_acc_counts, 1))
+        return 1;
+
+    for (size_t n = 0; n < cmd_flags->multi_acc_counts.size (); n++)
+    {
+        int nacc = cmd_flags->multi_acc_counts[n];
+
+        if (nacc != 1 && !powerpc::fvec_L2sqr_multi_acc (nacc))
+            return 1;
+    }
+    return 0;
+}
+
+static float
+run_multi_acc_kernel (fvec_pair_fn_t pair_fn, fvec_norm_fn_t norm_fn,
+                      const float *x, const float *y, size_t d,
+                      unsigned int num_runs)
+{
+    float result = 0;
+    unsigned int i;
+
+    if (pair_fn)
+        for (i = 0; i < num_runs; i++)
+            result += pair_fn (x, y, d);
+    else
+        for (i = 0; i < num_runs; i++)
+            result += norm_fn (x, d);
+    return result;
+}
+
+/* Time each selected function that has multiple accumulator variants with
+   each accumulator count.  The number of runs is the one used for the
+   generic tests.  */
+void
+run_multi_acc_tests (struct results_data_t* result, unsigned int array_index,
+                     struct flags_t cmd_flags, const struct test_data_t *data)
+{
+    using namespace std;
+    size_t first = multi_acc_results.size ();
+    size_t d = data->size;
+    fvec_pair_fn_t pair_fn;
+    fvec_norm_fn_t norm_fn;
+    unsigned long long int t0, t1;
+    unsigned int i;
+    size_t k, n;
+    int rep;
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        for (n = 0; n < cmd_flags.multi_acc_counts.size (); n++)
+        {
+            struct multi_acc_result_t res;
+
+            if (!multi_acc_kernel (i, cmd_flags.multi_acc_counts[n],
+                                   &pair_fn, &norm_fn))
+                continue;
+
+            res.fun_id = i;
+            res.array_index = array_index;
+            res.nacc = cmd_flags.multi_acc_counts[n];
+            res.num_runs = result[i].num_runs[array_index];
+            multi_acc_results.push_back (res);
+        }
+    }
+
+    if (first == multi_acc_results.size ())
+        return;
+
+    cout << "  Multiple accumulator kernels" << endl;
+
+    /* Interleave the variants across the repetitions as in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < multi_acc_results.size (); k++)
+        {
+            struct multi_acc_result_t *res = &multi_acc_results[k];
+            struct perf_counts_t counts;
+
+            multi_acc_kernel (res->fun_id, res->nacc, &pair_fn, &norm_fn);
+
+            perf_counters_start ();
+            t0 = get_time ();
+            run_multi_acc_kernel (pair_fn, norm_fn, data->x, data->y0, d,
+                                  res->num_runs);
+            t1 = get_time ();
+            perf_counters_stop ();
+
+            if (rep < cmd_flags.num_warmup)
+                continue;
+
+            res->samples.push_back (t1 - t0);
+
+            /* Fewest cycles of the repetitions.  */
+            perf_counters_read (&counts);
+            if (counts.valid[PERF_CYCLES] && counts.value[PERF_CYCLES] > 0
+                && (res->min_cycles == 0
+                    || counts.value[PERF_CYCLES] < res->min_cycles))
+                res->min_cycles = counts.value[PERF_CYCLES];
+        }
+
+    for (k = first; k < multi_acc_results.size (); k++)
+    {
+        struct multi_acc_result_t *res = &multi_acc_results[k];
+        const struct kernel_info_t *kinfo = get_kernel_info (res->fun_id);
+        float ref;
+        double diff;
+
+        compute_time_stats (res->samples, &res->stats);
+
+        multi_acc_kernel (res->fun_id, res->nacc, &pair_fn, &norm_fn);
+        res->result = run_multi_acc_kernel (pair_fn, norm_fn, data->x,
+                                            data->y0, d, 1);
+        ref = run_multi_acc_kernel (kinfo->fvec_pair[CODE_VER_ORIG],
+                                    kinfo->fvec_norm[CODE_VER_ORIG],
+                                    data->x, data->y0, d, 1);
+
+        /* Relative difference as in print_results_check_flt, but absolute
+           for results under 1.  The cosine distance of almost parallel
+           vectors is the rounding error of the sums, which depends on the
+           order of the sums.  */
+        diff = fabs ((double) res->result - ref);
+        if (fabs (ref) > 1)
+            diff /= fabs (ref);
+        res->mismatch = !(diff < ERR_THRESHOLD);
+
+        if (res->mismatch)
+            cout << "WARNING, " << result[res->fun_id].function_name
+                 << " with " << res->nacc << " accumulators, array size "
+                 << d << ", differs from the base version.\n";
+    }
+}
+
+/* Elements per ns of the fastest repetition.  */
+static double
+multi_acc_elements_per_ns (const struct multi_acc_result_t *res,
+                           struct flags_t cmd_flags)
+{
+    if (res->stats.min == 0)
+        return 0;
+    return (double) cmd_flags.array_sizes[res->array_index] * res->num_runs
+           / res->stats.min;
+}
+
+/* Elements per cycle of the repetition with the fewest cycles, 0 without
+   cycle counts.  */
+static double
+multi_acc_elements_per_cycle (const struct multi_acc_result_t *res,
+                              struct flags_t cmd_flags)
+{
+    if (res->min_cycles == 0)
+        return 0;
+    return (double) cmd_flags.array_sizes[res->array_index] * res->num_runs
+           / res->min_cycles;
+}
+
+static void
+print_multi_acc_rate (std::ofstream &out_file, double rate)
+{
+    if (rate > 0)
+        out_file << rate;
+    else
+        out_file << "-";
+}
+
+/* One row per function, array size and accumulator count, then the peak
+   throughput of each function and count over the array sizes.  The speedup
+   is over the first count given.  */
+void
+print_multi_acc_tests (std::ofstream &out_file, struct results_data_t* result,
+                       struct flags_t cmd_flags)
+{
+    size_t n, m, k;
+
+    out_file << "Multiple accumulator kernels, median execution time per call"
+             << " in ns, elements\nper ns and per cycle of the fastest"
+             << " repetition and the speedup over the first\naccumulator"
+             << " count.  Results that differ from the base version are"
+             << " marked\nwith !.  Elements per cycle need --perf_counters.\n";
+    out_file << "Function name\tarray size\taccumulators\tns/call"
+             << "\telements/ns\telements/cycle\tspeedup\n";
+
+    out_file << std::fixed;
+    for (n = 0; n < multi_acc_results.size (); n = m)
+    {
+        const struct multi_acc_result_t *ref = &multi_acc_results[n];
+
+        for (m = n; m < multi_acc_results.size ()
+                 && multi_acc_results[m].fun_id == ref->fun_id
+                 && multi_acc_results[m].array_index == ref->array_index; m++)
+        {
+            const struct multi_acc_result_t *res = &multi_acc_results[m];
+
+            out_file << "  " << result[res->fun_id].function_name << "\t"
+                     << cmd_flags.array_sizes[res->array_index] << "\t"
+                     << res->nacc << "\t" << std::setprecision (2)
+                     << res->stats.median / res->num_runs
+                     << (res->mismatch ? "!" : "") << "\t"
+                     << std::setprecision (3);
+            print_multi_acc_rate (out_file,
+                                  multi_acc_elements_per_ns (res, cmd_flags));
+            out_file << "\t";
+            print_multi_acc_rate (out_file,
+                                  multi_acc_elements_per_cycle (res,
+                                                                cmd_flags));
+            out_file << "\t" << ref->stats.median / res->stats.median << "\n";
+        }
+    }
+
+    out_file << "\nPeak elements per ns and per cycle over the array sizes.\n";
+    out_file << "Function name\taccumulators\telements/ns\tarray size"
+             << "\telements/cycle\tarray size\n";
+    for (n = 0; n < multi_acc_results.size (); n++)
+    {
+        const struct multi_acc_result_t *res = &multi_acc_results[n];
+        const struct multi_acc_result_t *best_ns = res, *best_cycle = res;
+        bool printed = false;
+
+        /* Print each function and count once, at its first result.  */
+        for (k = 0; k < n && !printed; k++)
+            printed = (multi_acc_results[k].fun_id == res->fun_id
+                       && multi_acc_results[k].nacc == res->nacc);
+        if (printed)
+            continue;
+
+        for (k = n + 1; k < multi_acc_results.size (); k++)
+        {
+            const struct multi_acc_result_t *other = &multi_acc_results[k];
+
+            if (other->fun_id != res->fun_id || other->nacc != res->nacc)
+                continue;
+            if (multi_acc_elements_per_ns (other, cmd_flags)
+                > multi_acc_elements_per_ns (best_ns, cmd_flags))
+                best_ns = other;
+            if (multi_acc_elements_per_cycle (other, cmd_flags)
+                > multi_acc_elements_per_cycle (best_cycle, cmd_flags))
+                best_cycle = other;
+        }
+
+        out_file << "  " << result[res->fun_id].function_name << "\t"
+                 << res->nacc << "\t";
+        print_multi_acc_rate (out_file,
+                              multi_acc_elements_per_ns (best_ns, cmd_flags));
+        out_file << "\t" << cmd_flags.array_sizes[best_ns->array_index]
+                 << "\t";
+        if (multi_acc_elements_per_cycle (best_cycle, cmd_flags) > 0)
+            out_file << multi_acc_elements_per_cycle (best_cycle, cmd_flags)
+                     << "\t"
+                     << cmd_flags.array_sizes[best_cycle->array_index];
+        else
+            out_file << "-\t-";
+        out_file << "\n";
+    }
+    out_file << std::defaultfloat << std::setprecision (6) << "\n";
+}
+
+/* The variants are added to the JSON file as records with the version
+   multi_acc and the accumulator count.  */
+void
+write_json_multi_acc_results (std::ofstream &out_file,
+                              struct results_data_t* result,
+                              struct flags_t cmd_flags, bool *first)
+{
+    for (size_t n = 0; n < multi_acc_results.size (); n++)
+    {
+        const struct multi_acc_result_t *res = &multi_acc_results[n];
+        double per_cycle = multi_acc_elements_per_cycle (res, cmd_flags);
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"accumulators\": " << res->nacc
+             << ", \"dim\": " << cmd_flags.array_sizes[res->array_index]
+             << ", \"dtype\": \"" << func_dtype_name (res->fun_id)
+             << "\", \"threads\": 1, \"working_set\": \"none\""
+             << ", \"num_runs\": " << res->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"elements_per_ns\": "
+             << multi_acc_elements_per_ns (res, cmd_flags)
+             << ", \"elements_per_cycle\": ";
+        if (per_cycle > 0)
+            keys << per_cycle;
+        else
+            keys << "null";
+
+        rec.mode = "multi_acc";
+        rec.kernel = result[res->fun_id].function_name;
+        rec.version = "multi_acc";
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        rec.checked = true;
+        rec.mismatch = res->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
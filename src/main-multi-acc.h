@@ -0,0 +1,51 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_MULTI_ACC_H
+#define MAIN_MULTI_ACC_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+/* Time of one function, accumulator count and array size.  One accumulator
+   is the intrinsic version.  */
+struct multi_acc_result_t {
+    unsigned int fun_id = 0;
+    unsigned int array_index = 0;
+    unsigned int nacc = 0;
+    unsigned int num_runs = 0;
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    unsigned long long int min_cycles = 0;  /* 0, no cycle counts.  */
+    float result = 0;
+    bool mismatch = false;          /* Differs from the base version.  */
+};
+
+int parse_multi_acc_arg (const char *arg, struct flags_t *cmd_flags);
+
+void run_multi_acc_tests (struct results_data_t* result,
+                          unsigned int array_index, struct flags_t cmd_flags,
+                          const struct test_data_t *data);
+
+void print_multi_acc_tests (std::ofstream &out_file,
+                            struct results_data_t* result,
+                            struct flags_t cmd_flags);
+void write_json_multi_acc_results (std::ofstream &out_file,
+                                   struct results_data_t* result,
+                                   struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_MULTI_ACC_H */
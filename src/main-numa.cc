@@ -0,0 +1,94 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* NUMA placement of the working set databases.  By default a database is
+   placed on the node of the thread that first touches it.  With --numa the
+   databases are bound to the node of the thread (local), to another node
+   (remote), to a given node or interleaved over the nodes, see
+   storage/numa.cc.  */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "main-numa.h"
+
+/* Parse the --numa argument, first_touch, local, remote, interleave or
+   the node number.  */
+int
+parse_numa_arg (const char *arg, struct flags_t *cmd_flags)
+{
+    char *end;
+    long node;
+
+    if (strcmp (arg, "first_touch") == 0)
+        cmd_flags->numa_policy = NUMA_FIRST_TOUCH;
+    else if (strcmp (arg, "local") == 0)
+        cmd_flags->numa_policy = NUMA_LOCAL;
+    else if (strcmp (arg, "remote") == 0)
+        cmd_flags->numa_policy = NUMA_REMOTE;
+    else if (strcmp (arg, "interleave") == 0)
+        cmd_flags->numa_policy = NUMA_INTERLEAVE;
+    else
+    {
+        node = strtol (arg, &end, 10);
+        if (end == arg || *end != '\0' || node < 0 || node >= NUMA_MAX_NODES)
+            return 1;
+
+        cmd_flags->numa_policy = NUMA_NODE;
+        cmd_flags->numa_node = (int) node;
+    }
+    return 0;
+}
+
+const char*
+numa_policy_name (struct flags_t cmd_flags)
+{
+    static char name[32];
+
+    switch (cmd_flags.numa_policy)
+    {
+    case NUMA_LOCAL:
+        return "local";
+    case NUMA_REMOTE:
+        return "remote";
+    case NUMA_INTERLEAVE:
+        return "interleave";
+    case NUMA_NODE:
+        snprintf (name, sizeof (name), "node %d", cmd_flags.numa_node);
+        return name;
+    default:
+        return "first touch";
+    }
+}
+
+/* Memory node for a database used by a thread running on cpu.  */
+int
+numa_policy_node (struct flags_t cmd_flags, int cpu)
+{
+    switch (cmd_flags.numa_policy)
+    {
+    case NUMA_LOCAL:
+        return numa_node_of_cpu (cpu);
+    case NUMA_REMOTE:
+        return numa_remote_node (numa_node_of_cpu (cpu));
+    case NUMA_INTERLEAVE:
+        return NUMA_NODE_INTERLEAVE;
+    case NUMA_NODE:
+        return cmd_flags.numa_node;
+    default:
+        return NUMA_NODE_ANY;
+    }
+}
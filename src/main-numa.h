@@ -0,0 +1,27 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_NUMA_H
+#define MAIN_NUMA_H
+
+#include "main-helpers.h"
+#include "numa.h"
+
+int parse_numa_arg (const char *arg, struct flags_t *cmd_flags);
+const char* numa_policy_name (struct flags_t cmd_flags);
+int numa_policy_node (struct flags_t cmd_flags, int cpu);
+
+#endif /* MAIN_NUMA_H */
@@ -0,0 +1,328 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Offset sweep.  The test arrays start on a cache line, but the callers of
+   the functions pass vectors at any address.  With --offset_sweep each test
+   is repeated with all of the input arrays starting 0 to 15 bytes past a
+   cache line, or 0 to 3 floats with --offset_sweep floats.  The time per
+   call at each offset is reported, giving the cost of the misaligned loads,
+   and the result at each offset is checked against the result at offset 0,
+   catching functions that are only correct on aligned data, for example a
+   vector float pointer dereference compiled to a load that ignores the low
+   address bits.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include "main-offsets.h"
+#include "main-stats.h"
+#include "main-output.h"
+
+/* Results of all of the array sizes and offsets, printed at the end of the
+   run.  */
+static std::vector<struct offset_result_t> offset_results;
+
+int
+parse_offset_sweep_arg (const char *arg, struct flags_t *cmd_flags)
+{
+    if (strcmp (arg, "bytes") == 0)
+        cmd_flags->offset_sweep = OFFSET_SWEEP_BYTES;
+    else if (strcmp (arg, "floats") == 0)
+        cmd_flags->offset_sweep = OFFSET_SWEEP_FLOATS;
+    else
+        return 1;
+
+    return 0;
+}
+
+static unsigned int
+offset_step (struct flags_t cmd_flags)
+{
+    if (cmd_flags.offset_sweep == OFFSET_SWEEP_FLOATS)
+        return sizeof (float);
+
+    return 1;
+}
+
+/* A copy of n bytes of src starting offset bytes past a cache line.  */
+static void*
+offset_copy (struct arena_t *arena, const void *src, size_t n,
+             unsigned int offset)
+{
+    char *buf = (char *) arena_alloc (arena, n + offset);
+
+    memcpy (buf + offset, src, n);
+    return buf + offset;
+}
+
+static bool
+results_match (struct results_data_t* scratch, unsigned int fun_id,
+               unsigned int code_ver, const struct offset_result_t *ref)
+{
+    double diff;
+
+    if (scratch[fun_id].result_type == RESULT_INT)
+        return scratch[fun_id].result_i[0][code_ver] == ref->result_i;
+
+    /* Relative difference as in print_results_check_flt.  */
+    diff = fabs ((double) scratch[fun_id].result_f[0][code_ver]
+                 - ref->result_f);
+    if (ref->result_f != 0)
+        diff /= fabs (ref->result_f);
+
+    return diff < ERR_THRESHOLD;
+}
+
+/* Run the selected tests at each offset.  The number of runs of each test
+   is the one used for the aligned test.  */
+void
+run_offset_tests (struct results_data_t* result, unsigned int array_index,
+                  struct flags_t cmd_flags, const struct test_data_t *data)
+{
+    using namespace std;
+    struct results_data_t scratch[FUNC_ID_MAX];
+    size_t first = offset_results.size ();
+    size_t d = data->size;
+    size_t flt_bytes = d * sizeof (float);
+    unsigned int offset, i, code_ver;
+    int rep;
+
+    resize_results (scratch, 1);
+
+    cout << "  Offset sweep, " << OFFSET_SWEEP_MAX / offset_step (cmd_flags)
+         << " offsets" << endl;
+
+    for (offset = 0; offset < OFFSET_SWEEP_MAX;
+         offset += offset_step (cmd_flags))
+    {
+        struct arena_t arena;
+        struct test_data_t shifted = *data;
+
+        arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+        shifted.x = (const float *) offset_copy (&arena, data->x, flt_bytes,
+                                                 offset);
+        shifted.y0 = (const float *) offset_copy (&arena, data->y0, flt_bytes,
+                                                  offset);
+        shifted.y1 = (const float *) offset_copy (&arena, data->y1, flt_bytes,
+                                                  offset);
+        shifted.y2 = (const float *) offset_copy (&arena, data->y2, flt_bytes,
+                                                  offset);
+        shifted.y3 = (const float *) offset_copy (&arena, data->y3, flt_bytes,
+                                                  offset);
+        shifted.xi = (const int8_t *) offset_copy (&arena, data->xi, d,
+                                                   offset);
+        shifted.yi = (const int8_t *) offset_copy (&arena, data->yi, d,
+                                                   offset);
+        shifted.c1 = (const uint8_t *) offset_copy (&arena, data->c1, d,
+                                                    offset);
+        shifted.c2 = (const uint8_t *) offset_copy (&arena, data->c2, d,
+                                                    offset);
+        shifted.dis = (float *) offset_copy (&arena, data->dis,
+                                             NY_DISTANCE * sizeof (float),
+                                             offset);
+
+        for (i = 0; i < FUNC_ID_MAX; i++)
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+                scratch[i].time_samples[0][code_ver].clear ();
+
+        /* Interleave the tests across the repetitions as in main.  */
+        for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+            for (i = 0; i < FUNC_ID_MAX; i++)
+            {
+                if (!cmd_flags.run_func_flag[i])
+                    continue;
+
+                if (rep == cmd_flags.num_warmup)
+                    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS;
+                         code_ver++)
+                        scratch[i].time_samples[0][code_ver].clear ();
+
+                run_test (scratch, i, 0, result[i].num_runs[array_index],
+                          cmd_flags.run_code_version, &shifted);
+            }
+
+        for (i = 0; i < FUNC_ID_MAX; i++)
+        {
+            if (!cmd_flags.run_func_flag[i])
+                continue;
+
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            {
+                struct offset_result_t res;
+
+                if (!cmd_flags.run_code_version[code_ver])
+                    continue;
+
+                res.fun_id = i;
+                res.array_index = array_index;
+                res.code_ver = code_ver;
+                res.offset = offset;
+                res.num_runs = result[i].num_runs[array_index];
+                res.samples = scratch[i].time_samples[0][code_ver];
+                compute_time_stats (res.samples, &res.stats);
+                res.result_f = scratch[i].result_f[0][code_ver];
+                res.result_i = scratch[i].result_i[0][code_ver];
+
+                /* The offset 0 results are the first of this array
+                   size.  */
+                if (offset > 0)
+                    for (size_t k = first; k < offset_results.size (); k++)
+                    {
+                        const struct offset_result_t *ref
+                            = &offset_results[k];
+
+                        if (ref->offset == 0 && ref->fun_id == i
+                            && ref->code_ver == code_ver)
+                        {
+                            res.mismatch = !results_match (scratch, i,
+                                                           code_ver, ref);
+                            break;
+                        }
+                    }
+
+                if (res.mismatch)
+                {
+                    cout << "WARNING, " << result[i].function_name
+                         << " " << code_version_name (code_ver)
+                         << " version, array size " << d
+                         << ", gives a different result with the inputs "
+                         << offset << " bytes from a cache line.\n";
+                }
+                offset_results.push_back (res);
+            }
+        }
+
+        arena_release (&arena);
+    }
+}
+
+/* ns per call of res, 0 if not run.  */
+static double
+offset_ns_per_call (const struct offset_result_t *res)
+{
+    return res->num_runs ? res->stats.median / res->num_runs : 0;
+}
+
+/* One row per function, code version and array size with the median ns
+   per call at each offset, then the same relative to offset 0.  Results
+   that differ from the result at offset 0 are marked with a !.  */
+void
+print_offset_tests (std::ofstream &out_file, struct results_data_t* result,
+                    struct flags_t cmd_flags)
+{
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+    unsigned int offset;
+    int num_mismatches = 0;
+    size_t n, m;
+
+    for (n = 0; n < offset_results.size (); n++)
+        if (offset_results[n].mismatch)
+            num_mismatches++;
+
+    out_file << "Offset sweep, the input arrays start 0 to "
+             << OFFSET_SWEEP_MAX - 1 << " bytes past a cache line in steps"
+             << " of " << offset_step (cmd_flags) << " byte"
+             << (offset_step (cmd_flags) > 1 ? "s" : "") << ".\n"
+             << num_mismatches << " results differ from the result with"
+             << " aligned inputs, marked with !.\n";
+
+    for (int relative = 0; relative < 2; relative++)
+    {
+        if (relative)
+            out_file << "Time per call relative to offset 0.\n";
+        else
+            out_file << "Median execution time per call in ns.\n";
+
+        out_file << "Function name\tarray size\toffset\n\t\t";
+        for (offset = 0; offset < OFFSET_SWEEP_MAX;
+             offset += offset_step (cmd_flags))
+            out_file << offset << "\t";
+        out_file << "\n";
+
+        /* The results of each array size are in offset order, the offset
+           0 result of each function and code version starts a row.  */
+        for (n = 0; n < offset_results.size (); n++)
+        {
+            const struct offset_result_t *first = &offset_results[n];
+            double base_ns = offset_ns_per_call (first);
+
+            if (first->offset != 0)
+                continue;
+
+            out_file << "  " << result[first->fun_id].function_name
+                     << suffix[first->code_ver] << "\t"
+                     << cmd_flags.array_sizes[first->array_index];
+
+            for (m = n; m < offset_results.size (); m++)
+            {
+                const struct offset_result_t *res = &offset_results[m];
+                double ns = offset_ns_per_call (res);
+
+                if (res->array_index != first->array_index)
+                    break;
+                if (res->fun_id != first->fun_id
+                    || res->code_ver != first->code_ver)
+                    continue;
+
+                out_file << "\t" << std::fixed;
+                if (relative)
+                    out_file << std::setprecision (3)
+                             << (base_ns > 0 ? ns / base_ns : 0);
+                else
+                    out_file << std::setprecision (2) << ns;
+                out_file << (res->mismatch ? "!" : "") << std::defaultfloat;
+            }
+            out_file << "\n";
+        }
+        out_file << "\n";
+    }
+}
+
+/* The offset results are added to the JSON file as records with the offset
+   in bytes set.  They are not used by --compare.  */
+void
+write_json_offset_results (std::ofstream &out_file,
+                           struct results_data_t* result,
+                           struct flags_t cmd_flags, bool *first)
+{
+    for (size_t n = 0; n < offset_results.size (); n++)
+    {
+        const struct offset_result_t *res = &offset_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"dim\": " << cmd_flags.array_sizes[res->array_index]
+             << ", \"dtype\": \"" << func_dtype_name (res->fun_id)
+             << "\", \"threads\": 1, \"working_set\": \"none\""
+             << ", \"offset\": " << res->offset
+             << ", \"num_runs\": " << res->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ns_per_call\": " << offset_ns_per_call (res);
+
+        rec.mode = "offset_sweep";
+        rec.kernel = result[res->fun_id].function_name;
+        rec.version = code_version_name (res->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        rec.checked = true;
+        rec.mismatch = res->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
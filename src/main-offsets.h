@@ -0,0 +1,56 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_OFFSETS_H
+#define MAIN_OFFSETS_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+/* The input arrays are offset by 0 to OFFSET_SWEEP_MAX - 1 bytes from a
+   cache line, in steps of 1 byte or of one float.  */
+#define OFFSET_SWEEP_MAX 16
+
+/* Result of one function, code version and array size with the inputs at
+   one offset.  */
+struct offset_result_t {
+    unsigned int fun_id = 0;
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int offset = 0;        /* Bytes.  */
+    unsigned int num_runs = 0;
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    float result_f = 0;
+    long int result_i = 0;
+    bool mismatch = false;          /* Differs from the result at offset 0.  */
+};
+
+int parse_offset_sweep_arg (const char *arg, struct flags_t *cmd_flags);
+
+void run_offset_tests (struct results_data_t* result,
+                       unsigned int array_index, struct flags_t cmd_flags,
+                       const struct test_data_t *data);
+
+void print_offset_tests (std::ofstream &out_file,
+                         struct results_data_t* result,
+                         struct flags_t cmd_flags);
+void write_json_offset_results (std::ofstream &out_file,
+                                struct results_data_t* result,
+                                struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_OFFSETS_H */
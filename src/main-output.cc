@@ -0,0 +1,514 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Machine readable results.  Each measurement is written as one record
+   keyed by (kernel, version, dim, dtype, threads, working_set) to a JSON
+   and a CSV file.  The JSON file keeps the time of each repetition so a
+   later run can be compared against it with --compare.  The JSON records are
+   written one per line so read_json_results only needs to handle the files
+   written by write_json_results, not general JSON.  */
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "main-output.h"
+#include "main-threads.h"
+#include "main-offsets.h"
+#include "main-accuracy.h"
+#include "main-fixed-dim.h"
+#include "main-multi-acc.h"
+#include "main-cosine.h"
+#include "main-sparse.h"
+#include "main-maxsim.h"
+#include "main-range.h"
+#include "main-filter.h"
+#include "main-panel.h"
+#include "main-parallel.h"
+#include "main-pairwise.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-working-set.h"
+#include "main-perf.h"
+
+const char*
+code_version_name (int code_ver)
+{
+    switch (code_ver)
+    {
+    case CODE_VER_ORIG:
+        return "base";
+    case CODE_OPTIMIZED_PPC:
+        return "optimized";
+    case CODE_INTRINSIC_PPC:
+        return "intrinsic";
+    default:
+        return "unknown";
+    }
+}
+
+const char*
+func_dtype_name (unsigned int fun_id)
+{
+    const struct kernel_info_t *kinfo = get_kernel_info (fun_id);
+
+    switch (kinfo->sig)
+    {
+    case SIG_IVEC_PAIR:
+        return "int8";
+    case SIG_BVEC_PAIR:
+        return "uint8";
+    default:
+        return "float32";
+    }
+}
+
+void
+write_json_string (std::ostream &out_file, const char *str)
+{
+    out_file << "\"";
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            out_file << '\\';
+        out_file << *str;
+    }
+    out_file << "\"";
+}
+
+/* One record per line, see read_json_results.  The records after the
+   first one end the line of the previous record.  */
+void
+write_json_timing_record (std::ofstream &out_file, bool *first,
+                          const struct json_timing_record_t *rec)
+{
+    if (!*first)
+        out_file << ",\n";
+    *first = false;
+
+    out_file << "    {\"mode\": \"" << rec->mode << "\", \"kernel\": ";
+    write_json_string (out_file, rec->kernel);
+    out_file << ", \"version\": \"" << rec->version << "\"" << rec->keys
+             << std::fixed << std::setprecision (1)
+             << ", \"median_ns\": " << rec->stats->median
+             << ", \"min_ns\": " << rec->stats->min
+             << ", \"mean_ns\": " << rec->stats->mean
+             << ", \"p99_ns\": " << rec->stats->p99
+             << ", \"stddev_ns\": " << rec->stats->stddev
+             << std::defaultfloat << std::setprecision (6);
+
+    /* JSON has no infinity or NaN.  */
+    if (rec->err_key)
+    {
+        out_file << ", \"" << rec->err_key << "\": ";
+        if (std::isfinite (rec->max_err))
+            out_file << rec->max_err;
+        else
+            out_file << "null";
+    }
+    if (rec->checked)
+        out_file << ", \"result_matches\": "
+                 << (rec->mismatch ? "false" : "true");
+
+    out_file << ", \"samples\": [";
+    for (size_t k = 0; k < rec->samples->size (); k++)
+        out_file << (k ? ", " : "") << (*rec->samples)[k];
+    out_file << "]}";
+}
+
+static void
+write_result_value (std::ostream &out_file, struct results_data_t* result,
+                    int fun_id, int array_index, int code_ver)
+{
+    if (result[fun_id].result_type == RESULT_INT)
+        out_file << result[fun_id].result_i[array_index][code_ver];
+    else
+        out_file << std::setprecision (9)
+                 << result[fun_id].result_f[array_index][code_ver];
+}
+
+static void
+write_json_perf_counts (std::ostream &out_file,
+                        struct perf_counts_t *counts, int num_runs)
+{
+    /* Counter values per call.  */
+    double calls = (double) counts->num_samples * num_runs;
+
+    if (calls == 0)
+        return;
+
+    out_file << std::fixed << std::setprecision (4);
+    for (int e = 0; e < PERF_EVENT_MAX; e++)
+        if (counts->valid[e])
+            out_file << ", \"" << perf_event_name (e) << "_per_call\": "
+                     << counts->value[e] / calls;
+
+    if (counts->valid[PERF_CYCLES] && counts->valid[PERF_INSTRUCTIONS]
+        && counts->value[PERF_CYCLES] > 0)
+        out_file << ", \"ipc\": " << (double) counts->value[PERF_INSTRUCTIONS]
+                    / counts->value[PERF_CYCLES];
+    out_file << std::defaultfloat;
+}
+
+void
+write_json_results (std::ofstream &out_file, int fun_index_max,
+                    int array_index_max, struct results_data_t* result,
+                    struct flags_t cmd_flags)
+{
+    unsigned int i, j, code_ver;
+    bool first = true;
+
+    out_file << "{\n";
+    out_file << "  \"program_version\": \"" << VERSION << "\",\n";
+    out_file << "  \"date\": \"" << getDateAsFileSuffix () << "\",\n";
+    out_file << "  \"cpu\": " << cmd_flags.cpu << ",\n";
+    out_file << "  \"reps\": " << cmd_flags.num_reps << ",\n";
+    out_file << "  \"warmup\": " << cmd_flags.num_warmup << ",\n";
+    out_file << "  \"records\": [\n";
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        for (j = 0; j < array_index_max; j++)
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            {
+                struct json_timing_record_t rec;
+                std::ostringstream keys;
+
+                if (!cmd_flags.run_code_version[code_ver])
+                    continue;
+
+                keys << ", \"dim\": " << cmd_flags.array_sizes[j]
+                     << ", \"dtype\": \"" << func_dtype_name (i)
+                     << "\", \"threads\": " << cmd_flags.num_threads
+                     << ", \"working_set\": \"" << working_set_name (cmd_flags)
+                     << "\", \"num_runs\": " << result[i].num_runs[j];
+                if (cmd_flags.working_set != WORKING_SET_NONE)
+                    keys << ", \"page_size\": \"" << page_size_name (cmd_flags)
+                         << "\"";
+                keys << std::fixed << std::setprecision (4)
+                     << ", \"ns_per_call\": "
+                     << result[i].time_stats[j][code_ver].median
+                        / result[i].num_runs[j]
+                     << std::defaultfloat << ", \"result\": ";
+                write_result_value (keys, result, i, j, code_ver);
+                if (cmd_flags.perf_counters)
+                    write_json_perf_counts (keys,
+                                            &result[i].perf[j][code_ver],
+                                            result[i].num_runs[j]);
+
+                rec.kernel = result[i].function_name;
+                rec.version = code_version_name (code_ver);
+                rec.keys = keys.str ();
+                rec.stats = &result[i].time_stats[j][code_ver];
+                rec.samples = &result[i].time_samples[j][code_ver];
+                write_json_timing_record (out_file, &first, &rec);
+            }
+    }
+    write_json_thread_results (out_file, result, cmd_flags, &first);
+    write_json_offset_results (out_file, result, cmd_flags, &first);
+    write_json_accuracy_results (out_file, result, cmd_flags, &first);
+    write_json_fixed_dim_results (out_file, result, cmd_flags, &first);
+    write_json_multi_acc_results (out_file, result, cmd_flags, &first);
+    write_json_cosine_results (out_file, result, cmd_flags, &first);
+    write_json_sparse_results (out_file, &first);
+    write_json_maxsim_results (out_file, cmd_flags, &first);
+    write_json_range_results (out_file, cmd_flags, &first);
+    write_json_filter_results (out_file, cmd_flags, &first);
+    write_json_panel_results (out_file, cmd_flags, &first);
+    write_json_parallel_results (out_file, cmd_flags, &first);
+    write_json_pairwise_results (out_file, cmd_flags, &first);
+    out_file << "\n  ]\n}\n";
+}
+
+void
+write_csv_results (std::ofstream &out_file, int fun_index_max,
+                   int array_index_max, struct results_data_t* result,
+                   struct flags_t cmd_flags)
+{
+    unsigned int i, j, code_ver;
+
+    out_file << "kernel,version,dim,dtype,threads,working_set,num_runs,reps,"
+             << "median_ns,min_ns,mean_ns,p99_ns,stddev_ns,ns_per_call,"
+             << "result\n";
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        for (j = 0; j < array_index_max; j++)
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            {
+                struct time_stats_t *stats
+                    = &result[i].time_stats[j][code_ver];
+
+                if (!cmd_flags.run_code_version[code_ver])
+                    continue;
+
+                out_file << result[i].function_name << ","
+                         << code_version_name (code_ver) << ","
+                         << cmd_flags.array_sizes[j] << ","
+                         << func_dtype_name (i) << ","
+                         << cmd_flags.num_threads << ","
+                         << working_set_name (cmd_flags) << ","
+                         << result[i].num_runs[j] << ","
+                         << cmd_flags.num_reps << ","
+                         << std::fixed << std::setprecision (1)
+                         << stats->median << "," << stats->min << ","
+                         << stats->mean << "," << stats->p99 << ","
+                         << stats->stddev << ","
+                         << std::setprecision (4)
+                         << stats->median / result[i].num_runs[j] << ","
+                         << std::defaultfloat;
+                write_result_value (out_file, result, i, j, code_ver);
+                out_file << "\n";
+            }
+    }
+    write_csv_thread_results (out_file, result, cmd_flags);
+}
+
+/* Helpers to pull a field out of one record line.  Return false if the
+   field is not in the line.  */
+static bool
+find_json_key (const std::string &line, const char *key, size_t *pos)
+{
+    std::string pattern = std::string ("\"") + key + "\":";
+    size_t p = line.find (pattern);
+
+    if (p == std::string::npos)
+        return false;
+
+    p += pattern.size ();
+    while (p < line.size () && line[p] == ' ')
+        p++;
+
+    *pos = p;
+    return true;
+}
+
+static bool
+get_json_string (const std::string &line, const char *key, std::string &value)
+{
+    size_t p;
+
+    value.clear ();
+    if (!find_json_key (line, key, &p) || line[p] != '"')
+        return false;
+
+    for (p++; p < line.size () && line[p] != '"'; p++)
+    {
+        if (line[p] == '\\' && p + 1 < line.size ())
+            p++;
+        value += line[p];
+    }
+    return true;
+}
+
+static bool
+get_json_number (const std::string &line, const char *key, double *value)
+{
+    size_t p;
+
+    if (!find_json_key (line, key, &p))
+        return false;
+
+    *value = strtod (line.c_str () + p, NULL);
+    return true;
+}
+
+static bool
+get_json_samples (const std::string &line, const char *key,
+                  std::vector<unsigned long long int> &samples)
+{
+    size_t p;
+    const char *str;
+    char *end;
+
+    samples.clear ();
+    if (!find_json_key (line, key, &p) || line[p] != '[')
+        return false;
+
+    str = line.c_str () + p + 1;
+    while (*str && *str != ']')
+    {
+        unsigned long long int sample = strtoull (str, &end, 10);
+
+        if (end == str)
+            break;
+
+        samples.push_back (sample);
+        str = end;
+        while (*str == ',' || *str == ' ')
+            str++;
+    }
+    return true;
+}
+
+int
+read_json_results (const char *file_name,
+                   std::vector<struct output_record_t> &records)
+{
+    std::ifstream in_file (file_name);
+    std::string line;
+    double value;
+
+    if (!in_file)
+        return -1;
+
+    while (std::getline (in_file, line))
+    {
+        struct output_record_t record;
+        std::string mode;
+
+        /* Only the records of the main timing loops are compared, the
+           other tests write records of their own mode.  */
+        if (!get_json_string (line, "mode", mode) || mode != JSON_TIMING_MODE
+            || !get_json_string (line, "kernel", record.kernel))
+            continue;
+
+        get_json_string (line, "version", record.version);
+        get_json_string (line, "dtype", record.dtype);
+        get_json_string (line, "working_set", record.working_set);
+        if (get_json_number (line, "dim", &value))
+            record.dim = (long int) value;
+        if (get_json_number (line, "threads", &value))
+            record.threads = (long int) value;
+        if (get_json_number (line, "num_runs", &value))
+            record.num_runs = (long int) value;
+        get_json_number (line, "median_ns", &record.median_ns);
+        get_json_samples (line, "samples", record.samples);
+
+        records.push_back (record);
+    }
+    return 0;
+}
+
+int
+compare_results (std::ofstream &out_file, const char *baseline_file,
+                 int fun_index_max, int array_index_max,
+                 struct results_data_t* result, struct flags_t cmd_flags)
+{
+    /* Compare the time per call of each test against the matching record
+       in the baseline.  The baseline samples are scaled to the current
+       number of runs since the number of runs is calibrated per run.  A test
+       has regressed if the upper end of the confidence interval of the
+       speedup, baseline time / current time, is below 1 / (1 + threshold).
+       Returns the number of regressions.  */
+    using namespace std;
+    std::vector<struct output_record_t> baseline;
+    unsigned int i, j, k, code_ver;
+    int num_regressions = 0, num_compared = 0;
+    double limit = 1.0 / (1.0 + cmd_flags.compare_threshold / 100.0);
+    double gain = 1.0 + cmd_flags.compare_threshold / 100.0;
+
+    if (read_json_results (baseline_file, baseline))
+    {
+        cout << "ERROR, could not read the baseline file " << baseline_file
+             << ", exiting.\n";
+        exit (-1);
+    }
+
+    out_file << "Comparison against baseline " << baseline_file
+             << ", threshold " << std::defaultfloat
+             << cmd_flags.compare_threshold << "%.\n";
+    out_file << "Function name\tversion\tarray size\tbaseline ns/call"
+             << "\tns/call\tspeedup\tconfidence interval\tstatus\n";
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        for (j = 0; j < array_index_max; j++)
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            {
+                struct output_record_t *base_rec = NULL;
+                std::vector<unsigned long long int> base_samples;
+                double ratio, ci_low, ci_high, scale;
+                const char *status;
+
+                if (!cmd_flags.run_code_version[code_ver])
+                    continue;
+
+                for (k = 0; k < baseline.size (); k++)
+                    if (baseline[k].kernel == result[i].function_name
+                        && baseline[k].version == code_version_name (code_ver)
+                        && baseline[k].dim == cmd_flags.array_sizes[j]
+                        && baseline[k].dtype == func_dtype_name (i)
+                        && baseline[k].threads == cmd_flags.num_threads
+                        && baseline[k].working_set
+                           == working_set_name (cmd_flags))
+                    {
+                        base_rec = &baseline[k];
+                        break;
+                    }
+
+                if (base_rec == NULL || base_rec->num_runs <= 0
+                    || base_rec->samples.empty ())
+                    continue;
+
+                scale = (double) result[i].num_runs[j] / base_rec->num_runs;
+                for (k = 0; k < base_rec->samples.size (); k++)
+                    base_samples.push_back ((unsigned long long int)
+                                            llround (base_rec->samples[k]
+                                                     * scale));
+
+                bootstrap_speedup_ci (base_samples,
+                                      result[i].time_samples[j][code_ver],
+                                      &ratio, &ci_low, &ci_high);
+                num_compared++;
+
+                if (ci_high > 0 && ci_high < limit)
+                {
+                    status = "REGRESSION";
+                    num_regressions++;
+                    cout << "REGRESSION " << result[i].function_name << " "
+                         << code_version_name (code_ver) << " size "
+                         << cmd_flags.array_sizes[j] << ", speedup "
+                         << std::fixed << std::setprecision (3) << ratio << " [" << ci_low << ", " << ci_high
+                         << "]\n";
+                }
+                else if (ci_low > gain)
+                    status = "improved";
+                else
+                    status = "unchanged";
+
+                out_file << "  " << result[i].function_name << "\t"
+                         << code_version_name (code_ver) << "\t"
+                         << cmd_flags.array_sizes[j] << "\t"
+                         << std::fixed << std::setprecision (4)
+                         << base_rec->median_ns / base_rec->num_runs << "\t"
+                         << result[i].time_stats[j][code_ver].median
+                            / result[i].num_runs[j] << "\t"
+                         << std::setprecision (3) << ratio << "\t["
+                         << ci_low << ", " << ci_high << "]\t" << status
+                         << "\n";
+            }
+    }
+
+    out_file << num_compared << " tests compared, " << num_regressions
+             << " regressions.\n\n";
+
+    cout << "Compared " << num_compared << " tests against "
+         << baseline_file << ", " << num_regressions << " regressions.\n";
+    if (num_compared == 0)
+        cout << "WARNING, no tests in the baseline match this run.\n";
+
+    return num_regressions;
+}
@@ -0,0 +1,82 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_OUTPUT_H
+#define MAIN_OUTPUT_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "main-helpers.h"
+
+/* Exit code of the program if --compare finds a regression.  */
+#define REGRESSION_EXIT_CODE 2
+
+/* Mode of the JSON records of the main timing loops, the only records
+   read back by --compare.  */
+#define JSON_TIMING_MODE "timing"
+
+/* One measurement read back from a JSON results file.  */
+struct output_record_t {
+    std::string kernel;
+    std::string version;
+    std::string dtype;
+    std::string working_set;
+    long int dim = 0;
+    long int threads = 0;
+    long int num_runs = 0;
+    double median_ns = 0;
+    std::vector<unsigned long long int> samples;
+};
+
+/* One JSON record of a timed test.  keys holds the keys of the test, each
+   written as , "key": value.  max_err is written under err_key unless it
+   is NULL, and result_matches if checked is set.  */
+struct json_timing_record_t {
+    const char *mode = JSON_TIMING_MODE;
+    const char *kernel = "";
+    const char *version = "";
+    std::string keys;
+    const struct time_stats_t *stats = NULL;
+    const std::vector<unsigned long long int> *samples = NULL;
+    const char *err_key = NULL;
+    double max_err = 0;
+    bool checked = false;
+    bool mismatch = false;
+};
+
+const char* code_version_name (int code_ver);
+const char* func_dtype_name (unsigned int fun_id);
+void write_json_string (std::ostream &out_file, const char *str);
+void write_json_timing_record (std::ofstream &out_file, bool *first,
+                               const struct json_timing_record_t *rec);
+
+void write_json_results (std::ofstream &out_file, int fun_index_max,
+                         int array_index_max, struct results_data_t* result,
+                         struct flags_t cmd_flags);
+void write_csv_results (std::ofstream &out_file, int fun_index_max,
+                        int array_index_max, struct results_data_t* result,
+                        struct flags_t cmd_flags);
+
+int read_json_results (const char *file_name,
+                       std::vector<struct output_record_t> &records);
+
+int compare_results (std::ofstream &out_file, const char *baseline_file,
+                     int fun_index_max, int array_index_max,
+                     struct results_data_t* result, struct flags_t cmd_flags);
+
+#endif /* MAIN_OUTPUT_H */
@@ -0,0 +1,476 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Pairwise distance matrices.  With --pairwise the all-pairs distances of a
+   set of n vectors of the array size are computed for the L2, inner
+   product, L1, cosine, Jaccard and Hamming distances with nested loops over
+   the pair function, and with pairwise_cdist and pairwise_pdist writing
+   float and half precision distances, see pairwise.h.  n is
+   PAIRWISE_SET_SIZE and the number of matrices per sample is calibrated as
+   for the other tests.  cdist and pdist run on a work pool of the largest
+   --parallel thread count, one thread by default.  The distances are
+   checked against the nested loops of the base version.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-pairwise.h"
+#include "main-parallel.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "pairwise.h"
+
+static std::vector<struct pairwise_test_result_t> pairwise_results;
+
+/* Pair function of the nested loops of each metric.  */
+static const int pairwise_loop_id[PAIRWISE_METRIC_MAX] = {
+    FVEC_L2SQR_REF, FVEC_INNER_PRODUCT_REF, FVEC_L1_REF, COSINE_DISTANCE_REF,
+    JACCARD_DISTANCE_REF, HAMMING_DISTANCE_REF};
+
+/* Pair and batch_4 functions used by cdist and pdist, the cosine distance
+   is computed from the inner product.  */
+static const int pairwise_pair_id[PAIRWISE_METRIC_MAX] = {
+    FVEC_L2SQR_REF, FVEC_INNER_PRODUCT_REF, FVEC_L1_REF,
+    FVEC_INNER_PRODUCT_REF, JACCARD_DISTANCE_REF, HAMMING_DISTANCE_REF};
+static const int pairwise_batch_4_id[PAIRWISE_METRIC_MAX] = {
+    FVEC_L2SQR_BATCH_4_REF, FVEC_INNER_PRODUCT_BATCH_4_REF, -1,
+    FVEC_INNER_PRODUCT_BATCH_4_REF, -1, -1};
+
+static const char*
+pairwise_metric_name (unsigned int metric)
+{
+    switch (metric)
+    {
+    case PAIRWISE_L2:
+        return "fvec_L2sqr_ref";
+    case PAIRWISE_IP:
+        return "fvec_inner_product_ref";
+    case PAIRWISE_L1:
+        return "fvec_L1_ref";
+    case PAIRWISE_COSINE:
+        return "cosine_distance_ref";
+    case PAIRWISE_JACCARD:
+        return "jaccard_distance_ref";
+    case PAIRWISE_HAMMING:
+        return "hamming_distance_ref";
+    }
+    return "unknown";
+}
+
+static const char*
+pairwise_mode_name (unsigned int mode)
+{
+    switch (mode)
+    {
+    case PAIRWISE_LOOPS:
+        return "loops";
+    case PAIRWISE_CDIST_F32:
+        return "cdist_f32";
+    case PAIRWISE_CDIST_F16:
+        return "cdist_f16";
+    case PAIRWISE_PDIST_F32:
+        return "pdist_f32";
+    case PAIRWISE_PDIST_F16:
+        return "pdist_f16";
+    }
+    return "unknown";
+}
+
+static bool
+pairwise_is_pdist (unsigned int mode)
+{
+    return mode == PAIRWISE_PDIST_F32 || mode == PAIRWISE_PDIST_F16;
+}
+
+static unsigned int
+pairwise_mode_dtype (unsigned int mode)
+{
+    return mode == PAIRWISE_CDIST_F16 || mode == PAIRWISE_PDIST_F16
+           ? PAIRWISE_FLOAT16 : PAIRWISE_FLOAT32;
+}
+
+/* The set of vectors, floats stride apart and Hamming codes of d bytes
+   code_stride bytes apart.  */
+struct pairwise_set_t {
+    const float *x;
+    const uint8_t *codes;
+    size_t n;
+    size_t stride;
+    size_t code_stride;
+    size_t d;
+};
+
+static void
+pairwise_kernels (unsigned int code_ver, unsigned int metric,
+                  struct pairwise_kernels_t *kern)
+{
+    const struct kernel_info_t *pair
+        = get_kernel_info (pairwise_pair_id[metric]);
+
+    kern->metric = metric;
+    if (metric == PAIRWISE_HAMMING)
+        kern->code_pair = pair->bvec_pair[code_ver];
+    else
+        kern->pair = pair->fvec_pair[code_ver];
+    if (pairwise_batch_4_id[metric] >= 0)
+        kern->batch_4 = get_kernel_info (pairwise_batch_4_id[metric])
+                            ->fvec_batch_4[code_ver];
+    if (metric == PAIRWISE_COSINE)
+        kern->norm_sqr = get_kernel_info (FVEC_NORM_L2SQR_REF)
+                             ->fvec_norm[code_ver];
+}
+
+/* All of the n * n distances of the set with the pair function of metric,
+   dis[i * n + j].  */
+static void
+run_pairwise_loops (unsigned int code_ver, unsigned int metric,
+                    const struct pairwise_set_t *set, float *dis)
+{
+    const struct kernel_info_t *info
+        = get_kernel_info (pairwise_loop_id[metric]);
+    size_t i, j;
+
+    if (metric == PAIRWISE_HAMMING)
+    {
+        for (i = 0; i < set->n; i++)
+            for (j = 0; j < set->n; j++)
+                dis[i * set->n + j]
+                    = (float) info->bvec_pair[code_ver] (
+                        set->codes + i * set->code_stride,
+                        set->codes + j * set->code_stride, set->d);
+        return;
+    }
+
+    for (i = 0; i < set->n; i++)
+        for (j = 0; j < set->n; j++)
+            dis[i * set->n + j]
+                = info->fvec_pair[code_ver] (set->x + i * set->stride,
+                                             set->x + j * set->stride,
+                                             set->d);
+}
+
+static void
+run_pairwise_pass (struct work_pool_t *pool, unsigned int code_ver,
+                   unsigned int metric, unsigned int mode,
+                   const struct pairwise_set_t *set, void *dis)
+{
+    struct pairwise_kernels_t kern;
+    const void *x = set->x;
+    size_t stride = set->stride;
+
+    if (mode == PAIRWISE_LOOPS)
+    {
+        run_pairwise_loops (code_ver, metric, set, (float *) dis);
+        return;
+    }
+
+    pairwise_kernels (code_ver, metric, &kern);
+    if (metric == PAIRWISE_HAMMING)
+    {
+        x = set->codes;
+        stride = set->code_stride;
+    }
+
+    if (pairwise_is_pdist (mode))
+        pairwise_pdist (pool, &kern, x, set->n, stride, set->d,
+                        pairwise_mode_dtype (mode), dis);
+    else
+        pairwise_cdist (pool, &kern, x, set->n, stride, x, set->n, stride,
+                        set->d, pairwise_mode_dtype (mode), dis);
+}
+
+/* Largest difference of the distances of mode from ref, the n * n
+   distances of the base nested loops.  */
+static double
+pairwise_max_err (unsigned int mode, size_t n, const void *dis,
+                  const float *ref)
+{
+    bool half = pairwise_mode_dtype (mode) == PAIRWISE_FLOAT16;
+    double max_err = 0;
+
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = pairwise_is_pdist (mode) ? i + 1 : 0; j < n; j++)
+        {
+            size_t k = pairwise_is_pdist (mode) ? pairwise_pdist_index (n, i, j)
+                                                : i * n + j;
+            double a = half ? half_to_float (((const uint16_t *) dis)[k])
+                            : ((const float *) dis)[k];
+
+            check_rel_error (&max_err, a, ref[i * n + j]);
+        }
+    return max_err;
+}
+
+/* Arguments of run_pairwise_pass while calibrating.  */
+struct pairwise_calibrate_arg_t {
+    struct work_pool_t *pool;
+    const struct pairwise_test_result_t *r;
+    const struct pairwise_set_t *set;
+    void *dis;
+};
+
+static void
+pairwise_calibrate_run (void *arg, unsigned int num_runs)
+{
+    struct pairwise_calibrate_arg_t *a
+        = (struct pairwise_calibrate_arg_t *) arg;
+
+    for (unsigned int run = 0; run < num_runs; run++)
+        run_pairwise_pass (a->pool, a->r->code_ver, a->r->metric, a->r->mode,
+                           a->set, a->dis);
+}
+
+void
+run_pairwise_tests (unsigned int array_index, struct flags_t cmd_flags)
+{
+    using namespace std;
+    size_t first = pairwise_results.size ();
+    size_t d = cmd_flags.array_sizes[array_index];
+    struct arena_t arena;
+    struct pairwise_set_t set;
+    struct work_pool_t pool;
+    struct parallel_pin_t pin;
+    float *x, *dis, *ref;
+    uint8_t *codes;
+    unsigned long long int t0, t1;
+    unsigned int code_ver, metric, mode, run;
+    int threads = 1;
+    size_t k, i;
+    int rep;
+
+    for (i = 0; i < cmd_flags.parallel_counts.size (); i++)
+        threads = max (threads, cmd_flags.parallel_counts[i]);
+
+    set.n = PAIRWISE_SET_SIZE;
+    set.d = d;
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        for (metric = 0; metric < PAIRWISE_METRIC_MAX; metric++)
+        {
+            const struct kernel_info_t *info
+                = get_kernel_info (pairwise_loop_id[metric]);
+
+            if (!cmd_flags.run_func_flag[pairwise_loop_id[metric]]
+                || (metric == PAIRWISE_HAMMING ? !info->bvec_pair[code_ver]
+                                               : !info->fvec_pair[code_ver]))
+                continue;
+
+            for (mode = 0; mode < PAIRWISE_MODE_MAX; mode++)
+            {
+                struct pairwise_test_result_t r;
+
+                r.array_index = array_index;
+                r.code_ver = code_ver;
+                r.metric = metric;
+                r.mode = mode;
+                r.n = set.n;
+                r.threads = mode == PAIRWISE_LOOPS ? 1 : threads;
+                pairwise_results.push_back (r);
+            }
+        }
+    }
+
+    if (first == pairwise_results.size ())
+        return;
+
+    cout << "  Pairwise distances" << endl;
+
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    x = (float *) arena_alloc_vectors (&arena, set.n, d, sizeof (float));
+    codes = (uint8_t *) arena_alloc_vectors (&arena, set.n, d,
+                                             sizeof (uint8_t));
+    dis = (float *) arena_alloc (&arena, set.n * set.n * sizeof (float));
+    ref = (float *) arena_alloc (&arena, set.n * set.n * sizeof (float));
+
+    /* Padded rows keep the vector loads of the optimized functions
+       aligned.  */
+    set.stride = arena_padded_dim (d, sizeof (float));
+    set.code_stride = arena_padded_dim (d, sizeof (uint8_t));
+
+    /* The Jaccard distance needs non-negative values.  */
+    mt19937 gen (PAIRWISE_SEED + d);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+    uniform_int_distribution<int> byte (0, 255);
+
+    for (i = 0; i < set.n; i++)
+        for (size_t j = 0; j < d; j++)
+        {
+            x[i * set.stride + j] = value (gen);
+            codes[i * set.code_stride + j] = (uint8_t) byte (gen);
+        }
+
+    set.x = x;
+    set.codes = codes;
+
+    pin.flags = &cmd_flags;
+    pin.unbound = 0;
+    work_pool_init (&pool, threads, parallel_pin, &pin);
+
+    /* Calibrate the number of matrices per sample of each version, metric
+       and mode.  */
+    for (k = first; k < pairwise_results.size (); k++)
+    {
+        struct pairwise_test_result_t *r = &pairwise_results[k];
+        struct pairwise_calibrate_arg_t arg = { &pool, r, &set, dis };
+
+        if (cmd_flags.calibrate)
+            r->num_runs = calibrate_runs (pairwise_calibrate_run, &arg,
+                                          calibrate_target_ns (cmd_flags));
+        else
+            r->num_runs = cmd_flags.num_runs;
+    }
+
+    /* Interleave the versions, metrics and modes across the repetitions as
+       in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < pairwise_results.size (); k++)
+        {
+            struct pairwise_test_result_t *r = &pairwise_results[k];
+
+            t0 = get_time ();
+            for (run = 0; run < r->num_runs; run++)
+                run_pairwise_pass (&pool, r->code_ver, r->metric, r->mode,
+                                   &set, dis);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                r->samples.push_back (t1 - t0);
+        }
+
+    if (pin.unbound > 0)
+        cout << "WARNING, could not bind all of the pairwise distance threads"
+             << " to a CPU, the scaling may vary.\n";
+
+    /* Check the distances against the nested loops of the base version.  */
+    for (k = first; k < pairwise_results.size (); k++)
+    {
+        struct pairwise_test_result_t *r = &pairwise_results[k];
+
+        compute_time_stats (r->samples, &r->stats);
+
+        run_pairwise_loops (CODE_VER_ORIG, r->metric, &set, ref);
+        run_pairwise_pass (&pool, r->code_ver, r->metric, r->mode, &set, dis);
+
+        r->max_err = pairwise_max_err (r->mode, set.n, dis, ref);
+        r->mismatch = !(r->max_err
+                        < (pairwise_mode_dtype (r->mode) == PAIRWISE_FLOAT16
+                           ? PAIRWISE_HALF_ERR_THRESHOLD : ERR_THRESHOLD));
+
+        if (r->mismatch)
+            cout << "WARNING, " << pairwise_metric_name (r->metric) << " "
+                 << pairwise_mode_name (r->mode) << " "
+                 << code_version_name (r->code_ver) << " version, array size "
+                 << d << ", differs from the base version by "
+                 << r->max_err << ".\n";
+    }
+
+    work_pool_release (&pool);
+    arena_release (&arena);
+}
+
+/* Median ms per matrix.  */
+static double
+pairwise_ms_per_matrix (const struct pairwise_test_result_t *r)
+{
+    return r->stats.median / (1e6 * r->num_runs);
+}
+
+/* One row per array size, code version and metric with the ms of each mode
+   and the speedup of pdist_f32 over the nested loops.  */
+void
+print_pairwise_tests (std::ofstream &out_file, struct flags_t cmd_flags)
+{
+    unsigned int mode;
+    size_t n;
+
+    out_file << "Pairwise distances, median execution time in ms of the"
+             << " all-pairs\ndistances of n vectors with nested loops over the"
+             << " pair function, and with\ncdist and pdist writing float and"
+             << " half precision distances on threads\nthreads, and the"
+             << " speedup of pdist_f32 over the loops.  Results that differ\n"
+             << "from the base version are marked with !.\n";
+    out_file << "Array size\tversion\tfunction\tn\tthreads";
+    for (mode = 0; mode < PAIRWISE_MODE_MAX; mode++)
+        out_file << "\t" << pairwise_mode_name (mode);
+    out_file << "\tspeedup\n";
+
+    /* The modes of an array size, version and metric are consecutive.  */
+    for (n = 0; n + PAIRWISE_MODE_MAX <= pairwise_results.size ();
+         n += PAIRWISE_MODE_MAX)
+    {
+        const struct pairwise_test_result_t *row = &pairwise_results[n];
+
+        out_file << "  " << cmd_flags.array_sizes[row->array_index] << "\t"
+                 << code_version_name (row->code_ver) << "\t"
+                 << pairwise_metric_name (row->metric) << "\t" << row->n
+                 << "\t" << row[PAIRWISE_CDIST_F32].threads << std::fixed
+                 << std::setprecision (3);
+        for (mode = 0; mode < PAIRWISE_MODE_MAX; mode++)
+            out_file << "\t" << pairwise_ms_per_matrix (&row[mode])
+                     << (row[mode].mismatch ? "!" : "");
+
+        out_file << "\t" << std::setprecision (2)
+                 << pairwise_ms_per_matrix (&row[PAIRWISE_LOOPS])
+                    / pairwise_ms_per_matrix (&row[PAIRWISE_PDIST_F32])
+                 << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_pairwise_results (std::ofstream &out_file,
+                             struct flags_t cmd_flags, bool *first)
+{
+    for (size_t n = 0; n < pairwise_results.size (); n++)
+    {
+        const struct pairwise_test_result_t *r = &pairwise_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"pairwise_mode\": \"" << pairwise_mode_name (r->mode)
+             << "\", \"dim\": " << cmd_flags.array_sizes[r->array_index]
+             << ", \"dtype\": \""
+             << (r->metric == PAIRWISE_HAMMING ? "uint8" : "float32")
+             << "\", \"out_dtype\": \""
+             << (pairwise_mode_dtype (r->mode) == PAIRWISE_FLOAT16
+                 ? "float16" : "float32")
+             << "\", \"num_vectors\": " << r->n
+             << ", \"threads\": " << r->threads
+             << ", \"num_runs\": " << r->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ms_per_matrix\": " << pairwise_ms_per_matrix (r);
+
+        rec.mode = "pairwise";
+        rec.kernel = pairwise_metric_name (r->metric);
+        rec.version = code_version_name (r->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &r->stats;
+        rec.samples = &r->samples;
+        rec.err_key = "max_err";
+        rec.max_err = r->max_err;
+        rec.checked = true;
+        rec.mismatch = r->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_PAIRWISE_H
+#define MAIN_PAIRWISE_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+#define PAIRWISE_SET_SIZE   256         /* Vectors of the set.  */
+#define PAIRWISE_SEED       487
+
+/* The half precision distances are checked to two units in the last
+   place of a half, which has 10 bits of mantissa, as nearly equal floats may
+   round to adjacent halves.  */
+#define PAIRWISE_HALF_ERR_THRESHOLD  (1.0 / 512)
+
+/* Ways the all-pairs distances of a set of vectors are computed.  */
+enum pairwise_mode_id {
+    PAIRWISE_LOOPS = 0,         /* Nested loops over the pair function.  */
+    PAIRWISE_CDIST_F32,
+    PAIRWISE_CDIST_F16,
+    PAIRWISE_PDIST_F32,
+    PAIRWISE_PDIST_F16,
+    PAIRWISE_MODE_MAX,
+};
+
+/* Time of one array size, code version, metric and mode.  */
+struct pairwise_test_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int metric = 0;
+    unsigned int mode = 0;
+    size_t n = 0;                   /* Vectors of the set.  */
+    int threads = 0;
+    unsigned int num_runs = 0;      /* Matrices per timed sample.  */
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base nested loops.  */
+    bool mismatch = false;
+};
+
+void run_pairwise_tests (unsigned int array_index, struct flags_t cmd_flags);
+
+void print_pairwise_tests (std::ofstream &out_file, struct flags_t cmd_flags);
+void write_json_pairwise_results (std::ofstream &out_file,
+                                  struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_PAIRWISE_H */
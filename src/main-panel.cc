@@ -0,0 +1,367 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Panel layout.  With --panel a query is compared with a database of
+   PANEL_DB_SIZE vectors of the array size stored row-major and in panels
+   of 4, 8 and 16 vectors interleaved by dimension, see panel_store_t.  The
+   row-major database is scanned with the batch_4 functions of the L2
+   distance and inner product and with fvec_L1_ref, the panels with the
+   panel functions of each metric.  The distances are checked against the
+   base version over the row-major database.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-panel.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "panel.h"
+#include "distances/base/panel_distance.h"
+#include "distances/intrinsic/panel_distance.h"
+
+static std::vector<struct panel_test_result_t> panel_results;
+
+typedef void (*panel_fn_t) (float* dis, const float* x, const float* panels,
+                            size_t d, size_t ny, size_t width);
+
+/* Panel functions of each metric and code version, there is no optimized
+   version.  */
+static const panel_fn_t panel_fn[PANEL_METRIC_MAX][NUM_CODE_VERSIONS] = {
+    {base::fvec_L2sqr_ny_panel_ref, NULL,
+     powerpc::fvec_L2sqr_ny_panel_ref_ippc},
+    {base::fvec_inner_product_ny_panel_ref, NULL,
+     powerpc::fvec_inner_product_ny_panel_ref_ippc},
+    {base::fvec_L1_ny_panel_ref, NULL, powerpc::fvec_L1_ny_panel_ref_ippc},
+};
+
+/* Row-major pair and batch_4 functions of each metric, L1 has no batch_4
+   function.  */
+static const int panel_pair_id[PANEL_METRIC_MAX] = {
+    FVEC_L2SQR_REF, FVEC_INNER_PRODUCT_REF, FVEC_L1_REF};
+static const int panel_batch_4_id[PANEL_METRIC_MAX] = {
+    FVEC_L2SQR_BATCH_4_REF, FVEC_INNER_PRODUCT_BATCH_4_REF, -1};
+
+static const size_t panel_width[PANEL_LAYOUT_MAX] = {0, 4, 8, 16};
+
+static const char*
+panel_metric_name (unsigned int metric)
+{
+    switch (metric)
+    {
+    case PANEL_METRIC_L2:
+        return "fvec_L2sqr_ny_panel_ref";
+    case PANEL_METRIC_IP:
+        return "fvec_inner_product_ny_panel_ref";
+    case PANEL_METRIC_L1:
+        return "fvec_L1_ny_panel_ref";
+    }
+    return "unknown";
+}
+
+static const char*
+panel_layout_name (unsigned int layout)
+{
+    switch (layout)
+    {
+    case PANEL_ROWS:
+        return "rows";
+    case PANEL_WIDTH_4:
+        return "panel_4";
+    case PANEL_WIDTH_8:
+        return "panel_8";
+    case PANEL_WIDTH_16:
+        return "panel_16";
+    }
+    return "unknown";
+}
+
+/* The query and the database, row-major with rows stride floats apart and
+   in the panel stores of each width.  */
+struct panel_db_t {
+    const float *x;
+    const float *rows;
+    size_t stride;
+    const struct panel_store_t *panels;     /* Indexed by layout.  */
+    size_t d;
+};
+
+/* Distances of the query to the database in one layout, to dis.  */
+static void
+run_panel_pass (unsigned int code_ver, unsigned int metric,
+                unsigned int layout, const struct panel_db_t *db, float *dis)
+{
+    const struct kernel_info_t *pair = get_kernel_info (panel_pair_id[metric]);
+    fvec_batch_4_fn_t batch_4 = NULL;
+    size_t i = 0;
+
+    if (layout != PANEL_ROWS)
+    {
+        panel_fn[metric][code_ver] (dis, db->x, db->panels[layout].data, db->d,
+                                    PANEL_DB_SIZE, panel_width[layout]);
+        return;
+    }
+
+    if (panel_batch_4_id[metric] >= 0)
+        batch_4 = get_kernel_info (panel_batch_4_id[metric])
+                      ->fvec_batch_4[code_ver];
+
+    if (batch_4)
+        for (; i + 4 <= PANEL_DB_SIZE; i += 4)
+            batch_4 (db->x, db->rows + i * db->stride,
+                     db->rows + (i + 1) * db->stride,
+                     db->rows + (i + 2) * db->stride,
+                     db->rows + (i + 3) * db->stride, db->d, dis[i],
+                     dis[i + 1], dis[i + 2], dis[i + 3]);
+
+    for (; i < PANEL_DB_SIZE; i++)
+        dis[i] = pair->fvec_pair[code_ver] (db->x, db->rows + i * db->stride,
+                                            db->d);
+}
+
+/* Arguments of run_panel_pass while calibrating.  */
+struct panel_calibrate_arg_t {
+    const struct panel_test_result_t *r;
+    const struct panel_db_t *db;
+    float *dis;
+};
+
+static void
+panel_calibrate_run (void *arg, unsigned int num_runs)
+{
+    struct panel_calibrate_arg_t *a = (struct panel_calibrate_arg_t *) arg;
+
+    for (unsigned int run = 0; run < num_runs; run++)
+        run_panel_pass (a->r->code_ver, a->r->metric, a->r->layout, a->db,
+                        a->dis);
+}
+
+void
+run_panel_tests (unsigned int array_index, struct flags_t cmd_flags)
+{
+    using namespace std;
+    size_t first = panel_results.size ();
+    size_t d = cmd_flags.array_sizes[array_index];
+    struct arena_t arena;
+    struct panel_db_t db;
+    struct panel_store_t panels[PANEL_LAYOUT_MAX];
+    float *x, *rows, *dis, *ref;
+    unsigned long long int t0, t1;
+    unsigned int code_ver, metric, layout, run;
+    size_t k, i, j;
+    int rep;
+
+    if (!cmd_flags.run_func_flag[FVEC_L2SQR_BATCH_4_REF])
+        return;
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver]
+            || panel_fn[PANEL_METRIC_L2][code_ver] == NULL)
+            continue;
+
+        for (metric = 0; metric < PANEL_METRIC_MAX; metric++)
+            for (layout = 0; layout < PANEL_LAYOUT_MAX; layout++)
+            {
+                struct panel_test_result_t r;
+
+                r.array_index = array_index;
+                r.code_ver = code_ver;
+                r.metric = metric;
+                r.layout = layout;
+                panel_results.push_back (r);
+            }
+    }
+
+    if (first == panel_results.size ())
+        return;
+
+    cout << "  Panel layout" << endl;
+
+    /* Padded rows keep the vector loads of the optimized batch_4 functions
+       aligned.  */
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    x = (float *) arena_alloc_vectors (&arena, 1, d, sizeof (float));
+    rows = (float *) arena_alloc_vectors (&arena, PANEL_DB_SIZE, d,
+                                          sizeof (float));
+    dis = (float *) arena_alloc (&arena, PANEL_DB_SIZE * sizeof (float));
+    ref = (float *) arena_alloc (&arena, PANEL_DB_SIZE * sizeof (float));
+
+    db.stride = arena_padded_dim (d, sizeof (float));
+
+    mt19937 gen (PANEL_SEED + d);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+
+    for (j = 0; j < d; j++)
+        x[j] = value (gen);
+    for (i = 0; i < PANEL_DB_SIZE; i++)
+        for (j = 0; j < d; j++)
+            rows[i * db.stride + j] = value (gen);
+
+    for (layout = PANEL_WIDTH_4; layout < PANEL_LAYOUT_MAX; layout++)
+        panel_store_from_rows (&panels[layout], rows, PANEL_DB_SIZE, d,
+                               db.stride, panel_width[layout]);
+
+    db.x = x;
+    db.rows = rows;
+    db.panels = panels;
+    db.d = d;
+
+    /* Calibrate the number of queries per sample of each version, metric
+       and layout.  */
+    for (k = first; k < panel_results.size (); k++)
+    {
+        struct panel_test_result_t *r = &panel_results[k];
+        struct panel_calibrate_arg_t arg = { r, &db, dis };
+
+        if (cmd_flags.calibrate)
+            r->num_runs = calibrate_runs (panel_calibrate_run, &arg,
+                                          calibrate_target_ns (cmd_flags));
+        else
+            r->num_runs = cmd_flags.num_runs;
+    }
+
+    /* Interleave the versions, metrics and layouts across the repetitions
+       as in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < panel_results.size (); k++)
+        {
+            struct panel_test_result_t *r = &panel_results[k];
+
+            t0 = get_time ();
+            for (run = 0; run < r->num_runs; run++)
+                run_panel_pass (r->code_ver, r->metric, r->layout, &db, dis);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                r->samples.push_back (t1 - t0);
+        }
+
+    /* Check the distances against the base version over the rows.  */
+    for (k = first; k < panel_results.size (); k++)
+    {
+        struct panel_test_result_t *r = &panel_results[k];
+
+        compute_time_stats (r->samples, &r->stats);
+
+        run_panel_pass (CODE_VER_ORIG, r->metric, PANEL_ROWS, &db, ref);
+        run_panel_pass (r->code_ver, r->metric, r->layout, &db, dis);
+
+        r->max_err = 0;
+        for (i = 0; i < PANEL_DB_SIZE; i++)
+            check_rel_error (&r->max_err, dis[i], ref[i]);
+        r->mismatch = !(r->max_err < ERR_THRESHOLD);
+
+        if (r->mismatch)
+            cout << "WARNING, " << panel_metric_name (r->metric) << " "
+                 << panel_layout_name (r->layout) << " "
+                 << code_version_name (r->code_ver) << " version, array size "
+                 << d << ", differs from the base version by "
+                 << r->max_err << ".\n";
+    }
+
+    for (layout = PANEL_WIDTH_4; layout < PANEL_LAYOUT_MAX; layout++)
+        panel_store_release (&panels[layout]);
+    arena_release (&arena);
+}
+
+/* Median ns per database vector.  */
+static double
+panel_ns_per_vector (const struct panel_test_result_t *r)
+{
+    return r->stats.median / ((double) r->num_runs * PANEL_DB_SIZE);
+}
+
+/* One row per array size, code version and metric with the ns per database
+   vector of each layout and the speedup of the fastest panel width over
+   the row-major database.  */
+void
+print_panel_tests (std::ofstream &out_file, struct flags_t cmd_flags)
+{
+    unsigned int layout;
+    size_t n;
+
+    out_file << "Panel layout, median execution time per database vector in"
+             << " ns for a database of\n" << PANEL_DB_SIZE << " vectors"
+             << " stored row-major, scanned with the batch_4 functions or"
+             << " fvec_L1_ref,\nand in panels of 4, 8 and 16 vectors, and the"
+             << " speedup of the fastest panel width\nover the rows.  Results"
+             << " that differ from the base version are marked with !.\n";
+    out_file << "Array size\tversion\tfunction";
+    for (layout = 0; layout < PANEL_LAYOUT_MAX; layout++)
+        out_file << "\t" << panel_layout_name (layout);
+    out_file << "\tspeedup\n";
+
+    /* The layouts of an array size, version and metric are consecutive.  */
+    for (n = 0; n + PANEL_LAYOUT_MAX <= panel_results.size ();
+         n += PANEL_LAYOUT_MAX)
+    {
+        const struct panel_test_result_t *row = &panel_results[n];
+        double best = panel_ns_per_vector (&row[PANEL_WIDTH_4]);
+
+        out_file << "  " << cmd_flags.array_sizes[row->array_index] << "\t"
+                 << code_version_name (row->code_ver) << "\t"
+                 << panel_metric_name (row->metric) << std::fixed
+                 << std::setprecision (2);
+        for (layout = 0; layout < PANEL_LAYOUT_MAX; layout++)
+        {
+            out_file << "\t" << panel_ns_per_vector (&row[layout])
+                     << (row[layout].mismatch ? "!" : "");
+            if (layout != PANEL_ROWS
+                && panel_ns_per_vector (&row[layout]) < best)
+                best = panel_ns_per_vector (&row[layout]);
+        }
+
+        out_file << "\t" << std::setprecision (3)
+                 << panel_ns_per_vector (&row[PANEL_ROWS]) / best
+                 << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_panel_results (std::ofstream &out_file, struct flags_t cmd_flags,
+                          bool *first)
+{
+    for (size_t n = 0; n < panel_results.size (); n++)
+    {
+        const struct panel_test_result_t *r = &panel_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"panel_layout\": \"" << panel_layout_name (r->layout)
+             << "\", \"dim\": " << cmd_flags.array_sizes[r->array_index]
+             << ", \"dtype\": \"float32\", \"db_size\": " << PANEL_DB_SIZE
+             << ", \"num_runs\": " << r->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ns_per_vector\": " << panel_ns_per_vector (r);
+
+        rec.mode = "panel";
+        rec.kernel = panel_metric_name (r->metric);
+        rec.version = code_version_name (r->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &r->stats;
+        rec.samples = &r->samples;
+        rec.err_key = "max_err";
+        rec.max_err = r->max_err;
+        rec.checked = true;
+        rec.mismatch = r->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
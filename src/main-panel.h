@@ -0,0 +1,64 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_PANEL_H
+#define MAIN_PANEL_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+/* Database vectors per query, not a multiple of 8 or 16 so the zero padded
+   last panel is timed too.  */
+#define PANEL_DB_SIZE       1020
+#define PANEL_SEED          613
+
+enum panel_metric_id {
+    PANEL_METRIC_L2 = 0,
+    PANEL_METRIC_IP,
+    PANEL_METRIC_L1,
+    PANEL_METRIC_MAX,
+};
+
+/* Layouts of the database timed per metric.  */
+enum panel_layout_id {
+    PANEL_ROWS = 0,             /* Row-major, batch_4 or pair functions.  */
+    PANEL_WIDTH_4,
+    PANEL_WIDTH_8,
+    PANEL_WIDTH_16,
+    PANEL_LAYOUT_MAX,
+};
+
+/* Time of one array size, code version, metric and layout.  */
+struct panel_test_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int metric = 0;
+    unsigned int layout = 0;
+    unsigned int num_runs = 0;      /* Queries per timed sample.  */
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base row-major result.  */
+    bool mismatch = false;
+};
+
+void run_panel_tests (unsigned int array_index, struct flags_t cmd_flags);
+
+void print_panel_tests (std::ofstream &out_file, struct flags_t cmd_flags);
+void write_json_panel_results (std::ofstream &out_file,
+                               struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_PANEL_H */
@@ -0,0 +1,530 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Parallel engines.  With --parallel <n1,n2,...> one k-NN search over a
+   database of PARALLEL_DB_BYTES, a distance matrix and a k-means step are
+   split into cache-sized chunks and run by a work pool of n1, n2, ...
+   threads, see parallel_search.h.  Unlike --threads, which runs separate
+   calls on each thread, the threads share the work of one call.  The
+   engines use fvec_L2sqr_ref of the highest code version run and are
+   checked against a serial run of the same function.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-parallel.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "main-threads.h"
+#include "work_pool.h"
+#include "parallel_search.h"
+
+static std::vector<struct parallel_test_result_t> parallel_results;
+
+static const char*
+parallel_engine_name (unsigned int engine)
+{
+    switch (engine)
+    {
+    case PARALLEL_KNN:
+        return "knn_search";
+    case PARALLEL_MATRIX:
+        return "distance_matrix";
+    case PARALLEL_KMEANS:
+        return "kmeans_step";
+    }
+    return "unknown";
+}
+
+/* Binds worker threads to the CPUs of the --threads test, worker 0 is the
+   thread running the tests.  */
+void
+parallel_pin (void *arg, int worker)
+{
+    struct parallel_pin_t *pin = (struct parallel_pin_t *) arg;
+
+    if (pin_to_cpu (get_thread_cpu (*pin->flags, worker)) < 0)
+        pin->unbound++;
+}
+
+/* Inputs of the engines, the database rows are stride floats apart.  */
+struct parallel_db_t {
+    knn_distance_fn_t fn;
+    parallel_batch_4_fn_t batch_4;
+    const float *x;             /* PARALLEL_MATRIX_QUERIES queries.  */
+    const float *y;
+    size_t ny;
+    size_t matrix_ny;
+    size_t kmeans_n;
+    const float *centroids;     /* PARALLEL_KMEANS_CLUSTERS of the points.  */
+    size_t stride;
+    size_t d;
+};
+
+/* Outputs of the engines.  */
+struct parallel_out_t {
+    struct topk_t knn[PARALLEL_KNN_QUERIES];
+    float *dis;
+    int64_t *assign;
+    float *centroids;
+    double objective;
+};
+
+static size_t
+parallel_num_chunks (unsigned int engine, const struct parallel_db_t *db)
+{
+    size_t chunk = parallel_chunk_vectors (db->stride);
+
+    switch (engine)
+    {
+    case PARALLEL_KNN:
+        return (db->ny + chunk - 1) / chunk;
+    case PARALLEL_MATRIX:
+        return (PARALLEL_MATRIX_QUERIES + PARALLEL_TILE_QUERIES - 1)
+               / PARALLEL_TILE_QUERIES * ((db->matrix_ny + chunk - 1) / chunk);
+    }
+    return (db->kmeans_n + chunk - 1) / chunk;
+}
+
+/* Run one engine on pool, returns the chunks stolen.  */
+static size_t
+run_parallel_job (struct work_pool_t *pool, unsigned int engine,
+                  const struct parallel_db_t *db, struct parallel_out_t *out)
+{
+    size_t stolen = 0;
+
+    switch (engine)
+    {
+    case PARALLEL_KNN:
+        for (size_t q = 0; q < PARALLEL_KNN_QUERIES; q++)
+        {
+            topk_reset (&out->knn[q]);
+            parallel_knn_search (pool, db->fn, db->batch_4,
+                                 db->x + q * db->stride, db->y, db->ny,
+                                 db->stride, db->d, &out->knn[q]);
+            stolen += work_pool_stolen (pool);
+        }
+        return stolen;
+
+    case PARALLEL_MATRIX:
+        parallel_distance_matrix (pool, db->fn, db->batch_4, db->x,
+                                  PARALLEL_MATRIX_QUERIES, db->stride, db->y,
+                                  db->matrix_ny, db->stride, db->d, out->dis);
+        break;
+
+    case PARALLEL_KMEANS:
+        out->objective = parallel_kmeans_step (pool, db->fn, db->batch_4,
+                                               db->y, db->kmeans_n, db->stride,
+                                               db->d, db->centroids,
+                                               PARALLEL_KMEANS_CLUSTERS,
+                                               db->stride, out->assign,
+                                               out->centroids);
+        break;
+    }
+    return work_pool_stolen (pool);
+}
+
+/* The engines run serially, without the pool.  The k-NN results are
+   sorted.  The k-NN and matrix distances are those of the pair distance,
+   the k-means points are assigned with parallel_nearest as in the engine,
+   so a point close to two centroids goes to the same one.  */
+static void
+run_serial_job (const struct parallel_db_t *db, struct parallel_out_t *out)
+{
+    size_t q, i, j, c;
+
+    for (q = 0; q < PARALLEL_KNN_QUERIES; q++)
+    {
+        topk_reset (&out->knn[q]);
+        knn_search (db->fn, db->x + q * db->stride, db->y, db->ny, db->stride,
+                    db->d, &out->knn[q]);
+        topk_sort (&out->knn[q]);
+    }
+
+    for (q = 0; q < PARALLEL_MATRIX_QUERIES; q++)
+        for (j = 0; j < db->matrix_ny; j++)
+            out->dis[q * db->matrix_ny + j]
+                = db->fn (db->x + q * db->stride, db->y + j * db->stride,
+                          db->d);
+
+    std::vector<double> sums (PARALLEL_KMEANS_CLUSTERS * db->d, 0);
+    std::vector<size_t> counts (PARALLEL_KMEANS_CLUSTERS, 0);
+
+    out->objective = 0;
+    for (i = 0; i < db->kmeans_n; i++)
+    {
+        const float *xi = db->y + i * db->stride;
+        float best;
+        size_t best_c = parallel_nearest (db->fn, db->batch_4, xi,
+                                          db->centroids,
+                                          PARALLEL_KMEANS_CLUSTERS,
+                                          db->stride, db->d, &best);
+
+        out->assign[i] = (int64_t) best_c;
+        counts[best_c]++;
+        out->objective += best;
+        for (j = 0; j < db->d; j++)
+            sums[best_c * db->d + j] += xi[j];
+    }
+
+    for (c = 0; c < PARALLEL_KMEANS_CLUSTERS; c++)
+        for (j = 0; j < db->d; j++)
+            out->centroids[c * db->stride + j]
+                = counts[c] ? (float) (sums[c * db->d + j] / counts[c])
+                            : db->centroids[c * db->stride + j];
+}
+
+/* Largest difference of the output of engine from the serial output.  The
+   k-NN results are compared by distance, as ties may be broken by another
+   id.  */
+static double
+parallel_max_err (unsigned int engine, const struct parallel_db_t *db,
+                  struct parallel_out_t *out, struct parallel_out_t *ref)
+{
+    double max_err = 0;
+    size_t q, i, j;
+
+    switch (engine)
+    {
+    case PARALLEL_KNN:
+        for (q = 0; q < PARALLEL_KNN_QUERIES; q++)
+        {
+            topk_sort (&out->knn[q]);
+            if (out->knn[q].n != ref->knn[q].n)
+                return INFINITY;
+            for (i = 0; i < ref->knn[q].n; i++)
+                check_rel_error (&max_err, out->knn[q].dis[i],
+                                 ref->knn[q].dis[i]);
+        }
+        break;
+
+    case PARALLEL_MATRIX:
+        for (i = 0; i < PARALLEL_MATRIX_QUERIES * db->matrix_ny; i++)
+            check_rel_error (&max_err, out->dis[i], ref->dis[i]);
+        break;
+
+    case PARALLEL_KMEANS:
+        for (i = 0; i < db->kmeans_n; i++)
+            if (out->assign[i] != ref->assign[i])
+                return INFINITY;
+        for (i = 0; i < PARALLEL_KMEANS_CLUSTERS; i++)
+            for (j = 0; j < db->d; j++)
+                check_rel_error (&max_err, out->centroids[i * db->stride + j],
+                                 ref->centroids[i * db->stride + j]);
+        check_rel_error (&max_err, out->objective / db->kmeans_n,
+                         ref->objective / db->kmeans_n);
+        break;
+    }
+    return max_err;
+}
+
+static void
+parallel_out_init (struct parallel_out_t *out, struct arena_t *arena,
+                   const struct parallel_db_t *db)
+{
+    for (size_t q = 0; q < PARALLEL_KNN_QUERIES; q++)
+        topk_init (&out->knn[q], PARALLEL_K);
+    out->dis = (float *) arena_alloc (arena, PARALLEL_MATRIX_QUERIES
+                                             * db->matrix_ny * sizeof (float));
+    out->assign = (int64_t *) arena_alloc (arena,
+                                           db->kmeans_n * sizeof (int64_t));
+    out->centroids = (float *) arena_alloc_vectors (arena,
+                                                    PARALLEL_KMEANS_CLUSTERS,
+                                                    db->d, sizeof (float));
+    out->objective = 0;
+}
+
+static void
+parallel_out_release (struct parallel_out_t *out)
+{
+    for (size_t q = 0; q < PARALLEL_KNN_QUERIES; q++)
+        topk_release (&out->knn[q]);
+}
+
+void
+run_parallel_tests (unsigned int array_index, struct flags_t cmd_flags)
+{
+    using namespace std;
+    size_t first = parallel_results.size ();
+    size_t d = cmd_flags.array_sizes[array_index];
+    const struct kernel_info_t *info = get_kernel_info (FVEC_L2SQR_REF);
+    struct arena_t arena;
+    struct parallel_db_t db;
+    struct parallel_out_t out, ref;
+    struct parallel_pin_t pin;
+    std::vector<struct work_pool_t> pools (cmd_flags.parallel_counts.size ());
+    float *x, *y, *centroids;
+    unsigned long long int t0, t1;
+    unsigned int engine;
+    int code_ver = -1, ver;
+    size_t k, i, j, t;
+    int rep;
+
+    if (!cmd_flags.run_func_flag[FVEC_L2SQR_REF])
+        return;
+
+    /* The fastest version run, the scaling of the others is alike.  */
+    for (ver = 0; ver < NUM_CODE_VERSIONS; ver++)
+        if (cmd_flags.run_code_version[ver] && info->fvec_pair[ver])
+            code_ver = ver;
+    if (code_ver < 0)
+        return;
+
+    for (engine = 0; engine < PARALLEL_ENGINE_MAX; engine++)
+        for (t = 0; t < cmd_flags.parallel_counts.size (); t++)
+        {
+            struct parallel_test_result_t r;
+
+            r.array_index = array_index;
+            r.code_ver = code_ver;
+            r.engine = engine;
+            r.threads = cmd_flags.parallel_counts[t];
+            parallel_results.push_back (r);
+        }
+
+    cout << "  Parallel engines" << endl;
+
+    db.stride = arena_padded_dim (d, sizeof (float));
+    db.d = d;
+    db.fn = info->fvec_pair[code_ver];
+    db.batch_4 = get_kernel_info (FVEC_L2SQR_BATCH_4_REF)
+                 ->fvec_batch_4[code_ver];
+    db.ny = PARALLEL_DB_BYTES / (db.stride * sizeof (float));
+    if (db.ny < PARALLEL_KMEANS_CLUSTERS)
+        db.ny = PARALLEL_KMEANS_CLUSTERS;
+    db.matrix_ny = min (db.ny, (size_t) PARALLEL_MATRIX_DB);
+    db.kmeans_n = min (db.ny, (size_t) PARALLEL_KMEANS_POINTS);
+
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    x = (float *) arena_alloc_vectors (&arena, PARALLEL_MATRIX_QUERIES, d,
+                                       sizeof (float));
+    y = (float *) arena_alloc_vectors (&arena, db.ny, d, sizeof (float));
+    centroids = (float *) arena_alloc_vectors (&arena,
+                                               PARALLEL_KMEANS_CLUSTERS, d,
+                                               sizeof (float));
+
+    mt19937 gen (PARALLEL_SEED + d);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+
+    for (i = 0; i < PARALLEL_MATRIX_QUERIES; i++)
+        for (j = 0; j < d; j++)
+            x[i * db.stride + j] = value (gen);
+    for (i = 0; i < db.ny; i++)
+        for (j = 0; j < d; j++)
+            y[i * db.stride + j] = value (gen);
+
+    /* The initial centroids are points spread over the k-means points.  */
+    for (i = 0; i < PARALLEL_KMEANS_CLUSTERS; i++)
+        for (j = 0; j < d; j++)
+            centroids[i * db.stride + j]
+                = y[i * (db.kmeans_n / PARALLEL_KMEANS_CLUSTERS) * db.stride
+                    + j];
+
+    db.x = x;
+    db.y = y;
+    db.centroids = centroids;
+
+    parallel_out_init (&out, &arena, &db);
+    parallel_out_init (&ref, &arena, &db);
+
+    pin.flags = &cmd_flags;
+    pin.unbound = 0;
+    for (t = 0; t < pools.size (); t++)
+        work_pool_init (&pools[t], cmd_flags.parallel_counts[t], parallel_pin,
+                        &pin);
+
+    /* Interleave the engines and thread counts across the repetitions as
+       in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < parallel_results.size (); k++)
+        {
+            struct parallel_test_result_t *r = &parallel_results[k];
+            struct work_pool_t *pool = &pools[(k - first) % pools.size ()];
+            size_t stolen;
+
+            t0 = get_time ();
+            stolen = run_parallel_job (pool, r->engine, &db, &out);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+            {
+                r->samples.push_back (t1 - t0);
+                r->stolen += stolen;
+            }
+        }
+
+    if (pin.unbound > 0)
+        cout << "WARNING, could not bind all of the parallel engine threads"
+             << " to a CPU, the scaling may vary.\n";
+
+    /* Check the engines against a serial run.  */
+    run_serial_job (&db, &ref);
+
+    for (k = first; k < parallel_results.size (); k++)
+    {
+        struct parallel_test_result_t *r = &parallel_results[k];
+        struct work_pool_t *pool = &pools[(k - first) % pools.size ()];
+
+        compute_time_stats (r->samples, &r->stats);
+        r->num_chunks = parallel_num_chunks (r->engine, &db);
+        if (r->engine == PARALLEL_KNN)
+            r->num_chunks *= PARALLEL_KNN_QUERIES;
+
+        run_parallel_job (pool, r->engine, &db, &out);
+        r->max_err = parallel_max_err (r->engine, &db, &out, &ref);
+        r->mismatch = !(r->max_err < ERR_THRESHOLD);
+
+        if (r->mismatch)
+            cout << "WARNING, parallel " << parallel_engine_name (r->engine)
+                 << " on " << r->threads << " threads, array size " << d
+                 << ", differs from the serial run by " << r->max_err
+                 << ".\n";
+    }
+
+    for (t = 0; t < pools.size (); t++)
+        work_pool_release (&pools[t]);
+    parallel_out_release (&out);
+    parallel_out_release (&ref);
+    arena_release (&arena);
+}
+
+/* Median ms of the result r.  */
+static double
+parallel_ms (const struct parallel_test_result_t *r)
+{
+    return r->stats.median / 1e6;
+}
+
+/* Speedup of r over base, the smallest thread count of its array size and
+   engine.  */
+static double
+parallel_speedup (const struct parallel_test_result_t *r,
+                  const struct parallel_test_result_t *base)
+{
+    return base->stats.median / r->stats.median;
+}
+
+/* Speedup per thread, relative to the smallest thread count, 1 with linear
+   scaling.  */
+static double
+parallel_efficiency (const struct parallel_test_result_t *r,
+                     const struct parallel_test_result_t *base)
+{
+    return parallel_speedup (r, base) * base->threads / r->threads;
+}
+
+static double
+parallel_stolen_pct (const struct parallel_test_result_t *r)
+{
+    if (r->samples.empty () || r->num_chunks == 0)
+        return 0;
+    return 100.0 * r->stolen / ((double) r->num_chunks * r->samples.size ());
+}
+
+/* The thread counts of an array size and engine are consecutive, returns
+   the one with the fewest threads.  */
+static const struct parallel_test_result_t*
+parallel_base (size_t n, size_t num_counts)
+{
+    size_t group = n - n % num_counts;
+    const struct parallel_test_result_t *base = &parallel_results[group];
+
+    for (size_t t = group; t < group + num_counts; t++)
+        if (parallel_results[t].threads < base->threads)
+            base = &parallel_results[t];
+    return base;
+}
+
+/* One row per array size, engine and thread count with the median ms of a
+   job, the speedup and efficiency over the smallest thread count and the
+   share of the chunks run by a thief.  */
+void
+print_parallel_tests (std::ofstream &out_file, struct flags_t cmd_flags)
+{
+    size_t num_counts = cmd_flags.parallel_counts.size ();
+
+    out_file << "Parallel engines, median execution time in ms of "
+             << PARALLEL_KNN_QUERIES << " k-NN searches of a\n"
+             << PARALLEL_DB_BYTES / (1024 * 1024) << " MB database, of a "
+             << PARALLEL_MATRIX_QUERIES << " x " << PARALLEL_MATRIX_DB
+             << " distance matrix and of a k-means step of\n"
+             << PARALLEL_KMEANS_POINTS << " points and "
+             << PARALLEL_KMEANS_CLUSTERS << " centroids, with the speedup and"
+             << " efficiency over\nthe smallest thread count and the percent"
+             << " of the chunks stolen.  Results\nthat differ from a serial run"
+             << " are marked with !.\n";
+    out_file << "Array size\tversion\tengine\tthreads\tms\tspeedup"
+             << "\tefficiency\tstolen %\n";
+
+    for (size_t n = 0; n < parallel_results.size (); n++)
+    {
+        const struct parallel_test_result_t *r = &parallel_results[n];
+        const struct parallel_test_result_t *base
+            = parallel_base (n, num_counts);
+
+        out_file << "  " << cmd_flags.array_sizes[r->array_index] << "\t"
+                 << code_version_name (r->code_ver) << "\t"
+                 << parallel_engine_name (r->engine) << "\t" << r->threads
+                 << std::fixed << std::setprecision (3) << "\t"
+                 << parallel_ms (r) << (r->mismatch ? "!" : "") << "\t"
+                 << std::setprecision (2) << parallel_speedup (r, base)
+                 << "\t" << parallel_efficiency (r, base) << "\t"
+                 << std::setprecision (1) << parallel_stolen_pct (r)
+                 << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_parallel_results (std::ofstream &out_file,
+                             struct flags_t cmd_flags, bool *first)
+{
+    size_t num_counts = cmd_flags.parallel_counts.size ();
+
+    for (size_t n = 0; n < parallel_results.size (); n++)
+    {
+        const struct parallel_test_result_t *r = &parallel_results[n];
+        const struct parallel_test_result_t *base
+            = parallel_base (n, num_counts);
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"parallel_engine\": \"" << parallel_engine_name (r->engine)
+             << "\", \"dim\": " << cmd_flags.array_sizes[r->array_index]
+             << ", \"dtype\": \"float32\", \"threads\": " << r->threads
+             << ", \"num_chunks\": " << r->num_chunks
+             << std::fixed << std::setprecision (4)
+             << ", \"speedup\": " << parallel_speedup (r, base)
+             << ", \"efficiency\": " << parallel_efficiency (r, base)
+             << ", \"stolen_pct\": " << parallel_stolen_pct (r);
+
+        rec.mode = "parallel";
+        rec.kernel = "fvec_L2sqr_ref";
+        rec.version = code_version_name (r->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &r->stats;
+        rec.samples = &r->samples;
+        rec.err_key = "max_err";
+        rec.max_err = r->max_err;
+        rec.checked = true;
+        rec.mismatch = r->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
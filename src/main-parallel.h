@@ -0,0 +1,70 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_PARALLEL_H
+#define MAIN_PARALLEL_H
+
+#include <fstream>
+#include <vector>
+#include <atomic>
+#include "main-helpers.h"
+
+#define PARALLEL_DB_BYTES       (32 * 1024 * 1024)
+#define PARALLEL_K              10
+#define PARALLEL_KNN_QUERIES    4       /* Searches per timed sample.  */
+#define PARALLEL_MATRIX_QUERIES 64
+#define PARALLEL_MATRIX_DB      4096
+#define PARALLEL_KMEANS_POINTS  16384
+#define PARALLEL_KMEANS_CLUSTERS 64
+#define PARALLEL_SEED           929
+
+enum parallel_engine_id {
+    PARALLEL_KNN = 0,           /* parallel_knn_search.  */
+    PARALLEL_MATRIX,            /* parallel_distance_matrix.  */
+    PARALLEL_KMEANS,            /* parallel_kmeans_step.  */
+    PARALLEL_ENGINE_MAX,
+};
+
+/* Time of one array size, engine and thread count.  */
+struct parallel_test_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int engine = 0;
+    int threads = 0;
+    size_t num_chunks = 0;          /* Chunks of one job.  */
+    size_t stolen = 0;              /* Chunks stolen over the samples.  */
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against a serial run.  */
+    bool mismatch = false;
+};
+
+/* Argument of parallel_pin, the work_init_fn_t of the pools of the tests.
+   unbound counts the threads that could not be bound to their CPU.  */
+struct parallel_pin_t {
+    struct flags_t *flags;
+    std::atomic<int> unbound;
+};
+
+void parallel_pin (void *arg, int worker);
+
+void run_parallel_tests (unsigned int array_index, struct flags_t cmd_flags);
+
+void print_parallel_tests (std::ofstream &out_file, struct flags_t cmd_flags);
+void write_json_parallel_results (std::ofstream &out_file,
+                                  struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_PARALLEL_H */
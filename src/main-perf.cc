@@ -0,0 +1,391 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Hardware performance counters.  With --perf_counters the timed region of
+   each test is wrapped with a perf_event_open group of cycles, instructions,
+   L1D read misses, last level cache misses, branch misses and optionally a
+   raw event such as a vector instruction count.  The counts are summed over
+   the timed repetitions and reported per call along with the IPC, cycles per
+   element and bytes per cycle, which show whether a kernel is limited by the
+   FMA latency or by the loads.
+
+   The counters are started before t0 and stopped after t1 so the ioctl
+   calls are not included in the measured time.  If the counters are not
+   available, for example on AIX or when perf_event_paranoid does not allow
+   them, the program prints a warning and only reports the times.  */
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "main-perf.h"
+#include "main-kernels.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_SUPPORTED 1
+#else
+#define PERF_COUNTERS_SUPPORTED 0
+#endif
+
+static bool perf_enabled = false;
+static int perf_fd[PERF_EVENT_MAX];
+static unsigned long long int perf_id[PERF_EVENT_MAX];
+
+/* Counts of the last start/stop pair.  */
+static unsigned long long int last_value[PERF_EVENT_MAX];
+static bool last_valid[PERF_EVENT_MAX];
+
+const char*
+perf_event_name (int event)
+{
+    switch (event)
+    {
+    case PERF_CYCLES:
+        return "cycles";
+    case PERF_INSTRUCTIONS:
+        return "instructions";
+    case PERF_L1D_MISSES:
+        return "L1D_misses";
+    case PERF_LLC_MISSES:
+        return "LLC_misses";
+    case PERF_BRANCH_MISSES:
+        return "branch_misses";
+    case PERF_VECTOR_OPS:
+        return "vector_ops";
+    default:
+        return "unknown";
+    }
+}
+
+bool
+perf_counters_enabled (void)
+{
+    return perf_enabled;
+}
+
+#if PERF_COUNTERS_SUPPORTED
+static int
+open_perf_event (unsigned int type, unsigned long long int config,
+                 int group_fd)
+{
+    struct perf_event_attr attr;
+
+    memset (&attr, 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (group_fd == -1);   /* The leader starts the group.  */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+        | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall (__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+int
+perf_counters_init (bool enable, long long int raw_event)
+{
+    /* Returns 0 if the counters are enabled.  */
+    using namespace std;
+    int i;
+
+    for (i = 0; i < PERF_EVENT_MAX; i++)
+    {
+        perf_fd[i] = -1;
+        last_valid[i] = false;
+    }
+
+    perf_enabled = false;
+    if (!enable)
+        return -1;
+
+#if PERF_COUNTERS_SUPPORTED
+    perf_fd[PERF_CYCLES] = open_perf_event (PERF_TYPE_HARDWARE,
+                                            PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (perf_fd[PERF_CYCLES] < 0)
+    {
+        cout << "WARNING, hardware performance counters are not available ("
+             << strerror (errno) << "), reporting times only.\n";
+        return -1;
+    }
+
+    perf_fd[PERF_INSTRUCTIONS]
+        = open_perf_event (PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,
+                           perf_fd[PERF_CYCLES]);
+    perf_fd[PERF_L1D_MISSES]
+        = open_perf_event (PERF_TYPE_HW_CACHE,
+                           PERF_COUNT_HW_CACHE_L1D
+                           | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                           | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                           perf_fd[PERF_CYCLES]);
+    perf_fd[PERF_LLC_MISSES]
+        = open_perf_event (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,
+                           perf_fd[PERF_CYCLES]);
+    perf_fd[PERF_BRANCH_MISSES]
+        = open_perf_event (PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,
+                           perf_fd[PERF_CYCLES]);
+
+    /* There is no generic event for vector instructions, the raw event
+       code is processor specific.  */
+    if (raw_event >= 0)
+        perf_fd[PERF_VECTOR_OPS]
+            = open_perf_event (PERF_TYPE_RAW, raw_event, perf_fd[PERF_CYCLES]);
+
+    for (i = 0; i < PERF_EVENT_MAX; i++)
+    {
+        if (perf_fd[i] < 0)
+        {
+            if (i != PERF_VECTOR_OPS || raw_event >= 0)
+                cout << "WARNING, performance counter " << perf_event_name (i)
+                     << " is not available.\n";
+            continue;
+        }
+
+        if (ioctl (perf_fd[i], PERF_EVENT_IOC_ID, &perf_id[i]))
+        {
+            close (perf_fd[i]);
+            perf_fd[i] = -1;
+        }
+    }
+
+    perf_enabled = (perf_fd[PERF_CYCLES] >= 0);
+    return perf_enabled ? 0 : -1;
+#else
+    cout << "WARNING, hardware performance counters are only supported on"
+         << " Linux, reporting times only.\n";
+    return -1;
+#endif
+}
+
+void
+perf_counters_close (void)
+{
+#if PERF_COUNTERS_SUPPORTED
+    for (int i = 0; i < PERF_EVENT_MAX; i++)
+        if (perf_fd[i] >= 0)
+        {
+            close (perf_fd[i]);
+            perf_fd[i] = -1;
+        }
+#endif
+    perf_enabled = false;
+}
+
+void
+perf_counters_start (void)
+{
+    if (!perf_enabled)
+        return;
+
+#if PERF_COUNTERS_SUPPORTED
+    ioctl (perf_fd[PERF_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl (perf_fd[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void
+perf_counters_stop (void)
+{
+    if (!perf_enabled)
+        return;
+
+#if PERF_COUNTERS_SUPPORTED
+    /* Group read format: nr, time_enabled, time_running, then a value and
+       id pair per event.  */
+    unsigned long long int buf[3 + 2 * PERF_EVENT_MAX];
+    unsigned long long int nr, enabled, running;
+    double scale = 1.0;
+    int i;
+    unsigned int k;
+
+    ioctl (perf_fd[PERF_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    for (i = 0; i < PERF_EVENT_MAX; i++)
+        last_valid[i] = false;
+
+    if (read (perf_fd[PERF_CYCLES], buf, sizeof (buf))
+        < (ssize_t) (3 * sizeof (buf[0])))
+        return;
+
+    nr = buf[0];
+    enabled = buf[1];
+    running = buf[2];
+
+    /* The group was not scheduled on the PMU.  */
+    if (running == 0)
+        return;
+
+    /* Scale up if the group was multiplexed with other events.  */
+    if (running < enabled)
+        scale = (double) enabled / running;
+
+    for (k = 0; k < nr && k < PERF_EVENT_MAX; k++)
+        for (i = 0; i < PERF_EVENT_MAX; i++)
+            if (perf_fd[i] >= 0 && perf_id[i] == buf[4 + 2 * k])
+            {
+                last_value[i] = (unsigned long long int)
+                    (buf[3 + 2 * k] * scale);
+                last_valid[i] = true;
+            }
+#endif
+}
+
+void
+perf_counters_read (struct perf_counts_t *counts)
+{
+    /* Add the counts of the last start/stop pair to counts.  */
+    if (!perf_enabled)
+        return;
+
+    for (int i = 0; i < PERF_EVENT_MAX; i++)
+    {
+        if (counts->num_samples == 0)
+            counts->valid[i] = last_valid[i];
+        else
+            counts->valid[i] = counts->valid[i] && last_valid[i];
+
+        if (last_valid[i])
+            counts->value[i] += last_value[i];
+    }
+    counts->num_samples++;
+}
+
+double
+bytes_per_call (unsigned int fun_id, size_t d)
+{
+    /* Bytes of vector data read by one call of the function on arrays of
+       size d, as the test_* functions and the working set mode call it.  */
+    const struct kernel_info_t *kinfo = get_kernel_info (fun_id);
+
+    switch (kinfo->sig)
+    {
+    case SIG_FVEC_NORM:
+        return (double) d * kinfo->elem_size;
+    case SIG_FVEC_BATCH_4:
+        return 5.0 * d * kinfo->elem_size;
+    case SIG_FVEC_NY_TRANSPOSED:
+        /* Called with dimension d / 4 on NY_DISTANCE vectors plus the
+           y_sqlen array.  */
+        return ((double) (d / 4) * (NY_DISTANCE + 1) + NY_DISTANCE)
+            * kinfo->elem_size;
+    default:
+        return 2.0 * d * kinfo->elem_size;
+    }
+}
+
+static void
+print_perf_counters_code_ver (std::ofstream &out_file, int fun_index_max,
+                              int array_index_max,
+                              struct results_data_t* result,
+                              struct flags_t cmd_flags,
+                              char group_id_name[][GROUP_ID_NAME_MAX],
+                              int code_ver, const char *suffix)
+{
+    unsigned int i, j, e;
+    int group_id = -1;     /* Initialize id to print group names  */
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        print_group_name (out_file, &group_id, i, result, group_id_name);
+
+        for (j = 0; j < array_index_max; j++)
+        {
+            struct perf_counts_t *counts = &result[i].perf[j][code_ver];
+            double calls = (double) counts->num_samples
+                * result[i].num_runs[j];
+            double cycles;
+
+            out_file << "  " << result[i].function_name << suffix << "\t"
+                     << cmd_flags.array_sizes[j] << std::fixed
+                     << std::setprecision (2);
+
+            if (calls == 0 || !counts->valid[PERF_CYCLES]
+                || counts->value[PERF_CYCLES] == 0)
+            {
+                out_file << "\tn/a\n";
+                continue;
+            }
+
+            cycles = counts->value[PERF_CYCLES] / calls;
+            out_file << "\t" << cycles;
+
+            if (counts->valid[PERF_INSTRUCTIONS])
+                out_file << "\t" << counts->value[PERF_INSTRUCTIONS] / calls
+                         << "\t" << (double) counts->value[PERF_INSTRUCTIONS]
+                            / counts->value[PERF_CYCLES];
+            else
+                out_file << "\tn/a\tn/a";
+
+            out_file << "\t" << cycles / cmd_flags.array_sizes[j]
+                     << "\t" << bytes_per_call (i, cmd_flags.array_sizes[j])
+                        / cycles;
+
+            for (e = PERF_L1D_MISSES; e < PERF_EVENT_MAX; e++)
+            {
+                if (counts->valid[e])
+                    out_file << "\t" << std::setprecision (4)
+                             << counts->value[e] / calls;
+                else
+                    out_file << "\tn/a";
+            }
+            out_file << "\n";
+        }
+    }
+    out_file << "\n";
+}
+
+void
+print_perf_counters (std::ofstream &out_file, int fun_index_max,
+                     int array_index_max, struct results_data_t* result,
+                     struct flags_t cmd_flags,
+                     char group_id_name[][GROUP_ID_NAME_MAX])
+{
+    unsigned int code_ver;
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+    const char *version_name[NUM_CODE_VERSIONS] = {"Original",
+                                                   "Optimized PowerPC",
+                                                   "Intrinsic PowerPC"};
+
+    out_file << "Hardware performance counters per call, averaged over the "
+             << "timed repetitions.\n";
+    out_file << "cycles/element is per element of the array size, "
+             << "bytes/cycle counts the vector data read by each call.\n\n";
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        out_file << version_name[code_ver] << " code performance counters.\n";
+        out_file << "Function name\tarray size\tcycles\tinstructions\tIPC"
+                 << "\tcycles/element\tbytes/cycle\tL1D misses\tLLC misses"
+                 << "\tbranch misses\tvector ops\n";
+        print_perf_counters_code_ver (out_file, fun_index_max,
+                                      array_index_max, result, cmd_flags,
+                                      group_id_name, code_ver,
+                                      suffix[code_ver]);
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_PERF_H
+#define MAIN_PERF_H
+
+#include <fstream>
+#include "main-helpers.h"
+
+int perf_counters_init (bool enable, long long int raw_event);
+void perf_counters_close (void);
+bool perf_counters_enabled (void);
+const char* perf_event_name (int event);
+
+void perf_counters_start (void);
+void perf_counters_stop (void);
+void perf_counters_read (struct perf_counts_t *counts);
+double bytes_per_call (unsigned int fun_id, size_t d);
+
+void print_perf_counters (std::ofstream &out_file, int fun_index_max,
+                          int array_index_max, struct results_data_t* result,
+                          struct flags_t cmd_flags,
+                          char group_id_name[][GROUP_ID_NAME_MAX]);
+
+#endif /* MAIN_PERF_H */
@@ -0,0 +1,456 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Range search.  With --range_search a query is compared with a database
+   of RANGE_DB_SIZE vectors of the array size, stored transposed for the L2
+   and inner product kernels and as codes of the array size bytes for the
+   Hamming kernel.  The radius of each metric is set so RANGE_MATCH_PERCENT
+   of the database is within it.  The range kernels of each code version
+   are timed, and the L2 distances with fvec_L2sqr_ny_transposed_ref
+   followed by a scan of the distance array for comparison.  The matches
+   are checked against the base version of the range kernel.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-range.h"
+#include "main-kernels.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "range.h"
+#include "distances/base/range_search.h"
+#include "distances/intrinsic/range_search.h"
+
+static std::vector<struct range_test_result_t> range_results;
+
+typedef void (*l2_range_fn_t) (const float* x, const float* y,
+                               const float* y_sqlen, size_t d,
+                               size_t d_offset, size_t ny, float radius,
+                               struct range_result_t* res);
+typedef void (*ip_range_fn_t) (const float* x, const float* y, size_t d,
+                               size_t d_offset, size_t ny, float radius,
+                               struct range_result_t* res);
+typedef void (*hamming_range_fn_t) (const uint8_t* x, const uint8_t* y,
+                                    size_t size, size_t y_stride, size_t ny,
+                                    size_t radius,
+                                    struct range_result_t* res);
+
+/* The range functions of one code version, there is no optimized
+   version.  */
+struct range_kernels_t {
+    fvec_ny_transposed_fn_t l2_ny;
+    l2_range_fn_t l2;
+    ip_range_fn_t ip;
+    hamming_range_fn_t hamming;
+};
+
+static const struct range_kernels_t range_kernels[NUM_CODE_VERSIONS] = {
+    {base::fvec_L2sqr_ny_transposed_ref,
+     base::fvec_L2sqr_ny_transposed_range_ref,
+     base::fvec_inner_product_ny_transposed_range_ref,
+     base::hamming_distance_ny_range_ref},
+    {NULL, NULL, NULL, NULL},
+    {powerpc::fvec_L2sqr_ny_transposed_ref_ippc,
+     powerpc::fvec_L2sqr_ny_transposed_range_ref_ippc,
+     powerpc::fvec_inner_product_ny_transposed_range_ref_ippc,
+     powerpc::hamming_distance_ny_range_ref_ippc},
+};
+
+static const char*
+range_kernel_name (unsigned int kernel)
+{
+    switch (kernel)
+    {
+    case RANGE_L2_FULL:
+        return "l2_full";
+    case RANGE_L2:
+        return "l2";
+    case RANGE_IP:
+        return "ip";
+    case RANGE_HAMMING:
+        return "hamming";
+    }
+    return "unknown";
+}
+
+static const char*
+range_function_name (unsigned int kernel)
+{
+    switch (kernel)
+    {
+    case RANGE_L2_FULL:
+        return "fvec_L2sqr_ny_transposed_ref";
+    case RANGE_L2:
+        return "fvec_L2sqr_ny_transposed_range_ref";
+    case RANGE_IP:
+        return "fvec_inner_product_ny_transposed_range_ref";
+    case RANGE_HAMMING:
+        return "hamming_distance_ny_range_ref";
+    }
+    return "unknown";
+}
+
+/* The query and the database, element j of vector i is y[i + j * ny].  The
+   codes of the Hamming kernel are d bytes long, code_stride bytes apart.
+   dis is the distance array of the RANGE_L2_FULL kernel.  */
+struct range_db_t {
+    const float *x;
+    const float *y;
+    const float *y_sqlen;
+    const uint8_t *xb;
+    const uint8_t *yb;
+    float *dis;
+    size_t d;
+    size_t code_stride;
+    float l2_radius;
+    float ip_radius;
+    size_t hamming_radius;
+};
+
+/* One query against the database, the matches go to res.  */
+static void
+run_range_pass (const struct range_kernels_t *k, unsigned int kernel,
+                const struct range_db_t *db, struct range_result_t *res)
+{
+    range_result_reset (res);
+
+    switch (kernel)
+    {
+    case RANGE_L2_FULL:
+        k->l2_ny (db->dis, db->x, db->y, db->y_sqlen, db->d, RANGE_DB_SIZE,
+                  RANGE_DB_SIZE);
+        for (size_t i = 0; i < RANGE_DB_SIZE; i++)
+            if (db->dis[i] < db->l2_radius)
+                range_result_push (res, db->dis[i], (int64_t) i);
+        break;
+
+    case RANGE_L2:
+        k->l2 (db->x, db->y, db->y_sqlen, db->d, RANGE_DB_SIZE, RANGE_DB_SIZE,
+               db->l2_radius, res);
+        break;
+
+    case RANGE_IP:
+        k->ip (db->x, db->y, db->d, RANGE_DB_SIZE, RANGE_DB_SIZE,
+               db->ip_radius, res);
+        break;
+
+    case RANGE_HAMMING:
+        k->hamming (db->xb, db->yb, db->d, db->code_stride, RANGE_DB_SIZE,
+                    db->hamming_radius, res);
+        break;
+    }
+}
+
+/* Largest relative difference of the distances of res and ref, infinite if
+   they do not hold the same ids.  */
+static double
+range_result_diff (const struct range_result_t *res,
+                   const struct range_result_t *ref)
+{
+    double max_err = 0;
+
+    if (res->n != ref->n)
+        return HUGE_VAL;
+
+    for (size_t i = 0; i < res->n; i++)
+    {
+        if (res->ids[i] != ref->ids[i])
+            return HUGE_VAL;
+        check_rel_error (&max_err, res->dis[i], ref->dis[i]);
+    }
+    return max_err;
+}
+
+/* Arguments of run_range_pass while calibrating.  */
+struct range_calibrate_arg_t {
+    const struct range_test_result_t *r;
+    const struct range_db_t *db;
+    struct range_result_t *res;
+};
+
+static void
+range_calibrate_run (void *arg, unsigned int num_runs)
+{
+    struct range_calibrate_arg_t *a = (struct range_calibrate_arg_t *) arg;
+
+    for (unsigned int run = 0; run < num_runs; run++)
+        run_range_pass (&range_kernels[a->r->code_ver], a->r->kernel, a->db,
+                        a->res);
+}
+
+void
+run_range_tests (unsigned int array_index, struct flags_t cmd_flags)
+{
+    using namespace std;
+    size_t first = range_results.size ();
+    size_t d = cmd_flags.array_sizes[array_index];
+    size_t num_match = RANGE_DB_SIZE * RANGE_MATCH_PERCENT / 100;
+    struct arena_t arena;
+    struct range_db_t db;
+    struct range_result_t res, ref;
+    float *x, *y, *y_sqlen, *dis;
+    uint8_t *xb, *yb;
+    vector<float> sorted (RANGE_DB_SIZE);
+    vector<size_t> hamming (RANGE_DB_SIZE);
+    unsigned long long int t0, t1;
+    unsigned int code_ver, kernel, run;
+    size_t k, i, j;
+    int rep;
+
+    if (!cmd_flags.run_func_flag[FVEC_L2SQR_NY_TRANSPOSED_REF])
+        return;
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver]
+            || range_kernels[code_ver].l2 == NULL)
+            continue;
+
+        for (kernel = 0; kernel < RANGE_KERNEL_MAX; kernel++)
+        {
+            struct range_test_result_t r;
+
+            r.array_index = array_index;
+            r.code_ver = code_ver;
+            r.kernel = kernel;
+            range_results.push_back (r);
+        }
+    }
+
+    if (first == range_results.size ())
+        return;
+
+    cout << "  Range search" << endl;
+
+    arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+    x = (float *) arena_alloc (&arena, d * sizeof (float));
+    y = (float *) arena_alloc (&arena, d * RANGE_DB_SIZE * sizeof (float));
+    y_sqlen = (float *) arena_alloc (&arena, RANGE_DB_SIZE * sizeof (float));
+    dis = (float *) arena_alloc (&arena, RANGE_DB_SIZE * sizeof (float));
+    xb = (uint8_t *) arena_alloc_vectors (&arena, 1, d, 1);
+    yb = (uint8_t *) arena_alloc_vectors (&arena, RANGE_DB_SIZE, d, 1);
+
+    mt19937 gen (RANGE_SEED + d);
+    uniform_real_distribution<float> value (0.0f, 1.0f);
+    uniform_int_distribution<int> byte (0, 255);
+
+    db.d = d;
+    db.code_stride = arena_padded_dim (d, 1);
+
+    for (j = 0; j < d; j++)
+    {
+        x[j] = value (gen);
+        xb[j] = byte (gen);
+    }
+    for (i = 0; i < RANGE_DB_SIZE; i++)
+    {
+        y_sqlen[i] = 0;
+        for (j = 0; j < d; j++)
+        {
+            y[i + j * RANGE_DB_SIZE] = value (gen);
+            y_sqlen[i] += y[i + j * RANGE_DB_SIZE] * y[i + j * RANGE_DB_SIZE];
+            yb[i * db.code_stride + j] = byte (gen);
+        }
+    }
+
+    db.x = x;
+    db.y = y;
+    db.y_sqlen = y_sqlen;
+    db.xb = xb;
+    db.yb = yb;
+    db.dis = dis;
+
+    /* Radii between the num_match-th and the next best distance of the
+       base version, so the versions agree on the matches.  */
+    base::fvec_L2sqr_ny_transposed_ref (dis, x, y, y_sqlen, d, RANGE_DB_SIZE,
+                                        RANGE_DB_SIZE);
+    sorted.assign (dis, dis + RANGE_DB_SIZE);
+    sort (sorted.begin (), sorted.end ());
+    db.l2_radius = (sorted[num_match - 1] + sorted[num_match]) / 2;
+
+    for (i = 0; i < RANGE_DB_SIZE; i++)
+    {
+        float dp = 0;
+
+        for (j = 0; j < d; j++)
+            dp += x[j] * y[i + j * RANGE_DB_SIZE];
+        sorted[i] = dp;
+    }
+    sort (sorted.begin (), sorted.end (), greater<float> ());
+    db.ip_radius = (sorted[num_match - 1] + sorted[num_match]) / 2;
+
+    for (i = 0; i < RANGE_DB_SIZE; i++)
+        hamming[i] = base::hamming_distance_ref (xb, yb + i * db.code_stride,
+                                                 d);
+    sort (hamming.begin (), hamming.end ());
+    db.hamming_radius = hamming[num_match - 1] + 1;
+
+    range_result_init (&res, 0);
+    range_result_init (&ref, 0);
+
+    /* Calibrate the number of queries per sample of each version and
+       kernel.  */
+    for (k = first; k < range_results.size (); k++)
+    {
+        struct range_test_result_t *r = &range_results[k];
+        struct range_calibrate_arg_t arg = { r, &db, &res };
+
+        if (cmd_flags.calibrate)
+            r->num_runs = calibrate_runs (range_calibrate_run, &arg,
+                                          calibrate_target_ns (cmd_flags));
+        else
+            r->num_runs = cmd_flags.num_runs;
+    }
+
+    /* Interleave the versions and kernels across the repetitions as in
+       main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (k = first; k < range_results.size (); k++)
+        {
+            struct range_test_result_t *r = &range_results[k];
+            const struct range_kernels_t *kern = &range_kernels[r->code_ver];
+
+            t0 = get_time ();
+            for (run = 0; run < r->num_runs; run++)
+                run_range_pass (kern, r->kernel, &db, &res);
+            t1 = get_time ();
+
+            if (rep >= cmd_flags.num_warmup)
+                r->samples.push_back (t1 - t0);
+        }
+
+    /* Check the matches against the base version of the range kernel of
+       the metric, the ids have to be the same.  */
+    for (k = first; k < range_results.size (); k++)
+    {
+        struct range_test_result_t *r = &range_results[k];
+
+        compute_time_stats (r->samples, &r->stats);
+
+        if (r->kernel == RANGE_IP)
+            r->radius = db.ip_radius;
+        else if (r->kernel == RANGE_HAMMING)
+            r->radius = db.hamming_radius;
+        else
+            r->radius = db.l2_radius;
+
+        run_range_pass (&range_kernels[CODE_VER_ORIG],
+                        r->kernel == RANGE_L2_FULL ? RANGE_L2 : r->kernel,
+                        &db, &ref);
+        run_range_pass (&range_kernels[r->code_ver], r->kernel, &db, &res);
+        r->matches = res.n;
+        r->max_err = range_result_diff (&res, &ref);
+        r->mismatch = !(r->max_err < ERR_THRESHOLD);
+
+        if (r->mismatch)
+            cout << "WARNING, range search " << range_kernel_name (r->kernel)
+                 << " kernel " << code_version_name (r->code_ver)
+                 << " version, array size " << d
+                 << ", differs from the base version by " << r->max_err
+                 << ".\n";
+    }
+
+    range_result_release (&res);
+    range_result_release (&ref);
+    arena_release (&arena);
+}
+
+/* Median ns per database vector.  */
+static double
+range_ns_per_vector (const struct range_test_result_t *r)
+{
+    return r->stats.median / ((double) r->num_runs * RANGE_DB_SIZE);
+}
+
+/* One row per array size and code version with the ns per database vector
+   of each kernel and the speedup of the L2 range kernel over the full
+   distance array.  */
+void
+print_range_tests (std::ofstream &out_file, struct flags_t cmd_flags)
+{
+    unsigned int kernel;
+    size_t n;
+
+    out_file << "Range search, median execution time per database vector in"
+             << " ns for a database of\n" << RANGE_DB_SIZE << " vectors with "
+             << RANGE_MATCH_PERCENT << "% of them within the radius, and the"
+             << " speedup of the L2 range\nkernel over the full distance"
+             << " array.  Results that differ from the base\nversion are"
+             << " marked with !.\n";
+    out_file << "Array size\tversion";
+    for (kernel = 0; kernel < RANGE_KERNEL_MAX; kernel++)
+        out_file << "\t" << range_kernel_name (kernel);
+    out_file << "\tspeedup\tmatches\n";
+
+    /* The kernels of an array size and version are consecutive.  */
+    for (n = 0; n + RANGE_KERNEL_MAX <= range_results.size ();
+         n += RANGE_KERNEL_MAX)
+    {
+        const struct range_test_result_t *row = &range_results[n];
+
+        out_file << "  " << cmd_flags.array_sizes[row->array_index] << "\t"
+                 << code_version_name (row->code_ver) << std::fixed
+                 << std::setprecision (2);
+        for (kernel = 0; kernel < RANGE_KERNEL_MAX; kernel++)
+            out_file << "\t" << range_ns_per_vector (&row[kernel])
+                     << (row[kernel].mismatch ? "!" : "");
+
+        out_file << "\t" << std::setprecision (3)
+                 << range_ns_per_vector (&row[RANGE_L2_FULL])
+                    / range_ns_per_vector (&row[RANGE_L2])
+                 << "\t" << row[RANGE_L2].matches
+                 << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_range_results (std::ofstream &out_file, struct flags_t cmd_flags,
+                          bool *first)
+{
+    for (size_t n = 0; n < range_results.size (); n++)
+    {
+        const struct range_test_result_t *r = &range_results[n];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"range_kernel\": \"" << range_kernel_name (r->kernel)
+             << "\", \"dim\": " << cmd_flags.array_sizes[r->array_index]
+             << ", \"dtype\": \""
+             << (r->kernel == RANGE_HAMMING ? "uint8" : "float32")
+             << "\", \"db_size\": " << RANGE_DB_SIZE
+             << ", \"radius\": " << r->radius
+             << ", \"matches\": " << r->matches
+             << ", \"num_runs\": " << r->num_runs
+             << std::fixed << std::setprecision (4)
+             << ", \"ns_per_vector\": " << range_ns_per_vector (r);
+
+        rec.mode = "range_search";
+        rec.kernel = range_function_name (r->kernel);
+        rec.version = code_version_name (r->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &r->stats;
+        rec.samples = &r->samples;
+        rec.err_key = "max_err";
+        rec.max_err = r->max_err;
+        rec.checked = true;
+        rec.mismatch = r->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
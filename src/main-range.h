@@ -0,0 +1,57 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_RANGE_H
+#define MAIN_RANGE_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+#define RANGE_DB_SIZE       1024        /* Database vectors per query.  */
+#define RANGE_MATCH_PERCENT 1           /* Of the database within radius.  */
+#define RANGE_SEED          577
+
+/* Kernels timed per array size and code version.  */
+enum range_kernel_id {
+    RANGE_L2_FULL = 0,          /* fvec_L2sqr_ny_transposed, then filter.  */
+    RANGE_L2,                   /* fvec_L2sqr_ny_transposed_range.  */
+    RANGE_IP,                   /* fvec_inner_product_ny_transposed_range.  */
+    RANGE_HAMMING,              /* hamming_distance_ny_range.  */
+    RANGE_KERNEL_MAX,
+};
+
+/* Time of one array size, code version and kernel.  */
+struct range_test_result_t {
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    unsigned int kernel = 0;
+    unsigned int num_runs = 0;      /* Queries per timed sample.  */
+    double radius = 0;
+    size_t matches = 0;             /* Vectors within the radius.  */
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base range kernel.  */
+    bool mismatch = false;
+};
+
+void run_range_tests (unsigned int array_index, struct flags_t cmd_flags);
+
+void print_range_tests (std::ofstream &out_file, struct flags_t cmd_flags);
+void write_json_range_results (std::ofstream &out_file,
+                               struct flags_t cmd_flags, bool *first);
+
+#endif /* MAIN_RANGE_H */
@@ -0,0 +1,331 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* k-NN recall test.  With --dataset and --queries each code version of
+   fvec_L2sqr_ref is used for a brute force search of the k nearest dataset
+   vectors of each query.  The results are compared against the ids in the
+   --groundtruth file, or against the results of the base version if no
+   ground truth is given, and the recall@k and the time per query are
+   reported.  With --early_abandon the search is also timed with
+   fvec_L2sqr_early_ref and fvec_L1_early_ref, which stop computing the
+   distance of a vector that can not enter the top k.  */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "main-recall.h"
+#include "main-kernels.h"
+#include "main-output.h"
+#include "knn.h"
+#include "distances/base/early_abandon.h"
+#include "distances/optimized/early_abandon.h"
+#include "distances/intrinsic/early_abandon.h"
+
+/* Early abandon functions of each code version, for fvec_L2sqr_ref and
+   fvec_L1_ref.  */
+#define NUM_EARLY_METRICS 2
+
+static const int early_func_id[NUM_EARLY_METRICS] = {FVEC_L2SQR_REF,
+                                                     FVEC_L1_REF};
+static const char *early_func_name[NUM_EARLY_METRICS] = {"fvec_L2sqr_ref",
+                                                         "fvec_L1_ref"};
+
+static const knn_early_distance_fn_t
+early_fn[NUM_EARLY_METRICS][NUM_CODE_VERSIONS] = {
+    {base::fvec_L2sqr_early_ref, powerpc::fvec_L2sqr_early_ref_ppc,
+     powerpc::fvec_L2sqr_early_ref_ippc},
+    {base::fvec_L1_early_ref, powerpc::fvec_L1_early_ref_ppc,
+     powerpc::fvec_L1_early_ref_ippc},
+};
+
+/* Dimensions computed by count_early_distance since the last reset.  */
+static size_t early_dims;
+static int early_metric;
+
+/* Base early abandon distance that also counts the dimensions computed, one
+   EARLY_ABANDON_BLOCK at a time as the early abandon functions.  */
+static float
+count_early_distance (const float* x, const float* y, size_t d,
+                      float threshold)
+{
+    float res = 0;
+
+    for (size_t start = 0; start < d; start += EARLY_ABANDON_BLOCK)
+    {
+        size_t len = std::min (d - start, (size_t) EARLY_ABANDON_BLOCK);
+
+        if (early_metric == 0)
+            res += base::fvec_L2sqr_ref (x + start, y + start, len);
+        else
+            res += base::fvec_L1_ref (x + start, y + start, len);
+        early_dims += len;
+
+        if (res >= threshold)
+            break;
+    }
+    return res;
+}
+
+/* Number of the ids in found that are also in ref.  */
+static size_t
+count_matches (const int64_t *found, const int64_t *ref, size_t k)
+{
+    size_t i, j, matches = 0;
+
+    for (i = 0; i < k; i++)
+        for (j = 0; j < k; j++)
+            if (found[i] == ref[j])
+            {
+                matches++;
+                break;
+            }
+
+    return matches;
+}
+
+/* Time the search of the nq queries of xq over xb with the full and the
+   early abandon distance functions of each code version.  The neighbors of
+   both are compared, and the dimensions computed by the base early abandon
+   search are counted to report the work saved.  */
+static void
+run_early_abandon_test (std::ofstream &out_file, struct flags_t cmd_flags,
+                        const struct float_matrix_t *xb,
+                        const struct float_matrix_t *xq, size_t nq, size_t k)
+{
+    using namespace std;
+    struct topk_t res;
+    vector<int64_t> full (nq * k), early (nq * k);
+    int metric, code_ver, pass;
+    size_t q, i;
+
+    topk_init (&res, k);
+
+    out_file << "Early abandon k-NN search, the distance is checked against"
+             << " the k-th best distance\nevery " << EARLY_ABANDON_BLOCK
+             << " dimensions.  Work saved is the fraction of the dimensions"
+             << " not computed\nby the base version, matches the fraction"
+             << " of the neighbors found by both\nsearches.\n";
+    out_file << "Function\tversion\tms/query\tearly ms/query\tspeedup\t"
+             << "work saved\tmatches\n";
+
+    for (metric = 0; metric < NUM_EARLY_METRICS; metric++)
+    {
+        const struct kernel_info_t *info
+            = get_kernel_info (early_func_id[metric]);
+        double saved;
+
+        /* Count the dimensions of the base early abandon search.  */
+        early_metric = metric;
+        early_dims = 0;
+        for (q = 0; q < nq; q++)
+        {
+            topk_reset (&res);
+            knn_search_early (count_early_distance, xq->data + q * xq->stride,
+                              xb->data, xb->n, xb->stride, xb->stride, &res);
+        }
+        saved = 1.0 - (double) early_dims / ((double) nq * xb->n * xb->stride);
+
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            unsigned long long int elapsed[2] = {0, 0};
+            size_t matches = 0;
+
+            if (!cmd_flags.run_code_version[code_ver])
+                continue;
+
+            for (pass = 0; pass < 2; pass++)
+                for (q = 0; q < nq; q++)
+                {
+                    const float *x = xq->data + q * xq->stride;
+                    vector<int64_t> &found = pass ? early : full;
+                    unsigned long long int t0, t1;
+
+                    topk_reset (&res);
+                    t0 = get_time ();
+                    if (pass)
+                        knn_search_early (early_fn[metric][code_ver], x,
+                                          xb->data, xb->n, xb->stride,
+                                          xb->stride, &res);
+                    else
+                        knn_search (info->fvec_pair[code_ver], x, xb->data,
+                                    xb->n, xb->stride, xb->stride, &res);
+                    t1 = get_time ();
+                    elapsed[pass] += t1 - t0;
+
+                    topk_sort (&res);
+                    for (i = 0; i < k; i++)
+                        found[q * k + i] = i < res.n ? res.ids[i] : -1;
+                }
+
+            for (q = 0; q < nq; q++)
+                matches += count_matches (&early[q * k], &full[q * k], k);
+
+            if (matches != nq * k)
+                cout << "WARNING, the early abandon search with "
+                     << early_func_name[metric] << " "
+                     << code_version_name (code_ver)
+                     << " version found " << matches << " of the " << nq * k
+                     << " neighbors of the full search.\n";
+
+            out_file << "  " << early_func_name[metric] << "\t"
+                     << code_version_name (code_ver) << "\t" << fixed
+                     << setprecision (3) << elapsed[0] / 1.0e6 / nq << "\t"
+                     << elapsed[1] / 1.0e6 / nq << "\t"
+                     << (double) elapsed[0] / elapsed[1] << "\t"
+                     << setprecision (4) << saved << "\t"
+                     << (double) matches / (nq * k) << "\n";
+            out_file.unsetf (ios_base::floatfield);
+        }
+    }
+    out_file << "\n";
+
+    topk_release (&res);
+}
+
+void
+run_recall_test (std::ofstream &out_file, struct flags_t cmd_flags,
+                 const struct dataset_t *base,
+                 const struct dataset_t *queries,
+                 const struct dataset_t *groundtruth)
+{
+    using namespace std;
+    const struct kernel_info_t *info = get_kernel_info (FVEC_L2SQR_REF);
+    struct float_matrix_t xb, xq;
+    struct topk_t res;
+    size_t k = cmd_flags.recall_k;
+    size_t nq, q;
+    int code_ver;
+
+    if (queries->d != base->d)
+    {
+        cout << "ERROR, the queries have dimension " << queries->d
+             << ", the dataset has dimension " << base->d << ", exiting.\n";
+        exit (-1);
+    }
+
+    if (k > base->n)
+        k = base->n;
+
+    nq = queries->n;
+    if (nq > (size_t) cmd_flags.num_queries)
+        nq = cmd_flags.num_queries;
+
+    if (groundtruth && (groundtruth->n < nq || groundtruth->d < k))
+    {
+        cout << "ERROR, the ground truth has " << groundtruth->n
+             << " rows of " << groundtruth->d << " ids, need " << nq
+             << " rows of " << k << " ids, exiting.\n";
+        exit (-1);
+    }
+
+    cout << "Running k-NN recall test, " << nq << " queries, k = " << k
+         << endl;
+
+    /* The rows are zero padded to the same stride, the distances are
+       computed over the padded dimension so the functions do not run
+       their scalar tail loops.  */
+    dataset_float_matrix (base, base->n, &xb);
+    dataset_float_matrix (queries, nq, &xq);
+    topk_init (&res, k);
+
+    /* The sorted ids found by each code version, nq rows of k ids.  */
+    vector<vector<int64_t> > found (NUM_CODE_VERSIONS);
+    vector<unsigned long long int> elapsed (NUM_CODE_VERSIONS, 0);
+    vector<int64_t> ref (nq * k);
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        found[code_ver].resize (nq * k);
+
+        for (q = 0; q < nq; q++)
+        {
+            unsigned long long int t0, t1;
+
+            topk_reset (&res);
+            t0 = get_time ();
+            knn_search (info->fvec_pair[code_ver], xq.data + q * xq.stride,
+                        xb.data, xb.n, xb.stride, xb.stride, &res);
+            t1 = get_time ();
+            elapsed[code_ver] += t1 - t0;
+
+            topk_sort (&res);
+            for (size_t i = 0; i < k; i++)
+                found[code_ver][q * k + i] = i < res.n ? res.ids[i] : -1;
+        }
+    }
+
+    /* The ground truth rows may hold more than k ids, the first k are the
+       k nearest.  */
+    if (groundtruth)
+    {
+        vector<int64_t> row (groundtruth->d);
+
+        for (q = 0; q < nq; q++)
+        {
+            dataset_row_int64 (groundtruth, q, row.data ());
+            for (size_t i = 0; i < k; i++)
+                ref[q * k + i] = row[i];
+        }
+    }
+    else
+        ref = found[CODE_VER_ORIG];
+
+    out_file << "Brute force k-NN recall of fvec_L2sqr_ref.\n";
+    out_file << "Dataset " << base->file_name << ", " << base->n
+             << " vectors of " << dataset_dtype_name (base->dtype)
+             << ", dimension " << base->d << ".\n";
+    out_file << nq << " queries from " << queries->file_name << ", k = " << k
+             << ", reference ";
+    if (groundtruth)
+        out_file << "ground truth " << groundtruth->file_name << ".\n";
+    else
+        out_file << "base code results.\n";
+    out_file << "Code version\trecall@" << k << "\tms/query\tqueries/s\n";
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        size_t matches = 0;
+        double ms_per_query;
+
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        for (q = 0; q < nq; q++)
+            matches += count_matches (&found[code_ver][q * k], &ref[q * k],
+                                      k);
+
+        ms_per_query = (double) elapsed[code_ver] / nq / 1.0e6;
+
+        out_file << "  " << code_version_name (code_ver) << "\t" << fixed
+                 << setprecision (4) << (double) matches / (nq * k) << "\t"
+                 << setprecision (3) << ms_per_query << "\t"
+                 << setprecision (1) << 1.0e3 / ms_per_query << "\n";
+        out_file.unsetf (ios_base::floatfield);
+    }
+    out_file << "\n";
+
+    if (cmd_flags.early_abandon)
+        run_early_abandon_test (out_file, cmd_flags, &xb, &xq, nq, k);
+
+    topk_release (&res);
+    release_float_matrix (&xq);
+    release_float_matrix (&xb);
+}
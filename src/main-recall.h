@@ -0,0 +1,29 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_RECALL_H
+#define MAIN_RECALL_H
+
+#include <fstream>
+#include "main-helpers.h"
+#include "main-dataset.h"
+
+void run_recall_test (std::ofstream &out_file, struct flags_t cmd_flags,
+                      const struct dataset_t *base,
+                      const struct dataset_t *queries,
+                      const struct dataset_t *groundtruth);
+
+#endif /* MAIN_RECALL_H */
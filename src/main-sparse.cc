@@ -0,0 +1,447 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Sparse vector kernels.  With --sparse a database of SPARSE_DB_SIZE sparse
+   vectors is scanned with SPARSE_NUM_QUERIES queries for each profile in
+   sparse_profiles, with sparse queries and with the queries stored dense.
+   The number of nonzeros per vector is log-normal around the mean of the
+   profile and the indices are drawn uniformly or from a Zipf distribution,
+   as the terms of a vocabulary.  The array sizes do not apply, the test
+   runs once.  The time per database vector is reported and the distances
+   are checked against the base version of the sparse-sparse kernel.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "main-sparse.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "distances/base/sparse_distance.h"
+#include "distances/intrinsic/sparse_distance.h"
+
+static std::vector<struct sparse_result_t> sparse_results;
+
+/* Shape of the generated sparse vectors.  */
+struct sparse_profile_t {
+    const char *name;
+    size_t dim;
+    double query_nnz;           /* Mean nonzeros per query.  */
+    double doc_nnz;             /* Mean nonzeros per database vector.  */
+    double zipf_s;              /* Zipf exponent of the indices, 0 uniform.  */
+};
+
+static const struct sparse_profile_t sparse_profiles[] = {
+    /* Learned sparse retrieval over a BERT vocabulary, as SPLADE.  */
+    {"splade", 30522, 32, 128, 1.0},
+    /* Keyword queries over the same vocabulary.  */
+    {"short_query", 30522, 4, 64, 1.0},
+    /* 10% of the dimensions set, no frequent indices.  */
+    {"uniform", 1024, 102, 102, 0},
+};
+
+#define SPARSE_NUM_PROFILES \
+    (sizeof (sparse_profiles) / sizeof (sparse_profiles[0]))
+
+#define SPARSE_NNZ_SIGMA    0.5     /* Of the log-normal nonzero counts.  */
+
+typedef void (*svec_ny_fn_t) (float* dis, const int32_t* xi, const float* xv,
+                              size_t nx, const int64_t* y_offsets,
+                              const int32_t* y_ids, const float* y_vals,
+                              size_t ny);
+typedef void (*svec_dense_ip_ny_fn_t) (float* dis, const float* x,
+                                       const int64_t* y_offsets,
+                                       const int32_t* y_ids,
+                                       const float* y_vals, size_t ny);
+typedef void (*svec_dense_l2_ny_fn_t) (float* dis, const float* x,
+                                       float x_sqlen,
+                                       const int64_t* y_offsets,
+                                       const int32_t* y_ids,
+                                       const float* y_vals, size_t ny);
+
+/* The sparse functions of one code version, there is no optimized
+   version.  */
+struct sparse_kernels_t {
+    svec_ny_fn_t ip;
+    svec_ny_fn_t l2;
+    svec_dense_ip_ny_fn_t dense_ip;
+    svec_dense_l2_ny_fn_t dense_l2;
+};
+
+static const struct sparse_kernels_t sparse_kernels[NUM_CODE_VERSIONS] = {
+    {base::svec_inner_product_ny_ref, base::svec_L2sqr_ny_ref,
+     base::svec_dense_inner_product_ny_ref, base::svec_dense_L2sqr_ny_ref},
+    {NULL, NULL, NULL, NULL},
+    {powerpc::svec_inner_product_ny_ref_ippc,
+     powerpc::svec_L2sqr_ny_ref_ippc,
+     powerpc::svec_dense_inner_product_ny_ref_ippc,
+     powerpc::svec_dense_L2sqr_ny_ref_ippc},
+};
+
+static const char*
+sparse_kernel_name (unsigned int kernel)
+{
+    switch (kernel)
+    {
+    case SPARSE_IP:
+        return "ip";
+    case SPARSE_L2:
+        return "l2";
+    case SPARSE_DENSE_IP:
+        return "dense_ip";
+    case SPARSE_DENSE_L2:
+        return "dense_l2";
+    }
+    return "unknown";
+}
+
+static const char*
+sparse_function_name (unsigned int kernel)
+{
+    switch (kernel)
+    {
+    case SPARSE_IP:
+        return "svec_inner_product_ny_ref";
+    case SPARSE_L2:
+        return "svec_L2sqr_ny_ref";
+    case SPARSE_DENSE_IP:
+        return "svec_dense_inner_product_ny_ref";
+    case SPARSE_DENSE_L2:
+        return "svec_dense_L2sqr_ny_ref";
+    }
+    return "unknown";
+}
+
+/* A set of sparse vectors in CSR form, see base/sparse_distance.h.  */
+struct sparse_set_t {
+    std::vector<int64_t> offsets;
+    std::vector<int32_t> ids;
+    std::vector<float> vals;
+    size_t n;
+};
+
+/* The database, the queries and the queries stored dense with their
+   squared norms.  */
+struct sparse_db_t {
+    struct sparse_set_t y;
+    struct sparse_set_t x;
+    std::vector<float> x_dense;
+    std::vector<float> x_sqlen;
+    size_t dim;
+};
+
+/* Append n sparse vectors of the profile to set.  */
+static void
+generate_sparse_set (std::mt19937 &gen, const struct sparse_profile_t *prof,
+                     double mean_nnz, size_t n, struct sparse_set_t *set)
+{
+    using namespace std;
+    vector<double> weights (prof->dim, 1.0);
+    vector<int32_t> ids;
+    size_t i, j, nnz;
+
+    /* Index i has weight 1 / (i + 1)^s, the low indices are the frequent
+       terms.  */
+    if (prof->zipf_s > 0)
+        for (i = 0; i < prof->dim; i++)
+            weights[i] = 1.0 / pow ((double) (i + 1), prof->zipf_s);
+
+    discrete_distribution<int32_t> index (weights.begin (), weights.end ());
+    lognormal_distribution<double> count (log (mean_nnz) - SPARSE_NNZ_SIGMA
+                                          * SPARSE_NNZ_SIGMA / 2,
+                                          SPARSE_NNZ_SIGMA);
+    uniform_real_distribution<float> value (0.01f, 1.0f);
+
+    set->n = n;
+    set->offsets.push_back (0);
+    for (i = 0; i < n; i++)
+    {
+        nnz = (size_t) lround (count (gen));
+        nnz = std::min (std::max (nnz, (size_t) 1), prof->dim / 2);
+
+        /* Draw until there are nnz distinct indices.  */
+        ids.clear ();
+        while (ids.size () < nnz)
+        {
+            for (j = ids.size (); j < nnz; j++)
+                ids.push_back (index (gen));
+            sort (ids.begin (), ids.end ());
+            ids.erase (unique (ids.begin (), ids.end ()), ids.end ());
+        }
+
+        for (j = 0; j < nnz; j++)
+        {
+            set->ids.push_back (ids[j]);
+            set->vals.push_back (value (gen));
+        }
+        set->offsets.push_back (set->ids.size ());
+    }
+}
+
+/* Mean nonzeros per vector of set.  */
+static double
+sparse_mean_nnz (const struct sparse_set_t *set)
+{
+    return (double) set->ids.size () / set->n;
+}
+
+/* One scan of the database per query, the distances of query q go to
+   dis + q * SPARSE_DB_SIZE.  */
+static void
+run_sparse_pass (const struct sparse_kernels_t *k, unsigned int kernel,
+                 const struct sparse_db_t *db, float *dis)
+{
+    const struct sparse_set_t *x = &db->x;
+    const struct sparse_set_t *y = &db->y;
+    size_t q;
+
+    for (q = 0; q < SPARSE_NUM_QUERIES; q++)
+    {
+        int64_t start = x->offsets[q];
+        size_t nx = x->offsets[q + 1] - start;
+        float *dis_q = dis + q * SPARSE_DB_SIZE;
+
+        switch (kernel)
+        {
+        case SPARSE_IP:
+            k->ip (dis_q, x->ids.data () + start, x->vals.data () + start, nx,
+                   y->offsets.data (), y->ids.data (), y->vals.data (),
+                   SPARSE_DB_SIZE);
+            break;
+
+        case SPARSE_L2:
+            k->l2 (dis_q, x->ids.data () + start, x->vals.data () + start, nx,
+                   y->offsets.data (), y->ids.data (), y->vals.data (),
+                   SPARSE_DB_SIZE);
+            break;
+
+        case SPARSE_DENSE_IP:
+            k->dense_ip (dis_q, db->x_dense.data () + q * db->dim,
+                         y->offsets.data (), y->ids.data (), y->vals.data (),
+                         SPARSE_DB_SIZE);
+            break;
+
+        case SPARSE_DENSE_L2:
+            k->dense_l2 (dis_q, db->x_dense.data () + q * db->dim,
+                         db->x_sqlen[q], y->offsets.data (), y->ids.data (),
+                         y->vals.data (), SPARSE_DB_SIZE);
+            break;
+        }
+    }
+}
+
+void
+run_sparse_tests (struct flags_t cmd_flags)
+{
+    using namespace std;
+    vector<float> dis (SPARSE_NUM_QUERIES * SPARSE_DB_SIZE);
+    vector<float> ref_ip (SPARSE_NUM_QUERIES * SPARSE_DB_SIZE);
+    vector<float> ref_l2 (SPARSE_NUM_QUERIES * SPARSE_DB_SIZE);
+    unsigned long long int t0, t1;
+    unsigned int profile, code_ver, kernel;
+    size_t first, k, j, q;
+    int rep;
+
+    cout << "Sparse vector kernels" << endl;
+
+    for (profile = 0; profile < SPARSE_NUM_PROFILES; profile++)
+    {
+        const struct sparse_profile_t *prof = &sparse_profiles[profile];
+        struct sparse_db_t db;
+
+        mt19937 gen (SPARSE_SEED + profile);
+
+        db.dim = prof->dim;
+        generate_sparse_set (gen, prof, prof->doc_nnz, SPARSE_DB_SIZE, &db.y);
+        generate_sparse_set (gen, prof, prof->query_nnz, SPARSE_NUM_QUERIES,
+                             &db.x);
+
+        /* The dense copies of the queries are set up once and not
+           timed.  */
+        db.x_dense.assign (SPARSE_NUM_QUERIES * db.dim, 0.0f);
+        db.x_sqlen.assign (SPARSE_NUM_QUERIES, 0.0f);
+        for (q = 0; q < SPARSE_NUM_QUERIES; q++)
+            for (j = db.x.offsets[q]; j < (size_t) db.x.offsets[q + 1]; j++)
+            {
+                db.x_dense[q * db.dim + db.x.ids[j]] = db.x.vals[j];
+                db.x_sqlen[q] += db.x.vals[j] * db.x.vals[j];
+            }
+
+        first = sparse_results.size ();
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            if (!cmd_flags.run_code_version[code_ver]
+                || sparse_kernels[code_ver].ip == NULL)
+                continue;
+
+            for (kernel = 0; kernel < SPARSE_KERNEL_MAX; kernel++)
+            {
+                struct sparse_result_t res;
+
+                res.profile = profile;
+                res.code_ver = code_ver;
+                res.kernel = kernel;
+                res.query_nnz = sparse_mean_nnz (&db.x);
+                res.doc_nnz = sparse_mean_nnz (&db.y);
+                sparse_results.push_back (res);
+            }
+        }
+
+        /* Interleave the versions and kernels across the repetitions as
+           in main.  */
+        for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+            for (k = first; k < sparse_results.size (); k++)
+            {
+                struct sparse_result_t *res = &sparse_results[k];
+
+                t0 = get_time ();
+                run_sparse_pass (&sparse_kernels[res->code_ver], res->kernel,
+                                 &db, dis.data ());
+                t1 = get_time ();
+
+                if (rep >= cmd_flags.num_warmup)
+                    res->samples.push_back (t1 - t0);
+            }
+
+        /* Check the sparse and dense query kernels of each version against
+           the base sparse kernel of the metric.  The difference is relative
+           to the distance, absolute below 1 where the inner product of
+           vectors with few common indices is close to 0.  */
+        run_sparse_pass (&sparse_kernels[CODE_VER_ORIG], SPARSE_IP, &db,
+                         ref_ip.data ());
+        run_sparse_pass (&sparse_kernels[CODE_VER_ORIG], SPARSE_L2, &db,
+                         ref_l2.data ());
+
+        for (k = first; k < sparse_results.size (); k++)
+        {
+            struct sparse_result_t *res = &sparse_results[k];
+            const vector<float> &ref
+                = (res->kernel == SPARSE_IP || res->kernel == SPARSE_DENSE_IP)
+                  ? ref_ip : ref_l2;
+
+            compute_time_stats (res->samples, &res->stats);
+
+            run_sparse_pass (&sparse_kernels[res->code_ver], res->kernel,
+                             &db, dis.data ());
+            for (j = 0; j < dis.size (); j++)
+                check_rel_error (&res->max_err, dis[j], ref[j]);
+            res->mismatch = !(res->max_err < ERR_THRESHOLD);
+
+            if (res->mismatch)
+                cout << "WARNING, sparse " << sparse_kernel_name (res->kernel)
+                     << " kernel " << code_version_name (res->code_ver)
+                     << " version, profile " << prof->name
+                     << ", differs from the base version by "
+                     << res->max_err << ".\n";
+        }
+    }
+}
+
+/* Median ns per database vector.  */
+static double
+sparse_ns_per_vector (const struct sparse_result_t *res)
+{
+    return res->stats.median
+           / ((double) SPARSE_NUM_QUERIES * SPARSE_DB_SIZE);
+}
+
+/* One row per profile and code version with the ns per database vector of
+   each kernel, then the speedup of each kernel over the base version.  */
+void
+print_sparse_tests (std::ofstream &out_file)
+{
+    const struct sparse_result_t *base_row = NULL;
+    unsigned int kernel;
+    size_t n;
+
+    out_file << "Sparse vector kernels, median execution time per database"
+             << " vector in ns for a\ndatabase of " << SPARSE_DB_SIZE
+             << " sparse vectors and the speedup over the base version.\n"
+             << "The dense kernels take the queries stored dense.  Results"
+             << " that differ from\nthe base sparse kernel are marked with"
+             << " !.\n";
+    out_file << "Profile\tdims\tquery nnz\tdoc nnz\tversion";
+    for (kernel = 0; kernel < SPARSE_KERNEL_MAX; kernel++)
+        out_file << "\t" << sparse_kernel_name (kernel);
+    out_file << "\tspeedup";
+    for (kernel = 0; kernel < SPARSE_KERNEL_MAX; kernel++)
+        out_file << "\t" << sparse_kernel_name (kernel);
+    out_file << "\n";
+
+    /* The kernels of a profile and version are consecutive, the base
+       version is the first row of a profile.  */
+    for (n = 0; n + SPARSE_KERNEL_MAX <= sparse_results.size ();
+         n += SPARSE_KERNEL_MAX)
+    {
+        const struct sparse_result_t *row = &sparse_results[n];
+
+        if (row->code_ver == CODE_VER_ORIG)
+            base_row = row;
+
+        out_file << "  " << sparse_profiles[row->profile].name << "\t"
+                 << sparse_profiles[row->profile].dim << std::fixed
+                 << std::setprecision (1) << "\t" << row->query_nnz << "\t"
+                 << row->doc_nnz << "\t" << code_version_name (row->code_ver)
+                 << std::setprecision (2);
+        for (kernel = 0; kernel < SPARSE_KERNEL_MAX; kernel++)
+            out_file << "\t" << sparse_ns_per_vector (&row[kernel])
+                     << (row[kernel].mismatch ? "!" : "");
+
+        out_file << "\t" << std::setprecision (3);
+        for (kernel = 0; kernel < SPARSE_KERNEL_MAX; kernel++)
+            out_file << "\t" << base_row[kernel].stats.median
+                                / row[kernel].stats.median;
+        out_file << std::defaultfloat << std::setprecision (6) << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+write_json_sparse_results (std::ofstream &out_file, bool *first)
+{
+    for (size_t n = 0; n < sparse_results.size (); n++)
+    {
+        const struct sparse_result_t *res = &sparse_results[n];
+        const struct sparse_profile_t *prof = &sparse_profiles[res->profile];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"sparse_profile\": \"" << prof->name
+             << "\", \"dim\": " << prof->dim
+             << ", \"dtype\": \"float32\""
+             << std::fixed << std::setprecision (1)
+             << ", \"query_nnz\": " << res->query_nnz
+             << ", \"doc_nnz\": " << res->doc_nnz
+             << ", \"db_size\": " << SPARSE_DB_SIZE
+             << ", \"num_queries\": " << SPARSE_NUM_QUERIES
+             << std::setprecision (4)
+             << ", \"ns_per_vector\": " << sparse_ns_per_vector (res);
+
+        rec.mode = "sparse";
+        rec.kernel = sparse_function_name (res->kernel);
+        rec.version = code_version_name (res->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        rec.err_key = "max_err";
+        rec.max_err = res->max_err;
+        rec.checked = true;
+        rec.mismatch = res->mismatch;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
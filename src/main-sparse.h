@@ -0,0 +1,55 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_SPARSE_H
+#define MAIN_SPARSE_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+
+#define SPARSE_DB_SIZE      1024    /* Sparse vectors per scan.  */
+#define SPARSE_NUM_QUERIES  16      /* Scans per timed sample.  */
+#define SPARSE_SEED         2718
+
+/* Kernels timed per profile and code version, all scan the database.  */
+enum sparse_kernel_id {
+    SPARSE_IP = 0,              /* Sparse query, svec_inner_product_ny.  */
+    SPARSE_L2,                  /* Sparse query, svec_L2sqr_ny.  */
+    SPARSE_DENSE_IP,            /* Dense query, svec_dense_inner_product_ny.  */
+    SPARSE_DENSE_L2,            /* Dense query, svec_dense_L2sqr_ny.  */
+    SPARSE_KERNEL_MAX,
+};
+
+/* Time of one profile, code version and kernel.  */
+struct sparse_result_t {
+    unsigned int profile = 0;
+    unsigned int code_ver = 0;
+    unsigned int kernel = 0;
+    double query_nnz = 0;           /* Mean nnz of the generated vectors.  */
+    double doc_nnz = 0;
+    struct time_stats_t stats;
+    std::vector<unsigned long long int> samples;
+    double max_err = 0;             /* Against the base sparse kernel.  */
+    bool mismatch = false;
+};
+
+void run_sparse_tests (struct flags_t cmd_flags);
+
+void print_sparse_tests (std::ofstream &out_file);
+void write_json_sparse_results (std::ofstream &out_file, bool *first);
+
+#endif /* MAIN_SPARSE_H */
@@ -0,0 +1,398 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Each test is repeated num_warmup + num_reps times.  The warmup
+   repetitions are discarded, the remaining execution times are kept as
+   samples.  The samples are summarized as min, median, mean, 99th
+   percentile and standard deviation.  The speedup of the optimized and
+   intrinsic versions is the ratio of the median times with a bootstrap
+   confidence interval, so small differences between code versions can be
+   told apart from noise.  */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include "main-stats.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_AIX)
+#include <sys/processor.h>
+#include <sys/thread.h>
+#endif
+
+static double
+median_of_sorted (const std::vector<unsigned long long int> &sorted)
+{
+    size_t n = sorted.size ();
+
+    if (n == 0)
+        return 0;
+
+    if (n % 2)
+        return (double) sorted[n / 2];
+
+    return ((double) sorted[n / 2 - 1] + (double) sorted[n / 2]) / 2.0;
+}
+
+void
+compute_time_stats (const std::vector<unsigned long long int> &samples,
+                    struct time_stats_t *stats)
+{
+    std::vector<unsigned long long int> sorted (samples);
+    size_t n = sorted.size ();
+    size_t i, p99_index;
+    double sum = 0, sum_sq = 0;
+
+    *stats = time_stats_t ();
+    if (n == 0)
+        return;
+
+    std::sort (sorted.begin (), sorted.end ());
+
+    for (i = 0; i < n; i++)
+        sum += (double) sorted[i];
+
+    stats->min = (double) sorted[0];
+    stats->median = median_of_sorted (sorted);
+    stats->mean = sum / n;
+
+    /* Nearest rank percentile.  */
+    p99_index = (size_t) ceil (0.99 * n);
+    stats->p99 = (double) sorted[p99_index > 0 ? p99_index - 1 : 0];
+
+    for (i = 0; i < n; i++)
+        sum_sq += ((double) sorted[i] - stats->mean)
+            * ((double) sorted[i] - stats->mean);
+
+    /* Sample standard deviation.  */
+    if (n > 1)
+        stats->stddev = sqrt (sum_sq / (n - 1));
+}
+
+void
+bootstrap_speedup_ci (const std::vector<unsigned long long int> &base,
+                      const std::vector<unsigned long long int> &run,
+                      double *ratio, double *ci_low, double *ci_high)
+{
+    /* The speedup is median (base) / median (run).  The confidence interval
+       is taken from the distribution of the ratio over resamples of both
+       sets of samples drawn with replacement.  A fixed seed makes the
+       interval reproducible for the same samples.  */
+    std::vector<unsigned long long int> sorted_base (base);
+    std::vector<unsigned long long int> sorted_run (run);
+    std::vector<unsigned long long int> resample_base (base.size ());
+    std::vector<unsigned long long int> resample_run (run.size ());
+    std::vector<double> ratios;
+    std::mt19937 gen (BOOTSTRAP_SEED);
+    double alpha = (1.0 - CONFIDENCE_LEVEL) / 2.0;
+    double run_median;
+    size_t b, i;
+
+    *ratio = *ci_low = *ci_high = 0;
+    if (base.empty () || run.empty ())
+        return;
+
+    std::sort (sorted_base.begin (), sorted_base.end ());
+    std::sort (sorted_run.begin (), sorted_run.end ());
+    run_median = median_of_sorted (sorted_run);
+    if (run_median == 0)
+        return;
+
+    *ratio = median_of_sorted (sorted_base) / run_median;
+
+    std::uniform_int_distribution<size_t> pick_base (0, base.size () - 1);
+    std::uniform_int_distribution<size_t> pick_run (0, run.size () - 1);
+
+    ratios.reserve (BOOTSTRAP_RESAMPLES);
+    for (b = 0; b < BOOTSTRAP_RESAMPLES; b++)
+    {
+        for (i = 0; i < base.size (); i++)
+            resample_base[i] = base[pick_base (gen)];
+        for (i = 0; i < run.size (); i++)
+            resample_run[i] = run[pick_run (gen)];
+
+        std::sort (resample_base.begin (), resample_base.end ());
+        std::sort (resample_run.begin (), resample_run.end ());
+
+        run_median = median_of_sorted (resample_run);
+        if (run_median > 0)
+            ratios.push_back (median_of_sorted (resample_base) / run_median);
+    }
+
+    if (ratios.empty ())
+        return;
+
+    std::sort (ratios.begin (), ratios.end ());
+    *ci_low = ratios[(size_t) (alpha * (ratios.size () - 1))];
+    *ci_high = ratios[(size_t) ((1.0 - alpha) * (ratios.size () - 1))];
+}
+
+/* Raise *max_err to the difference of a result x from the reference ref,
+   relative to ref if |ref| > 1.  A NaN result is an infinite error, so it
+   is not lost to the next comparison.  */
+void
+check_rel_error (double *max_err, double x, double ref)
+{
+    double err = fabs (x - ref) / std::max (1.0, fabs (ref));
+
+    if (std::isnan (err))
+        err = HUGE_VAL;
+    if (!(err <= *max_err))
+        *max_err = err;
+}
+
+unsigned int
+calibrate_next_runs (unsigned int num_runs, unsigned long long int elapsed_ns,
+                     unsigned long long int target_ns, bool *done)
+{
+    /* Grow the number of runs by CALIBRATE_GROWTH until a loop takes at
+       least a tenth of the target time, which is long enough compared to
+       the timer resolution to estimate the time per run.  Then scale the
+       number of runs to the target time.  */
+    double runs;
+
+    if (elapsed_ns * CALIBRATE_GROWTH < target_ns
+        && num_runs < MAX_CALIBRATED_RUNS / CALIBRATE_GROWTH)
+    {
+        *done = false;
+        return num_runs * CALIBRATE_GROWTH;
+    }
+
+    *done = true;
+    if (elapsed_ns == 0)
+        return MAX_CALIBRATED_RUNS;
+
+    runs = (double) num_runs * target_ns / elapsed_ns;
+    if (runs < 1)
+        return 1;
+    if (runs > MAX_CALIBRATED_RUNS)
+        return MAX_CALIBRATED_RUNS;
+
+    return (unsigned int) runs;
+}
+
+unsigned long long int
+calibrate_target_ns (struct flags_t cmd_flags)
+{
+    /* The target time is for all of the timed repetitions of a test.  */
+    return (unsigned long long int) (cmd_flags.target_time_ms * 1000000.0
+                                     / cmd_flags.num_reps);
+}
+
+void
+clear_time_samples (struct results_data_t* result, unsigned int array_index)
+{
+    /* Discard the warmup repetitions.  */
+    unsigned int i, code_ver;
+
+    check_array_index (result, array_index);
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            result[i].time_samples[array_index][code_ver].clear ();
+            result[i].perf[array_index][code_ver] = perf_counts_t ();
+        }
+}
+
+void
+summarize_time_samples (struct results_data_t* result,
+                        unsigned int array_index)
+{
+    /* Compute the statistics of the repetitions.  The median is reported
+       as the execution time of the test.  */
+    unsigned int i, code_ver;
+
+    check_array_index (result, array_index);
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            struct time_stats_t *stats
+                = &result[i].time_stats[array_index][code_ver];
+
+            if (result[i].time_samples[array_index][code_ver].empty ())
+                continue;
+
+            compute_time_stats (result[i].time_samples[array_index][code_ver],
+                                stats);
+            result[i].execution_time[array_index][code_ver]
+                = (unsigned long long int) llround (stats->median);
+        }
+}
+
+int
+pin_to_cpu (int cpu)
+{
+    /* Bind the process to one CPU so the repetitions are not migrated
+       between CPUs with different cache contents or clock frequencies.
+       If cpu is -1, bind to the CPU the process is currently running on.
+       Returns the CPU number or -1 if the process could not be bound.  */
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+
+    if (cpu < 0)
+        cpu = sched_getcpu ();
+
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return -1;
+
+    CPU_ZERO (&cpu_set);
+    CPU_SET (cpu, &cpu_set);
+
+    if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set))
+        return -1;
+
+    return cpu;
+#elif defined(_AIX)
+    if (cpu < 0)
+        cpu = mycpu ();
+
+    if (bindprocessor (BINDTHREAD, thread_self (), cpu))
+        return -1;
+
+    return cpu;
+#else
+    return -1;
+#endif
+}
+
+static void
+print_time_stats_code_ver (std::ofstream &out_file, int fun_index_max,
+                           int array_index_max,
+                           struct results_data_t* result,
+                           struct flags_t cmd_flags,
+                           char group_id_name[][GROUP_ID_NAME_MAX],
+                           int code_ver, const char *suffix)
+{
+    unsigned int i, j;
+    int group_id = -1;     /* Initialize id to print group names  */
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        print_group_name (out_file, &group_id, i, result, group_id_name);
+
+        for (j = 0; j < array_index_max; j++)
+        {
+            struct time_stats_t *stats = &result[i].time_stats[j][code_ver];
+
+            out_file << "  " << result[i].function_name << suffix << "\t"
+                     << cmd_flags.array_sizes[j] << "\t"
+                     << result[i].num_runs[j] << "\t"
+                     << std::fixed << std::setprecision (0)
+                     << stats->min << "\t" << stats->median << "\t"
+                     << stats->mean << "\t" << stats->p99 << "\t"
+                     << stats->stddev << "\t"
+                     << std::setprecision (2)
+                     << (stats->median > 0 ?
+                         100.0 * stats->stddev / stats->median : 0)
+                     << "%\n";
+        }
+    }
+    out_file << "\n";
+}
+
+static void
+print_speedup_code_ver (std::ofstream &out_file, int fun_index_max,
+                        int array_index_max, struct results_data_t* result,
+                        struct flags_t cmd_flags,
+                        char group_id_name[][GROUP_ID_NAME_MAX],
+                        int code_ver, const char *suffix)
+{
+    unsigned int i, j;
+    int group_id = -1;     /* Initialize id to print group names  */
+    double ratio, ci_low, ci_high;
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        print_group_name (out_file, &group_id, i, result, group_id_name);
+
+        for (j = 0; j < array_index_max; j++)
+        {
+            bootstrap_speedup_ci (result[i].time_samples[j][CODE_VER_ORIG],
+                                  result[i].time_samples[j][code_ver],
+                                  &ratio, &ci_low, &ci_high);
+
+            out_file << "  " << result[i].function_name << suffix << "\t"
+                     << cmd_flags.array_sizes[j] << "\t"
+                     << std::fixed << std::setprecision (3)
+                     << ratio << "\t[" << ci_low << ", " << ci_high << "]\n";
+        }
+    }
+    out_file << "\n";
+}
+
+void
+print_time_stats (std::ofstream &out_file, int fun_index_max,
+                  int array_index_max, struct results_data_t* result,
+                  struct flags_t cmd_flags,
+                  char group_id_name[][GROUP_ID_NAME_MAX])
+{
+    unsigned int code_ver;
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+    const char *version_name[NUM_CODE_VERSIONS] = {"Original",
+                                                   "Optimized PowerPC",
+                                                   "Intrinsic PowerPC"};
+
+    out_file << "Execution time statistics in ns of the loops of runs calls"
+             << " over " << cmd_flags.num_reps
+             << " repetitions after " << cmd_flags.num_warmup
+             << " warmup repetitions";
+    if (cmd_flags.cpu >= 0)
+        out_file << ", pinned to CPU " << cmd_flags.cpu;
+    else
+        out_file << ", not pinned to a CPU";
+    out_file << ".\n\n";
+
+    for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        out_file << version_name[code_ver] << " code execution time "
+                 << "statistics in ns.\n";
+        out_file << "Function name\tarray size\truns\tmin\tmedian\tmean"
+                 << "\tp99\tstddev\tstddev/median\n";
+        print_time_stats_code_ver (out_file, fun_index_max, array_index_max,
+                                   result, cmd_flags, group_id_name, code_ver,
+                                   suffix[code_ver]);
+    }
+
+    for (code_ver = CODE_VER_ORIG + 1; code_ver < NUM_CODE_VERSIONS;
+         code_ver++)
+    {
+        if (!cmd_flags.run_code_version[code_ver])
+            continue;
+
+        out_file << "Speedup of " << version_name[code_ver]
+                 << " code versus original code, ratio of the median times"
+                 << " with " << (int) (CONFIDENCE_LEVEL * 100)
+                 << "% bootstrap confidence interval.\n";
+        out_file << "Function name\tarray size\tspeedup\tconfidence interval\n";
+        print_speedup_code_ver (out_file, fun_index_max, array_index_max,
+                                result, cmd_flags, group_id_name, code_ver,
+                                suffix[code_ver]);
+    }
+}
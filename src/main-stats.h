@@ -0,0 +1,61 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_STATS_H
+#define MAIN_STATS_H
+
+#include <vector>
+#include <fstream>
+#include "main-helpers.h"
+
+/* Number of bootstrap resamples and the confidence level used for the
+   confidence interval of the speedup ratio.  */
+#define BOOTSTRAP_RESAMPLES   1000
+#define CONFIDENCE_LEVEL      0.95
+#define BOOTSTRAP_SEED        4321
+
+/* Calibration of the number of runs, see calibrate_next_runs.  */
+#define CALIBRATE_GROWTH      10
+#define MAX_CALIBRATED_RUNS   (1U << 30)
+
+unsigned int calibrate_next_runs (unsigned int num_runs,
+                                  unsigned long long int elapsed_ns,
+                                  unsigned long long int target_ns,
+                                  bool *done);
+unsigned long long int calibrate_target_ns (struct flags_t cmd_flags);
+
+void compute_time_stats (const std::vector<unsigned long long int> &samples,
+                         struct time_stats_t *stats);
+
+void check_rel_error (double *max_err, double x, double ref);
+
+void bootstrap_speedup_ci (const std::vector<unsigned long long int> &base,
+                           const std::vector<unsigned long long int> &run,
+                           double *ratio, double *ci_low, double *ci_high);
+
+void clear_time_samples (struct results_data_t* result,
+                         unsigned int array_index);
+void summarize_time_samples (struct results_data_t* result,
+                             unsigned int array_index);
+
+int pin_to_cpu (int cpu);
+
+void print_time_stats (std::ofstream &out_file, int fun_index_max,
+                       int array_index_max, struct results_data_t* result,
+                       struct flags_t cmd_flags,
+                       char group_id_name[][GROUP_ID_NAME_MAX]);
+
+#endif /* MAIN_STATS_H */
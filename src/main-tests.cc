@@ -16,6 +16,8 @@
 
 #include "main-tests.h"
 #include "main-supported.h"
+#include "main-perf.h"
+#include "main-stats.h"
 
 void
 check_fun_id (unsigned int fun_id)
@@ -30,11 +32,27 @@ check_fun_id (unsigned int fun_id)
 }
 
 void
-check_array_index (unsigned int array_index)
+resize_results (struct results_data_t* result, size_t num_array_sizes)
+{
+    /* Size the per array size results of all of the functions.  */
+    for (unsigned int i = 0; i < FUNC_ID_MAX; i++)
+    {
+        result[i].execution_time.assign (num_array_sizes, {});
+        result[i].time_samples.assign (num_array_sizes, {});
+        result[i].time_stats.assign (num_array_sizes, {});
+        result[i].perf.assign (num_array_sizes, {});
+        result[i].num_runs.assign (num_array_sizes, 0);
+        result[i].result_i.assign (num_array_sizes, {});
+        result[i].result_f.assign (num_array_sizes, {});
+    }
+}
+
+void
+check_array_index (struct results_data_t* result, unsigned int array_index)
 {
     using namespace std;
 
-    if (array_index >= MAX_ARRAY_SIZES)
+    if (array_index >= result[0].execution_time.size ())
     {
         cout << "ERROR, check_array_index: index out of range " << array_index
              <<", exiting.\n";
@@ -62,14 +80,18 @@ record_time (unsigned int fun_id, unsigned int array_index,
              unsigned long long int  stop_time,
              struct results_data_t* result)
 {
-    /* Calculate excution time and print to out file in tab separated
-       format.  */
+    /* Calculate excution time and save it as one sample of the test.  The
+       samples are summarized once all of the repetitions are done.  */
     unsigned long long int nano_sec = stop_time - start_time;
     check_fun_id (fun_id);
-    check_array_index (array_index);
+    check_array_index (result, array_index);
     check_code_ver(code_ver);
 
     result[fun_id].execution_time[array_index][code_ver] = nano_sec;
+    result[fun_id].time_samples[array_index][code_ver].push_back (nano_sec);
+
+    /* Add the counts of the timed region if the counters are enabled.  */
+    perf_counters_read (&result[fun_id].perf[array_index][code_ver]);
 }
 
 #if GET_TIME_OF_DAY
@@ -108,7 +130,7 @@ void record_float_result (unsigned int fun_id, unsigned int array_index,
                           struct results_data_t*results)
 {
     check_fun_id (fun_id);
-    check_array_index (array_index);
+    check_array_index (results, array_index);
     check_code_ver(code_ver);
 
     results[fun_id].result_type = RESULT_FLOAT;
@@ -121,7 +143,7 @@ void record_int_result (unsigned int fun_id, unsigned int array_index,
                         struct results_data_t*results)
 {
     check_fun_id (fun_id);
-    check_array_index (array_index);
+    check_array_index (results, array_index);
     check_code_ver(code_ver);
 
     results[fun_id].result_type = RESULT_INT;
@@ -145,13 +167,15 @@ test_fvec_L2sqr_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
     result = 0;
 
     for (i = 0; i < num_runs; i++) {
         result += base::fvec_L2sqr_ref(x, y, (size_t)array_size);
     }
-    t1 = get_time();;
+    t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -161,6 +185,7 @@ test_fvec_L2sqr_ref (struct results_data_t* distance_results,
     /* Test the ppc version of the code */
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
+        perf_counters_start ();
         t0 = get_time();
         result = 0;
 
@@ -168,6 +193,7 @@ test_fvec_L2sqr_ref (struct results_data_t* distance_results,
             result += powerpc::fvec_L2sqr_ref_ppc (x, y, (size_t)array_size);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -178,6 +204,7 @@ test_fvec_L2sqr_ref (struct results_data_t* distance_results,
     /* Test the intrinsic ppc version of the code */
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
+        perf_counters_start ();
         t0 = get_time();
         result = 0;
 
@@ -185,6 +212,7 @@ test_fvec_L2sqr_ref (struct results_data_t* distance_results,
             result += powerpc::fvec_L2sqr_ref_ippc (x, y, (size_t)array_size);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -210,6 +238,7 @@ test_fvec_norm_L2sqr_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
     result = 0;
 
@@ -217,6 +246,7 @@ test_fvec_norm_L2sqr_ref (struct results_data_t* distance_results,
         result += base::fvec_norm_L2sqr_ref (x, (size_t)array_size);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -226,6 +256,7 @@ test_fvec_norm_L2sqr_ref (struct results_data_t* distance_results,
     /* Test the ppc version of the code */
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
+        perf_counters_start ();
         t0 = get_time();
         result = 0;
 
@@ -233,6 +264,7 @@ test_fvec_norm_L2sqr_ref (struct results_data_t* distance_results,
             result += powerpc::fvec_norm_L2sqr_ref_ppc (x, (size_t)array_size);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -243,6 +275,7 @@ test_fvec_norm_L2sqr_ref (struct results_data_t* distance_results,
     /* Test the ppc intrinsic version of the code */
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
+        perf_counters_start ();
         t0 = get_time();
         result = 0;
 
@@ -251,6 +284,7 @@ test_fvec_norm_L2sqr_ref (struct results_data_t* distance_results,
                                                          (size_t)array_size);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -279,12 +313,14 @@ test_fvec_L2sqr_ny_transposed_ref (
         dis[i] = 0.0;
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         base::fvec_L2sqr_ny_transposed_ref (dis, x, y0, y1, d, d_offset, ny);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -304,6 +340,7 @@ test_fvec_L2sqr_ny_transposed_ref (
         for (i = 0; i < ny; i++)
             dis[i] = 0.0;
 
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -311,6 +348,7 @@ test_fvec_L2sqr_ny_transposed_ref (
                                                        d_offset, ny);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -331,6 +369,7 @@ test_fvec_L2sqr_ny_transposed_ref (
         for (i = 0; i < ny; i++)
             dis[i] = 0.0;
 
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -338,6 +377,7 @@ test_fvec_L2sqr_ny_transposed_ref (
                                                         d_offset, ny);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -379,6 +419,7 @@ test_fvec_L2sqr_batch_4_ref (struct results_data_t* distance_results,
     dp2 = 0;
     dp3 = 0;
 
+    perf_counters_start ();
     t0 = get_time();
     result = 0;
 
@@ -389,6 +430,7 @@ test_fvec_L2sqr_batch_4_ref (struct results_data_t* distance_results,
 	    result += dp0 + dp1 + dp2 + dp3;
 	}
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -400,6 +442,7 @@ test_fvec_L2sqr_batch_4_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -410,6 +453,7 @@ test_fvec_L2sqr_batch_4_ref (struct results_data_t* distance_results,
         }
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -422,6 +466,7 @@ test_fvec_L2sqr_batch_4_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -432,6 +477,7 @@ test_fvec_L2sqr_batch_4_ref (struct results_data_t* distance_results,
         }
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -459,12 +505,14 @@ test_ivec_L2sqr_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         result = base::ivec_L2sqr_ref (x, y, d);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -476,12 +524,14 @@ test_ivec_L2sqr_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::ivec_L2sqr_ref_ppc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -494,12 +544,14 @@ test_ivec_L2sqr_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::ivec_L2sqr_ref_ippc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -528,6 +580,7 @@ test_fvec_inner_product_ref (struct results_data_t* inner_prod_result,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
     result = 0;
 
@@ -535,6 +588,7 @@ test_fvec_inner_product_ref (struct results_data_t* inner_prod_result,
         result += base::fvec_inner_product_ref(x, y, (size_t)array_size);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  inner_prod_result);
@@ -544,6 +598,7 @@ test_fvec_inner_product_ref (struct results_data_t* inner_prod_result,
     /* Test the ppc version of the code */
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
+        perf_counters_start ();
         t0 = get_time();
         result = 0;
 
@@ -552,6 +607,7 @@ test_fvec_inner_product_ref (struct results_data_t* inner_prod_result,
                                                            (size_t)array_size);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      inner_prod_result);
@@ -562,6 +618,7 @@ test_fvec_inner_product_ref (struct results_data_t* inner_prod_result,
     /* Test the ppc intrinsic version of the code */
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
+        perf_counters_start ();
         t0 = get_time();
         result = 0;
 
@@ -570,6 +627,7 @@ test_fvec_inner_product_ref (struct results_data_t* inner_prod_result,
                                                            (size_t)array_size);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      inner_prod_result);
@@ -607,6 +665,7 @@ test_fvec_inner_product_batch_4_ref (struct results_data_t* distance_results,
     dp2 = 0;
     dp3 = 0;
 
+    perf_counters_start ();
     t0 = get_time();
     result = 0;
 
@@ -617,6 +676,7 @@ test_fvec_inner_product_batch_4_ref (struct results_data_t* distance_results,
 	    result += dp0 + dp1 + dp2 + dp3;
 	}
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -628,6 +688,7 @@ test_fvec_inner_product_batch_4_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -638,6 +699,7 @@ test_fvec_inner_product_batch_4_ref (struct results_data_t* distance_results,
         }
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -650,6 +712,7 @@ test_fvec_inner_product_batch_4_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -660,6 +723,7 @@ test_fvec_inner_product_batch_4_ref (struct results_data_t* distance_results,
         }
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -687,12 +751,14 @@ test_ivec_inner_product_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         result = base::ivec_inner_product_ref (x, y, d);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -704,12 +770,14 @@ test_ivec_inner_product_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::ivec_inner_product_ref_ppc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -722,12 +790,14 @@ test_ivec_inner_product_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::ivec_inner_product_ref_ippc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -758,12 +828,14 @@ test_fvec_L1_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         result = base::fvec_L1_ref (x, y, d);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -775,12 +847,14 @@ test_fvec_L1_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::fvec_L1_ref_ppc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -793,12 +867,14 @@ test_fvec_L1_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::fvec_L1_ref_ippc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -829,12 +905,14 @@ test_cosine_distance_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         result = base::cosine_distance_ref (x, y, d);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -846,12 +924,14 @@ test_cosine_distance_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::cosine_distance_ref_ppc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -864,12 +944,14 @@ test_cosine_distance_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::cosine_distance_ref_ippc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -901,12 +983,14 @@ test_hamming_distance_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         result = base::hamming_distance_ref (vec1, vec2, size);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -918,6 +1002,7 @@ test_hamming_distance_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -927,6 +1012,7 @@ test_hamming_distance_ref (struct results_data_t* distance_results,
             result = base::hamming_distance_ref (vec1, vec2, size);
 #endif
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -939,6 +1025,7 @@ test_hamming_distance_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
@@ -949,6 +1036,7 @@ test_hamming_distance_ref (struct results_data_t* distance_results,
 #endif
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -979,12 +1067,14 @@ test_jaccard_distance_ref (struct results_data_t* distance_results,
     check_fun_id (fun_id);
 
     /* Test the original code */
+    perf_counters_start ();
     t0 = get_time();
 
     for (i = 0; i < num_runs; i++)
         result = base::jaccard_distance_ref (x, y, d);
 
     t1 = get_time();
+    perf_counters_stop ();
 
     record_time (fun_id, array_index, CODE_VER_ORIG, t0, t1,
                  distance_results);
@@ -996,12 +1086,14 @@ test_jaccard_distance_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_OPTIMIZED_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::jaccard_distance_ref_ppc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_OPTIMIZED_PPC, t0, t1,
                      distance_results);
@@ -1014,12 +1106,14 @@ test_jaccard_distance_ref (struct results_data_t* distance_results,
     if (run_code_version[RUN_INTRINSIC_CODE])
     {
         result = 0;
+        perf_counters_start ();
         t0 = get_time();
 
         for (i = 0; i < num_runs; i++)
             result = powerpc::jaccard_distance_ippc (x, y, d);
 
         t1 = get_time();
+        perf_counters_stop ();
 
         record_time (fun_id, array_index, CODE_INTRINSIC_PPC, t0, t1,
                      distance_results);
@@ -1030,3 +1124,151 @@ test_jaccard_distance_ref (struct results_data_t* distance_results,
 
     return 0;
 }
+
+/**********  Test dispatch *************/
+
+int
+run_test (struct results_data_t* result, unsigned int fun_id,
+          unsigned int array_index, unsigned int num_runs,
+          bool run_code_version[NUM_CODE_VERSIONS],
+          struct test_data_t *data)
+{
+    /* Run the test of function fun_id on the input arrays in data.  */
+    using namespace std;
+    size_t size = data->size;
+
+    check_fun_id (fun_id);
+
+    switch (fun_id)
+    {
+    /**********  Eulcidian tests *************/
+    case FVEC_L2SQR_REF:
+        return test_fvec_L2sqr_ref (result, fun_id, array_index, num_runs,
+                                    run_code_version, data->x, data->y2,
+                                    size);
+
+    case FVEC_NORM_L2SQR_REF:
+        return test_fvec_norm_L2sqr_ref (result, fun_id, array_index,
+                                         num_runs, run_code_version, data->x,
+                                         size);
+
+    case FVEC_L2SQR_NY_TRANSPOSED_REF:
+        return test_fvec_L2sqr_ny_transposed_ref (result, fun_id, array_index,
+                                                  num_runs, run_code_version,
+                                                  data->dis, data->x,
+                                                  data->y1, data->y2,
+                                                  size / 4, 2, NY_DISTANCE);
+
+    case FVEC_L2SQR_BATCH_4_REF:
+        return test_fvec_L2sqr_batch_4_ref (result, fun_id, array_index,
+                                            num_runs, run_code_version,
+                                            data->x, data->y0, data->y1,
+                                            data->y2, data->y3, size,
+                                            data->dp0, data->dp1, data->dp2,
+                                            data->dp3);
+
+    case IVEC_L2SQR_REF:
+        return test_ivec_L2sqr_ref (result, fun_id, array_index, num_runs,
+                                    run_code_version, data->xi, data->yi,
+                                    size);
+
+    /**********  Inner product tests *************/
+    case FVEC_INNER_PRODUCT_REF:
+        return test_fvec_inner_product_ref (result, fun_id, array_index,
+                                            num_runs, run_code_version,
+                                            data->x, data->y2, size);
+
+    case FVEC_INNER_PRODUCT_BATCH_4_REF:
+        return test_fvec_inner_product_batch_4_ref (result, fun_id,
+                                                    array_index, num_runs,
+                                                    run_code_version,
+                                                    data->x, data->y0,
+                                                    data->y1, data->y2,
+                                                    data->y3, size,
+                                                    data->dp0, data->dp1,
+                                                    data->dp2, data->dp3);
+
+    case IVEC_INNER_PRODUCT_REF:
+        return test_ivec_inner_product_ref (result, fun_id, array_index,
+                                            num_runs, run_code_version,
+                                            data->xi, data->yi, size);
+
+    /**********  Manhattan, cosine, Hamming and Jaccard tests *************/
+    case FVEC_L1_REF:
+        return test_fvec_L1_ref (result, fun_id, array_index, num_runs,
+                                 run_code_version, data->x, data->y0, size);
+
+    case COSINE_DISTANCE_REF:
+        return test_cosine_distance_ref (result, fun_id, array_index,
+                                         num_runs, run_code_version, data->x,
+                                         data->y0, size);
+
+    case HAMMING_DISTANCE_REF:
+        return test_hamming_distance_ref (result, fun_id, array_index,
+                                          num_runs, run_code_version,
+                                          data->c1, data->c2, size);
+
+    case JACCARD_DISTANCE_REF:
+        return test_jaccard_distance_ref (result, fun_id, array_index,
+                                          num_runs, run_code_version, data->x,
+                                          data->y0, size);
+
+    default:
+        cout << "ERROR, run_test: no test for func_id " << fun_id
+             << ", exiting.\n";
+        exit(-1);
+    }
+}
+
+unsigned int
+calibrate_runs (calibrate_run_fn_t run, void *arg,
+                unsigned long long int target_ns)
+{
+    /* Find the number of runs for which one run of the test, all of the
+       code versions, takes about target_ns.  The samples recorded while
+       calibrating are discarded with the warmup repetitions.  */
+    unsigned long long int t0, t1;
+    unsigned int num_runs = 1;
+    bool done = false;
+
+    while (!done)
+    {
+        t0 = get_time();
+        run (arg, num_runs);
+        t1 = get_time();
+
+        num_runs = calibrate_next_runs (num_runs, t1 - t0, target_ns, &done);
+    }
+    return num_runs;
+}
+
+/* Arguments of run_test while calibrating.  */
+struct calibrate_test_arg_t {
+    struct results_data_t* result;
+    unsigned int fun_id;
+    unsigned int array_index;
+    bool *run_code_version;
+    struct test_data_t *data;
+};
+
+static void
+calibrate_test_run (void *arg, unsigned int num_runs)
+{
+    struct calibrate_test_arg_t *a = (struct calibrate_test_arg_t *) arg;
+
+    run_test (a->result, a->fun_id, a->array_index, num_runs,
+              a->run_code_version, a->data);
+}
+
+unsigned int
+calibrate_test (struct results_data_t* result, unsigned int fun_id,
+                unsigned int array_index,
+                bool run_code_version[NUM_CODE_VERSIONS],
+                struct test_data_t *data,
+                unsigned long long int target_ns)
+{
+    struct calibrate_test_arg_t arg = { result, fun_id, array_index,
+                                        run_code_version, data };
+
+    return calibrate_runs (calibrate_test_run, &arg, target_ns);
+}
@@ -14,10 +14,15 @@
  * limitations under the License.
  */
 
+#ifndef MAIN_TESTS_H
+#define MAIN_TESTS_H
+
 #include <stdio.h>
 #include <ctime>
 #include <ios>
 #include <iostream>
+#include <array>
+#include <vector>
 
 #include "distances/intrinsic/euclidean_l2_distance.h"
 #include "distances/optimized/euclidean_l2_distance.h"
@@ -44,7 +49,9 @@
 #include "distances/base/jaccard_distance.h"
 
 #define NAME_LEN 60
-#define MAX_ARRAY_SIZES 20
+
+/* Number of vectors passed to the ny_transposed functions.  */
+#define NY_DISTANCE 8
 
 #define RESULT_FLOAT 0
 #define RESULT_INT   1
@@ -58,13 +65,53 @@
 #define RUN_OPTIMIZED_CODE  1
 #define RUN_INTRINSIC_CODE  2
 
+/* Summary of the execution times of the repetitions of a test, see
+   main-stats.cc.  */
+struct time_stats_t {
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double p99 = 0;
+    double stddev = 0;
+};
+
+/* Hardware performance counters read around each timed region, see
+   main-perf.cc.  */
+enum perf_event_id {
+    PERF_CYCLES = 0,             /* Group leader.  */
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_VECTOR_OPS,             /* Raw event, only if --perf_raw_event.  */
+    PERF_EVENT_MAX,
+};
+
+/* Counts summed over the timed repetitions of a test.  */
+struct perf_counts_t {
+    unsigned long long int value[PERF_EVENT_MAX] = {};
+    bool valid[PERF_EVENT_MAX] = {};
+    unsigned int num_samples = 0;
+};
+
+/* The per array size results are indexed [array_index][code_ver].  They are
+   sized to the number of array sizes with resize_results.  */
 struct results_data_t {
     char function_name[NAME_LEN];
-    unsigned long long int execution_time[MAX_ARRAY_SIZES][NUM_CODE_VERSIONS];
+    /* Median of the repetitions once summarize_time_samples is called.  */
+    std::vector<std::array<unsigned long long int, NUM_CODE_VERSIONS> >
+        execution_time;
+    std::vector<std::array<std::vector<unsigned long long int>,
+                           NUM_CODE_VERSIONS> > time_samples;
+    std::vector<std::array<struct time_stats_t, NUM_CODE_VERSIONS> >
+        time_stats;
+    std::vector<std::array<struct perf_counts_t, NUM_CODE_VERSIONS> > perf;
+    /* Number of calls in each timed loop, from -R or calibrated.  */
+    std::vector<unsigned int> num_runs;
     int result_type = -1;
     int test_group = -1;           /* In group of euclidean, innerproduct..*/
-    long int result_i[MAX_ARRAY_SIZES][NUM_CODE_VERSIONS];
-    float result_f[MAX_ARRAY_SIZES][NUM_CODE_VERSIONS];
+    std::vector<std::array<long int, NUM_CODE_VERSIONS> > result_i;
+    std::vector<std::array<float, NUM_CODE_VERSIONS> > result_f;
 };
 
 enum func_id {
@@ -83,8 +130,24 @@ enum func_id {
     FUNC_ID_MAX,
 };
 
+/* The input arrays of one array size, passed to run_test.  */
+struct test_data_t {
+    const float *x, *y0, *y1, *y2, *y3;
+    const int8_t *xi, *yi;
+    const uint8_t *c1, *c2;
+    float *dis;
+    size_t size;
+    float dp0, dp1, dp2, dp3;
+};
+
 void
-check_array_index (unsigned int array_index);
+resize_results (struct results_data_t* result, size_t num_array_sizes);
+
+void
+check_array_index (struct results_data_t* result, unsigned int array_index);
+
+unsigned long long int
+get_time (void);
 
 void
 record_time(unsigned int fun_id, unsigned int array_index,
@@ -209,4 +272,25 @@ test_jaccard_distance_ref (struct results_data_t* distance_results,
                            bool run_code_version[NUM_CODE_VERSIONS],
                            const float* x, const float* y, size_t d);
 
-
+int
+run_test (struct results_data_t* result, unsigned int fun_id,
+          unsigned int array_index, unsigned int num_runs,
+          bool run_code_version[NUM_CODE_VERSIONS],
+          struct test_data_t *data);
+
+/* Runs num_runs calls of each code version of a test, the loop timed by
+   calibrate_runs.  */
+typedef void (*calibrate_run_fn_t) (void *arg, unsigned int num_runs);
+
+unsigned int
+calibrate_runs (calibrate_run_fn_t run, void *arg,
+                unsigned long long int target_ns);
+
+unsigned int
+calibrate_test (struct results_data_t* result, unsigned int fun_id,
+                unsigned int array_index,
+                bool run_code_version[NUM_CODE_VERSIONS],
+                struct test_data_t *data,
+                unsigned long long int target_ns);
+
+#endif /* MAIN_TESTS_H */
@@ -0,0 +1,837 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Thread scaling test.  With --threads each function is run concurrently
+   on each of the given numbers of threads.  Every thread calls the function
+   over a working set database, its own or one shared by all threads, as in
+   main-working-set.cc.  The threads are bound to CPUs so the SMT threads of
+   a core are filled first (compact) or one thread is placed per core first
+   (spread), giving the SMT and the core scaling curves.  The aggregate
+   vectors/s, the efficiency per thread and the database bandwidth are
+   reported.  With --numa_matrix the threads of each node read databases
+   bound to each node, giving the local and remote bandwidth.  */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "main-threads.h"
+#include "main-working-set.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "main-numa.h"
+
+/* Results of all of the array sizes and thread counts, printed at the end
+   of the run.  */
+static std::vector<struct thread_result_t> thread_results;
+
+/* A database shared by the threads.  With --numa_replicas there is one
+   per node, read by the threads running on the node.  */
+struct thread_shared_db_t {
+    int node = NUMA_NODE_ANY;
+    struct vector_db_t float_db;
+    struct vector_db_t byte_db;
+};
+
+/* Reusable barrier for the main thread and the worker threads.  */
+struct thread_barrier_t {
+    std::mutex lock;
+    std::condition_variable cond;
+    int count = 0;
+    int waiting = 0;
+    unsigned long int generation = 0;
+};
+
+static void
+barrier_wait (struct thread_barrier_t *b)
+{
+    std::unique_lock<std::mutex> guard (b->lock);
+    unsigned long int generation = b->generation;
+
+    if (++b->waiting == b->count)
+    {
+        b->waiting = 0;
+        b->generation++;
+        b->cond.notify_all ();
+    }
+    else
+        b->cond.wait (guard, [&] { return generation != b->generation; });
+}
+
+/* The worker threads and the job they run.  The main thread sets the job,
+   releases the workers with the start barrier and waits for them at the
+   done barrier.  */
+struct thread_pool_t {
+    int num_threads = 0;
+    std::vector<int> cpus;          /* CPU to bind each thread to.  */
+    std::vector<int> bound;         /* CPU bound to, -1 if not bound.  */
+
+    size_t d = 0;
+    size_t bytes = 0;
+    const struct flags_t *flags = NULL;
+    const struct dataset_t *ds = NULL;
+
+    /* Used by all threads with --shared_db.  */
+    const std::vector<struct thread_shared_db_t> *shared = NULL;
+    const float *shared_x_flt = NULL;
+    const uint8_t *shared_x_byte = NULL;
+
+    struct thread_barrier_t start;
+    struct thread_barrier_t done;
+
+    unsigned int fun_id = 0;
+    unsigned int code_ver = 0;
+    unsigned int num_runs = 0;
+    bool quit = false;
+
+    std::vector<unsigned long long int> t0;
+    std::vector<unsigned long long int> t1;
+    std::vector<double> sum;
+};
+
+static void
+thread_worker (struct thread_pool_t *pool, int index)
+{
+    struct vector_db_t own_float_db, own_byte_db;
+    const struct vector_db_t *float_db, *byte_db;
+    float *own_x_flt = NULL;
+    uint8_t *own_x_byte = NULL;
+    const float *x_flt;
+    const uint8_t *x_byte;
+    const struct vector_db_t *db;
+    const void *x;
+    int node;
+
+    pool->bound[index] = pin_to_cpu (pool->cpus[index]);
+
+    /* Each thread fills its own database after binding, so with first
+       touch placement the pages are placed near the CPU.  */
+    if (pool->shared)
+    {
+        const struct thread_shared_db_t *replica = &(*pool->shared)[0];
+
+        /* The replica on the node of the thread, if there is one.  */
+        node = numa_node_of_cpu (pool->bound[index]);
+        for (size_t r = 0; r < pool->shared->size (); r++)
+            if ((*pool->shared)[r].node == node)
+                replica = &(*pool->shared)[r];
+
+        float_db = &replica->float_db;
+        byte_db = &replica->byte_db;
+        x_flt = pool->shared_x_flt;
+        x_byte = pool->shared_x_byte;
+    }
+    else
+    {
+        node = numa_policy_node (*pool->flags, pool->bound[index]);
+        alloc_vector_db (&own_float_db, pool->d, sizeof (float), pool->bytes,
+                         pool->flags->random_access, pool->ds, node,
+                         page_size_arena_flags (*pool->flags));
+        alloc_vector_db (&own_byte_db, pool->d, sizeof (uint8_t),
+                         pool->bytes, pool->flags->random_access, pool->ds,
+                         node, page_size_arena_flags (*pool->flags));
+        alloc_working_set_query (pool->d, pool->ds, &own_x_flt, &own_x_byte);
+        float_db = &own_float_db;
+        byte_db = &own_byte_db;
+        x_flt = own_x_flt;
+        x_byte = own_x_byte;
+    }
+
+    /* Ready.  */
+    barrier_wait (&pool->done);
+
+    for (;;)
+    {
+        barrier_wait (&pool->start);
+        if (pool->quit)
+            break;
+
+        /* Use the database matching the element size of the function.  */
+        if (get_kernel_info (pool->fun_id)->elem_size == sizeof (float))
+        {
+            db = float_db;
+            x = x_flt;
+        }
+        else
+        {
+            db = byte_db;
+            x = x_byte;
+        }
+
+        pool->t0[index] = get_time ();
+        pool->sum[index] = run_working_set_kernel (pool->fun_id,
+                                                   pool->code_ver, db, x,
+                                                   pool->num_runs);
+        pool->t1[index] = get_time ();
+
+        barrier_wait (&pool->done);
+    }
+
+    if (!pool->shared)
+    {
+        release_vector_db (&own_float_db);
+        release_vector_db (&own_byte_db);
+        free (own_x_flt);
+        free (own_x_byte);
+    }
+}
+
+/* Run the current job on all threads and return the wall time from the
+   first thread starting to the last thread finishing.  */
+static unsigned long long int
+run_pool_job (struct thread_pool_t *pool, unsigned int fun_id,
+              unsigned int code_ver, unsigned int num_runs)
+{
+    unsigned long long int first, last;
+
+    pool->fun_id = fun_id;
+    pool->code_ver = code_ver;
+    pool->num_runs = num_runs;
+
+    barrier_wait (&pool->start);
+    barrier_wait (&pool->done);
+
+    first = pool->t0[0];
+    last = pool->t1[0];
+    for (int i = 1; i < pool->num_threads; i++)
+    {
+        if (pool->t0[i] < first)
+            first = pool->t0[i];
+        if (pool->t1[i] > last)
+            last = pool->t1[i];
+    }
+    return last - first;
+}
+
+/* Number of SMT threads per core, from the thread siblings of CPU 0.  */
+static int
+get_smt_width (void)
+{
+    int width = 0;
+#if defined(__linux__)
+    FILE *file = fopen ("/sys/devices/system/cpu/cpu0/topology/"
+                        "thread_siblings_list", "r");
+    int first, last;
+    char sep = '\n';
+
+    if (file == NULL)
+        return 1;
+
+    /* The list is a set of ranges, for example 0-7 or 0,4.  */
+    while (fscanf (file, "%d", &first) == 1)
+    {
+        last = first;
+        if (fscanf (file, "%c", &sep) != 1)
+            sep = '\n';
+        if (sep == '-')
+        {
+            if (fscanf (file, "%d", &last) != 1)
+                break;
+            if (fscanf (file, "%c", &sep) != 1)
+                sep = '\n';
+        }
+        width += last - first + 1;
+        if (sep != ',')
+            break;
+    }
+    fclose (file);
+#endif
+    return width > 0 ? width : 1;
+}
+
+/* CPU to bind thread number thread to.  With --thread_node the threads
+   are placed on the CPUs of the node.  */
+int
+get_thread_cpu (struct flags_t cmd_flags, int thread)
+{
+    std::vector<int> cpus;
+    long num_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+    int smt, num_cores;
+
+    if (!cmd_flags.thread_cpus.empty ())
+        return cmd_flags.thread_cpus[thread % cmd_flags.thread_cpus.size ()];
+
+    if (cmd_flags.thread_node >= 0
+        && numa_node_cpus (cmd_flags.thread_node, cpus) == 0)
+        num_cpus = cpus.size ();
+    else
+    {
+        if (num_cpus < 1)
+            num_cpus = 1;
+        for (long i = 0; i < num_cpus; i++)
+            cpus.push_back ((int) i);
+    }
+
+    if (cmd_flags.placement == PLACEMENT_COMPACT)
+        return cpus[thread % num_cpus];
+
+    /* Spread, thread i goes on core i until every core has a thread, then
+       on the next SMT thread of each core.  */
+    smt = get_smt_width ();
+    num_cores = num_cpus / smt > 0 ? num_cpus / smt : 1;
+
+    return cpus[((thread % num_cores) * smt + (thread / num_cores) % smt)
+                % num_cpus];
+}
+
+static size_t
+thread_db_bytes (struct flags_t cmd_flags)
+{
+    /* Without a working set the databases fit in half of the L1 cache, so
+       the test shows how well the functions use the load and vector units
+       of a core.  */
+    if (cmd_flags.working_set == WORKING_SET_NONE)
+        return get_cache_size (1) / CACHE_FRACTION_DIVISOR;
+
+    return get_working_set_bytes (cmd_flags);
+}
+
+static const char*
+thread_working_set_name (struct flags_t cmd_flags)
+{
+    if (cmd_flags.working_set == WORKING_SET_NONE)
+        return "L1";
+
+    return working_set_name (cmd_flags);
+}
+
+static bool
+run_thread_test_fun (struct flags_t cmd_flags, unsigned int fun_id)
+{
+    return cmd_flags.run_func_flag[fun_id]
+        && get_kernel_info (fun_id)->sig != SIG_FVEC_NY_TRANSPOSED;
+}
+
+/* Run the functions on num_threads threads.  The NUMA matrix results are
+   tagged with the node of the threads and of the databases.  */
+static void
+run_thread_count (unsigned int array_index, size_t d, struct flags_t cmd_flags,
+                  const struct dataset_t *ds, int num_threads,
+                  const std::vector<struct thread_shared_db_t> *shared,
+                  const float *shared_x_flt, const uint8_t *shared_x_byte,
+                  int cpu_node, int mem_node)
+{
+    using namespace std;
+    struct thread_pool_t pool;
+    std::vector<std::thread> threads;
+    unsigned int num_runs[FUNC_ID_MAX][NUM_CODE_VERSIONS];
+    std::vector<unsigned long long int>
+        samples[FUNC_ID_MAX][NUM_CODE_VERSIONS];
+    unsigned int i, code_ver;
+    int t, rep;
+    bool all_bound = true;
+
+    pool.num_threads = num_threads;
+    pool.d = d;
+    pool.bytes = thread_db_bytes (cmd_flags);
+    pool.flags = &cmd_flags;
+    pool.ds = ds;
+    pool.shared = shared;
+    pool.shared_x_flt = shared_x_flt;
+    pool.shared_x_byte = shared_x_byte;
+    pool.start.count = num_threads + 1;
+    pool.done.count = num_threads + 1;
+    pool.bound.assign (num_threads, -1);
+    pool.t0.assign (num_threads, 0);
+    pool.t1.assign (num_threads, 0);
+    pool.sum.assign (num_threads, 0);
+
+    for (t = 0; t < num_threads; t++)
+        pool.cpus.push_back (get_thread_cpu (cmd_flags, t));
+
+    for (t = 0; t < num_threads; t++)
+        threads.push_back (std::thread (thread_worker, &pool, t));
+
+    /* Wait for the threads to bind and set up their databases.  */
+    barrier_wait (&pool.done);
+
+    cout << "  " << num_threads << " threads on CPUs";
+    for (t = 0; t < num_threads; t++)
+    {
+        cout << " " << pool.bound[t];
+        if (pool.bound[t] < 0)
+            all_bound = false;
+    }
+    cout << endl;
+
+    if (!all_bound)
+        cout << "WARNING, could not bind all of the threads to a CPU, the"
+             << " scaling may vary.\n";
+
+    /* Calibrate the number of calls per thread so the repetitions of each
+       test take the target time on this number of threads.  */
+    for (i = 0; i < FUNC_ID_MAX; i++)
+    {
+        if (!run_thread_test_fun (cmd_flags, i))
+            continue;
+
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            bool done = !cmd_flags.calibrate;
+            unsigned int runs = cmd_flags.calibrate ? 1 : cmd_flags.num_runs;
+
+            if (!cmd_flags.run_code_version[code_ver])
+                continue;
+
+            while (!done)
+                runs = calibrate_next_runs (runs,
+                                            run_pool_job (&pool, i, code_ver,
+                                                          runs),
+                                            calibrate_target_ns (cmd_flags),
+                                            &done);
+            num_runs[i][code_ver] = runs;
+        }
+    }
+
+    /* Interleave the tests across the repetitions as in main.  */
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+        for (i = 0; i < FUNC_ID_MAX; i++)
+        {
+            if (!run_thread_test_fun (cmd_flags, i))
+                continue;
+
+            for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            {
+                unsigned long long int ns;
+
+                if (!cmd_flags.run_code_version[code_ver])
+                    continue;
+
+                ns = run_pool_job (&pool, i, code_ver,
+                                   num_runs[i][code_ver]);
+                if (rep >= cmd_flags.num_warmup)
+                    samples[i][code_ver].push_back (ns);
+            }
+        }
+
+    pool.quit = true;
+    barrier_wait (&pool.start);
+    for (t = 0; t < num_threads; t++)
+        threads[t].join ();
+
+    for (i = 0; i < FUNC_ID_MAX; i++)
+    {
+        if (!run_thread_test_fun (cmd_flags, i))
+            continue;
+
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+        {
+            struct thread_result_t res;
+
+            if (!cmd_flags.run_code_version[code_ver])
+                continue;
+
+            res.fun_id = i;
+            res.array_index = array_index;
+            res.code_ver = code_ver;
+            res.threads = num_threads;
+            res.cpu_node = cpu_node;
+            res.mem_node = mem_node;
+            res.num_runs = num_runs[i][code_ver];
+            res.samples = samples[i][code_ver];
+            compute_time_stats (res.samples, &res.stats);
+            thread_results.push_back (res);
+        }
+    }
+}
+
+/* Run the threads of each node with per thread databases bound to each
+   node, on the largest --threads count per node.  */
+static void
+run_numa_matrix (unsigned int array_index, size_t d,
+                 struct flags_t cmd_flags, const struct dataset_t *ds)
+{
+    using namespace std;
+    std::vector<int> nodes, cpus;
+    int num_threads = 1;
+    size_t c, m;
+
+    for (size_t n = 0; n < cmd_flags.thread_counts.size (); n++)
+        if (cmd_flags.thread_counts[n] > num_threads)
+            num_threads = cmd_flags.thread_counts[n];
+
+    numa_online_nodes (nodes);
+    cout << "  NUMA matrix, " << nodes.size () << " nodes, " << num_threads
+         << " threads per node\n";
+
+    for (c = 0; c < nodes.size (); c++)
+    {
+        /* Skip the memory only nodes.  */
+        if (numa_node_cpus (nodes[c], cpus))
+            continue;
+
+        for (m = 0; m < nodes.size (); m++)
+        {
+            struct flags_t flags = cmd_flags;
+
+            flags.thread_cpus.clear ();
+            flags.thread_node = nodes[c];
+            flags.numa_policy = NUMA_NODE;
+            flags.numa_node = nodes[m];
+
+            cout << "  CPU node " << nodes[c] << ", memory node " << nodes[m]
+                 << endl;
+            run_thread_count (array_index, d, flags, ds, num_threads, NULL,
+                              NULL, NULL, nodes[c], nodes[m]);
+        }
+    }
+}
+
+void
+run_thread_tests (struct results_data_t* result, unsigned int array_index,
+                  size_t d, struct flags_t cmd_flags,
+                  const struct dataset_t *ds)
+{
+    using namespace std;
+    std::vector<struct thread_shared_db_t> shared;
+    std::vector<int> nodes, cpus;
+    float *x_flt = NULL;
+    uint8_t *x_byte = NULL;
+    size_t bytes = thread_db_bytes (cmd_flags);
+
+    if (cmd_flags.thread_counts.empty ())
+    {
+        if (cmd_flags.numa_matrix)
+            run_numa_matrix (array_index, d, cmd_flags, ds);
+        return;
+    }
+
+    cout << "  Thread scaling, working set "
+         << thread_working_set_name (cmd_flags) << ", " << bytes << " bytes "
+         << (cmd_flags.shared_db ? "shared" : "per thread") << ", "
+         << numa_policy_name (cmd_flags) << " NUMA placement, "
+         << page_size_name (cmd_flags) << " pages" << endl;
+
+    /* A shared database is filled by the main thread, one replica bound to
+       each node with CPUs with --numa_replicas.  */
+    if (cmd_flags.shared_db)
+    {
+        if (cmd_flags.numa_replicas)
+        {
+            numa_online_nodes (nodes);
+            for (size_t n = 0; n < nodes.size (); n++)
+                if (numa_node_cpus (nodes[n], cpus) == 0)
+                {
+                    shared.push_back (thread_shared_db_t ());
+                    shared.back ().node = nodes[n];
+                }
+        }
+        else
+        {
+            shared.push_back (thread_shared_db_t ());
+            shared.back ().node = numa_policy_node (cmd_flags, cmd_flags.cpu);
+        }
+
+        for (size_t r = 0; r < shared.size (); r++)
+        {
+            alloc_vector_db (&shared[r].float_db, d, sizeof (float), bytes,
+                             cmd_flags.random_access, ds, shared[r].node,
+                             page_size_arena_flags (cmd_flags));
+            alloc_vector_db (&shared[r].byte_db, d, sizeof (uint8_t), bytes,
+                             cmd_flags.random_access, ds, shared[r].node,
+                             page_size_arena_flags (cmd_flags));
+        }
+        alloc_working_set_query (d, ds, &x_flt, &x_byte);
+
+        if (cmd_flags.numa_replicas)
+            cout << "  " << shared.size () << " database replicas\n";
+    }
+
+    for (size_t n = 0; n < cmd_flags.thread_counts.size (); n++)
+        run_thread_count (array_index, d, cmd_flags, ds,
+                          cmd_flags.thread_counts[n],
+                          cmd_flags.shared_db ? &shared : NULL,
+                          x_flt, x_byte, -1, -1);
+
+    for (size_t r = 0; r < shared.size (); r++)
+    {
+        release_vector_db (&shared[r].float_db);
+        release_vector_db (&shared[r].byte_db);
+    }
+    free (x_flt);
+    free (x_byte);
+
+    if (cmd_flags.numa_matrix)
+        run_numa_matrix (array_index, d, cmd_flags, ds);
+}
+
+/* Aggregate database vectors per second of all of the threads.  */
+static double
+vectors_per_second (const struct thread_result_t *res)
+{
+    if (res->stats.median <= 0)
+        return 0;
+
+    return (double) res->threads * res->num_runs
+        * db_vectors_per_call (res->fun_id) / (res->stats.median * 1.0e-9);
+}
+
+/* GB/s of the database vectors read by all threads.  */
+static double
+thread_gb_per_second (const struct thread_result_t *res,
+                      struct flags_t cmd_flags)
+{
+    return vectors_per_second (res) * cmd_flags.array_sizes[res->array_index]
+        * get_kernel_info (res->fun_id)->elem_size / 1.0e9;
+}
+
+/* One table per function, code version and array size of the GB/s of the
+   threads of each node (rows) reading the memory of each node
+   (columns).  */
+static void
+print_numa_matrix (std::ofstream &out_file, struct results_data_t* result,
+                   struct flags_t cmd_flags)
+{
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+    std::vector<bool> printed (thread_results.size (), false);
+    std::vector<int> nodes;
+    size_t n, m, c;
+
+    numa_online_nodes (nodes);
+
+    out_file << "NUMA bandwidth matrix in GB/s, working set "
+             << thread_working_set_name (cmd_flags) << ", "
+             << thread_db_bytes (cmd_flags) << " bytes per thread, "
+             << (cmd_flags.random_access ? "random" : "cyclic")
+             << " access.\nThe rows are the node of the threads, the"
+             << " columns the node of the databases.\n";
+
+    for (n = 0; n < thread_results.size (); n++)
+    {
+        const struct thread_result_t *first = &thread_results[n];
+
+        if (printed[n] || first->mem_node < 0)
+            continue;
+
+        out_file << "  " << result[first->fun_id].function_name
+                 << suffix[first->code_ver] << ", array size "
+                 << cmd_flags.array_sizes[first->array_index] << ", "
+                 << first->threads << " threads\n\tmemory";
+        for (c = 0; c < nodes.size (); c++)
+            out_file << "\t" << nodes[c];
+        out_file << "\n";
+
+        /* The results are in CPU node, then memory node order.  */
+        for (m = n; m < thread_results.size (); m++)
+        {
+            const struct thread_result_t *res = &thread_results[m];
+
+            if (printed[m] || res->mem_node < 0
+                || res->fun_id != first->fun_id
+                || res->code_ver != first->code_ver
+                || res->array_index != first->array_index)
+                continue;
+
+            if (res->mem_node == nodes[0] || m == n)
+                out_file << "\tnode " << res->cpu_node;
+
+            printed[m] = true;
+            out_file << "\t" << std::fixed << std::setprecision (2)
+                     << thread_gb_per_second (res, cmd_flags)
+                     << std::defaultfloat;
+            if (res->mem_node == nodes.back ())
+                out_file << "\n";
+        }
+    }
+    out_file << "\n";
+}
+
+void
+print_thread_tests (std::ofstream &out_file, struct results_data_t* result,
+                    struct flags_t cmd_flags)
+{
+    size_t n, m;
+
+    if (cmd_flags.numa_matrix)
+        print_numa_matrix (out_file, result, cmd_flags);
+
+    if (cmd_flags.thread_counts.empty ())
+        return;
+
+    out_file << "Thread scaling, working set "
+             << thread_working_set_name (cmd_flags) << ", "
+             << thread_db_bytes (cmd_flags) << " bytes "
+             << (cmd_flags.shared_db ? "shared by the threads"
+                 : "per thread") << ", "
+             << (cmd_flags.random_access ? "random" : "cyclic")
+             << " access, " << numa_policy_name (cmd_flags)
+             << (cmd_flags.numa_replicas && cmd_flags.shared_db
+                 ? " NUMA placement with a replica per node, "
+                 : " NUMA placement, ");
+    if (!cmd_flags.thread_cpus.empty ())
+        out_file << "CPU list placement.\n";
+    else if (cmd_flags.placement == PLACEMENT_SPREAD)
+        out_file << "spread placement.\n";
+    else
+        out_file << "compact placement.\n";
+
+    out_file << "vectors/s is the database vectors read by all threads per"
+             << " second, efficiency\nis the vectors/s per thread relative"
+             << " to the smallest thread count, peak is\nthe GB/s relative"
+             << " to the highest GB/s of the function.\n";
+    out_file << "Function name\tarray size\tthreads\tvectors/s\tefficiency"
+             << "\tGB/s\tpeak\n";
+
+    /* Group the thread counts of each function, code version and array
+       size.  The results are in thread count order.  The NUMA matrix
+       results are in their own table.  */
+    std::vector<bool> printed (thread_results.size (), false);
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+
+    for (n = 0; n < thread_results.size (); n++)
+        printed[n] = thread_results[n].mem_node >= 0;
+
+    for (n = 0; n < thread_results.size (); n++)
+    {
+        const struct thread_result_t *first = &thread_results[n];
+        const struct kernel_info_t *kinfo = get_kernel_info (first->fun_id);
+        size_t d = cmd_flags.array_sizes[first->array_index];
+        double base_rate, peak_gbs = 0;
+
+        if (printed[n])
+            continue;
+
+        for (m = n; m < thread_results.size (); m++)
+        {
+            const struct thread_result_t *res = &thread_results[m];
+
+            if (res->mem_node < 0 && res->fun_id == first->fun_id
+                && res->code_ver == first->code_ver
+                && res->array_index == first->array_index)
+            {
+                double gbs = vectors_per_second (res) * d
+                    * kinfo->elem_size / 1.0e9;
+
+                if (gbs > peak_gbs)
+                    peak_gbs = gbs;
+            }
+        }
+
+        base_rate = vectors_per_second (first) / first->threads;
+
+        for (m = n; m < thread_results.size (); m++)
+        {
+            const struct thread_result_t *res = &thread_results[m];
+            double rate, gbs;
+
+            if (printed[m] || res->fun_id != first->fun_id
+                || res->code_ver != first->code_ver
+                || res->array_index != first->array_index)
+                continue;
+
+            printed[m] = true;
+            rate = vectors_per_second (res);
+            gbs = rate * d * kinfo->elem_size / 1.0e9;
+
+            out_file << "  " << result[res->fun_id].function_name
+                     << suffix[res->code_ver] << "\t" << d << "\t"
+                     << res->threads << "\t" << std::fixed
+                     << std::setprecision (0) << rate << "\t"
+                     << std::setprecision (1)
+                     << (base_rate > 0 ? 100.0 * rate / res->threads
+                         / base_rate : 0) << "%\t"
+                     << std::setprecision (2) << gbs << "\t"
+                     << std::setprecision (1)
+                     << (peak_gbs > 0 ? 100.0 * gbs / peak_gbs : 0) << "%\n"
+                     << std::defaultfloat;
+        }
+    }
+    out_file << "\n";
+}
+
+/* The thread results are added to the JSON and CSV files as records with
+   the number of threads set.  The times are the wall times of num_runs
+   calls on each thread.  The NUMA matrix records also have the node of
+   the threads and of the databases.  The JSON records have the mode
+   thread_scaling or numa_matrix and are not read back by the baseline
+   comparison, as they measure other loops than the main records.  */
+void
+write_json_thread_results (std::ofstream &out_file,
+                           struct results_data_t* result,
+                           struct flags_t cmd_flags, bool *first)
+{
+    for (size_t n = 0; n < thread_results.size (); n++)
+    {
+        const struct thread_result_t *res = &thread_results[n];
+        const struct kernel_info_t *kinfo = get_kernel_info (res->fun_id);
+        double rate = vectors_per_second (res);
+        size_t d = cmd_flags.array_sizes[res->array_index];
+        struct json_timing_record_t rec;
+        std::ostringstream keys;
+
+        keys << ", \"dim\": " << d
+             << ", \"dtype\": \"" << func_dtype_name (res->fun_id)
+             << "\", \"threads\": " << res->threads
+             << ", \"working_set\": \"" << thread_working_set_name (cmd_flags)
+             << "\", \"num_runs\": " << res->num_runs
+             << ", \"page_size\": \"" << page_size_name (cmd_flags) << "\"";
+        if (res->mem_node >= 0)
+            keys << ", \"cpu_node\": " << res->cpu_node
+                 << ", \"mem_node\": " << res->mem_node;
+        keys << std::fixed << std::setprecision (4)
+             << ", \"ns_per_call\": " << res->stats.median / res->num_runs
+             << std::setprecision (0)
+             << ", \"vectors_per_s\": " << rate
+             << std::setprecision (4)
+             << ", \"gb_per_s\": " << rate * d * kinfo->elem_size / 1.0e9;
+
+        rec.mode = res->mem_node >= 0 ? "numa_matrix" : "thread_scaling";
+        rec.kernel = result[res->fun_id].function_name;
+        rec.version = code_version_name (res->code_ver);
+        rec.keys = keys.str ();
+        rec.stats = &res->stats;
+        rec.samples = &res->samples;
+        write_json_timing_record (out_file, first, &rec);
+    }
+}
+
+void
+write_csv_thread_results (std::ofstream &out_file,
+                          struct results_data_t* result,
+                          struct flags_t cmd_flags)
+{
+    for (size_t n = 0; n < thread_results.size (); n++)
+    {
+        const struct thread_result_t *res = &thread_results[n];
+
+        /* The NUMA matrix nodes are only in the JSON records.  */
+        if (res->mem_node >= 0)
+            continue;
+
+        out_file << result[res->fun_id].function_name << ","
+                 << code_version_name (res->code_ver) << ","
+                 << cmd_flags.array_sizes[res->array_index] << ","
+                 << func_dtype_name (res->fun_id) << ","
+                 << res->threads << ","
+                 << thread_working_set_name (cmd_flags) << ","
+                 << res->num_runs << ","
+                 << cmd_flags.num_reps << ","
+                 << std::fixed << std::setprecision (1)
+                 << res->stats.median << "," << res->stats.min << ","
+                 << res->stats.mean << "," << res->stats.p99 << ","
+                 << res->stats.stddev << ","
+                 << std::setprecision (4)
+                 << res->stats.median / res->num_runs << ","
+                 << std::defaultfloat << "\n";
+    }
+}
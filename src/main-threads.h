@@ -0,0 +1,56 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_THREADS_H
+#define MAIN_THREADS_H
+
+#include <fstream>
+#include <vector>
+#include "main-helpers.h"
+#include "main-dataset.h"
+
+/* Result of one function, code version and array size on one thread
+   count.  */
+struct thread_result_t {
+    unsigned int fun_id = 0;
+    unsigned int array_index = 0;
+    unsigned int code_ver = 0;
+    int threads = 0;
+    int cpu_node = -1;              /* NUMA matrix nodes, else -1.  */
+    int mem_node = -1;
+    unsigned int num_runs = 0;      /* Calls per thread.  */
+    struct time_stats_t stats;      /* Of the wall time of all threads.  */
+    std::vector<unsigned long long int> samples;
+};
+
+int get_thread_cpu (struct flags_t cmd_flags, int thread);
+
+void run_thread_tests (struct results_data_t* result,
+                       unsigned int array_index, size_t d,
+                       struct flags_t cmd_flags,
+                       const struct dataset_t *ds);
+
+void print_thread_tests (std::ofstream &out_file,
+                         struct results_data_t* result,
+                         struct flags_t cmd_flags);
+void write_json_thread_results (std::ofstream &out_file,
+                                struct results_data_t* result,
+                                struct flags_t cmd_flags, bool *first);
+void write_csv_thread_results (std::ofstream &out_file,
+                               struct results_data_t* result,
+                               struct flags_t cmd_flags);
+
+#endif /* MAIN_THREADS_H */
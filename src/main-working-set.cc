@@ -0,0 +1,745 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Working set mode.  The test_* functions in main-tests.cc call each
+   function NUM_RUNS times on the same x and y arrays, so the data is always
+   in the L1 cache.  In working set mode the functions are run over a
+   database of vectors sized to fit in the L1, L2 or L3 cache or to be a
+   multiple of the last level cache, forcing the data to come from memory.
+   The database vectors are visited in order or in a random permutation.  */
+
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <unistd.h>
+#include "main-working-set.h"
+#include "main-stats.h"
+#include "main-perf.h"
+#include "main-numa.h"
+
+#define WORKING_SET_SEED 1234
+
+size_t
+get_cache_size (int level)
+{
+    long size = -1;
+
+    /* Linux reports the cache sizes with sysconf.  Use the Power 10 sizes if
+       the OS does not report them.  */
+    switch (level)
+    {
+    case 1:
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+        size = sysconf (_SC_LEVEL1_DCACHE_SIZE);
+#endif
+        if (size <= 0)
+            size = DEFAULT_L1_CACHE_SIZE;
+        break;
+
+    case 2:
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        size = sysconf (_SC_LEVEL2_CACHE_SIZE);
+#endif
+        if (size <= 0)
+            size = DEFAULT_L2_CACHE_SIZE;
+        break;
+
+    default:
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        size = sysconf (_SC_LEVEL3_CACHE_SIZE);
+#endif
+        if (size <= 0)
+            size = DEFAULT_L3_CACHE_SIZE;
+        break;
+    }
+    return (size_t) size;
+}
+
+size_t
+get_working_set_bytes (struct flags_t cmd_flags)
+{
+    switch (cmd_flags.working_set)
+    {
+    case WORKING_SET_L1:
+        return get_cache_size (1) / CACHE_FRACTION_DIVISOR;
+
+    case WORKING_SET_L2:
+        return get_cache_size (2) / CACHE_FRACTION_DIVISOR;
+
+    case WORKING_SET_L3:
+        return get_cache_size (3) / CACHE_FRACTION_DIVISOR;
+
+    default:
+        /* DRAM, a multiple of the last level cache.  */
+        return get_cache_size (3) * cmd_flags.llc_multiple;
+    }
+}
+
+int
+parse_working_set_arg (const char *arg, struct flags_t *cmd_flags)
+{
+    char *end;
+    long mult;
+
+    if (strcmp (arg, "L1") == 0)
+        cmd_flags->working_set = WORKING_SET_L1;
+    else if (strcmp (arg, "L2") == 0)
+        cmd_flags->working_set = WORKING_SET_L2;
+    else if (strcmp (arg, "L3") == 0)
+        cmd_flags->working_set = WORKING_SET_L3;
+    else if (strcmp (arg, "DRAM") == 0)
+        cmd_flags->working_set = WORKING_SET_DRAM;
+    else
+    {
+        /* Multiple of the last level cache, for example 4xLLC.  */
+        mult = strtol (arg, &end, 10);
+
+        if (mult <= 0 || strcmp (end, "xLLC") != 0)
+            return 1;
+
+        cmd_flags->working_set = WORKING_SET_DRAM;
+        cmd_flags->llc_multiple = (int) mult;
+    }
+    return 0;
+}
+
+const char*
+working_set_name (struct flags_t cmd_flags)
+{
+    switch (cmd_flags.working_set)
+    {
+    case WORKING_SET_L1:
+        return "L1";
+    case WORKING_SET_L2:
+        return "L2";
+    case WORKING_SET_L3:
+        return "L3";
+    case WORKING_SET_DRAM:
+        return "DRAM";
+    default:
+        return "none";
+    }
+}
+
+/* Parse the --page_size argument.  */
+int
+parse_page_size_arg (const char *arg, struct flags_t *cmd_flags)
+{
+    if (strcmp (arg, "default") == 0)
+        cmd_flags->page_size = PAGE_SIZE_DEFAULT;
+    else if (strcmp (arg, "base") == 0)
+        cmd_flags->page_size = PAGE_SIZE_BASE;
+    else if (strcmp (arg, "thp") == 0)
+        cmd_flags->page_size = PAGE_SIZE_THP;
+    else if (strcmp (arg, "hugetlb") == 0)
+        cmd_flags->page_size = PAGE_SIZE_HUGETLB;
+    else
+        return 1;
+
+    return 0;
+}
+
+const char*
+page_size_name (struct flags_t cmd_flags)
+{
+    switch (cmd_flags.page_size)
+    {
+    case PAGE_SIZE_BASE:
+        return "base";
+    case PAGE_SIZE_THP:
+        return "thp";
+    case PAGE_SIZE_HUGETLB:
+        return "hugetlb";
+    default:
+        return "default";
+    }
+}
+
+/* Arena flags of the pages backing the working set databases.  */
+int
+page_size_arena_flags (struct flags_t cmd_flags)
+{
+    switch (cmd_flags.page_size)
+    {
+    case PAGE_SIZE_BASE:
+        return ARENA_BASE_PAGES;
+    case PAGE_SIZE_THP:
+        return ARENA_HUGE_PAGES;
+    case PAGE_SIZE_HUGETLB:
+        return ARENA_HUGETLB;
+    default:
+        return 0;
+    }
+}
+
+void
+alloc_vector_db (struct vector_db_t *db, size_t d, size_t elem_size,
+                 size_t bytes, bool random_access,
+                 const struct dataset_t *ds, int node, int arena_flags)
+{
+    using namespace std;
+    size_t i, n, stride;
+
+    /* Round the vector size up to DB_ROW_ALIGN bytes.  The functions are
+       always called with d, the padding is never read.  Need at least four
+       vectors for the batch_4 functions.  */
+    stride = ((d * elem_size + DB_ROW_ALIGN - 1) / DB_ROW_ALIGN)
+        * DB_ROW_ALIGN;
+    n = bytes / stride;
+    if (n < 4)
+        n = 4;
+
+    /* The database gets a chunk of its own, on the pages and the node
+       asked for.  */
+    arena_init (&db->arena, n * stride, arena_flags);
+    db->arena.node = node;
+    db->data = (char *) arena_alloc (&db->arena, n * stride);
+
+    if (db->arena.hugetlb_failed)
+        cout << "WARNING, not enough free reserved huge pages for the "
+             << n * stride << " byte working set database, using"
+             << " transparent huge pages.\n";
+
+    db->offset = (size_t *) malloc (n * sizeof (size_t));
+
+    if (!db->offset)
+    {
+        cout << "ERROR, failed to allocate the working set visiting order.\n";
+        exit (-1);
+    }
+
+    db->elem_size = elem_size;
+    db->d = d;
+    db->stride = stride;
+    db->n_vectors = n;
+
+    /* Fill the database with the dataset rows, starting with row 1 since
+       row 0 is the query, or with random data, floats in [0, 1) or random
+       bytes.  The dataset rows are repeated if the working set holds more
+       vectors than the dataset.  */
+    mt19937 gen (WORKING_SET_SEED);
+
+    if (ds)
+    {
+        float *row = (float *) malloc (ds->d * sizeof (float));
+
+        if (!row)
+        {
+            cout << "ERROR, failed to allocate a dataset row.\n";
+            exit (-1);
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            char *v = db->data + i * stride;
+
+            if (elem_size == sizeof (float))
+            {
+                dataset_row_float (ds, (i + 1) % ds->n, row);
+                memcpy (v, row, d * sizeof (float));
+            }
+            else
+                dataset_row_uint8 (ds, (i + 1) % ds->n, d, (uint8_t *) v);
+        }
+
+        free (row);
+    }
+    else if (elem_size == sizeof (float))
+    {
+        uniform_real_distribution<float> dist (0.0, 1.0);
+
+        for (i = 0; i < n; i++)
+        {
+            float *v = (float *) (db->data + i * stride);
+
+            for (size_t j = 0; j < d; j++)
+                v[j] = dist (gen);
+        }
+    }
+    else
+    {
+        uniform_int_distribution<int> dist (0, 255);
+
+        for (i = 0; i < n; i++)
+        {
+            uint8_t *v = (uint8_t *) (db->data + i * stride);
+
+            for (size_t j = 0; j < d * elem_size; j++)
+                v[j] = (uint8_t) dist (gen);
+        }
+    }
+
+    /* Visit the vectors in order, or in a random permutation that defeats
+       the hardware prefetcher.  */
+    for (i = 0; i < n; i++)
+        db->offset[i] = i * stride;
+
+    if (random_access)
+        shuffle (db->offset, db->offset + n, gen);
+}
+
+void
+release_vector_db (struct vector_db_t *db)
+{
+    arena_release (&db->arena);
+    free (db->offset);
+    db->data = NULL;
+    db->offset = NULL;
+    db->n_vectors = 0;
+}
+
+/* The run_* functions call the function num_runs times, stepping through
+   the database vectors.  The sum of the function results is returned so the
+   compiler can not remove the calls and so the code versions can be
+   compared.  */
+
+static double
+run_fvec_pair (fvec_pair_fn_t fn, const float *x,
+               const struct vector_db_t *db, unsigned int num_runs)
+{
+    double result = 0;
+    size_t j = 0;
+
+    for (unsigned int i = 0; i < num_runs; i++)
+    {
+        result += fn (x, (const float *) (db->data + db->offset[j]), db->d);
+
+        if (++j == db->n_vectors)
+            j = 0;
+    }
+    return result;
+}
+
+static double
+run_fvec_norm (fvec_norm_fn_t fn, const struct vector_db_t *db,
+               unsigned int num_runs)
+{
+    double result = 0;
+    size_t j = 0;
+
+    for (unsigned int i = 0; i < num_runs; i++)
+    {
+        result += fn ((const float *) (db->data + db->offset[j]), db->d);
+
+        if (++j == db->n_vectors)
+            j = 0;
+    }
+    return result;
+}
+
+static double
+run_fvec_batch_4 (fvec_batch_4_fn_t fn, const float *x,
+                  const struct vector_db_t *db, unsigned int num_runs)
+{
+    double result = 0;
+    float dis0, dis1, dis2, dis3;
+    size_t n4 = (db->n_vectors / 4) * 4;
+    size_t j = 0;
+
+    for (unsigned int i = 0; i < num_runs; i++)
+    {
+        fn (x, (const float *) (db->data + db->offset[j]),
+            (const float *) (db->data + db->offset[j + 1]),
+            (const float *) (db->data + db->offset[j + 2]),
+            (const float *) (db->data + db->offset[j + 3]), db->d,
+            dis0, dis1, dis2, dis3);
+        result += dis0 + dis1 + dis2 + dis3;
+
+        j = j + 4;
+        if (j == n4)
+            j = 0;
+    }
+    return result;
+}
+
+static long int
+run_ivec_pair (ivec_pair_fn_t fn, const int8_t *x,
+               const struct vector_db_t *db, unsigned int num_runs)
+{
+    long int result = 0;
+    size_t j = 0;
+
+    for (unsigned int i = 0; i < num_runs; i++)
+    {
+        result += fn (x, (const int8_t *) (db->data + db->offset[j]), db->d);
+
+        if (++j == db->n_vectors)
+            j = 0;
+    }
+    return result;
+}
+
+static long int
+run_bvec_pair (bvec_pair_fn_t fn, const uint8_t *x,
+               const struct vector_db_t *db, unsigned int num_runs)
+{
+    long int result = 0;
+    size_t j = 0;
+
+    for (unsigned int i = 0; i < num_runs; i++)
+    {
+        result += fn (x, (const uint8_t *) (db->data + db->offset[j]), db->d);
+
+        if (++j == db->n_vectors)
+            j = 0;
+    }
+    return result;
+}
+
+/* Number of database vectors read by one call of function fun_id.  */
+unsigned int
+db_vectors_per_call (unsigned int fun_id)
+{
+    return get_kernel_info (fun_id)->sig == SIG_FVEC_BATCH_4 ? 4 : 1;
+}
+
+/* Call function fun_id num_runs times over the database and return the sum
+   of the results.  The integer results are exact in a double.  */
+double
+run_working_set_kernel (unsigned int fun_id, unsigned int code_ver,
+                        const struct vector_db_t *db, const void *x,
+                        unsigned int num_runs)
+{
+    const struct kernel_info_t *kinfo = get_kernel_info (fun_id);
+
+    switch (kinfo->sig)
+    {
+    case SIG_FVEC_PAIR:
+        return run_fvec_pair (kinfo->fvec_pair[code_ver], (const float *) x,
+                              db, num_runs);
+
+    case SIG_FVEC_NORM:
+        return run_fvec_norm (kinfo->fvec_norm[code_ver], db, num_runs);
+
+    case SIG_FVEC_BATCH_4:
+        return run_fvec_batch_4 (kinfo->fvec_batch_4[code_ver],
+                                 (const float *) x, db, num_runs);
+
+    case SIG_IVEC_PAIR:
+        return run_ivec_pair (kinfo->ivec_pair[code_ver], (const int8_t *) x,
+                              db, num_runs);
+
+    case SIG_BVEC_PAIR:
+        return run_bvec_pair (kinfo->bvec_pair[code_ver],
+                              (const uint8_t *) x, db, num_runs);
+
+    default:
+        /* The ny_transposed function reads a transposed block of vectors,
+           there is no database form of it.  */
+        return 0;
+    }
+}
+
+int
+test_working_set (struct results_data_t* result, unsigned int fun_id,
+                  unsigned int array_index, unsigned int num_runs,
+                  bool run_code_version[NUM_CODE_VERSIONS],
+                  const struct vector_db_t *db, const void *x)
+{
+    unsigned long long int t0;
+    unsigned long long int t1;
+    double sum;
+    const struct kernel_info_t *kinfo = get_kernel_info (fun_id);
+
+    if (kinfo->sig == SIG_FVEC_NY_TRANSPOSED)
+        return 1;
+
+    for (unsigned int code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+    {
+        /* The base version is always run.  */
+        if (code_ver != CODE_VER_ORIG && !run_code_version[code_ver])
+            continue;
+
+        perf_counters_start ();
+        t0 = get_time();
+        sum = run_working_set_kernel (fun_id, code_ver, db, x, num_runs);
+        t1 = get_time();
+        perf_counters_stop ();
+
+        record_time (fun_id, array_index, code_ver, t0, t1, result);
+
+        if (kinfo->sig == SIG_IVEC_PAIR || kinfo->sig == SIG_BVEC_PAIR)
+            record_int_result (fun_id, array_index, code_ver, (long int) sum,
+                               result);
+        else
+            record_float_result (fun_id, array_index, code_ver, (float) sum,
+                                 result);
+    }
+    return 0;
+}
+
+static int
+run_working_set_test (struct results_data_t* result, unsigned int fun_id,
+                      unsigned int array_index, unsigned int num_runs,
+                      bool run_code_version[NUM_CODE_VERSIONS],
+                      const struct vector_db_t *float_db, const float *x_flt,
+                      const struct vector_db_t *byte_db, const uint8_t *x_byte)
+{
+    /* Run the test on the database matching the element size of the
+       function.  */
+    const struct kernel_info_t *kinfo = get_kernel_info (fun_id);
+
+    if (kinfo->sig == SIG_FVEC_NY_TRANSPOSED)
+        return 1;
+
+    if (kinfo->elem_size == sizeof (float))
+        return test_working_set (result, fun_id, array_index, num_runs,
+                                 run_code_version, float_db, x_flt);
+
+    return test_working_set (result, fun_id, array_index, num_runs,
+                             run_code_version, byte_db, x_byte);
+}
+
+/* Arguments of run_working_set_test while calibrating.  */
+struct calibrate_working_set_arg_t {
+    struct results_data_t* result;
+    unsigned int fun_id;
+    unsigned int array_index;
+    bool *run_code_version;
+    const struct vector_db_t *float_db;
+    const float *x_flt;
+    const struct vector_db_t *byte_db;
+    const uint8_t *x_byte;
+};
+
+static void
+calibrate_working_set_run (void *arg, unsigned int num_runs)
+{
+    struct calibrate_working_set_arg_t *a
+        = (struct calibrate_working_set_arg_t *) arg;
+
+    run_working_set_test (a->result, a->fun_id, a->array_index, num_runs,
+                          a->run_code_version, a->float_db, a->x_flt,
+                          a->byte_db, a->x_byte);
+}
+
+static unsigned int
+calibrate_working_set (struct results_data_t* result, unsigned int fun_id,
+                       unsigned int array_index,
+                       bool run_code_version[NUM_CODE_VERSIONS],
+                       const struct vector_db_t *float_db, const float *x_flt,
+                       const struct vector_db_t *byte_db,
+                       const uint8_t *x_byte,
+                       unsigned long long int target_ns)
+{
+    struct calibrate_working_set_arg_t arg = { result, fun_id, array_index,
+                                               run_code_version, float_db,
+                                               x_flt, byte_db, x_byte };
+
+    return calibrate_runs (calibrate_working_set_run, &arg, target_ns);
+}
+
+/* Allocate the float and byte query vectors, row 0 of the dataset or
+   generated data.  */
+void
+alloc_working_set_query (size_t d, const struct dataset_t *ds,
+                         float **x_flt, uint8_t **x_byte)
+{
+    using namespace std;
+    size_t i;
+
+    *x_flt = (float *) malloc (d * sizeof (float));
+    *x_byte = (uint8_t *) malloc (d * sizeof (uint8_t));
+
+    if (!*x_flt || !*x_byte)
+    {
+        cout << "ERROR, failed to allocate the working set query vectors.\n";
+        exit (-1);
+    }
+
+    if (ds)
+    {
+        float *row = (float *) malloc (ds->d * sizeof (float));
+
+        if (!row)
+        {
+            cout << "ERROR, failed to allocate a dataset row.\n";
+            exit (-1);
+        }
+
+        dataset_row_float (ds, 0, row);
+        memcpy (*x_flt, row, d * sizeof (float));
+        dataset_row_uint8 (ds, 0, d, *x_byte);
+        free (row);
+    }
+    else
+        for (i = 0; i < d; i++)
+        {
+            (*x_flt)[i] = (float) (i % 7) / 7.0;
+            (*x_byte)[i] = (uint8_t) (i * 5);
+        }
+}
+
+void
+run_working_set_tests (struct results_data_t* result,
+                       unsigned int array_index, size_t d,
+                       struct flags_t cmd_flags, const struct dataset_t *ds)
+{
+    using namespace std;
+    struct vector_db_t float_db, byte_db;
+    size_t bytes = get_working_set_bytes (cmd_flags);
+    float *x_flt;
+    uint8_t *x_byte;
+    unsigned int i;
+    int rep;
+
+    /* The database vectors are allocated once per element size and shared
+       by the functions.  */
+    alloc_vector_db (&float_db, d, sizeof (float), bytes,
+                     cmd_flags.random_access, ds,
+                     numa_policy_node (cmd_flags, cmd_flags.cpu),
+                     page_size_arena_flags (cmd_flags));
+    alloc_vector_db (&byte_db, d, sizeof (uint8_t), bytes,
+                     cmd_flags.random_access, ds,
+                     numa_policy_node (cmd_flags, cmd_flags.cpu),
+                     page_size_arena_flags (cmd_flags));
+
+    cout << "  Working set " << working_set_name (cmd_flags) << ", "
+         << bytes << " bytes, " << float_db.n_vectors << " float vectors, "
+         << byte_db.n_vectors << " int8 vectors, "
+         << (cmd_flags.random_access ? "random" : "cyclic") << " access, "
+         << numa_policy_name (cmd_flags) << " NUMA placement, "
+         << page_size_name (cmd_flags) << " pages\n";
+
+    /* The query vector stays in the L1 cache.  */
+    alloc_working_set_query (d, ds, &x_flt, &x_byte);
+
+    /* Set the number of database vectors each test visits, then repeat
+       the tests as in main, discarding the warmup repetitions.  */
+    for (i = 0; i < FUNC_ID_MAX; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        if (cmd_flags.calibrate)
+            result[i].num_runs[array_index]
+                = calibrate_working_set (result, i, array_index,
+                                         cmd_flags.run_code_version,
+                                         &float_db, x_flt, &byte_db, x_byte,
+                                         calibrate_target_ns (cmd_flags));
+        else
+            result[i].num_runs[array_index] = cmd_flags.num_runs;
+    }
+
+    for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
+    {
+        if (rep == cmd_flags.num_warmup)
+            clear_time_samples (result, array_index);
+
+        for (i = 0; i < FUNC_ID_MAX; i++)
+        {
+            if (!cmd_flags.run_func_flag[i])
+                continue;
+
+            run_working_set_test (result, i, array_index,
+                                  result[i].num_runs[array_index],
+                                  cmd_flags.run_code_version, &float_db,
+                                  x_flt, &byte_db, x_byte);
+        }
+    }
+
+    summarize_time_samples (result, array_index);
+
+    free (x_flt);
+    free (x_byte);
+    release_vector_db (&float_db);
+    release_vector_db (&byte_db);
+}
+
+static void
+print_working_set_code_ver (std::ofstream &out_file, int fun_index_max,
+                            int array_index_max,
+                            struct results_data_t* result,
+                            struct flags_t cmd_flags,
+                            char group_id_name[][GROUP_ID_NAME_MAX],
+                            int code_ver, const char *suffix,
+                            bool print_bandwidth)
+{
+    unsigned int i, j;
+    int group_id = -1;     /* Initialize id to print group names  */
+    const struct kernel_info_t *kinfo;
+
+    for (i = 0; i < fun_index_max; i++)
+    {
+        if (!cmd_flags.run_func_flag[i])
+            continue;
+
+        kinfo = get_kernel_info (i);
+        if (kinfo->sig == SIG_FVEC_NY_TRANSPOSED)
+            continue;
+
+        print_group_name (out_file, &group_id, i, result, group_id_name);
+        out_file << "  " << result[i].function_name << suffix << "\t";
+
+        for (j = 0; j < array_index_max; j++)
+        {
+            double ns = (double) result[i].execution_time[j][code_ver];
+            double vectors = (double) result[i].num_runs[j]
+                             * db_vectors_per_call (i);
+
+            if (print_bandwidth)
+                /* Bytes per ns is GB/s.  */
+                out_file << std::fixed << std::setprecision (2)
+                         << vectors * cmd_flags.array_sizes[j]
+                            * kinfo->elem_size / ns << "\t";
+            else
+                out_file << std::fixed << std::setprecision (2)
+                         << ns / vectors << "\t";
+        }
+        out_file << "\n";
+    }
+    out_file << "\n";
+}
+
+void
+print_working_set (std::ofstream &out_file, int fun_index_max,
+                   int array_index_max, struct results_data_t* result,
+                   struct flags_t cmd_flags,
+                   char group_id_name[][GROUP_ID_NAME_MAX])
+{
+    unsigned int j, code_ver;
+    const char *suffix[NUM_CODE_VERSIONS] = {PPC_BASE_SUFFIX, PPC_OPT_SUFFIX,
+                                             PPC_INTRINSIC_SUFFIX};
+
+    out_file << "Working set " << working_set_name (cmd_flags) << ", "
+             << get_working_set_bytes (cmd_flags) << " bytes, "
+             << (cmd_flags.random_access ? "random" : "cyclic")
+             << " access, " << numa_policy_name (cmd_flags)
+             << " NUMA placement, " << page_size_name (cmd_flags)
+             << " pages.\n\n";
+
+    for (int bw = 0; bw < 2; bw++)
+    {
+        if (bw)
+            out_file << "Database bandwidth in GB/s.\n";
+        else
+            out_file << "Execution time per database vector in ns.\n";
+
+        out_file << "Function name \t array size\n\t";
+        for (j = 0; j < array_index_max; j++)
+            out_file << cmd_flags.array_sizes[j] << "\t";
+        out_file << "\n";
+
+        for (code_ver = 0; code_ver < NUM_CODE_VERSIONS; code_ver++)
+            if (cmd_flags.run_code_version[code_ver])
+                print_working_set_code_ver (out_file, fun_index_max,
+                                            array_index_max, result,
+                                            cmd_flags, group_id_name,
+                                            code_ver, suffix[code_ver], bw);
+    }
+}
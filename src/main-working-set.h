@@ -0,0 +1,89 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAIN_WORKING_SET_H
+#define MAIN_WORKING_SET_H
+
+#include <fstream>
+#include "main-helpers.h"
+#include "main-kernels.h"
+#include "main-dataset.h"
+
+/* Cache sizes to use if the OS does not report them.  The defaults are for
+   a Power 10 core.  */
+#define DEFAULT_L1_CACHE_SIZE  (32 * 1024)
+#define DEFAULT_L2_CACHE_SIZE  (2 * 1024 * 1024)
+#define DEFAULT_L3_CACHE_SIZE  (8 * 1024 * 1024)
+
+/* The L1, L2 and L3 working sets are sized to half of the cache so the
+   query vector, the visiting order and the stack also fit.  */
+#define CACHE_FRACTION_DIVISOR 2
+
+/* The database vectors start on a DB_ROW_ALIGN byte boundary since the
+   optimized versions of the functions load the vectors with vector float
+   pointers.  The database is allocated from an arena, so it starts on a
+   cache line.  */
+#define DB_ROW_ALIGN    ARENA_VEC_BYTES
+
+/* A database of n_vectors vectors of dimension d.  The vectors are visited
+   in the order given by offset[], the byte offset of each vector from the
+   start of data.  */
+struct vector_db_t {
+    char *data = NULL;
+    size_t elem_size = 0;
+    size_t d = 0;
+    size_t stride = 0;              /* Bytes between consecutive vectors.  */
+    size_t n_vectors = 0;
+    size_t *offset = NULL;
+    struct arena_t arena;           /* Holds data.  */
+};
+
+size_t get_cache_size (int level);
+size_t get_working_set_bytes (struct flags_t cmd_flags);
+int parse_working_set_arg (const char *arg, struct flags_t *cmd_flags);
+const char* working_set_name (struct flags_t cmd_flags);
+int parse_page_size_arg (const char *arg, struct flags_t *cmd_flags);
+const char* page_size_name (struct flags_t cmd_flags);
+int page_size_arena_flags (struct flags_t cmd_flags);
+
+void alloc_vector_db (struct vector_db_t *db, size_t d, size_t elem_size,
+                      size_t bytes, bool random_access,
+                      const struct dataset_t *ds, int node,
+                      int arena_flags);
+void release_vector_db (struct vector_db_t *db);
+void alloc_working_set_query (size_t d, const struct dataset_t *ds,
+                              float **x_flt, uint8_t **x_byte);
+unsigned int db_vectors_per_call (unsigned int fun_id);
+
+double run_working_set_kernel (unsigned int fun_id, unsigned int code_ver,
+                               const struct vector_db_t *db, const void *x,
+                               unsigned int num_runs);
+int test_working_set (struct results_data_t* result, unsigned int fun_id,
+                      unsigned int array_index, unsigned int num_runs,
+                      bool run_code_version[NUM_CODE_VERSIONS],
+                      const struct vector_db_t *db, const void *x);
+
+void run_working_set_tests (struct results_data_t* result,
+                            unsigned int array_index, size_t d,
+                            struct flags_t cmd_flags,
+                            const struct dataset_t *ds);
+
+void print_working_set (std::ofstream &out_file, int fun_index_max,
+                        int array_index_max, struct results_data_t* result,
+                        struct flags_t cmd_flags,
+                        char group_id_name[][GROUP_ID_NAME_MAX]);
+
+#endif /* MAIN_WORKING_SET_H */
@@ -23,8 +23,26 @@
 #include <cstring>
 #include <filesystem>
 #include "main-helpers.h"
-
-#define NY_DISTANCE 8
+#include "main-working-set.h"
+#include "main-stats.h"
+#include "main-output.h"
+#include "main-perf.h"
+#include "main-dataset.h"
+#include "main-recall.h"
+#include "main-threads.h"
+#include "main-offsets.h"
+#include "main-accuracy.h"
+#include "main-fuzz.h"
+#include "main-fixed-dim.h"
+#include "main-multi-acc.h"
+#include "main-cosine.h"
+#include "main-sparse.h"
+#include "main-maxsim.h"
+#include "main-range.h"
+#include "main-filter.h"
+#include "main-panel.h"
+#include "main-parallel.h"
+#include "main-pairwise.h"
 
 
 int
@@ -39,6 +57,8 @@ main(int argc, char *argv[])
     char group_id_name[GROUP_ID_MAX][GROUP_ID_NAME_MAX];
 
     long long int array_size, i, j, array_index;
+    int rep, cpu;
+    int exit_code = 0;
     float **x_d = (float **)malloc(sizeof(float *));
     float **y0_d = (float **)malloc(sizeof(float *));
     float **y1_d = (float **)malloc(sizeof(float *));
@@ -57,25 +77,63 @@ main(int argc, char *argv[])
     float tmp_flt;
     float result;
     struct flags_t cmd_flags;
+    struct dataset_t dataset, queries, groundtruth;
 
 
     rtn = read_cmd_opts (argc, argv, &cmd_flags);
     if (rtn)
         cout <<"ERROR reading command line args\n";
 
+    /* Pin to one CPU so the repetitions of the tests are comparable.  */
+    if (cmd_flags.pin_cpu)
+    {
+        cpu = pin_to_cpu (cmd_flags.cpu);
+        if (cpu < 0)
+            cout << "WARNING, could not pin the tests to a CPU, the"
+                 << " execution times may vary.\n";
+        cmd_flags.cpu = cpu;
+    }
+    else
+        cmd_flags.cpu = -1;
+
 
     // Create Result directory and output file for test results.
     std::filesystem::create_directories("./results");
     // suffix for test results and time file names
-    string dateSuffix = "_" + getDateAsFileSuffix() + ".txt";
+    string dateStamp = getDateAsFileSuffix();
+    string dateSuffix = "_" + dateStamp + ".txt";
 
       // test_results ouptut text file with time stamp
     string RESULTS_OUTPUT = "results/test_results" + dateSuffix;
     // test_time output text file with time stamp
     string TIME_OUTPUT = "results/test_time" + dateSuffix;
+    // machine readable copies of the test_time file
+    string JSON_OUTPUT = "results/test_time_" + dateStamp + ".json";
+    string CSV_OUTPUT = "results/test_time_" + dateStamp + ".csv";
+
+    if (cmd_flags.json_file)
+        JSON_OUTPUT = cmd_flags.json_file;
+    if (cmd_flags.csv_file)
+        CSV_OUTPUT = cmd_flags.csv_file;
     ofstream timefile (TIME_OUTPUT);
-    ofstream resultfile (RESULTS_OUTPUT);
-    
+    ofstream resultfile, jsonfile, csvfile;
+
+    /* --fuzz only writes its summary to the test_time file, so the other
+       files are not created.  A stream that is not opened passes the checks
+       below.  */
+    if (cmd_flags.fuzz_iterations > 0)
+    {
+        if (cmd_flags.json_file || cmd_flags.csv_file)
+            cout << "WARNING, --json and --csv are not written with"
+                 << " --fuzz.\n";
+    }
+    else
+    {
+        resultfile.open (RESULTS_OUTPUT);
+        jsonfile.open (JSON_OUTPUT);
+        csvfile.open (CSV_OUTPUT);
+    }
+
     if (!timefile) {
         cout << "Could not open output file " << TIME_OUTPUT << "exiting.\n";
         exit (-1);
@@ -87,15 +145,80 @@ main(int argc, char *argv[])
         exit (-1);
     }
 
+    if (!jsonfile) {
+        cout << "Could not open output file " << JSON_OUTPUT << "exiting.\n";
+        exit (-1);
+    }
+
+    if (!csvfile) {
+        cout << "Could not open output file " << CSV_OUTPUT << "exiting.\n";
+        exit (-1);
+    }
+
+    /* Use the vectors of a dataset file as the test data.  The array size
+       is the dataset dimension.  */
+    if (cmd_flags.dataset_file)
+    {
+        dataset_open (cmd_flags.dataset_file, &dataset);
+        cout << "Dataset " << dataset.file_name << ", " << dataset.n
+             << " vectors of " << dataset_dtype_name (dataset.dtype)
+             << ", dimension " << dataset.d << endl;
+
+        cmd_flags.array_sizes.assign (1, (int) dataset.d);
+        cmd_flags.num_array_sizes = 1;
+
+        if (cmd_flags.queries_file)
+        {
+            dataset_open (cmd_flags.queries_file, &queries);
+            if (queries.d != dataset.d)
+            {
+                cout << "ERROR, the queries have dimension " << queries.d
+                     << ", the dataset has dimension " << dataset.d
+                     << ", exiting.\n";
+                exit (-1);
+            }
+        }
+
+        if (cmd_flags.groundtruth_file)
+            dataset_open (cmd_flags.groundtruth_file, &groundtruth);
+    }
+    else if (cmd_flags.queries_file || cmd_flags.groundtruth_file)
+    {
+        cout << "ERROR, --queries and --groundtruth require --dataset.\n";
+        exit (-1);
+    }
+
+    if (cmd_flags.early_abandon && !cmd_flags.queries_file)
+    {
+        cout << "ERROR, --early_abandon requires --dataset and --queries.\n";
+        exit (-1);
+    }
+
     /* Set the array sizes to do the testing on.  */
-    array_sizes = cmd_flags.array_sizes;
+    array_sizes = cmd_flags.array_sizes.data();
     num_array_sizes = cmd_flags.num_array_sizes;
-    check_array_index (num_array_sizes);
 
-    results = (struct results_data_t*)
-        malloc (sizeof (results_data_t) * FUNC_ID_MAX);
+    /* The results hold the time samples in std::vector so must be
+       constructed.  */
+    results = new results_data_t[FUNC_ID_MAX];
+    resize_results (results, num_array_sizes);
 
     initialize_group_func_names(group_id_name, results);
+    initialize_kernel_table();
+
+    if (cmd_flags.perf_counters
+        && perf_counters_init (true, cmd_flags.perf_raw_event))
+        cmd_flags.perf_counters = false;
+
+    /* The ny_transposed function works on a transposed block of vectors,
+       it has no database form.  */
+    if (cmd_flags.working_set != WORKING_SET_NONE
+        && cmd_flags.run_func_flag[FVEC_L2SQR_NY_TRANSPOSED_REF])
+    {
+        cout << "fvec_L2sqr_ny_transposed_ref is not run in working set"
+             << " mode.\n";
+        cmd_flags.run_func_flag[FVEC_L2SQR_NY_TRANSPOSED_REF] = false;
+    }
 
     /* Print the command line arguments, the function names, run flag,
        associated group, optimized and excluded flags if the verbose command
@@ -103,6 +226,19 @@ main(int argc, char *argv[])
     if (cmd_flags.verbose_output)
         print_cmd_opts (cmd_flags, results, group_id_name);
 
+    /* Check the code versions against the base version on random inputs
+       instead of timing them.  */
+    if (cmd_flags.fuzz_iterations > 0)
+    {
+        exit_code = run_fuzz_tests (timefile, results, cmd_flags);
+        perf_counters_close ();
+        dataset_close (&dataset);
+        dataset_close (&queries);
+        dataset_close (&groundtruth);
+        delete [] results;
+        return exit_code;
+    }
+
     for (array_index = 0; array_index < num_array_sizes; array_index++) {
         /* Test the various distance functions in euclidean_l2_distance.cc  */
         /* Setup input arrays for the various euclidian distance tests */
@@ -111,7 +247,43 @@ main(int argc, char *argv[])
 
         cout << "Running array size "<< size << endl;
 
-        load_data_float (size, x_d, y0_d, y1_d, y2_d, y3_d);
+        /* Run the functions concurrently on each of the thread counts and
+           on the threads of each NUMA node.  */
+        if (!cmd_flags.thread_counts.empty () || cmd_flags.numa_matrix)
+            run_thread_tests (results, array_index, size, cmd_flags,
+                              cmd_flags.dataset_file ? &dataset : NULL);
+
+        /* Check the results against the long double oracle.  */
+        if (cmd_flags.accuracy_trials > 0)
+            run_accuracy_tests (results, array_index, size, cmd_flags);
+
+        if (cmd_flags.working_set != WORKING_SET_NONE)
+        {
+            /* Run the functions over a database of vectors sized to the
+               requested cache level.  */
+            run_working_set_tests (results, array_index, size, cmd_flags,
+                                   cmd_flags.dataset_file ? &dataset : NULL);
+            continue;
+        }
+
+        struct arena_t arena;
+
+        arena_init (&arena, ARENA_CHUNK_SIZE, 0);
+        load_data_float (&arena, size, x_d, y0_d, y1_d, y2_d, y3_d);
+        load_data_int8 (&arena, size, xi_d, yi_d);
+        load_data_char (&arena, size, c1_d, c2_d);
+
+        /* Replace the generated data with the dataset rows.  x is the first
+           query if there are queries.  */
+        if (cmd_flags.dataset_file)
+        {
+            dataset_load_float (&dataset, 0, size, *x_d, *y0_d, *y1_d,
+                                *y2_d, *y3_d);
+            if (cmd_flags.queries_file)
+                dataset_row_float (&queries, 0, *x_d);
+            dataset_load_int8 (&dataset, 0, size, *xi_d, *yi_d);
+            dataset_load_char (&dataset, 0, size, *c1_d, *c2_d);
+        }
 
         const float * x = *x_d;
         const float * y0 = *y0_d;
@@ -119,139 +291,167 @@ main(int argc, char *argv[])
         const float * y2 = *y2_d;
         const float * y3 = *y3_d;
 
-        load_data_int8 (size, xi_d, yi_d);
-
         const int8_t * xi = *xi_d;
         const int8_t * yi = *yi_d;
 
-        load_data_char (size, c1_d, c2_d);
-
         const uint8_t * c1 = *c1_d;
         const uint8_t * c2 = *c2_d;
 
-        float *dis = (float *)malloc(sizeof(float *) * NY_DISTANCE);
-
-        /**********  Eulcidian tests *************/
-
-        /* Test fvec_L2sqr_ref  */
-        if (cmd_flags.run_func_flag[FVEC_L2SQR_REF])
-            test_fvec_L2sqr_ref (results, FVEC_L2SQR_REF, array_index,
-                                 cmd_flags.num_runs,
-                                 cmd_flags.run_code_version, x, y2, size);
-
-        /* Test fvec_norm_L2sqr_ref  */
-        if (cmd_flags.run_func_flag[FVEC_NORM_L2SQR_REF])
-            test_fvec_norm_L2sqr_ref (results, FVEC_NORM_L2SQR_REF,
-                                      array_index, cmd_flags.num_runs,
-                                      cmd_flags.run_code_version, x,
-                                      size);
-
-        /* Test fvec_L2sqr_ny_transposed_ref  */
-        if (cmd_flags.run_func_flag[FVEC_L2SQR_NY_TRANSPOSED_REF])
-            test_fvec_L2sqr_ny_transposed_ref (results,
-                                               FVEC_L2SQR_NY_TRANSPOSED_REF,
-                                               array_index, cmd_flags.num_runs,
-                                               cmd_flags.run_code_version,
-                                               dis, x, y1, y2,
-                                               (size_t)(size/4), 2,
-                                               NY_DISTANCE);
-
-        /* Test fvec_L2sqr_batch_4_ref   */
-        if (cmd_flags.run_func_flag[FVEC_L2SQR_BATCH_4_REF])
-            test_fvec_L2sqr_batch_4_ref (results, FVEC_L2SQR_BATCH_4_REF,
-                                         array_index, cmd_flags.num_runs,
-                                         cmd_flags.run_code_version, x, y0, y1,
-                                         y2, y3, size, dp0, dp1, dp2, dp3);
-
-        /* Test ivec_L2sqr_ref  */
-        if (cmd_flags.run_func_flag[IVEC_L2SQR_REF])
-            test_ivec_L2sqr_ref (results, IVEC_L2SQR_REF, array_index,
-                                 cmd_flags.num_runs,
-                                 cmd_flags.run_code_version, xi, yi, size);
-
-        /**********  Inner product tests *************/
-        /* Test inner_product_ref  */
-        if (cmd_flags.run_func_flag[FVEC_INNER_PRODUCT_REF])
-            test_fvec_inner_product_ref (results, FVEC_INNER_PRODUCT_REF,
-                                         array_index, cmd_flags.num_runs,
-                                         cmd_flags.run_code_version, x, y2,
-                                         size);
-
-        /* Test ivec_inner_product_batch_4_ref  */
-        if (cmd_flags.run_func_flag[FVEC_INNER_PRODUCT_BATCH_4_REF])
-            test_fvec_inner_product_batch_4_ref (results,
-                                                 FVEC_INNER_PRODUCT_BATCH_4_REF,
-                                                 array_index,
-                                                 cmd_flags.num_runs,
-                                                 cmd_flags.run_code_version,
-                                                 x, y0, y1, y2, y3, size,
-                                                 dp0, dp1, dp2, dp3);
-
-        /* Test ivec_inner_product_ref  */
-        if (cmd_flags.run_func_flag[IVEC_INNER_PRODUCT_REF])
-            test_ivec_L2sqr_ref (results, IVEC_INNER_PRODUCT_REF, array_index,
-                                 cmd_flags.num_runs,
-                                 cmd_flags.run_code_version, xi, yi, size);
-
-
-
-        /**********  Manhattan distance tests *************/
-	
-        if (cmd_flags.run_func_flag[FVEC_L1_REF])
-          { 
-	    test_fvec_L1_ref (results, FVEC_L1_REF, array_index,
-                          cmd_flags.num_runs,
-                          cmd_flags.run_code_version, x, y0, size);
-	    }
-
-        /**********  Cosine distance test *************/
-	
-        if (cmd_flags.run_func_flag[COSINE_DISTANCE_REF])
-          { 
-	    test_cosine_distance_ref (results, COSINE_DISTANCE_REF, array_index,
-                                  cmd_flags.num_runs,
-                                  cmd_flags.run_code_version, x, y0, size);
-	    }
-
-        /**********  Hamming distance test *************/
-
-        if (cmd_flags.run_func_flag[HAMMING_DISTANCE_REF])
+        float *dis = (float *) arena_alloc (&arena,
+                                            sizeof (float) * NY_DISTANCE);
+
+        struct test_data_t data = {x, y0, y1, y2, y3, xi, yi, c1, c2, dis,
+                                   (size_t) size, dp0, dp1, dp2, dp3};
+
+        /* Set the number of runs of each test.  Calibrating also warms up
+           the caches and branch predictors.  */
+        for (i = 0; i < FUNC_ID_MAX; i++)
         {
-            test_hamming_distance_ref (results, HAMMING_DISTANCE_REF,
-                                       array_index, cmd_flags.num_runs,
-                                       cmd_flags.run_code_version, c1, c2,
-                                       size);
-	    }
-
-        /**********  Jaccard distance test *************/
-	
-        if (cmd_flags.run_func_flag[JACCARD_DISTANCE_REF])
+            if (!cmd_flags.run_func_flag[i])
+                continue;
+
+            if (cmd_flags.calibrate)
+                results[i].num_runs[array_index]
+                    = calibrate_test (results, i, array_index,
+                                      cmd_flags.run_code_version, &data,
+                                      calibrate_target_ns (cmd_flags));
+            else
+                results[i].num_runs[array_index] = cmd_flags.num_runs;
+        }
+
+        /* Run all of the selected tests, then repeat.  Interleaving the
+           tests across the repetitions spreads any slow periods of the
+           system over all of the tests.  The samples of the warmup
+           repetitions are discarded.  */
+        for (rep = 0; rep < cmd_flags.num_warmup + cmd_flags.num_reps; rep++)
         {
-            test_jaccard_distance_ref (results, JACCARD_DISTANCE_REF,
-                                       array_index,
-                                       cmd_flags.num_runs,
-                                       cmd_flags.run_code_version, x, y0,
-                                       size);
-	    }
-       
+            if (rep == cmd_flags.num_warmup)
+                clear_time_samples (results, array_index);
+
+            for (i = 0; i < FUNC_ID_MAX; i++)
+                if (cmd_flags.run_func_flag[i])
+                    run_test (results, i, array_index,
+                              results[i].num_runs[array_index],
+                              cmd_flags.run_code_version, &data);
+        }
+
+        summarize_time_samples (results, array_index);
+
+        /* Repeat the tests with misaligned inputs.  */
+        if (cmd_flags.offset_sweep != OFFSET_SWEEP_NONE)
+            run_offset_tests (results, array_index, cmd_flags, &data);
+
+        /* Time the fixed dimension instances against the generic ones.  */
+        if (cmd_flags.fixed_dim)
+            run_fixed_dim_tests (results, array_index, cmd_flags, &data);
+
+        /* Time the multiple accumulator variants.  */
+        if (!cmd_flags.multi_acc_counts.empty ())
+            run_multi_acc_tests (results, array_index, cmd_flags, &data);
+
+        /* Time the cosine distance with cached and without norms.  */
+        if (cmd_flags.cosine_modes)
+            run_cosine_tests (results, array_index, cmd_flags, &data);
+
+        /* Time the MaxSim scoring of multi-vector documents.  */
+        if (cmd_flags.maxsim)
+            run_maxsim_tests (array_index, cmd_flags);
+
+        /* Time the range search kernels.  */
+        if (cmd_flags.range_search)
+            run_range_tests (array_index, cmd_flags);
+
+        /* Time the filtered searches over the selectivity sweep.  */
+        if (cmd_flags.filter_sweep)
+            run_filter_tests (array_index, cmd_flags);
+
+        /* Time the distances to panels of vectors.  */
+        if (cmd_flags.panel)
+            run_panel_tests (array_index, cmd_flags);
+
+        /* Time the parallel engines on each thread count.  */
+        if (!cmd_flags.parallel_counts.empty ())
+            run_parallel_tests (array_index, cmd_flags);
+
+        /* Time the all-pairs distance matrices.  */
+        if (cmd_flags.pairwise)
+            run_pairwise_tests (array_index, cmd_flags);
+
         /* Release data arrays.  */
-        release_data_float (x_d, y0_d, y1_d, y2_d, y3_d, dis);
-        release_data_int8 (xi_d, yi_d);
-        release_data_char (c1_d, c2_d);
+        arena_release (&arena);
     }
 
+    /* The sparse kernels do not depend on the array size.  */
+    if (cmd_flags.sparse)
+        run_sparse_tests (cmd_flags);
+
     /* Print results */
     print_time (timefile, FUNC_ID_MAX, array_index, results, cmd_flags,
                 group_id_name);
+    print_time_stats (timefile, FUNC_ID_MAX, array_index, results, cmd_flags,
+                      group_id_name);
+    if (cmd_flags.perf_counters)
+        print_perf_counters (timefile, FUNC_ID_MAX, array_index, results,
+                             cmd_flags, group_id_name);
+    if (cmd_flags.working_set != WORKING_SET_NONE)
+        print_working_set (timefile, FUNC_ID_MAX, array_index, results,
+                           cmd_flags, group_id_name);
+    if (!cmd_flags.thread_counts.empty () || cmd_flags.numa_matrix)
+        print_thread_tests (timefile, results, cmd_flags);
+    if (cmd_flags.offset_sweep != OFFSET_SWEEP_NONE)
+        print_offset_tests (timefile, results, cmd_flags);
+    if (cmd_flags.accuracy_trials > 0)
+        print_accuracy_tests (timefile, results, cmd_flags);
+    if (cmd_flags.fixed_dim)
+        print_fixed_dim_tests (timefile, results, cmd_flags);
+    if (!cmd_flags.multi_acc_counts.empty ())
+        print_multi_acc_tests (timefile, results, cmd_flags);
+    if (cmd_flags.cosine_modes)
+        print_cosine_tests (timefile, results, cmd_flags);
+    if (cmd_flags.sparse)
+        print_sparse_tests (timefile);
+    if (cmd_flags.maxsim)
+        print_maxsim_tests (timefile, cmd_flags);
+    if (cmd_flags.range_search)
+        print_range_tests (timefile, cmd_flags);
+    if (cmd_flags.filter_sweep)
+        print_filter_tests (timefile, cmd_flags);
+    if (cmd_flags.panel)
+        print_panel_tests (timefile, cmd_flags);
+    if (!cmd_flags.parallel_counts.empty ())
+        print_parallel_tests (timefile, cmd_flags);
+    if (cmd_flags.pairwise)
+        print_pairwise_tests (timefile, cmd_flags);
     print_result (resultfile, FUNC_ID_MAX, array_index, results, cmd_flags,
                   group_id_name);
+    write_json_results (jsonfile, FUNC_ID_MAX, array_index, results,
+                        cmd_flags);
+    write_csv_results (csvfile, FUNC_ID_MAX, array_index, results, cmd_flags);
+
+    /* Brute force k-NN recall over the dataset.  */
+    if (cmd_flags.queries_file)
+        run_recall_test (timefile, cmd_flags, &dataset, &queries,
+                         cmd_flags.groundtruth_file ? &groundtruth : NULL);
+
+    /* Compare against an earlier run.  */
+    if (cmd_flags.compare_file
+        && compare_results (timefile, cmd_flags.compare_file, FUNC_ID_MAX,
+                            array_index, results, cmd_flags) > 0)
+        exit_code = REGRESSION_EXIT_CODE;
+
+    perf_counters_close ();
+    dataset_close (&dataset);
+    dataset_close (&queries);
+    dataset_close (&groundtruth);
 
     /* Release results array.  */
-    free (results);
+    delete [] results;
 
     timefile.close();
     resultfile.close();
+    jsonfile.close();
+    csvfile.close();
 
-    return 0;
+    return exit_code;
 }
 
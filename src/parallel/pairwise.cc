@@ -0,0 +1,314 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* All-pairs distance matrices of one or two sets of vectors, split in tiles
+   of PAIRWISE_TILE by PAIRWISE_TILE vectors run by a work pool.  */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include "pairwise.h"
+
+/* IEEE half precision of f, rounded to nearest even.  Values too large for
+   a half are stored as infinity.  */
+uint16_t
+float_to_half (float f)
+{
+    uint32_t u, sign, mant, h, rem, round;
+    int e;
+
+    memcpy (&u, &f, sizeof (u));
+    sign = (u >> 16) & 0x8000;
+    mant = u & 0x7fffff;
+    e = (int) ((u >> 23) & 0xff) - 127 + 15;
+
+    if (e == 128 + 15)                      /* Infinity or NaN.  */
+        return sign | 0x7c00 | (mant ? 0x200 : 0);
+    if (e >= 31)
+        return sign | 0x7c00;
+
+    if (e <= 0)
+    {
+        /* Subnormal half, the implicit bit is shifted in.  */
+        if (e < -10)
+            return sign;
+        mant |= 0x800000;
+        h = mant >> (14 - e);
+        rem = mant & ((1u << (14 - e)) - 1);
+        round = 1u << (13 - e);
+    }
+    else
+    {
+        h = (uint32_t) e << 10 | mant >> 13;
+        rem = mant & 0x1fff;
+        round = 0x1000;
+    }
+
+    /* A carry out of the mantissa rounds up to the next exponent.  */
+    if (rem > round || (rem == round && (h & 1)))
+        h++;
+    return sign | h;
+}
+
+float
+half_to_float (uint16_t h)
+{
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t e = (h >> 10) & 0x1f, mant = h & 0x3ff, u;
+    float f;
+
+    if (e == 0)
+    {
+        f = ldexpf ((float) mant, -24);
+        return sign ? -f : f;
+    }
+
+    if (e == 31)
+        u = sign | 0x7f800000 | mant << 13;
+    else
+        u = sign | (e + 127 - 15) << 23 | mant << 13;
+    memcpy (&f, &u, sizeof (f));
+    return f;
+}
+
+struct pairwise_job_t {
+    const struct pairwise_kernels_t *kern;
+    const char *x;
+    size_t nx;
+    size_t x_stride;            /* In bytes.  */
+    const char *y;
+    size_t ny;
+    size_t y_stride;            /* In bytes.  */
+    size_t d;
+    unsigned int dtype;
+    void *dis;
+    size_t num_tiles;           /* Of y, or per side of pdist.  */
+    bool pdist;
+    const float *x_inv_norms;   /* Cosine only.  */
+    const float *y_inv_norms;
+};
+
+/* Distances of x vector i to the y vectors j0 to j1 - 1, to row.  */
+static void
+pairwise_row (const struct pairwise_job_t *job, size_t i, size_t j0,
+              size_t j1, float *row)
+{
+    const struct pairwise_kernels_t *kern = job->kern;
+    const char *xi = job->x + i * job->x_stride;
+    size_t j = j0;
+
+    if (kern->metric == PAIRWISE_HAMMING)
+    {
+        for (; j < j1; j++)
+            row[j - j0] = (float) kern->code_pair (
+                (const uint8_t *) xi,
+                (const uint8_t *) (job->y + j * job->y_stride), job->d);
+        return;
+    }
+
+    if (kern->batch_4)
+        for (; j + 4 <= j1; j += 4)
+        {
+            const char *yj = job->y + j * job->y_stride;
+
+            kern->batch_4 ((const float *) xi, (const float *) yj,
+                           (const float *) (yj + job->y_stride),
+                           (const float *) (yj + 2 * job->y_stride),
+                           (const float *) (yj + 3 * job->y_stride), job->d,
+                           row[j - j0], row[j - j0 + 1], row[j - j0 + 2],
+                           row[j - j0 + 3]);
+        }
+
+    for (; j < j1; j++)
+        row[j - j0] = kern->pair ((const float *) xi,
+                                  (const float *) (job->y + j * job->y_stride),
+                                  job->d);
+
+    if (kern->metric == PAIRWISE_COSINE)
+        for (j = j0; j < j1; j++)
+            row[j - j0] = 1.0f - row[j - j0] * job->x_inv_norms[i]
+                                 * job->y_inv_norms[j];
+}
+
+static void
+pairwise_store (const struct pairwise_job_t *job, size_t index,
+                const float *row, size_t n)
+{
+    if (job->dtype == PAIRWISE_FLOAT16)
+    {
+        uint16_t *dis = (uint16_t *) job->dis + index;
+
+        for (size_t k = 0; k < n; k++)
+            dis[k] = float_to_half (row[k]);
+    }
+    else
+        memcpy ((float *) job->dis + index, row, n * sizeof (float));
+}
+
+/* One tile of x vectors by y vectors.  The tiles of pdist are those on and
+   above the diagonal, row by row, and only the pairs i < j are computed.  */
+static void
+pairwise_tile (void *arg, int worker, size_t chunk)
+{
+    struct pairwise_job_t *job = (struct pairwise_job_t *) arg;
+    float row[PAIRWISE_TILE];
+    size_t ti = 0, tj, i, i1, j0, j1;
+
+    if (job->pdist)
+    {
+        while (chunk >= job->num_tiles - ti)
+            chunk -= job->num_tiles - ti++;
+        tj = ti + chunk;
+    }
+    else
+    {
+        ti = chunk / job->num_tiles;
+        tj = chunk % job->num_tiles;
+    }
+
+    i1 = (ti + 1) * PAIRWISE_TILE < job->nx ? (ti + 1) * PAIRWISE_TILE
+                                            : job->nx;
+    j1 = (tj + 1) * PAIRWISE_TILE < job->ny ? (tj + 1) * PAIRWISE_TILE
+                                            : job->ny;
+
+    for (i = ti * PAIRWISE_TILE; i < i1; i++)
+    {
+        j0 = tj * PAIRWISE_TILE;
+        if (job->pdist && j0 <= i)
+            j0 = i + 1;
+        if (j0 >= j1)
+            continue;
+
+        pairwise_row (job, i, j0, j1, row);
+        pairwise_store (job,
+                        job->pdist ? pairwise_pdist_index (job->nx, i, j0)
+                                   : i * job->ny + j0,
+                        row, j1 - j0);
+    }
+}
+
+static void
+pairwise_inv_norms (const struct pairwise_kernels_t *kern, const float *x,
+                    size_t n, size_t stride, size_t d,
+                    std::vector<float> &inv_norms)
+{
+    inv_norms.resize (n);
+    for (size_t i = 0; i < n; i++)
+        inv_norms[i] = 1.0f / sqrtf (kern->norm_sqr (x + i * stride, d));
+}
+
+static void
+pairwise_run (struct work_pool_t *pool, struct pairwise_job_t *job,
+              size_t num_chunks)
+{
+    if (job->kern->metric >= PAIRWISE_METRIC_MAX
+        || job->dtype >= PAIRWISE_DTYPE_MAX)
+    {
+        std::cout << "ERROR, pairwise metric " << job->kern->metric
+                  << " or output type " << job->dtype << " is not valid.\n";
+        exit (-1);
+    }
+
+    /* Without a pool the tiles run on the calling thread.  */
+    if (pool == NULL)
+        for (size_t c = 0; c < num_chunks; c++)
+            pairwise_tile (job, 0, c);
+    else
+        work_pool_run (pool, num_chunks, pairwise_tile, job);
+}
+
+static size_t
+pairwise_elem_size (const struct pairwise_kernels_t *kern)
+{
+    return kern->metric == PAIRWISE_HAMMING ? sizeof (uint8_t)
+                                            : sizeof (float);
+}
+
+/* Distances between the nx vectors of x and the ny vectors of y, strides
+   in elements, floats or Hamming code bytes.  dis[i * ny + j] is the
+   distance between x vector i and y vector j, of type dtype.  pool may be
+   NULL to run on the calling thread.  */
+void
+pairwise_cdist (struct work_pool_t *pool,
+                const struct pairwise_kernels_t *kern, const void *x,
+                size_t nx, size_t x_stride, const void *y, size_t ny,
+                size_t y_stride, size_t d, unsigned int dtype, void *dis)
+{
+    struct pairwise_job_t job;
+    std::vector<float> x_inv_norms, y_inv_norms;
+    size_t elem = pairwise_elem_size (kern);
+
+    if (kern->metric == PAIRWISE_COSINE)
+    {
+        pairwise_inv_norms (kern, (const float *) x, nx, x_stride, d,
+                            x_inv_norms);
+        pairwise_inv_norms (kern, (const float *) y, ny, y_stride, d,
+                            y_inv_norms);
+    }
+
+    job.kern = kern;
+    job.x = (const char *) x;
+    job.nx = nx;
+    job.x_stride = x_stride * elem;
+    job.y = (const char *) y;
+    job.ny = ny;
+    job.y_stride = y_stride * elem;
+    job.d = d;
+    job.dtype = dtype;
+    job.dis = dis;
+    job.num_tiles = (ny + PAIRWISE_TILE - 1) / PAIRWISE_TILE;
+    job.pdist = false;
+    job.x_inv_norms = x_inv_norms.data ();
+    job.y_inv_norms = y_inv_norms.data ();
+
+    pairwise_run (pool, &job,
+                  (nx + PAIRWISE_TILE - 1) / PAIRWISE_TILE * job.num_tiles);
+}
+
+/* Distances between the pairs i < j of the n vectors of x, n * (n - 1) / 2
+   of type dtype in the order of pairwise_pdist_index.  Only the tiles on
+   and above the diagonal are computed, half of the work of cdist (x, x).  */
+void
+pairwise_pdist (struct work_pool_t *pool,
+                const struct pairwise_kernels_t *kern, const void *x,
+                size_t n, size_t stride, size_t d, unsigned int dtype,
+                void *dis)
+{
+    struct pairwise_job_t job;
+    std::vector<float> inv_norms;
+
+    if (kern->metric == PAIRWISE_COSINE)
+        pairwise_inv_norms (kern, (const float *) x, n, stride, d, inv_norms);
+
+    job.kern = kern;
+    job.x = (const char *) x;
+    job.nx = n;
+    job.x_stride = stride * pairwise_elem_size (kern);
+    job.y = job.x;
+    job.ny = n;
+    job.y_stride = job.x_stride;
+    job.d = d;
+    job.dtype = dtype;
+    job.dis = dis;
+    job.num_tiles = (n + PAIRWISE_TILE - 1) / PAIRWISE_TILE;
+    job.pdist = true;
+    job.x_inv_norms = inv_norms.data ();
+    job.y_inv_norms = inv_norms.data ();
+
+    pairwise_run (pool, &job, job.num_tiles * (job.num_tiles + 1) / 2);
+}
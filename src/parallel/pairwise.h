@@ -0,0 +1,89 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_PAIRWISE_H
+#define PARALLEL_PAIRWISE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "work_pool.h"
+
+/* Vectors per side of a tile of the distance matrix.  The vectors of a tile
+   are reused from the cache for all of the vectors of the other side.  */
+#define PAIRWISE_TILE 64
+
+enum pairwise_metric_id {
+    PAIRWISE_L2 = 0,            /* Squared L2 distance.  */
+    PAIRWISE_IP,                /* Inner product.  */
+    PAIRWISE_L1,
+    PAIRWISE_COSINE,            /* 1 - x.y / (||x|| ||y||).  */
+    PAIRWISE_JACCARD,
+    PAIRWISE_HAMMING,           /* Of uint8_t codes of d bytes.  */
+    PAIRWISE_METRIC_MAX,
+};
+
+/* Element type of the distances written.  */
+enum pairwise_dtype_id {
+    PAIRWISE_FLOAT32 = 0,
+    PAIRWISE_FLOAT16,           /* IEEE half precision, as uint16_t.  */
+    PAIRWISE_DTYPE_MAX,
+};
+
+typedef float (*pairwise_fn_t) (const float* x, const float* y, size_t d);
+typedef float (*pairwise_norm_fn_t) (const float* x, size_t d);
+typedef void (*pairwise_batch_4_fn_t) (const float* x, const float* y0,
+                                       const float* y1, const float* y2,
+                                       const float* y3, const size_t d,
+                                       float& dis0, float& dis1, float& dis2,
+                                       float& dis3);
+typedef size_t (*pairwise_code_fn_t) (const uint8_t* x, const uint8_t* y,
+                                      size_t size);
+
+/* Kernels of one metric, of any code version.  The cosine distance is
+   computed from the inner product kernels and the squared norms of
+   norm_sqr, computed once per vector.  batch_4 may be NULL, then pair is
+   used for all of the vectors.  */
+struct pairwise_kernels_t {
+    unsigned int metric = PAIRWISE_L2;
+    pairwise_fn_t pair = NULL;              /* All but Hamming.  */
+    pairwise_batch_4_fn_t batch_4 = NULL;   /* L2, IP and cosine.  */
+    pairwise_norm_fn_t norm_sqr = NULL;     /* Cosine.  */
+    pairwise_code_fn_t code_pair = NULL;    /* Hamming.  */
+};
+
+/* Index of the distance between vectors i < j in the output of
+   pairwise_pdist, row by row as scipy's condensed distance matrix.  */
+static inline size_t
+pairwise_pdist_index (size_t n, size_t i, size_t j)
+{
+    return n * i - i * (i + 1) / 2 + (j - i - 1);
+}
+
+uint16_t float_to_half (float f);
+float half_to_float (uint16_t h);
+
+void pairwise_cdist (struct work_pool_t *pool,
+                     const struct pairwise_kernels_t *kern, const void *x,
+                     size_t nx, size_t x_stride, const void *y, size_t ny,
+                     size_t y_stride, size_t d, unsigned int dtype,
+                     void *dis);
+
+void pairwise_pdist (struct work_pool_t *pool,
+                     const struct pairwise_kernels_t *kern, const void *x,
+                     size_t n, size_t stride, size_t d, unsigned int dtype,
+                     void *dis);
+
+#endif /* PARALLEL_PAIRWISE_H */
@@ -0,0 +1,358 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Database scans, distance matrices and k-means steps split into chunks
+   run by a work pool.  Each worker accumulates into its own results, which
+   are merged once all of the chunks are done.  The distances are computed
+   4 database vectors at a time with the batch_4 function when there is
+   one, the pair distance does the rest of a chunk.  */
+
+#include <iostream>
+#include <cstdlib>
+#include <cfloat>
+#include <vector>
+#include "parallel_search.h"
+
+/* Database vectors of y_stride floats per chunk, at least one.  */
+size_t
+parallel_chunk_vectors (size_t y_stride)
+{
+    size_t n = PARALLEL_CHUNK_BYTES / (y_stride * sizeof (float));
+
+    return n > 0 ? n : 1;
+}
+
+/* Index of the nearest of the ny vectors of y to x, the first one of a
+   tie, and its distance to *dis.  */
+size_t
+parallel_nearest (knn_distance_fn_t fn, parallel_batch_4_fn_t batch_4,
+                  const float *x, const float *y, size_t ny, size_t y_stride,
+                  size_t d, float *dis)
+{
+    float best = FLT_MAX, dis4[4];
+    size_t best_j = 0, j = 0, k;
+
+    if (batch_4)
+        for (; j + 4 <= ny; j += 4)
+        {
+            const float *yj = y + j * y_stride;
+
+            batch_4 (x, yj, yj + y_stride, yj + 2 * y_stride,
+                     yj + 3 * y_stride, d, dis4[0], dis4[1], dis4[2],
+                     dis4[3]);
+            for (k = 0; k < 4; k++)
+                if (dis4[k] < best)
+                {
+                    best = dis4[k];
+                    best_j = j + k;
+                }
+        }
+
+    for (; j < ny; j++)
+    {
+        float dis_j = fn (x, y + j * y_stride, d);
+
+        if (dis_j < best)
+        {
+            best = dis_j;
+            best_j = j;
+        }
+    }
+
+    *dis = best;
+    return best_j;
+}
+
+static inline size_t
+num_chunks_of (size_t n, size_t per_chunk)
+{
+    return (n + per_chunk - 1) / per_chunk;
+}
+
+struct knn_job_t {
+    knn_distance_fn_t fn;
+    parallel_batch_4_fn_t batch_4;
+    const float *x;
+    const float *y;
+    size_t ny;
+    size_t y_stride;
+    size_t d;
+    size_t chunk;                   /* Database vectors per chunk.  */
+    struct topk_t *heaps;           /* One per worker.  */
+};
+
+static void
+knn_chunk (void *arg, int worker, size_t chunk)
+{
+    struct knn_job_t *job = (struct knn_job_t *) arg;
+    struct topk_t *h = &job->heaps[worker];
+    size_t first = chunk * job->chunk;
+    size_t last = first + job->chunk < job->ny ? first + job->chunk : job->ny;
+    size_t i = first;
+    float dis4[4];
+
+    if (job->batch_4)
+        for (; i + 4 <= last; i += 4)
+        {
+            const float *yi = job->y + i * job->y_stride;
+
+            job->batch_4 (job->x, yi, yi + job->y_stride,
+                          yi + 2 * job->y_stride, yi + 3 * job->y_stride,
+                          job->d, dis4[0], dis4[1], dis4[2], dis4[3]);
+            for (size_t k = 0; k < 4; k++)
+                if (dis4[k] < topk_threshold (h))
+                    topk_push (h, dis4[k], (int64_t) (i + k));
+        }
+
+    for (; i < last; i++)
+    {
+        float dis = job->fn (job->x, job->y + i * job->y_stride, job->d);
+
+        if (dis < topk_threshold (h))
+            topk_push (h, dis, (int64_t) i);
+    }
+}
+
+/* knn_search of the ny vectors of y with the chunks of the database spread
+   over the threads of pool.  Each worker keeps the k best of its chunks,
+   the heaps are merged into res, which is not sorted.  */
+void
+parallel_knn_search (struct work_pool_t *pool, knn_distance_fn_t fn,
+                     parallel_batch_4_fn_t batch_4, const float *x,
+                     const float *y, size_t ny, size_t y_stride, size_t d,
+                     struct topk_t *res)
+{
+    std::vector<struct topk_t> heaps (pool->num_threads);
+    struct knn_job_t job;
+    int w;
+
+    for (w = 0; w < pool->num_threads; w++)
+        topk_init (&heaps[w], res->k);
+
+    job.fn = fn;
+    job.batch_4 = batch_4;
+    job.x = x;
+    job.y = y;
+    job.ny = ny;
+    job.y_stride = y_stride;
+    job.d = d;
+    job.chunk = parallel_chunk_vectors (y_stride);
+    job.heaps = heaps.data ();
+
+    work_pool_run (pool, num_chunks_of (ny, job.chunk), knn_chunk, &job);
+
+    for (w = 0; w < pool->num_threads; w++)
+    {
+        for (size_t i = 0; i < heaps[w].n; i++)
+            if (heaps[w].dis[i] < topk_threshold (res))
+                topk_push (res, heaps[w].dis[i], heaps[w].ids[i]);
+        topk_release (&heaps[w]);
+    }
+}
+
+struct matrix_job_t {
+    knn_distance_fn_t fn;
+    parallel_batch_4_fn_t batch_4;
+    const float *x;
+    size_t nx;
+    size_t x_stride;
+    const float *y;
+    size_t ny;
+    size_t y_stride;
+    size_t d;
+    size_t chunk;                   /* Database vectors per chunk.  */
+    size_t num_y_chunks;
+    float *dis;
+};
+
+/* One tile of PARALLEL_TILE_QUERIES queries by a chunk of the database.
+   Each group of 4 database vectors is compared with all of the queries of
+   the tile while it is in the L1 cache.  */
+static void
+matrix_chunk (void *arg, int worker, size_t chunk)
+{
+    struct matrix_job_t *job = (struct matrix_job_t *) arg;
+    size_t q0 = (chunk / job->num_y_chunks) * PARALLEL_TILE_QUERIES;
+    size_t y0 = (chunk % job->num_y_chunks) * job->chunk;
+    size_t q1 = q0 + PARALLEL_TILE_QUERIES < job->nx
+                ? q0 + PARALLEL_TILE_QUERIES : job->nx;
+    size_t y1 = y0 + job->chunk < job->ny ? y0 + job->chunk : job->ny;
+    size_t j = y0;
+
+    if (job->batch_4)
+        for (; j + 4 <= y1; j += 4)
+        {
+            const float *yj = job->y + j * job->y_stride;
+
+            for (size_t i = q0; i < q1; i++)
+            {
+                float *dis = job->dis + i * job->ny + j;
+
+                job->batch_4 (job->x + i * job->x_stride, yj,
+                              yj + job->y_stride, yj + 2 * job->y_stride,
+                              yj + 3 * job->y_stride, job->d, dis[0], dis[1],
+                              dis[2], dis[3]);
+            }
+        }
+
+    for (; j < y1; j++)
+    {
+        const float *yj = job->y + j * job->y_stride;
+
+        for (size_t i = q0; i < q1; i++)
+            job->dis[i * job->ny + j] = job->fn (job->x + i * job->x_stride,
+                                                 yj, job->d);
+    }
+}
+
+/* Distances between the nx vectors of x and the ny vectors of y,
+   dis[i * ny + j] is the distance between x vector i and y vector j.  The
+   matrix is split in tiles of queries by chunks of the database.  */
+void
+parallel_distance_matrix (struct work_pool_t *pool, knn_distance_fn_t fn,
+                          parallel_batch_4_fn_t batch_4, const float *x,
+                          size_t nx, size_t x_stride,
+                          const float *y, size_t ny, size_t y_stride,
+                          size_t d, float *dis)
+{
+    struct matrix_job_t job;
+
+    job.fn = fn;
+    job.batch_4 = batch_4;
+    job.x = x;
+    job.nx = nx;
+    job.x_stride = x_stride;
+    job.y = y;
+    job.ny = ny;
+    job.y_stride = y_stride;
+    job.d = d;
+    job.chunk = parallel_chunk_vectors (y_stride);
+    job.num_y_chunks = num_chunks_of (ny, job.chunk);
+    job.dis = dis;
+
+    work_pool_run (pool,
+                   num_chunks_of (nx, PARALLEL_TILE_QUERIES)
+                   * job.num_y_chunks, matrix_chunk, &job);
+}
+
+struct kmeans_job_t {
+    knn_distance_fn_t fn;
+    parallel_batch_4_fn_t batch_4;
+    const float *x;
+    size_t n;
+    size_t x_stride;
+    size_t d;
+    const float *centroids;
+    size_t nc;
+    size_t c_stride;
+    size_t chunk;                   /* Points per chunk.  */
+    int64_t *assign;
+
+    /* Per worker, nc * d sums of the points of each centroid, nc counts
+       and the sum of the distances.  */
+    std::vector<std::vector<double> > sums;
+    std::vector<std::vector<size_t> > counts;
+    std::vector<double> objective;
+};
+
+static void
+kmeans_chunk (void *arg, int worker, size_t chunk)
+{
+    struct kmeans_job_t *job = (struct kmeans_job_t *) arg;
+    double *sums = job->sums[worker].data ();
+    size_t *counts = job->counts[worker].data ();
+    size_t first = chunk * job->chunk;
+    size_t last = first + job->chunk < job->n ? first + job->chunk : job->n;
+    double objective = 0;
+
+    for (size_t i = first; i < last; i++)
+    {
+        const float *xi = job->x + i * job->x_stride;
+        float best;
+        size_t best_c = parallel_nearest (job->fn, job->batch_4, xi,
+                                          job->centroids, job->nc,
+                                          job->c_stride, job->d, &best);
+
+        job->assign[i] = (int64_t) best_c;
+        counts[best_c]++;
+        objective += best;
+        for (size_t j = 0; j < job->d; j++)
+            sums[best_c * job->d + j] += xi[j];
+    }
+
+    /* Once per chunk, the objectives of the workers share a cache line.  */
+    job->objective[worker] += objective;
+}
+
+/* One Lloyd iteration of k-means: assign each of the n points of x to the
+   nearest of the nc centroids and store the mean of the points of each
+   centroid to new_centroids, with the stride of centroids.  A centroid
+   without points is copied unchanged.  Returns the sum of the distances of
+   the points to their centroid.  */
+double
+parallel_kmeans_step (struct work_pool_t *pool, knn_distance_fn_t fn,
+                      parallel_batch_4_fn_t batch_4, const float *x,
+                      size_t n, size_t x_stride, size_t d,
+                      const float *centroids, size_t nc, size_t c_stride,
+                      int64_t *assign, float *new_centroids)
+{
+    struct kmeans_job_t job;
+    double objective = 0;
+    size_t c, j;
+    int w;
+
+    job.fn = fn;
+    job.batch_4 = batch_4;
+    job.x = x;
+    job.n = n;
+    job.x_stride = x_stride;
+    job.d = d;
+    job.centroids = centroids;
+    job.nc = nc;
+    job.c_stride = c_stride;
+    job.chunk = parallel_chunk_vectors (x_stride);
+    job.assign = assign;
+    job.sums.assign (pool->num_threads, std::vector<double> (nc * d, 0));
+    job.counts.assign (pool->num_threads, std::vector<size_t> (nc, 0));
+    job.objective.assign (pool->num_threads, 0);
+
+    work_pool_run (pool, num_chunks_of (n, job.chunk), kmeans_chunk, &job);
+
+    /* Merge the workers.  The chunks a worker runs, and so the order its
+       sums are added in, depend on the stealing, so the centroids and the
+       objective may differ from run to run in the last bits.  */
+    for (c = 0; c < nc; c++)
+    {
+        size_t count = 0;
+
+        for (w = 0; w < pool->num_threads; w++)
+            count += job.counts[w][c];
+
+        for (j = 0; j < d; j++)
+        {
+            double sum = 0;
+
+            for (w = 0; w < pool->num_threads; w++)
+                sum += job.sums[w][c * d + j];
+            new_centroids[c * c_stride + j]
+                = count ? (float) (sum / count) : centroids[c * c_stride + j];
+        }
+    }
+
+    for (w = 0; w < pool->num_threads; w++)
+        objective += job.objective[w];
+    return objective;
+}
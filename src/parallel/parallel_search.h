@@ -0,0 +1,67 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_PARALLEL_SEARCH_H
+#define PARALLEL_PARALLEL_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include "work_pool.h"
+#include "knn.h"
+
+/* Database bytes per chunk of the parallel scans, so the chunk being
+   scanned stays in the L2 cache.  */
+#define PARALLEL_CHUNK_BYTES   (256 * 1024)
+
+/* Queries per tile of parallel_distance_matrix, reused from the L1 cache
+   for every database vector of a chunk.  */
+#define PARALLEL_TILE_QUERIES  16
+
+/* Distances of x to 4 vectors, such as fvec_L2sqr_batch_4_ref of the code
+   version of the pair distance fn the engines are given.  batch_4 may be
+   NULL, then fn is used for all of the vectors.  */
+typedef void (*parallel_batch_4_fn_t) (const float* x, const float* y0,
+                                       const float* y1, const float* y2,
+                                       const float* y3, const size_t d,
+                                       float& dis0, float& dis1, float& dis2,
+                                       float& dis3);
+
+size_t parallel_chunk_vectors (size_t y_stride);
+
+size_t parallel_nearest (knn_distance_fn_t fn, parallel_batch_4_fn_t batch_4,
+                         const float *x, const float *y, size_t ny,
+                         size_t y_stride, size_t d, float *dis);
+
+void parallel_knn_search (struct work_pool_t *pool, knn_distance_fn_t fn,
+                          parallel_batch_4_fn_t batch_4, const float *x,
+                          const float *y, size_t ny, size_t y_stride,
+                          size_t d, struct topk_t *res);
+
+void parallel_distance_matrix (struct work_pool_t *pool,
+                               knn_distance_fn_t fn,
+                               parallel_batch_4_fn_t batch_4, const float *x,
+                               size_t nx, size_t x_stride, const float *y,
+                               size_t ny, size_t y_stride, size_t d,
+                               float *dis);
+
+double parallel_kmeans_step (struct work_pool_t *pool, knn_distance_fn_t fn,
+                             parallel_batch_4_fn_t batch_4, const float *x,
+                             size_t n, size_t x_stride, size_t d,
+                             const float *centroids, size_t nc,
+                             size_t c_stride, int64_t *assign,
+                             float *new_centroids);
+
+#endif /* PARALLEL_PARALLEL_SEARCH_H */
@@ -0,0 +1,221 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Thread pool with work stealing over ranges of chunk indices.  */
+
+#include <iostream>
+#include <cstdlib>
+#include "work_pool.h"
+
+static inline uint64_t
+range_pack (uint64_t lo, uint64_t hi)
+{
+    return hi << 32 | lo;
+}
+
+/* Take the next chunk of the worker's own range.  */
+static bool
+deque_pop (struct work_deque_t *q, size_t *chunk)
+{
+    uint64_t r = q->range.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        uint64_t lo = r & 0xffffffff, hi = r >> 32;
+
+        if (lo >= hi)
+            return false;
+        if (q->range.compare_exchange_weak (r, range_pack (lo + 1, hi),
+                                            std::memory_order_acq_rel))
+        {
+            *chunk = lo;
+            return true;
+        }
+    }
+}
+
+/* Take the upper half of the chunks left to victim, at least one, as the
+   new range of thief.  The range of thief is empty, so no other worker
+   updates it until it is stored.  */
+static bool
+deque_steal (struct work_deque_t *victim, struct work_deque_t *thief)
+{
+    uint64_t r = victim->range.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        uint64_t lo = r & 0xffffffff, hi = r >> 32;
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (lo >= hi)
+            return false;
+        if (victim->range.compare_exchange_weak (r, range_pack (lo, mid),
+                                                 std::memory_order_acq_rel))
+        {
+            thief->stolen += hi - mid;
+            thief->range.store (range_pack (mid, hi),
+                                std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+/* Run chunks of the current job until no worker has any left.  */
+static void
+work_pool_work (struct work_pool_t *pool, int worker)
+{
+    struct work_deque_t *own = &pool->deques[worker];
+    size_t chunk;
+    int i;
+
+    for (;;)
+    {
+        while (deque_pop (own, &chunk))
+            pool->fn (pool->arg, worker, chunk);
+
+        /* Look for work starting with the next worker, so the thieves
+           spread over the victims.  */
+        for (i = 1; i < pool->num_threads; i++)
+            if (deque_steal (&pool->deques[(worker + i) % pool->num_threads],
+                             own))
+                break;
+        if (i == pool->num_threads)
+            return;
+    }
+}
+
+static void
+work_pool_thread (struct work_pool_t *pool, int worker,
+                  work_init_fn_t init_fn, void *init_arg)
+{
+    unsigned long int seen = 0;
+
+    if (init_fn)
+        init_fn (init_arg, worker);
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard (pool->lock);
+
+            pool->start.wait (guard, [&] {
+                return pool->quit || pool->generation != seen; });
+            if (pool->quit)
+                return;
+            seen = pool->generation;
+        }
+
+        work_pool_work (pool, worker);
+
+        {
+            std::lock_guard<std::mutex> guard (pool->lock);
+
+            if (--pool->running == 0)
+                pool->done.notify_one ();
+        }
+    }
+}
+
+void
+work_pool_init (struct work_pool_t *pool, int num_threads,
+                work_init_fn_t init_fn, void *init_arg)
+{
+    if (num_threads < 1)
+        num_threads = 1;
+
+    pool->num_threads = num_threads;
+    pool->deques = new struct work_deque_t[num_threads];
+    for (int w = 0; w < num_threads; w++)
+        pool->deques[w].range.store (0);
+
+    pool->generation = 0;
+    pool->running = 0;
+    pool->quit = false;
+
+    for (int w = 1; w < num_threads; w++)
+        pool->threads.push_back (std::thread (work_pool_thread, pool, w,
+                                              init_fn, init_arg));
+}
+
+void
+work_pool_release (struct work_pool_t *pool)
+{
+    {
+        std::lock_guard<std::mutex> guard (pool->lock);
+
+        pool->quit = true;
+    }
+    pool->start.notify_all ();
+
+    for (size_t t = 0; t < pool->threads.size (); t++)
+        pool->threads[t].join ();
+    pool->threads.clear ();
+
+    delete[] pool->deques;
+    pool->deques = NULL;
+    pool->num_threads = 0;
+}
+
+/* Run fn on chunks 0 to num_chunks - 1 and return when all are done.
+   Worker w starts with chunks num_chunks * w / num_threads up to those of
+   worker w + 1, so without stealing each worker runs consecutive chunks.  */
+void
+work_pool_run (struct work_pool_t *pool, size_t num_chunks, work_fn_t fn,
+               void *arg)
+{
+    int n = pool->num_threads;
+
+    if (num_chunks > WORK_POOL_MAX_CHUNKS)
+    {
+        std::cout << "ERROR, " << num_chunks
+                  << " chunks is more than a job of the work pool can hold.\n";
+        exit (-1);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard (pool->lock);
+
+        for (int w = 0; w < n; w++)
+        {
+            pool->deques[w].range.store (
+                range_pack (num_chunks * w / n, num_chunks * (w + 1) / n),
+                std::memory_order_relaxed);
+            pool->deques[w].stolen = 0;
+        }
+
+        pool->fn = fn;
+        pool->arg = arg;
+        pool->num_chunks = num_chunks;
+        pool->running = n - 1;
+        pool->generation++;
+    }
+    pool->start.notify_all ();
+
+    work_pool_work (pool, 0);
+
+    std::unique_lock<std::mutex> guard (pool->lock);
+    pool->done.wait (guard, [&] { return pool->running == 0; });
+}
+
+size_t
+work_pool_stolen (const struct work_pool_t *pool)
+{
+    size_t stolen = 0;
+
+    for (int w = 0; w < pool->num_threads; w++)
+        stolen += pool->deques[w].stolen;
+    return stolen;
+}
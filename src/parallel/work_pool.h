@@ -0,0 +1,82 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_WORK_POOL_H
+#define PARALLEL_WORK_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/* Chunks of a job run by work_pool_run, at most 2^32 - 1.  */
+#define WORK_POOL_MAX_CHUNKS 0xffffffffULL
+
+/* Bytes the deques of the workers are apart, a Power cache line, so the
+   compare and swaps of one worker do not invalidate the line of another.  */
+#define WORK_POOL_LINE 128
+
+/* Runs chunk of a job on worker, 0 to num_threads - 1.  */
+typedef void (*work_fn_t) (void *arg, int worker, size_t chunk);
+
+/* Runs once on each worker thread when it starts, e.g. to bind it to a
+   CPU.  Not called for worker 0, the thread calling work_pool_run.  */
+typedef void (*work_init_fn_t) (void *arg, int worker);
+
+/* Chunks [lo, hi) of the job left to a worker, packed as hi << 32 | lo so
+   the owner taking chunks from lo and the thieves taking the upper half
+   update it with one compare and swap.  A job is a range of chunk indices,
+   so nothing is allocated per chunk.  */
+struct alignas (WORK_POOL_LINE) work_deque_t {
+    std::atomic<uint64_t> range;
+    size_t stolen = 0;              /* Chunks this worker stole.  */
+};
+
+/* num_threads - 1 worker threads and the thread calling work_pool_run run
+   the chunks of a job.  Each starts with an equal share of the chunks and
+   steals half of the chunks left to another worker when it runs out.  */
+struct work_pool_t {
+    int num_threads = 0;
+    std::vector<std::thread> threads;
+    struct work_deque_t *deques = NULL;
+
+    std::mutex lock;
+    std::condition_variable start;
+    std::condition_variable done;
+    unsigned long int generation = 0;   /* Jobs started.  */
+    int running = 0;                    /* Workers still in the job.  */
+    bool quit = false;
+
+    work_fn_t fn = NULL;
+    void *arg = NULL;
+    size_t num_chunks = 0;
+};
+
+void work_pool_init (struct work_pool_t *pool, int num_threads,
+                     work_init_fn_t init_fn, void *init_arg);
+void work_pool_release (struct work_pool_t *pool);
+
+void work_pool_run (struct work_pool_t *pool, size_t num_chunks,
+                    work_fn_t fn, void *arg);
+
+/* Chunks of the last job run by a worker other than the one they were
+   first given to.  */
+size_t work_pool_stolen (const struct work_pool_t *pool);
+
+#endif /* PARALLEL_WORK_POOL_H */
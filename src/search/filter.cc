@@ -0,0 +1,82 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Selection of the database vectors a search is restricted to.  */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include "filter.h"
+
+void
+id_selector_init (struct id_selector_t *sel, size_t ny)
+{
+    size_t num_words = id_selector_num_words (ny);
+
+    sel->ny = ny;
+    sel->nids = 0;
+    sel->bitmap = (uint64_t *) calloc (num_words ? num_words : 1,
+                                       sizeof (uint64_t));
+    sel->ids = (int64_t *) malloc ((ny ? ny : 1) * sizeof (int64_t));
+
+    if (!sel->bitmap || !sel->ids)
+    {
+        std::cout << "ERROR, failed to allocate the id selector.\n";
+        exit (-1);
+    }
+}
+
+void
+id_selector_release (struct id_selector_t *sel)
+{
+    free (sel->bitmap);
+    free (sel->ids);
+    sel->bitmap = NULL;
+    sel->ids = NULL;
+    sel->ny = 0;
+    sel->nids = 0;
+}
+
+/* Deselect all of the vectors.  */
+void
+id_selector_clear (struct id_selector_t *sel)
+{
+    memset (sel->bitmap, 0,
+            id_selector_num_words (sel->ny) * sizeof (uint64_t));
+    sel->nids = 0;
+}
+
+/* Rebuild the sorted list of ids from the bitmap, only the set bits of each
+   word are visited.  */
+void
+id_selector_finish (struct id_selector_t *sel)
+{
+    size_t num_words = id_selector_num_words (sel->ny);
+    size_t n = 0;
+
+    for (size_t w = 0; w < num_words; w++)
+    {
+        uint64_t word = sel->bitmap[w];
+
+        while (word)
+        {
+            sel->ids[n++] = (int64_t) (w * ID_SELECTOR_WORD_BITS
+                                       + __builtin_ctzll (word));
+            word &= word - 1;
+        }
+    }
+    sel->nids = n;
+}
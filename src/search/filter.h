@@ -0,0 +1,63 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEARCH_FILTER_H
+#define SEARCH_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define ID_SELECTOR_WORD_BITS 64
+
+/* Vectors 0 to ny - 1 of a database a search is restricted to, such as the
+   vectors matching a metadata filter.  The selection is held both as a
+   dense bitmap, bit i % 64 of word i / 64 set for a selected vector i, and
+   as the sorted list of the selected ids, so a kernel can use whichever
+   suits the selectivity.  */
+struct id_selector_t {
+    size_t ny = 0;
+    uint64_t *bitmap = NULL;        /* id_selector_num_words (ny) words.  */
+    size_t nids = 0;                /* Number of selected vectors.  */
+    int64_t *ids = NULL;            /* Sorted, valid after finish.  */
+};
+
+void id_selector_init (struct id_selector_t *sel, size_t ny);
+void id_selector_release (struct id_selector_t *sel);
+void id_selector_clear (struct id_selector_t *sel);
+void id_selector_finish (struct id_selector_t *sel);
+
+static inline size_t
+id_selector_num_words (size_t ny)
+{
+    return (ny + ID_SELECTOR_WORD_BITS - 1) / ID_SELECTOR_WORD_BITS;
+}
+
+/* Select vector id, id_selector_finish updates the list of ids.  */
+static inline void
+id_selector_add (struct id_selector_t *sel, int64_t id)
+{
+    sel->bitmap[id / ID_SELECTOR_WORD_BITS]
+        |= (uint64_t) 1 << (id % ID_SELECTOR_WORD_BITS);
+}
+
+static inline bool
+id_selector_is_member (const struct id_selector_t *sel, int64_t id)
+{
+    return (sel->bitmap[id / ID_SELECTOR_WORD_BITS]
+            >> (id % ID_SELECTOR_WORD_BITS)) & 1;
+}
+
+#endif /* SEARCH_FILTER_H */
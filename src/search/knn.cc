@@ -0,0 +1,154 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Top-k result heap and brute force k nearest neighbor search.  */
+
+#include <iostream>
+#include <cstdlib>
+#include "knn.h"
+
+void
+topk_init (struct topk_t *h, size_t k)
+{
+    h->k = k;
+    h->n = 0;
+    h->dis = (float *) malloc (k * sizeof (float));
+    h->ids = (int64_t *) malloc (k * sizeof (int64_t));
+
+    if (!h->dis || !h->ids)
+    {
+        std::cout << "ERROR, failed to allocate the top-k heap.\n";
+        exit (-1);
+    }
+}
+
+void
+topk_release (struct topk_t *h)
+{
+    free (h->dis);
+    free (h->ids);
+    h->dis = NULL;
+    h->ids = NULL;
+    h->k = 0;
+    h->n = 0;
+}
+
+void
+topk_reset (struct topk_t *h)
+{
+    h->n = 0;
+}
+
+static inline void
+topk_swap (struct topk_t *h, size_t i, size_t j)
+{
+    float dis = h->dis[i];
+    int64_t id = h->ids[i];
+
+    h->dis[i] = h->dis[j];
+    h->ids[i] = h->ids[j];
+    h->dis[j] = dis;
+    h->ids[j] = id;
+}
+
+void
+topk_sift_up (struct topk_t *h, size_t i)
+{
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+
+        if (h->dis[parent] >= h->dis[i])
+            break;
+        topk_swap (h, parent, i);
+        i = parent;
+    }
+}
+
+/* Restore the heap below i for the first n entries.  */
+static void
+sift_down_n (struct topk_t *h, size_t i, size_t n)
+{
+    for (;;)
+    {
+        size_t largest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < n && h->dis[left] > h->dis[largest])
+            largest = left;
+        if (right < n && h->dis[right] > h->dis[largest])
+            largest = right;
+        if (largest == i)
+            break;
+        topk_swap (h, i, largest);
+        i = largest;
+    }
+}
+
+void
+topk_sift_down (struct topk_t *h, size_t i)
+{
+    sift_down_n (h, i, h->n);
+}
+
+/* Sort the results by increasing distance.  The heap property is lost, call
+   topk_reset before reusing the heap.  */
+void
+topk_sort (struct topk_t *h)
+{
+    size_t n;
+
+    for (n = h->n; n > 1; n--)
+    {
+        topk_swap (h, 0, n - 1);
+        sift_down_n (h, 0, n - 1);
+    }
+}
+
+/* Find the k vectors of y closest to x with the distance function fn.  The
+   ny vectors of y are y_stride floats apart.  The results are added to res
+   and are not sorted.  */
+void
+knn_search (knn_distance_fn_t fn, const float *x, const float *y,
+            size_t ny, size_t y_stride, size_t d, struct topk_t *res)
+{
+    for (size_t i = 0; i < ny; i++)
+    {
+        float dis = fn (x, y + i * y_stride, d);
+
+        if (dis < topk_threshold (res))
+            topk_push (res, dis, (int64_t) i);
+    }
+}
+
+/* As knn_search, with the threshold of the heap passed to fn so it can stop
+   computing the distance of a vector that can not enter the heap.  The
+   threshold is FLT_MAX until the heap holds k results.  */
+void
+knn_search_early (knn_early_distance_fn_t fn, const float *x,
+                  const float *y, size_t ny, size_t y_stride, size_t d,
+                  struct topk_t *res)
+{
+    for (size_t i = 0; i < ny; i++)
+    {
+        float threshold = topk_threshold (res);
+        float dis = fn (x, y + i * y_stride, d, threshold);
+
+        if (dis < threshold)
+            topk_push (res, dis, (int64_t) i);
+    }
+}
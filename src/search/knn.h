@@ -0,0 +1,84 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEARCH_KNN_H
+#define SEARCH_KNN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cfloat>
+
+/* Distance function used by the searches, one of the base, optimized or
+   intrinsic versions of a pair distance such as fvec_L2sqr_ref.  Smaller
+   distances are better.  */
+typedef float (*knn_distance_fn_t) (const float* x, const float* y,
+                                    size_t d);
+
+/* Distance function that may stop once the distance reaches threshold, such
+   as fvec_L2sqr_early_ref.  The result is exact if it is below threshold.  */
+typedef float (*knn_early_distance_fn_t) (const float* x, const float* y,
+                                          size_t d, float threshold);
+
+/* The k best results seen so far, kept as a max-heap on the distance so
+   dis[0] is the k-th best distance and the threshold a new candidate has to
+   beat.  */
+struct topk_t {
+    size_t k = 0;
+    size_t n = 0;                   /* Number of results held, <= k.  */
+    float *dis = NULL;
+    int64_t *ids = NULL;
+};
+
+void topk_init (struct topk_t *h, size_t k);
+void topk_release (struct topk_t *h);
+void topk_reset (struct topk_t *h);
+void topk_sort (struct topk_t *h);
+
+void topk_sift_down (struct topk_t *h, size_t i);
+void topk_sift_up (struct topk_t *h, size_t i);
+
+/* Distance a candidate has to be below to enter the heap.  */
+static inline float
+topk_threshold (const struct topk_t *h)
+{
+    return h->n < h->k ? FLT_MAX : h->dis[0];
+}
+
+static inline void
+topk_push (struct topk_t *h, float dis, int64_t id)
+{
+    if (h->n < h->k)
+    {
+        h->dis[h->n] = dis;
+        h->ids[h->n] = id;
+        topk_sift_up (h, h->n);
+        h->n++;
+    }
+    else if (dis < h->dis[0])
+    {
+        h->dis[0] = dis;
+        h->ids[0] = id;
+        topk_sift_down (h, 0);
+    }
+}
+
+void knn_search (knn_distance_fn_t fn, const float *x, const float *y,
+                 size_t ny, size_t y_stride, size_t d, struct topk_t *res);
+void knn_search_early (knn_early_distance_fn_t fn, const float *x,
+                       const float *y, size_t ny, size_t y_stride, size_t d,
+                       struct topk_t *res);
+
+#endif /* SEARCH_KNN_H */
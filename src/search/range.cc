@@ -0,0 +1,73 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Growable result buffer of the range searches.  */
+
+#include <iostream>
+#include <cstdlib>
+#include "range.h"
+
+#define RANGE_RESULT_MIN_CAPACITY 64
+
+void
+range_result_init (struct range_result_t *r, size_t capacity)
+{
+    r->n = 0;
+    r->capacity = 0;
+    r->dis = NULL;
+    r->ids = NULL;
+    range_result_grow (r, capacity);
+}
+
+void
+range_result_release (struct range_result_t *r)
+{
+    free (r->dis);
+    free (r->ids);
+    r->dis = NULL;
+    r->ids = NULL;
+    r->n = 0;
+    r->capacity = 0;
+}
+
+void
+range_result_reset (struct range_result_t *r)
+{
+    r->n = 0;
+}
+
+/* Grow the arrays to hold at least min_capacity results, doubling the
+   capacity so appending n results costs O(n) copies.  */
+void
+range_result_grow (struct range_result_t *r, size_t min_capacity)
+{
+    size_t capacity = r->capacity ? r->capacity : RANGE_RESULT_MIN_CAPACITY;
+
+    while (capacity < min_capacity)
+        capacity *= 2;
+    if (capacity == r->capacity)
+        return;
+
+    r->dis = (float *) realloc (r->dis, capacity * sizeof (float));
+    r->ids = (int64_t *) realloc (r->ids, capacity * sizeof (int64_t));
+
+    if (!r->dis || !r->ids)
+    {
+        std::cout << "ERROR, failed to allocate the range search results.\n";
+        exit (-1);
+    }
+    r->capacity = capacity;
+}
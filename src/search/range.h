@@ -0,0 +1,56 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEARCH_RANGE_H
+#define SEARCH_RANGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Results of a range search, the ids and distances of the vectors within
+   the radius in the order they were found.  The arrays grow as needed, so
+   the caller does not have to know the number of results in advance.  */
+struct range_result_t {
+    size_t n = 0;                   /* Number of results held.  */
+    size_t capacity = 0;
+    float *dis = NULL;
+    int64_t *ids = NULL;
+};
+
+void range_result_init (struct range_result_t *r, size_t capacity);
+void range_result_release (struct range_result_t *r);
+void range_result_reset (struct range_result_t *r);
+void range_result_grow (struct range_result_t *r, size_t min_capacity);
+
+/* Make room for n more results, so they can be stored without checking
+   the capacity for each one.  */
+static inline void
+range_result_reserve (struct range_result_t *r, size_t n)
+{
+    if (r->n + n > r->capacity)
+        range_result_grow (r, r->n + n);
+}
+
+static inline void
+range_result_push (struct range_result_t *r, float dis, int64_t id)
+{
+    range_result_reserve (r, 1);
+    r->dis[r->n] = dis;
+    r->ids[r->n] = id;
+    r->n++;
+}
+
+#endif /* SEARCH_RANGE_H */
@@ -0,0 +1,208 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Arena allocator for the vector storage.  Plain malloc only guarantees 16
+   byte alignment on Power and the vectors of the test arrays could share
+   cache lines, so the arrays, datasets and indexes get their vectors from
+   an arena instead.
+
+   The chunks can be backed by huge pages, reducing the TLB misses of
+   scanning a large database.  Transparent huge pages are requested with
+   madvise, reserved huge pages (vm.nr_hugepages) are mapped with
+   MAP_HUGETLB, falling back to transparent huge pages if none are
+   free.  */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#include "arena.h"
+#include "numa.h"
+
+void
+arena_init (struct arena_t *a, size_t chunk_size, int flags)
+{
+    a->chunks = NULL;
+    a->chunk_size = chunk_size ? chunk_size : ARENA_CHUNK_SIZE;
+    a->flags = flags;
+    a->node = NUMA_NODE_ANY;
+    a->bytes = 0;
+    a->hugetlb_failed = false;
+}
+
+void
+arena_release (struct arena_t *a)
+{
+    struct arena_chunk_t *chunk, *next;
+
+    for (chunk = a->chunks; chunk; chunk = next)
+    {
+        next = chunk->next;
+#if defined(__linux__)
+        if (chunk->mapped)
+            munmap (chunk->data, chunk->size);
+        else
+#endif
+            free (chunk->data);
+        delete chunk;
+    }
+    a->chunks = NULL;
+    a->bytes = 0;
+}
+
+/* The default huge page size, from /proc/meminfo.  */
+size_t
+arena_huge_page_size (void)
+{
+    static size_t huge_page_size = 0;
+#if defined(__linux__)
+    FILE *file;
+    char line[128];
+    unsigned long int kb;
+
+    if (huge_page_size)
+        return huge_page_size;
+
+    file = fopen ("/proc/meminfo", "r");
+    if (file)
+    {
+        while (fgets (line, sizeof (line), file))
+            if (sscanf (line, "Hugepagesize: %lu kB", &kb) == 1)
+            {
+                huge_page_size = kb * 1024;
+                break;
+            }
+        fclose (file);
+    }
+#endif
+    if (huge_page_size == 0)
+        huge_page_size = ARENA_HUGE_PAGE_SIZE;
+
+    return huge_page_size;
+}
+
+/* Map a chunk of reserved huge pages.  Returns NULL if there are not
+   enough free huge pages.  */
+static void*
+arena_map_hugetlb (size_t size)
+{
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    void *data = mmap (NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    return data == MAP_FAILED ? NULL : data;
+#else
+    return NULL;
+#endif
+}
+
+static struct arena_chunk_t*
+arena_new_chunk (struct arena_t *a, size_t bytes)
+{
+    struct arena_chunk_t *chunk = new struct arena_chunk_t;
+    size_t align = ARENA_ALIGN;
+    long page_size = sysconf (_SC_PAGESIZE);
+    void *data = NULL;
+
+    chunk->size = bytes > a->chunk_size ? bytes : a->chunk_size;
+
+    /* Bound and madvise'd chunks start on a page so the other allocations
+       on the page are not affected.  */
+    if (((a->flags & (ARENA_PAGE_ALIGN | ARENA_BASE_PAGES))
+         || a->node != NUMA_NODE_ANY) && page_size > (long) align)
+        align = page_size;
+
+    /* Huge page chunks are rounded up to whole huge pages.  */
+    if (a->flags & (ARENA_HUGE_PAGES | ARENA_HUGETLB))
+    {
+        align = arena_huge_page_size ();
+        chunk->size = (chunk->size + align - 1) / align * align;
+    }
+
+    if (a->flags & ARENA_HUGETLB)
+    {
+        data = arena_map_hugetlb (chunk->size);
+        if (data)
+            chunk->mapped = true;
+        else
+            a->hugetlb_failed = true;
+    }
+
+    if (data == NULL && posix_memalign (&data, align, chunk->size) != 0)
+    {
+        std::cout << "ERROR, failed to allocate a " << chunk->size
+                  << " byte arena chunk.\n";
+        exit (-1);
+    }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (!chunk->mapped && (a->flags & (ARENA_HUGE_PAGES | ARENA_HUGETLB)))
+        madvise (data, chunk->size, MADV_HUGEPAGE);
+#endif
+#if defined(__linux__) && defined(MADV_NOHUGEPAGE)
+    if (a->flags & ARENA_BASE_PAGES)
+        madvise (data, chunk->size, MADV_NOHUGEPAGE);
+#endif
+
+    /* Bind the pages before they are first touched by the memset.  */
+    if (numa_bind_memory (data, chunk->size, a->node))
+    {
+        std::cout << "WARNING, could not bind an arena chunk to ";
+        if (a->node == NUMA_NODE_INTERLEAVE)
+            std::cout << "all nodes";
+        else
+            std::cout << "node " << a->node;
+        std::cout << ", placed on first touch.\n";
+    }
+
+    memset (data, 0, chunk->size);
+    chunk->data = (char *) data;
+    chunk->next = a->chunks;
+    a->chunks = chunk;
+    return chunk;
+}
+
+/* A zeroed block of at least bytes bytes starting on an ARENA_ALIGN byte
+   boundary.  Exits if there is no memory.  */
+void*
+arena_alloc (struct arena_t *a, size_t bytes)
+{
+    struct arena_chunk_t *chunk = a->chunks;
+    void *block;
+
+    /* Keep the next block aligned.  */
+    bytes = (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    if (bytes == 0)
+        bytes = ARENA_ALIGN;
+
+    if (chunk == NULL || chunk->size - chunk->used < bytes)
+        chunk = arena_new_chunk (a, bytes);
+
+    block = chunk->data + chunk->used;
+    chunk->used += bytes;
+    a->bytes += bytes;
+    return block;
+}
+
+void*
+arena_alloc_vectors (struct arena_t *a, size_t n, size_t d, size_t elem_size)
+{
+    return arena_alloc (a, n * arena_padded_dim (d, elem_size) * elem_size);
+}
@@ -0,0 +1,88 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_ARENA_H
+#define STORAGE_ARENA_H
+
+#include <cstddef>
+
+/* Every block starts on a Power cache line.  The optimized versions of the
+   functions load the vectors with vector float pointers, so the blocks
+   are also 16 byte aligned.  */
+#define ARENA_ALIGN          128
+
+/* Vectors are padded to a multiple of a VSX register.  */
+#define ARENA_VEC_BYTES      16
+
+/* Default size of the chunks the blocks are carved from.  */
+#define ARENA_CHUNK_SIZE     (1024 * 1024)
+
+/* Flags of arena_init, the pages backing the chunks.  By default the
+   chunks get whatever pages the OS gives.  */
+#define ARENA_HUGE_PAGES     0x1   /* Transparent huge pages, madvise.  */
+#define ARENA_HUGETLB        0x2   /* Reserved huge pages, MAP_HUGETLB.  */
+#define ARENA_BASE_PAGES     0x4   /* No transparent huge pages.  */
+#define ARENA_PAGE_ALIGN     0x8   /* Chunks start on a page.  */
+
+/* Huge page size if the OS does not report it.  */
+#define ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+struct arena_chunk_t {
+    struct arena_chunk_t *next = NULL;
+    char *data = NULL;
+    size_t size = 0;
+    size_t used = 0;
+    bool mapped = false;            /* From mmap, else posix_memalign.  */
+};
+
+/* Blocks are carved from a list of chunks and are only released all at
+   once by arena_release.  Blocks larger than the chunk size get a chunk of
+   their own.  All of the memory is zeroed.  The chunks are bound to node
+   before they are first touched, see numa_bind_memory.  */
+struct arena_t {
+    struct arena_chunk_t *chunks = NULL;
+    size_t chunk_size = ARENA_CHUNK_SIZE;
+    int flags = 0;
+    int node = -1;                  /* NUMA_NODE_ANY, first touch.  */
+    size_t bytes = 0;               /* Bytes handed out.  */
+    bool hugetlb_failed = false;    /* Fell back from MAP_HUGETLB.  */
+};
+
+void arena_init (struct arena_t *a, size_t chunk_size, int flags);
+void arena_release (struct arena_t *a);
+size_t arena_huge_page_size (void);
+
+void* arena_alloc (struct arena_t *a, size_t bytes);
+
+/* Number of elements of elem_size bytes in a vector of dimension d padded
+   to a multiple of ARENA_VEC_BYTES.  */
+static inline size_t
+arena_padded_dim (size_t d, size_t elem_size)
+{
+    size_t per_vec = ARENA_VEC_BYTES / elem_size;
+
+    return (d + per_vec - 1) / per_vec * per_vec;
+}
+
+/* n vectors of dimension d, each padded to arena_padded_dim elements.  The
+   padding is zero, so L2, L1, inner product, cosine and Hamming distances
+   over the padded dimension equal those over d and the functions can be
+   called with the padded dimension, never running their scalar tail
+   loop.  */
+void* arena_alloc_vectors (struct arena_t *a, size_t n, size_t d,
+                           size_t elem_size);
+
+#endif /* STORAGE_ARENA_H */
@@ -0,0 +1,195 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/* NUMA topology and memory binding of the vector storage.  The topology is
+   read from sysfs and the memory is bound with the mbind system call, so
+   libnuma is not needed.  On other systems there is one node and the
+   binding is not done.  */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#include "numa.h"
+
+/* Memory policy modes and flags of mbind, see linux/mempolicy.h.  */
+#define NUMA_MPOL_BIND        2
+#define NUMA_MPOL_INTERLEAVE  3
+#define NUMA_MPOL_MF_MOVE     (1 << 1)
+
+/* Read a sysfs list of ranges such as 0-7,16-23.  Returns non zero if the
+   file can not be read.  */
+static int
+read_range_list (const char *path, std::vector<int> &list)
+{
+    FILE *file = fopen (path, "r");
+    int first, last;
+    char sep = '\n';
+
+    list.clear ();
+    if (file == NULL)
+        return 1;
+
+    while (fscanf (file, "%d", &first) == 1)
+    {
+        last = first;
+        if (fscanf (file, "%c", &sep) != 1)
+            sep = '\n';
+        if (sep == '-')
+        {
+            if (fscanf (file, "%d", &last) != 1)
+                break;
+            if (fscanf (file, "%c", &sep) != 1)
+                sep = '\n';
+        }
+        for (int i = first; i <= last; i++)
+            list.push_back (i);
+        if (sep != ',')
+            break;
+    }
+    fclose (file);
+    return 0;
+}
+
+/* The online memory nodes.  The node numbers need not be consecutive, for
+   example 0 and 8.  */
+void
+numa_online_nodes (std::vector<int> &nodes)
+{
+    if (read_range_list ("/sys/devices/system/node/online", nodes)
+        || nodes.empty ())
+        nodes.assign (1, 0);
+}
+
+int
+numa_node_of_cpu (int cpu)
+{
+    char path[64];
+    struct dirent *entry;
+    DIR *dir;
+    int node = 0;
+
+    /* Not pinned, the CPU the thread is running on now.  */
+#if defined(__linux__)
+    if (cpu < 0)
+        cpu = sched_getcpu ();
+#endif
+    if (cpu < 0)
+        return 0;
+
+    /* The cpu directory has a nodeN link to its node.  */
+    snprintf (path, sizeof (path), "/sys/devices/system/cpu/cpu%d", cpu);
+    dir = opendir (path);
+    if (dir == NULL)
+        return 0;
+
+    while ((entry = readdir (dir)) != NULL)
+        if (strncmp (entry->d_name, "node", 4) == 0
+            && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+        {
+            node = atoi (entry->d_name + 4);
+            break;
+        }
+
+    closedir (dir);
+    return node;
+}
+
+/* The CPUs of a node.  Returns non zero if the node has no CPUs, for
+   example a memory only node.  */
+int
+numa_node_cpus (int node, std::vector<int> &cpus)
+{
+    char path[64];
+
+    snprintf (path, sizeof (path), "/sys/devices/system/node/node%d/cpulist",
+              node);
+    if (read_range_list (path, cpus))
+    {
+        long num_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+        /* No sysfs, one node with all of the CPUs.  */
+        cpus.clear ();
+        if (node != 0)
+            return 1;
+        for (long i = 0; i < (num_cpus > 0 ? num_cpus : 1); i++)
+            cpus.push_back ((int) i);
+    }
+    return cpus.empty ();
+}
+
+/* Bind the pages of addr to the memory node, or interleave them over all of
+   the nodes.  Must be called before the pages are touched, addr must be
+   page aligned.  Returns non zero if the memory could not be bound.  */
+int
+numa_bind_memory (void *addr, size_t len, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long int mask[NUMA_MAX_NODES / (8 * sizeof (unsigned long int))];
+    const int bits = 8 * sizeof (unsigned long int);
+    int mode = NUMA_MPOL_BIND;
+
+    if (node == NUMA_NODE_ANY)
+        return 0;
+
+    memset (mask, 0, sizeof (mask));
+
+    if (node == NUMA_NODE_INTERLEAVE)
+    {
+        std::vector<int> nodes;
+
+        numa_online_nodes (nodes);
+        mode = NUMA_MPOL_INTERLEAVE;
+        for (size_t i = 0; i < nodes.size (); i++)
+            if (nodes[i] < NUMA_MAX_NODES)
+                mask[nodes[i] / bits] |= 1UL << (nodes[i] % bits);
+    }
+    else if (node >= 0 && node < NUMA_MAX_NODES)
+        mask[node / bits] |= 1UL << (node % bits);
+    else
+        return 1;
+
+    /* The kernel reads maxnode - 1 bits of the mask.  */
+    if (syscall (SYS_mbind, addr, len, mode, mask, NUMA_MAX_NODES + 1,
+                 NUMA_MPOL_MF_MOVE) != 0)
+        return 1;
+
+    return 0;
+#else
+    return node == NUMA_NODE_ANY ? 0 : 1;
+#endif
+}
+
+/* The next online node after node, node itself on a single node
+   system.  */
+int
+numa_remote_node (int node)
+{
+    std::vector<int> nodes;
+
+    numa_online_nodes (nodes);
+    for (size_t i = 0; i < nodes.size (); i++)
+        if (nodes[i] == node)
+            return nodes[(i + 1) % nodes.size ()];
+
+    return nodes[0];
+}
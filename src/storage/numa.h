@@ -0,0 +1,37 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STORAGE_NUMA_H
+#define STORAGE_NUMA_H
+
+#include <cstddef>
+#include <vector>
+
+/* Memory node arguments of numa_bind_memory that are not a node number.  */
+#define NUMA_NODE_ANY         -1   /* No binding, placed on first touch.  */
+#define NUMA_NODE_INTERLEAVE  -2   /* Interleaved over all of the nodes.  */
+
+/* Largest node number supported by numa_bind_memory.  */
+#define NUMA_MAX_NODES        256
+
+void numa_online_nodes (std::vector<int> &nodes);
+int numa_node_of_cpu (int cpu);
+int numa_remote_node (int node);
+int numa_node_cpus (int node, std::vector<int> &cpus);
+int numa_bind_memory (void *addr, size_t len, int node);
+
+#endif /* STORAGE_NUMA_H */
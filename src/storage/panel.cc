@@ -0,0 +1,79 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Panel (blocked structure of arrays) vector storage.  */
+
+#include <iostream>
+#include <cstdlib>
+#include "panel.h"
+
+void
+panel_store_init (struct panel_store_t *p, size_t n, size_t d, size_t width)
+{
+    if (width != 4 && width != 8 && width != PANEL_MAX_WIDTH)
+    {
+        std::cout << "ERROR, panel width " << width
+                  << " is not supported, use 4, 8 or 16.\n";
+        exit (-1);
+    }
+
+    p->n = n;
+    p->d = d;
+    p->width = width;
+    p->num_panels = (n + width - 1) / width;
+
+    /* The arena zeroes the memory, which pads the last panel.  */
+    arena_init (&p->arena, ARENA_CHUNK_SIZE, 0);
+    p->data = (float *) arena_alloc (&p->arena, p->num_panels * d * width
+                                                * sizeof (float));
+}
+
+void
+panel_store_release (struct panel_store_t *p)
+{
+    arena_release (&p->arena);
+    p->data = NULL;
+    p->n = 0;
+    p->num_panels = 0;
+}
+
+/* Store the n row-major vectors of x, stride floats apart, in panels of
+   width vectors.  */
+void
+panel_store_from_rows (struct panel_store_t *p, const float *x, size_t n,
+                       size_t d, size_t stride, size_t width)
+{
+    panel_store_init (p, n, d, width);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        float *panel = p->data + (i / width) * d * width + i % width;
+
+        for (size_t j = 0; j < d; j++)
+            panel[j * width] = x[i * stride + j];
+    }
+}
+
+/* Copy vector i back to the d floats of row.  */
+void
+panel_store_get_row (const struct panel_store_t *p, size_t i, float *row)
+{
+    const float *panel = p->data + (i / p->width) * p->d * p->width
+                         + i % p->width;
+
+    for (size_t j = 0; j < p->d; j++)
+        row[j] = panel[j * p->width];
+}
@@ -0,0 +1,58 @@
+/**
+ * © Copyright IBM Corporation 2024. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_PANEL_H
+#define STORAGE_PANEL_H
+
+#include <cstddef>
+#include "arena.h"
+
+/* Vectors per panel supported by the panel kernels.  */
+#define PANEL_MAX_WIDTH 16
+
+/* n vectors of dimension d stored in panels of width vectors interleaved
+   by dimension, width is 4, 8 or 16.  Element j of vector i is
+   data[(i / width) * d * width + j * width + i % width], so the width
+   elements of dimension j of a panel are consecutive and one vector load
+   holds 4 database vectors.  The last panel is zero padded to width
+   vectors.  */
+struct panel_store_t {
+    size_t n = 0;
+    size_t d = 0;
+    size_t width = 0;
+    size_t num_panels = 0;
+    float *data = NULL;
+    struct arena_t arena;
+};
+
+void panel_store_init (struct panel_store_t *p, size_t n, size_t d,
+                       size_t width);
+void panel_store_release (struct panel_store_t *p);
+
+void panel_store_from_rows (struct panel_store_t *p, const float *x,
+                            size_t n, size_t d, size_t stride,
+                            size_t width);
+void panel_store_get_row (const struct panel_store_t *p, size_t i,
+                          float *row);
+
+/* Floats of one panel.  */
+static inline size_t
+panel_store_panel_size (const struct panel_store_t *p)
+{
+    return p->d * p->width;
+}
+
+#endif /* STORAGE_PANEL_H */